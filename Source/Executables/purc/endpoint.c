@@ -1105,6 +1105,84 @@ static int on_update(pcmcth_renderer* rdr, pcmcth_endpoint* endpoint,
     return update_dom(rdr, endpoint, msg, PCRDR_K_OPERATION_UPDATE);
 }
 
+static int apply_change(pcmcth_renderer* rdr, pcmcth_endpoint* endpoint,
+        pcmcth_udom *dom, purc_variant_t change)
+{
+    purc_variant_t v;
+    const char *op_name = NULL;
+    const char *element_value = NULL;
+    const char *property = NULL;
+
+    if ((v = purc_variant_object_get_by_ckey(change, "operation")))
+        op_name = purc_variant_get_string_const(v);
+    if ((v = purc_variant_object_get_by_ckey(change, "element")))
+        element_value = purc_variant_get_string_const(v);
+    if ((v = purc_variant_object_get_by_ckey(change, "property")))
+        property = purc_variant_get_string_const(v);
+    purc_clr_error();
+
+    purc_atom_t op_atom = op_name ? pcrdr_try_operation_atom(op_name) : 0;
+    unsigned int op;
+    if (op_atom == 0 || element_value == NULL ||
+            pcrdr_operation_from_atom(op_atom, &op) == NULL ||
+            op < PCRDR_K_OPERATION_APPEND || op > PCRDR_K_OPERATION_CLEAR) {
+        return PCRDR_SC_BAD_REQUEST;
+    }
+
+    /* the same constraint on the data as update_dom() */
+    purc_variant_t data = purc_variant_object_get_by_ckey(change, "data");
+    purc_clr_error();
+    if (data != PURC_VARIANT_INVALID && !purc_variant_is_native(data)) {
+        return PCRDR_SC_BAD_REQUEST;
+    }
+
+    return rdr->cbs.update_udom(endpoint->session, dom, op,
+            strtoull(element_value, NULL, 16), property, data);
+}
+
+static int on_apply_changes(pcmcth_renderer* rdr, pcmcth_endpoint* endpoint,
+        const pcrdr_msg *msg)
+{
+    int retv = PCRDR_SC_OK;
+    pcmcth_udom *dom = NULL;
+    pcrdr_msg response = { };
+    size_t nr_changes = 0, i = 0;
+
+    if (msg->target != PCRDR_MSG_TARGET_DOM ||
+            msg->dataType != PCRDR_MSG_DATA_TYPE_JSON ||
+            !purc_variant_array_size(msg->data, &nr_changes)) {
+        retv = PCRDR_SC_BAD_REQUEST;
+        goto done;
+    }
+
+    dom = (pcmcth_udom *)(uintptr_t)msg->targetValue;
+    if (dom == NULL) {
+        retv = PCRDR_SC_NOT_FOUND;
+        goto done;
+    }
+
+    /* stop at the first failed change and report its index;
+       a change not implemented by the uDOM yet is not a failure */
+    for (i = 0; i < nr_changes; i++) {
+        retv = apply_change(rdr, endpoint, dom,
+                purc_variant_array_get(msg->data, i));
+        if (retv == PCRDR_SC_NOT_IMPLEMENTED)
+            retv = PCRDR_SC_OK;
+        else if (retv != PCRDR_SC_OK)
+            break;
+    }
+    purc_clr_error();
+
+done:
+    response.type = PCRDR_MSG_TYPE_RESPONSE;
+    response.requestId = msg->requestId;
+    response.sourceURI = PURC_VARIANT_INVALID;
+    response.retCode = retv;
+    response.resultValue = i;
+    response.dataType = PCRDR_MSG_DATA_TYPE_VOID;
+    return send_simple_response(rdr, endpoint, &response);
+}
+
 static int on_call_method(pcmcth_renderer* rdr, pcmcth_endpoint* endpoint,
         const pcrdr_msg *msg)
 {
@@ -1411,6 +1489,7 @@ static struct request_handler {
 } handlers[] = {
     { PCRDR_OPERATION_ADDPAGEGROUPS, on_add_page_groups },
     { PCRDR_OPERATION_APPEND, on_append },
+    { PCRDR_OPERATION_APPLYCHANGES, on_apply_changes },
     { PCRDR_OPERATION_CALLMETHOD, on_call_method },
     { PCRDR_OPERATION_CLEAR, on_clear },
     { PCRDR_OPERATION_CREATEPLAINWINDOW, on_create_plain_window },
@@ -692,7 +692,7 @@ pcdoc_elem_coll_new_from_descendants(purc_document_t doc,
                     PCDOC_SPECIAL_ELEM_ROOT);
         }
 
-        if (!doc->ops->elem_coll_select(doc, coll, ancestor, selector)) {
+        if (doc->ops->elem_coll_select(doc, coll, ancestor, selector)) {
             pcdoc_elem_coll_delete(doc, coll);
             coll = NULL;
         }
@@ -702,13 +702,13 @@ pcdoc_elem_coll_new_from_descendants(purc_document_t doc,
 }
 
 pcdoc_elem_coll_t
-pcdoc_elem_coll_filter(purc_document_t doc,
+pcdoc_elem_coll_select(purc_document_t doc,
         pcdoc_elem_coll_t elem_coll, const char *selector)
 {
     pcdoc_elem_coll_t dst_coll = element_collection_new(selector);
 
     if (doc->ops->elem_coll_filter) {
-        if (!doc->ops->elem_coll_filter(doc, dst_coll,
+        if (doc->ops->elem_coll_filter(doc, dst_coll,
                 elem_coll, selector)) {
             pcdoc_elem_coll_delete(doc, dst_coll);
             dst_coll = NULL;
@@ -718,12 +718,31 @@ pcdoc_elem_coll_filter(purc_document_t doc,
     return dst_coll;
 }
 
+size_t
+pcdoc_elem_coll_count(purc_document_t doc, pcdoc_elem_coll_t elem_coll)
+{
+    UNUSED_PARAM(doc);
+
+    return pcutils_arrlist_length(elem_coll->elems);
+}
+
+pcdoc_element_t
+pcdoc_elem_coll_get(purc_document_t doc, pcdoc_elem_coll_t elem_coll,
+        size_t idx)
+{
+    UNUSED_PARAM(doc);
+
+    return pcutils_arrlist_get_idx(elem_coll->elems, idx);
+}
+
 void
 pcdoc_elem_coll_delete(purc_document_t doc,
         pcdoc_elem_coll_t elem_coll)
 {
     UNUSED_PARAM(doc);
 
+    if (elem_coll->selector)
+        free(elem_coll->selector);
     pcutils_arrlist_free(elem_coll->elems);
     return free(elem_coll);
 }
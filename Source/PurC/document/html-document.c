@@ -79,6 +79,7 @@ static purc_document_t create(const char *content, size_t length)
 static void destroy(purc_document_t doc)
 {
     assert(doc->impl);
+    pcdoc_html_selector_cleanup(doc);
     pchtml_html_document_destroy(doc->impl);
     free(doc);
 }
@@ -138,6 +139,20 @@ static const dom_node_op dom_node_ops[] = {
     dom_displace_content_by_node,
 };
 
+/* adds the descendants of the element to the indexes or removes them
+   from the indexes (before they are destroyed) */
+static void
+update_children_indexes(purc_document_t doc, pcdom_element_t *element,
+        bool add)
+{
+    pcdom_node_t *child = pcdom_interface_node(element)->first_child;
+    for (; child; child = child->next) {
+        if (child->type == PCDOM_NODE_TYPE_ELEMENT)
+            pcdoc_html_update_indexes(doc, (pcdoc_element_t)child,
+                    true, add);
+    }
+}
+
 static inline void
 dom_erase_element(pcdom_element_t *element)
 {
@@ -162,10 +177,12 @@ static pcdoc_element_t operate_element(purc_document_t doc,
     UNUSED_PARAM(self_close);
 
     if (op == PCDOC_OP_ERASE) {
+        pcdoc_html_update_indexes(doc, elem, true, false);
         dom_erase_element(pcdom_interface_element(elem));
         return NULL;
     }
     else if (op == PCDOC_OP_CLEAR) {
+        update_children_indexes(doc, pcdom_interface_element(elem), false);
         dom_clear_element(pcdom_interface_element(elem));
         return elem;
     }
@@ -181,6 +198,8 @@ static pcdoc_element_t operate_element(purc_document_t doc,
     new_elem = pcdom_document_create_element(dom_doc,
             (const unsigned char*)tag, strlen(tag), NULL, self_close);
     if (new_elem) {
+        if (op == PCDOC_OP_DISPLACE)
+            update_children_indexes(doc, dom_elem, false);
         dom_node_ops[op](dom_elem, pcdom_interface_node(new_elem));
     }
     else {
@@ -207,6 +226,8 @@ static pcdoc_text_node_t new_text_content(purc_document_t doc,
     text_node = pcdom_document_create_text_node(dom_doc,
             (const unsigned char *)text, length ? length : strlen(text));
     if (text_node) {
+        if (op == PCDOC_OP_DISPLACE)
+            update_children_indexes(doc, dom_elem, false);
         dom_node_ops[op](dom_elem, pcdom_interface_node(text_node));
     }
     else {
@@ -391,6 +412,12 @@ static pcdoc_node new_content(purc_document_t doc,
     pcdom_node_t *dom_node = subtree->first_child->first_child;
 
     if (subtree) {
+        if (op == PCDOC_OP_DISPLACE)
+            update_children_indexes(doc, dom_elem, false);
+
+        /* the new elements are still the children of the wrapping div */
+        update_children_indexes(doc,
+                pcdom_interface_element(subtree->first_child), true);
         dom_subtree_ops[op](dom_elem, subtree);
     }
     else {
@@ -427,13 +454,9 @@ dom_remove_element_attr(pcdom_element_t *element, const char* name)
     return retv;
 }
 
-static int set_attribute(purc_document_t doc,
-            pcdoc_element_t elem, pcdoc_operation op,
+static int dom_set_attribute(pcdom_element_t *dom_elem, pcdoc_operation op,
             const char *name, const char *val, size_t len)
 {
-    UNUSED_PARAM(doc);
-
-    pcdom_element_t *dom_elem = pcdom_interface_element(elem);
     if (op == PCDOC_OP_ERASE) {
         return dom_remove_element_attr(dom_elem, name);
     }
@@ -457,6 +480,27 @@ static int set_attribute(purc_document_t doc,
     return -1;
 }
 
+static int set_attribute(purc_document_t doc,
+            pcdoc_element_t elem, pcdoc_operation op,
+            const char *name, const char *val, size_t len)
+{
+    pcdom_element_t *dom_elem = pcdom_interface_element(elem);
+
+    /* only `id` and `class` affect the indexes */
+    bool indexed = (strcasecmp(name, "id") == 0 ||
+            strcasecmp(name, "class") == 0);
+
+    if (indexed)
+        pcdoc_html_update_indexes(doc, elem, false, false);
+
+    int ret = dom_set_attribute(dom_elem, op, name, val, len);
+
+    if (indexed)
+        pcdoc_html_update_indexes(doc, elem, false, true);
+
+    return ret;
+}
+
 static pcdoc_element_t special_elem(purc_document_t doc,
             pcdoc_special_elem which)
 {
@@ -1001,7 +1045,8 @@ struct purc_document_ops _pcdoc_html_ops = {
     .get_data = NULL,
     .travel = travel,
     .serialize = serialize,
-    .elem_coll_select = NULL,
-    .elem_coll_filter = NULL,
+    .find_elem = pcdoc_html_find_elem,
+    .elem_coll_select = pcdoc_html_elem_coll_select,
+    .elem_coll_filter = pcdoc_html_elem_coll_filter,
 };
 
@@ -0,0 +1,1419 @@
+/**
+ * @file html-selector.c
+ * @author
+ * @date 2026/10/16
+ * @brief The CSS selector engine and the element indexes of html document.
+ *
+ * Copyright (C) 2022 FMSoft <https://www.fmsoft.cn>
+ *
+ * This file is a part of PurC (short for Purring Cat), an HVML interpreter.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+// #undef NDEBUG
+
+#include "purc-document.h"
+#include "purc-errors.h"
+#include "purc-html.h"
+
+#include "private/document.h"
+#include "private/debug.h"
+#include "private/map.h"
+#include "private/sorted-array.h"
+
+#include <ctype.h>
+#include <string.h>
+#include <strings.h>
+
+/*
+ * The selectors are compiled into the same shape as the selectors of
+ * CSSEng (see `css_selector_type` and `css_combinator` in
+ * CSSEng/select/stylesheet.h): a selector group is a list of complex
+ * selectors; a complex selector is a chain of compound selectors joined
+ * by combinators; a compound selector is an optional type selector
+ * followed by a list of details.
+ */
+
+/* the maximal number of compiled selectors cached by a document */
+#define SEL_CACHE_MAX_ENTRIES       64
+
+/* the maximal number of a in an+b we accept */
+#define SEL_NTH_MAX                 1000000
+
+/* the keys shorter than this do not need a heap buffer */
+#define SZ_KEY_BUFF                 64
+
+typedef enum sel_detail_type {
+    SEL_DETAIL_CLASS,
+    SEL_DETAIL_ID,
+    SEL_DETAIL_PSEUDO_CLASS,
+    SEL_DETAIL_ATTRIBUTE,
+    SEL_DETAIL_ATTRIBUTE_EQUAL,
+    SEL_DETAIL_ATTRIBUTE_DASHMATCH,
+    SEL_DETAIL_ATTRIBUTE_INCLUDES,
+    SEL_DETAIL_ATTRIBUTE_PREFIX,
+    SEL_DETAIL_ATTRIBUTE_SUFFIX,
+    SEL_DETAIL_ATTRIBUTE_SUBSTRING,
+    SEL_DETAIL_NEGATION,
+} sel_detail_type;
+
+typedef enum sel_pseudo_class {
+    SEL_PSEUDO_ROOT,
+    SEL_PSEUDO_EMPTY,
+    SEL_PSEUDO_FIRST_CHILD,
+    SEL_PSEUDO_LAST_CHILD,
+    SEL_PSEUDO_ONLY_CHILD,
+    SEL_PSEUDO_FIRST_OF_TYPE,
+    SEL_PSEUDO_LAST_OF_TYPE,
+    SEL_PSEUDO_ONLY_OF_TYPE,
+    SEL_PSEUDO_NTH_CHILD,
+    SEL_PSEUDO_NTH_LAST_CHILD,
+    SEL_PSEUDO_NTH_OF_TYPE,
+    SEL_PSEUDO_NTH_LAST_OF_TYPE,
+} sel_pseudo_class;
+
+typedef enum sel_combinator {
+    SEL_COMBINATOR_NONE,
+    SEL_COMBINATOR_ANCESTOR,
+    SEL_COMBINATOR_PARENT,
+    SEL_COMBINATOR_SIBLING,
+    SEL_COMBINATOR_GENERIC_SIBLING,
+} sel_combinator;
+
+struct sel_compound;
+
+struct sel_detail {
+    sel_detail_type     type;
+    sel_pseudo_class    pseudo;
+
+    /* match the attribute value case-insensitively (the `i` flag) */
+    bool                icase;
+
+    /* the id, the class (in lowercase), or the attribute name */
+    char               *name;
+    size_t              name_len;
+
+    /* the attribute value */
+    char               *value;
+    size_t              value_len;
+
+    /* an+b for :nth-*() */
+    int                 a, b;
+
+    /* the argument of :not() */
+    struct sel_compound *negation;
+};
+
+struct sel_compound {
+    /* the combinator between this compound and the previous one */
+    sel_combinator      comb;
+
+    /* the tag name in lowercase; NULL for the universal selector */
+    char               *tag;
+    size_t              tag_len;
+
+    size_t              nr_details;
+    struct sel_detail  *details;
+};
+
+struct sel_complex {
+    size_t              nr_compounds;
+    struct sel_compound *compounds;
+};
+
+struct sel_group {
+    size_t              nr_complexes;
+    struct sel_complex *complexes;
+};
+
+struct pcdoc_html_sel_ctxt {
+    /* the compiled selectors, keyed by the selector text */
+    pcutils_map        *cache;
+
+    /* id -> sorted array of elements */
+    pcutils_map        *id_index;
+
+    /* class (in lowercase) -> sorted array of elements */
+    pcutils_map        *class_index;
+
+    /* whether the indexes have been built */
+    bool                indexed;
+};
+
+static inline bool is_space(char c)
+{
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r' ||
+        c == '\f' || c == '\v';
+}
+
+static inline bool is_name_char(char c)
+{
+    unsigned char uc = (unsigned char)c;
+    return uc == '-' || uc == '_' || uc == '\\' || isalnum(uc) || uc >= 0x80;
+}
+
+static inline const char *skip_spaces(const char *p)
+{
+    while (is_space(*p))
+        p++;
+    return p;
+}
+
+static void compound_clean(struct sel_compound *compound)
+{
+    for (size_t i = 0; i < compound->nr_details; i++) {
+        struct sel_detail *detail = compound->details + i;
+
+        free(detail->name);
+        free(detail->value);
+        if (detail->negation) {
+            compound_clean(detail->negation);
+            free(detail->negation);
+        }
+    }
+
+    free(compound->details);
+    free(compound->tag);
+}
+
+static void group_delete(struct sel_group *group)
+{
+    for (size_t i = 0; i < group->nr_complexes; i++) {
+        struct sel_complex *complex = group->complexes + i;
+
+        for (size_t j = 0; j < complex->nr_compounds; j++)
+            compound_clean(complex->compounds + j);
+        free(complex->compounds);
+    }
+
+    free(group->complexes);
+    free(group);
+}
+
+static void group_free_val(void *val)
+{
+    group_delete(val);
+}
+
+/* parses an identifier with the escapes resolved; NULL if empty */
+static char *parse_name(const char **pp, bool to_lower, size_t *len)
+{
+    const char *p = *pp;
+    char *name = malloc(strlen(p) + 1);
+    size_t n = 0;
+
+    if (name == NULL) {
+        purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
+        return NULL;
+    }
+
+    while (is_name_char(*p)) {
+        unsigned char c = (unsigned char)*p;
+        if (c == '\\') {
+            if (p[1] == '\0')
+                break;
+            c = (unsigned char)p[1];
+            p += 2;
+        }
+        else {
+            p++;
+        }
+
+        name[n++] = to_lower ? (char)tolower(c) : (char)c;
+    }
+
+    if (n == 0) {
+        free(name);
+        purc_set_error(PURC_ERROR_INVALID_VALUE);
+        return NULL;
+    }
+
+    name[n] = '\0';
+    *len = n;
+    *pp = p;
+    return name;
+}
+
+static char *parse_string(const char **pp, size_t *len)
+{
+    const char *p = *pp;
+    char quote = *p++;
+    char *str = malloc(strlen(p) + 1);
+    size_t n = 0;
+
+    if (str == NULL) {
+        purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
+        return NULL;
+    }
+
+    while (*p && *p != quote) {
+        if (*p == '\\' && p[1])
+            p++;
+        str[n++] = *p++;
+    }
+
+    if (*p != quote) {
+        free(str);
+        purc_set_error(PURC_ERROR_INVALID_VALUE);
+        return NULL;
+    }
+
+    str[n] = '\0';
+    *len = n;
+    *pp = p + 1;
+    return str;
+}
+
+static bool parse_integer(const char **pp, int *value)
+{
+    const char *p = *pp;
+    int n = 0;
+
+    if (!isdigit((unsigned char)*p))
+        return false;
+
+    while (isdigit((unsigned char)*p)) {
+        n = n * 10 + (*p - '0');
+        if (n > SEL_NTH_MAX)
+            return false;
+        p++;
+    }
+
+    *value = n;
+    *pp = p;
+    return true;
+}
+
+/* parses the argument of :nth-*(): odd, even, an+b, or b */
+static bool parse_nth(const char **pp, int *a, int *b)
+{
+    const char *p = *pp;
+
+    if (strncasecmp(p, "odd", 3) == 0 && !is_name_char(p[3])) {
+        *a = 2;
+        *b = 1;
+        p += 3;
+    }
+    else if (strncasecmp(p, "even", 4) == 0 && !is_name_char(p[4])) {
+        *a = 2;
+        *b = 0;
+        p += 4;
+    }
+    else {
+        int sign = 1, n = 1;
+        bool has_n;
+
+        if (*p == '+') {
+            p++;
+        }
+        else if (*p == '-') {
+            sign = -1;
+            p++;
+        }
+
+        has_n = parse_integer(&p, &n);
+        if (*p == 'n' || *p == 'N') {
+            *a = sign * n;
+            p = skip_spaces(p + 1);
+            if (*p == '+' || *p == '-') {
+                int sign_b = (*p == '-') ? -1 : 1;
+                p = skip_spaces(p + 1);
+                if (!parse_integer(&p, &n))
+                    return false;
+                *b = sign_b * n;
+            }
+            else {
+                *b = 0;
+            }
+        }
+        else if (has_n) {
+            *a = 0;
+            *b = sign * n;
+        }
+        else {
+            return false;
+        }
+    }
+
+    *pp = p;
+    return true;
+}
+
+static const struct {
+    const char         *name;
+    sel_pseudo_class    pseudo;
+} pseudo_classes[] = {
+    { "root",           SEL_PSEUDO_ROOT },
+    { "empty",          SEL_PSEUDO_EMPTY },
+    { "first-child",    SEL_PSEUDO_FIRST_CHILD },
+    { "last-child",     SEL_PSEUDO_LAST_CHILD },
+    { "only-child",     SEL_PSEUDO_ONLY_CHILD },
+    { "first-of-type",  SEL_PSEUDO_FIRST_OF_TYPE },
+    { "last-of-type",   SEL_PSEUDO_LAST_OF_TYPE },
+    { "only-of-type",   SEL_PSEUDO_ONLY_OF_TYPE },
+};
+
+static const struct {
+    const char         *name;
+    sel_pseudo_class    pseudo;
+} nth_pseudo_classes[] = {
+    { "nth-child",          SEL_PSEUDO_NTH_CHILD },
+    { "nth-last-child",     SEL_PSEUDO_NTH_LAST_CHILD },
+    { "nth-of-type",        SEL_PSEUDO_NTH_OF_TYPE },
+    { "nth-last-of-type",   SEL_PSEUDO_NTH_LAST_OF_TYPE },
+};
+
+static bool parse_compound(const char **pp, struct sel_compound *compound,
+        bool in_negation);
+
+static bool parse_pseudo(const char **pp, struct sel_detail *detail,
+        bool in_negation)
+{
+    const char *p = *pp + 1;
+    size_t len;
+    char *name;
+    bool ok = false;
+
+    /* pseudo elements never match an element */
+    if (*p == ':')
+        goto bad;
+
+    name = parse_name(&p, true, &len);
+    if (name == NULL)
+        return false;
+
+    detail->type = SEL_DETAIL_PSEUDO_CLASS;
+    if (*p != '(') {
+        for (size_t i = 0; i < PCA_TABLESIZE(pseudo_classes); i++) {
+            if (strcmp(name, pseudo_classes[i].name) == 0) {
+                detail->pseudo = pseudo_classes[i].pseudo;
+                ok = true;
+                break;
+            }
+        }
+    }
+    else if (strcmp(name, "not") == 0) {
+        if (!in_negation) {
+            detail->type = SEL_DETAIL_NEGATION;
+            detail->negation = calloc(1, sizeof(*detail->negation));
+            if (detail->negation) {
+                p = skip_spaces(p + 1);
+                if (parse_compound(&p, detail->negation, true)) {
+                    p = skip_spaces(p);
+                    ok = (*p == ')');
+                    p++;
+                }
+            }
+            else {
+                purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
+            }
+        }
+    }
+    else {
+        for (size_t i = 0; i < PCA_TABLESIZE(nth_pseudo_classes); i++) {
+            if (strcmp(name, nth_pseudo_classes[i].name) == 0) {
+                detail->pseudo = nth_pseudo_classes[i].pseudo;
+                p = skip_spaces(p + 1);
+                if (parse_nth(&p, &detail->a, &detail->b)) {
+                    p = skip_spaces(p);
+                    ok = (*p == ')');
+                    p++;
+                }
+                break;
+            }
+        }
+    }
+
+    free(name);
+    if (ok) {
+        *pp = p;
+        return true;
+    }
+
+bad:
+    purc_set_error(PURC_ERROR_INVALID_VALUE);
+    return false;
+}
+
+static bool parse_attribute(const char **pp, struct sel_detail *detail)
+{
+    const char *p = skip_spaces(*pp + 1);
+
+    /* the attribute names of HTML elements are in lowercase */
+    detail->name = parse_name(&p, true, &detail->name_len);
+    if (detail->name == NULL)
+        return false;
+
+    p = skip_spaces(p);
+    if (*p == ']') {
+        detail->type = SEL_DETAIL_ATTRIBUTE;
+        *pp = p + 1;
+        return true;
+    }
+
+    switch (*p) {
+    case '=':
+        detail->type = SEL_DETAIL_ATTRIBUTE_EQUAL;
+        p--;
+        break;
+    case '|':
+        detail->type = SEL_DETAIL_ATTRIBUTE_DASHMATCH;
+        break;
+    case '~':
+        detail->type = SEL_DETAIL_ATTRIBUTE_INCLUDES;
+        break;
+    case '^':
+        detail->type = SEL_DETAIL_ATTRIBUTE_PREFIX;
+        break;
+    case '$':
+        detail->type = SEL_DETAIL_ATTRIBUTE_SUFFIX;
+        break;
+    case '*':
+        detail->type = SEL_DETAIL_ATTRIBUTE_SUBSTRING;
+        break;
+    default:
+        goto bad;
+    }
+
+    if (p[1] != '=')
+        goto bad;
+
+    p = skip_spaces(p + 2);
+    if (*p == '"' || *p == '\'')
+        detail->value = parse_string(&p, &detail->value_len);
+    else
+        detail->value = parse_name(&p, false, &detail->value_len);
+    if (detail->value == NULL)
+        return false;
+
+    p = skip_spaces(p);
+    if ((*p == 'i' || *p == 'I' || *p == 's' || *p == 'S') &&
+            (is_space(p[1]) || p[1] == ']')) {
+        detail->icase = (*p == 'i' || *p == 'I');
+        p = skip_spaces(p + 1);
+    }
+
+    if (*p != ']')
+        goto bad;
+
+    *pp = p + 1;
+    return true;
+
+bad:
+    purc_set_error(PURC_ERROR_INVALID_VALUE);
+    return false;
+}
+
+static bool parse_compound(const char **pp, struct sel_compound *compound,
+        bool in_negation)
+{
+    const char *p = *pp;
+    bool empty = true;
+
+    if (*p == '*') {
+        p++;
+        empty = false;
+    }
+    else if (is_name_char(*p)) {
+        compound->tag = parse_name(&p, true, &compound->tag_len);
+        if (compound->tag == NULL)
+            return false;
+        empty = false;
+    }
+
+    while (*p == '#' || *p == '.' || *p == '[' || *p == ':') {
+        struct sel_detail *details;
+        details = realloc(compound->details,
+                sizeof(*details) * (compound->nr_details + 1));
+        if (details == NULL) {
+            purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
+            return false;
+        }
+
+        compound->details = details;
+        struct sel_detail *detail = details + compound->nr_details;
+        memset(detail, 0, sizeof(*detail));
+        compound->nr_details++;
+
+        bool ok;
+        switch (*p) {
+        case '#':
+            p++;
+            detail->type = SEL_DETAIL_ID;
+            detail->name = parse_name(&p, false, &detail->name_len);
+            ok = (detail->name != NULL);
+            break;
+
+        case '.':
+            /* class names are matched case-insensitively */
+            p++;
+            detail->type = SEL_DETAIL_CLASS;
+            detail->name = parse_name(&p, true, &detail->name_len);
+            ok = (detail->name != NULL);
+            break;
+
+        case '[':
+            ok = parse_attribute(&p, detail);
+            break;
+
+        default:
+            ok = parse_pseudo(&p, detail, in_negation);
+            break;
+        }
+
+        if (!ok)
+            return false;
+        empty = false;
+    }
+
+    if (empty) {
+        purc_set_error(PURC_ERROR_INVALID_VALUE);
+        return false;
+    }
+
+    *pp = p;
+    return true;
+}
+
+static bool parse_complex(const char **pp, struct sel_complex *complex)
+{
+    const char *p = skip_spaces(*pp);
+    sel_combinator comb = SEL_COMBINATOR_NONE;
+
+    for (;;) {
+        struct sel_compound *compounds;
+        compounds = realloc(complex->compounds,
+                sizeof(*compounds) * (complex->nr_compounds + 1));
+        if (compounds == NULL) {
+            purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
+            return false;
+        }
+
+        complex->compounds = compounds;
+        struct sel_compound *compound = compounds + complex->nr_compounds;
+        memset(compound, 0, sizeof(*compound));
+        complex->nr_compounds++;
+
+        compound->comb = comb;
+        if (!parse_compound(&p, compound, false))
+            return false;
+
+        const char *q = skip_spaces(p);
+        if (*q == '>' || *q == '+' || *q == '~') {
+            if (*q == '>')
+                comb = SEL_COMBINATOR_PARENT;
+            else if (*q == '+')
+                comb = SEL_COMBINATOR_SIBLING;
+            else
+                comb = SEL_COMBINATOR_GENERIC_SIBLING;
+            p = skip_spaces(q + 1);
+        }
+        else if (*q == ',' || *q == '\0') {
+            p = q;
+            break;
+        }
+        else if (q > p) {
+            comb = SEL_COMBINATOR_ANCESTOR;
+            p = q;
+        }
+        else {
+            purc_set_error(PURC_ERROR_INVALID_VALUE);
+            return false;
+        }
+    }
+
+    *pp = p;
+    return true;
+}
+
+static struct sel_group *group_parse(const char *selector)
+{
+    struct sel_group *group = calloc(1, sizeof(*group));
+    if (group == NULL) {
+        purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
+        return NULL;
+    }
+
+    const char *p = selector;
+    for (;;) {
+        struct sel_complex *complexes;
+        complexes = realloc(group->complexes,
+                sizeof(*complexes) * (group->nr_complexes + 1));
+        if (complexes == NULL) {
+            purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
+            goto failed;
+        }
+
+        group->complexes = complexes;
+        struct sel_complex *complex = complexes + group->nr_complexes;
+        memset(complex, 0, sizeof(*complex));
+        group->nr_complexes++;
+
+        if (!parse_complex(&p, complex))
+            goto failed;
+
+        if (*p == '\0')
+            break;
+
+        /* skip the comma */
+        p++;
+    }
+
+    return group;
+
+failed:
+    PC_DEBUG("Bad selector: %s\n", selector);
+    group_delete(group);
+    return NULL;
+}
+
+static inline pcdom_element_t *parent_element(pcdom_element_t *elem)
+{
+    pcdom_node_t *parent = elem->node.parent;
+    if (parent && parent->type == PCDOM_NODE_TYPE_ELEMENT)
+        return (pcdom_element_t *)parent;
+    return NULL;
+}
+
+static inline pcdom_element_t *prev_element(pcdom_element_t *elem)
+{
+    pcdom_node_t *node = elem->node.prev;
+    while (node && node->type != PCDOM_NODE_TYPE_ELEMENT)
+        node = node->prev;
+    return (pcdom_element_t *)node;
+}
+
+/* the next node of @node in pre-order within the subtree of @top */
+static inline pcdom_node_t *next_node(pcdom_node_t *node, pcdom_node_t *top)
+{
+    if (node->first_child)
+        return node->first_child;
+
+    while (node != top) {
+        if (node->next)
+            return node->next;
+        node = node->parent;
+    }
+
+    return NULL;
+}
+
+static bool has_token(const char *list, size_t list_len,
+        const char *token, size_t token_len, bool icase)
+{
+    const char *end = list + list_len;
+
+    while (list < end) {
+        while (list < end && is_space(*list))
+            list++;
+
+        const char *start = list;
+        while (list < end && !is_space(*list))
+            list++;
+
+        if ((size_t)(list - start) == token_len &&
+                (icase ? strncasecmp(start, token, token_len) :
+                 strncmp(start, token, token_len)) == 0)
+            return true;
+    }
+
+    return false;
+}
+
+static inline int compare_value(const char *s1, const char *s2, size_t n,
+        bool icase)
+{
+    return icase ? strncasecmp(s1, s2, n) : strncmp(s1, s2, n);
+}
+
+static bool match_attribute(pcdom_element_t *elem,
+        const struct sel_detail *detail)
+{
+    pcdom_attr_t *attr = pcdom_element_attr_is_exist(elem,
+            (const unsigned char *)detail->name, detail->name_len);
+    if (attr == NULL)
+        return false;
+
+    if (detail->type == SEL_DETAIL_ATTRIBUTE)
+        return true;
+
+    size_t len;
+    const char *value = (const char *)pcdom_attr_value(attr, &len);
+    if (value == NULL) {
+        value = "";
+        len = 0;
+    }
+
+    const char *expected = detail->value;
+    size_t exp_len = detail->value_len;
+    bool icase = detail->icase;
+
+    switch (detail->type) {
+    case SEL_DETAIL_ATTRIBUTE_EQUAL:
+        return len == exp_len &&
+            compare_value(value, expected, len, icase) == 0;
+
+    case SEL_DETAIL_ATTRIBUTE_DASHMATCH:
+        return (len == exp_len || (len > exp_len && value[exp_len] == '-')) &&
+            compare_value(value, expected, exp_len, icase) == 0;
+
+    case SEL_DETAIL_ATTRIBUTE_INCLUDES:
+        return exp_len > 0 && has_token(value, len, expected, exp_len, icase);
+
+    case SEL_DETAIL_ATTRIBUTE_PREFIX:
+        return exp_len > 0 && len >= exp_len &&
+            compare_value(value, expected, exp_len, icase) == 0;
+
+    case SEL_DETAIL_ATTRIBUTE_SUFFIX:
+        return exp_len > 0 && len >= exp_len &&
+            compare_value(value + len - exp_len, expected,
+                    exp_len, icase) == 0;
+
+    case SEL_DETAIL_ATTRIBUTE_SUBSTRING:
+        if (exp_len == 0 || len < exp_len)
+            return false;
+        for (size_t i = 0; i <= len - exp_len; i++) {
+            if (compare_value(value + i, expected, exp_len, icase) == 0)
+                return true;
+        }
+        return false;
+
+    default:
+        break;
+    }
+
+    return false;
+}
+
+/* the 1-based position of the element among its element siblings */
+static int element_position(pcdom_element_t *elem, bool from_end,
+        bool of_type)
+{
+    pcdom_node_t *self = pcdom_interface_node(elem);
+    pcdom_node_t *node = from_end ? self->next : self->prev;
+    int pos = 1;
+
+    while (node) {
+        if (node->type == PCDOM_NODE_TYPE_ELEMENT && (!of_type ||
+                    (node->local_name == self->local_name &&
+                     node->ns == self->ns)))
+            pos++;
+        node = from_end ? node->next : node->prev;
+    }
+
+    return pos;
+}
+
+static inline bool match_nth(int a, int b, int pos)
+{
+    if (a == 0)
+        return pos == b;
+
+    int diff = pos - b;
+    return diff / a >= 0 && diff % a == 0;
+}
+
+static bool match_pseudo(pcdom_element_t *elem,
+        const struct sel_detail *detail)
+{
+    pcdom_node_t *node = pcdom_interface_node(elem);
+
+    switch (detail->pseudo) {
+    case SEL_PSEUDO_ROOT:
+        return node->parent &&
+            node->parent->type == PCDOM_NODE_TYPE_DOCUMENT;
+
+    case SEL_PSEUDO_EMPTY:
+        for (pcdom_node_t *child = node->first_child; child;
+                child = child->next) {
+            if (child->type == PCDOM_NODE_TYPE_ELEMENT)
+                return false;
+            if (child->type == PCDOM_NODE_TYPE_TEXT ||
+                    child->type == PCDOM_NODE_TYPE_CDATA_SECTION) {
+                pcdom_text_t *text = pcdom_interface_text(child);
+                if (text->char_data.data.length > 0)
+                    return false;
+            }
+        }
+        return true;
+
+    case SEL_PSEUDO_FIRST_CHILD:
+        return element_position(elem, false, false) == 1;
+
+    case SEL_PSEUDO_LAST_CHILD:
+        return element_position(elem, true, false) == 1;
+
+    case SEL_PSEUDO_ONLY_CHILD:
+        return element_position(elem, false, false) == 1 &&
+            element_position(elem, true, false) == 1;
+
+    case SEL_PSEUDO_FIRST_OF_TYPE:
+        return element_position(elem, false, true) == 1;
+
+    case SEL_PSEUDO_LAST_OF_TYPE:
+        return element_position(elem, true, true) == 1;
+
+    case SEL_PSEUDO_ONLY_OF_TYPE:
+        return element_position(elem, false, true) == 1 &&
+            element_position(elem, true, true) == 1;
+
+    case SEL_PSEUDO_NTH_CHILD:
+        return match_nth(detail->a, detail->b,
+                element_position(elem, false, false));
+
+    case SEL_PSEUDO_NTH_LAST_CHILD:
+        return match_nth(detail->a, detail->b,
+                element_position(elem, true, false));
+
+    case SEL_PSEUDO_NTH_OF_TYPE:
+        return match_nth(detail->a, detail->b,
+                element_position(elem, false, true));
+
+    case SEL_PSEUDO_NTH_LAST_OF_TYPE:
+        return match_nth(detail->a, detail->b,
+                element_position(elem, true, true));
+    }
+
+    return false;
+}
+
+static bool match_compound(pcdom_element_t *elem,
+        const struct sel_compound *compound)
+{
+    if (compound->tag) {
+        size_t len;
+        const char *name;
+        name = (const char *)pcdom_element_local_name(elem, &len);
+        if (len != compound->tag_len ||
+                strncasecmp(name, compound->tag, len))
+            return false;
+    }
+
+    for (size_t i = 0; i < compound->nr_details; i++) {
+        const struct sel_detail *detail = compound->details + i;
+        const char *value;
+        size_t len;
+
+        switch (detail->type) {
+        case SEL_DETAIL_ID:
+            value = (const char *)pcdom_element_id(elem, &len);
+            if (value == NULL || len != detail->name_len ||
+                    memcmp(value, detail->name, len))
+                return false;
+            break;
+
+        case SEL_DETAIL_CLASS:
+            value = (const char *)pcdom_element_class(elem, &len);
+            if (value == NULL || !has_token(value, len,
+                        detail->name, detail->name_len, true))
+                return false;
+            break;
+
+        case SEL_DETAIL_PSEUDO_CLASS:
+            if (!match_pseudo(elem, detail))
+                return false;
+            break;
+
+        case SEL_DETAIL_NEGATION:
+            if (match_compound(elem, detail->negation))
+                return false;
+            break;
+
+        default:
+            if (!match_attribute(elem, detail))
+                return false;
+            break;
+        }
+    }
+
+    return true;
+}
+
+/* matches the compounds [0, idx] of the complex selector from right to left */
+static bool match_complex(pcdom_element_t *elem,
+        const struct sel_complex *complex, size_t idx)
+{
+    const struct sel_compound *compound = complex->compounds + idx;
+    pcdom_element_t *other;
+
+    if (!match_compound(elem, compound))
+        return false;
+
+    if (idx == 0)
+        return true;
+
+    switch (compound->comb) {
+    case SEL_COMBINATOR_ANCESTOR:
+        for (other = parent_element(elem); other;
+                other = parent_element(other)) {
+            if (match_complex(other, complex, idx - 1))
+                return true;
+        }
+        break;
+
+    case SEL_COMBINATOR_PARENT:
+        other = parent_element(elem);
+        return other && match_complex(other, complex, idx - 1);
+
+    case SEL_COMBINATOR_SIBLING:
+        other = prev_element(elem);
+        return other && match_complex(other, complex, idx - 1);
+
+    case SEL_COMBINATOR_GENERIC_SIBLING:
+        for (other = prev_element(elem); other;
+                other = prev_element(other)) {
+            if (match_complex(other, complex, idx - 1))
+                return true;
+        }
+        break;
+
+    case SEL_COMBINATOR_NONE:
+        break;
+    }
+
+    return false;
+}
+
+static bool match_group(pcdom_element_t *elem, const struct sel_group *group)
+{
+    for (size_t i = 0; i < group->nr_complexes; i++) {
+        const struct sel_complex *complex = group->complexes + i;
+        if (match_complex(elem, complex, complex->nr_compounds - 1))
+            return true;
+    }
+
+    return false;
+}
+
+static void index_free_val(void *val)
+{
+    pcutils_sorted_array_destroy(val);
+}
+
+static void index_update(pcutils_map *index, const char *key, size_t len,
+        bool to_lower, pcdom_element_t *elem, bool add)
+{
+    char buff[SZ_KEY_BUFF];
+    char *str = buff;
+
+    if (len >= sizeof(buff)) {
+        str = malloc(len + 1);
+        if (str == NULL)
+            return;
+    }
+
+    for (size_t i = 0; i < len; i++)
+        str[i] = to_lower ? (char)tolower((unsigned char)key[i]) : key[i];
+    str[len] = '\0';
+
+    pcutils_map_entry *entry = pcutils_map_find(index, str);
+    if (add) {
+        struct sorted_array *elems;
+        if (entry) {
+            elems = entry->val;
+        }
+        else {
+            elems = pcutils_sorted_array_create(SAFLAG_DEFAULT, 4,
+                    NULL, NULL);
+            if (elems && pcutils_map_insert(index, str, elems)) {
+                pcutils_sorted_array_destroy(elems);
+                elems = NULL;
+            }
+        }
+
+        /* a duplicate class name in the attribute is simply ignored */
+        if (elems)
+            pcutils_sorted_array_add(elems, elem, NULL);
+    }
+    else if (entry) {
+        struct sorted_array *elems = entry->val;
+        pcutils_sorted_array_remove(elems, elem);
+        if (pcutils_sorted_array_count(elems) == 0)
+            pcutils_map_erase(index, str);
+    }
+
+    if (str != buff)
+        free(str);
+}
+
+static void index_element(struct pcdoc_html_sel_ctxt *ctxt,
+        pcdom_element_t *elem, bool add)
+{
+    const char *value;
+    size_t len;
+
+    value = (const char *)pcdom_element_id(elem, &len);
+    if (value && len > 0)
+        index_update(ctxt->id_index, value, len, false, elem, add);
+
+    value = (const char *)pcdom_element_class(elem, &len);
+    if (value) {
+        const char *end = value + len;
+        while (value < end) {
+            while (value < end && is_space(*value))
+                value++;
+
+            const char *start = value;
+            while (value < end && !is_space(*value))
+                value++;
+
+            if (value > start)
+                index_update(ctxt->class_index, start, value - start, true,
+                        elem, add);
+        }
+    }
+}
+
+static void index_subtree(struct pcdoc_html_sel_ctxt *ctxt,
+        pcdom_node_t *top, bool add)
+{
+    for (pcdom_node_t *node = top; node; node = next_node(node, top)) {
+        if (node->type == PCDOM_NODE_TYPE_ELEMENT)
+            index_element(ctxt, pcdom_interface_element(node), add);
+    }
+}
+
+static struct pcdoc_html_sel_ctxt *get_ctxt(purc_document_t doc)
+{
+    struct pcdoc_html_sel_ctxt *ctxt = doc->sel_ctxt;
+    if (ctxt)
+        return ctxt;
+
+    ctxt = calloc(1, sizeof(*ctxt));
+    if (ctxt == NULL)
+        goto failed;
+
+    ctxt->cache = pcutils_map_create(copy_key_string, free_key_string,
+            NULL, group_free_val, comp_key_string, false);
+    ctxt->id_index = pcutils_map_create(copy_key_string, free_key_string,
+            NULL, index_free_val, comp_key_string, false);
+    ctxt->class_index = pcutils_map_create(copy_key_string, free_key_string,
+            NULL, index_free_val, comp_key_string, false);
+    if (ctxt->cache == NULL || ctxt->id_index == NULL ||
+            ctxt->class_index == NULL) {
+        doc->sel_ctxt = ctxt;
+        pcdoc_html_selector_cleanup(doc);
+        goto failed;
+    }
+
+    doc->sel_ctxt = ctxt;
+    return ctxt;
+
+failed:
+    purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
+    return NULL;
+}
+
+/* builds the indexes on the first query which can use them */
+static void ensure_indexed(purc_document_t doc,
+        struct pcdoc_html_sel_ctxt *ctxt)
+{
+    if (!ctxt->indexed) {
+        index_subtree(ctxt, pcdom_interface_node(doc->impl), true);
+        ctxt->indexed = true;
+    }
+}
+
+static struct sel_group *compile(struct pcdoc_html_sel_ctxt *ctxt,
+        const char *selector)
+{
+    pcutils_map_entry *entry = pcutils_map_find(ctxt->cache, selector);
+    if (entry)
+        return entry->val;
+
+    struct sel_group *group = group_parse(selector);
+    if (group == NULL)
+        return NULL;
+
+    if (pcutils_map_get_size(ctxt->cache) >= SEL_CACHE_MAX_ENTRIES)
+        pcutils_map_clear(ctxt->cache);
+
+    if (pcutils_map_insert(ctxt->cache, selector, group)) {
+        group_delete(group);
+        purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
+        return NULL;
+    }
+
+    return group;
+}
+
+/*
+ * Returns the index detail of the rightmost compound of the complex
+ * selector: an id is preferred to a class. NULL if there is no such one.
+ */
+static const struct sel_detail *
+index_detail(const struct sel_complex *complex)
+{
+    const struct sel_compound *compound;
+    const struct sel_detail *found = NULL;
+
+    compound = complex->compounds + complex->nr_compounds - 1;
+    for (size_t i = 0; i < compound->nr_details; i++) {
+        const struct sel_detail *detail = compound->details + i;
+        if (detail->type == SEL_DETAIL_ID)
+            return detail;
+        if (detail->type == SEL_DETAIL_CLASS && found == NULL)
+            found = detail;
+    }
+
+    return found;
+}
+
+static bool is_in_subtree(pcdom_element_t *elem, pcdom_node_t *top)
+{
+    for (pcdom_node_t *node = pcdom_interface_node(elem); node;
+            node = node->parent) {
+        if (node == top)
+            return true;
+    }
+
+    return false;
+}
+
+static size_t node_depth(pcdom_node_t *node)
+{
+    size_t depth = 0;
+    while (node->parent) {
+        node = node->parent;
+        depth++;
+    }
+
+    return depth;
+}
+
+static int compare_document_order(const void *v1, const void *v2)
+{
+    pcdom_node_t *n1 = *(pcdom_node_t **)v1;
+    pcdom_node_t *n2 = *(pcdom_node_t **)v2;
+
+    if (n1 == n2)
+        return 0;
+
+    size_t d1 = node_depth(n1);
+    size_t d2 = node_depth(n2);
+    pcdom_node_t *a = n1, *b = n2;
+
+    while (d1 > d2) {
+        a = a->parent;
+        d1--;
+    }
+    while (d2 > d1) {
+        b = b->parent;
+        d2--;
+    }
+
+    /* one is an ancestor of the other */
+    if (a == b)
+        return (a == n1) ? -1 : 1;
+
+    while (a->parent != b->parent) {
+        a = a->parent;
+        b = b->parent;
+    }
+
+    for (pcdom_node_t *node = a->next; node; node = node->next) {
+        if (node == b)
+            return -1;
+    }
+
+    return 1;
+}
+
+static int select_elements(purc_document_t doc,
+        struct pcdoc_html_sel_ctxt *ctxt, pcdom_element_t *scope,
+        const struct sel_group *group, struct pcutils_arrlist *result,
+        bool first_only)
+{
+    pcdom_node_t *top = pcdom_interface_node(scope);
+    bool use_indexes = true;
+
+    for (size_t i = 0; i < group->nr_complexes; i++) {
+        if (index_detail(group->complexes + i) == NULL) {
+            use_indexes = false;
+            break;
+        }
+    }
+
+    if (!use_indexes) {
+        for (pcdom_node_t *node = top; node; node = next_node(node, top)) {
+            if (node->type != PCDOM_NODE_TYPE_ELEMENT)
+                continue;
+
+            pcdom_element_t *elem = pcdom_interface_element(node);
+            if (match_group(elem, group)) {
+                if (pcutils_arrlist_append(result, elem))
+                    goto failed;
+                if (first_only)
+                    break;
+            }
+        }
+
+        return 0;
+    }
+
+    ensure_indexed(doc, ctxt);
+
+    /* an element may be matched by more than one complex selector */
+    struct sorted_array *selected = NULL;
+    if (group->nr_complexes > 1) {
+        selected = pcutils_sorted_array_create(SAFLAG_DEFAULT, 0, NULL, NULL);
+        if (selected == NULL)
+            goto failed;
+    }
+
+    for (size_t i = 0; i < group->nr_complexes; i++) {
+        const struct sel_complex *complex = group->complexes + i;
+        const struct sel_detail *detail = index_detail(complex);
+        pcutils_map_entry *entry;
+
+        entry = pcutils_map_find((detail->type == SEL_DETAIL_ID) ?
+                ctxt->id_index : ctxt->class_index, detail->name);
+        if (entry == NULL)
+            continue;
+
+        struct sorted_array *candidates = entry->val;
+        size_t n = pcutils_sorted_array_count(candidates);
+        for (size_t j = 0; j < n; j++) {
+            pcdom_element_t *elem;
+            elem = (pcdom_element_t *)pcutils_sorted_array_get(candidates,
+                    j, NULL);
+
+            if (!is_in_subtree(elem, top) ||
+                    !match_complex(elem, complex, complex->nr_compounds - 1))
+                continue;
+
+            if (selected) {
+                if (pcutils_sorted_array_find(selected, elem, NULL))
+                    continue;
+                pcutils_sorted_array_add(selected, elem, NULL);
+            }
+
+            if (pcutils_arrlist_append(result, elem)) {
+                if (selected)
+                    pcutils_sorted_array_destroy(selected);
+                goto failed;
+            }
+        }
+    }
+
+    if (selected)
+        pcutils_sorted_array_destroy(selected);
+
+    /* the index is ordered by address; restore the document order */
+    if (pcutils_arrlist_length(result) > 1)
+        pcutils_arrlist_sort(result, compare_document_order);
+
+    return 0;
+
+failed:
+    purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
+    return -1;
+}
+
+pcdoc_element_t
+pcdoc_html_find_elem(purc_document_t doc, pcdoc_element_t scope,
+        const char *selector)
+{
+    struct pcdoc_html_sel_ctxt *ctxt = get_ctxt(doc);
+    struct sel_group *group;
+
+    if (ctxt == NULL || (group = compile(ctxt, selector)) == NULL)
+        return NULL;
+
+    struct pcutils_arrlist *found = pcutils_arrlist_new_ex(NULL, 4);
+    if (found == NULL) {
+        purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
+        return NULL;
+    }
+
+    pcdoc_element_t elem = NULL;
+    if (select_elements(doc, ctxt, pcdom_interface_element(scope), group,
+                found, true) == 0 && pcutils_arrlist_length(found) > 0)
+        elem = pcutils_arrlist_get_idx(found, 0);
+
+    pcutils_arrlist_free(found);
+    return elem;
+}
+
+int
+pcdoc_html_elem_coll_select(purc_document_t doc,
+        pcdoc_elem_coll_t coll, pcdoc_element_t scope, const char *selector)
+{
+    struct pcdoc_html_sel_ctxt *ctxt = get_ctxt(doc);
+    struct sel_group *group;
+
+    if (ctxt == NULL || (group = compile(ctxt, selector)) == NULL)
+        return -1;
+
+    return select_elements(doc, ctxt, pcdom_interface_element(scope), group,
+            coll->elems, false);
+}
+
+int
+pcdoc_html_elem_coll_filter(purc_document_t doc,
+        pcdoc_elem_coll_t dst_coll, pcdoc_elem_coll_t src_coll,
+        const char *selector)
+{
+    struct pcdoc_html_sel_ctxt *ctxt = get_ctxt(doc);
+    struct sel_group *group;
+
+    if (ctxt == NULL || (group = compile(ctxt, selector)) == NULL)
+        return -1;
+
+    size_t n = pcutils_arrlist_length(src_coll->elems);
+    for (size_t i = 0; i < n; i++) {
+        pcdom_element_t *elem = pcutils_arrlist_get_idx(src_coll->elems, i);
+        if (match_group(elem, group) &&
+                pcutils_arrlist_append(dst_coll->elems, elem)) {
+            purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+void
+pcdoc_html_update_indexes(purc_document_t doc, pcdoc_element_t elem,
+        bool deep, bool add)
+{
+    struct pcdoc_html_sel_ctxt *ctxt = doc->sel_ctxt;
+
+    if (ctxt == NULL || !ctxt->indexed)
+        return;
+
+    if (deep)
+        index_subtree(ctxt, pcdom_interface_node(elem), add);
+    else
+        index_element(ctxt, pcdom_interface_element(elem), add);
+}
+
+void
+pcdoc_html_selector_cleanup(purc_document_t doc)
+{
+    struct pcdoc_html_sel_ctxt *ctxt = doc->sel_ctxt;
+
+    if (ctxt) {
+        if (ctxt->cache)
+            pcutils_map_destroy(ctxt->cache);
+        if (ctxt->id_index)
+            pcutils_map_destroy(ctxt->id_index);
+        if (ctxt->class_index)
+            pcutils_map_destroy(ctxt->class_index);
+        free(ctxt);
+        doc->sel_ctxt = NULL;
+    }
+}
+
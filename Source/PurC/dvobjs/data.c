@@ -2202,20 +2202,79 @@ static struct crc32algo_to_atom {
     { PURC_ALGO_CRC32Q,         0 }, // "CRC-32Q"
 };
 
-static ssize_t cb_calc_crc32(void *ctxt, const void *buf, size_t count)
+typedef void (*cb_digest_update)(void *ctxt, const void *data, size_t sz);
+
+#define SZ_DIGEST_SINK_BUFF     4096
+
+/* The stringifier writes a value piece by piece, often a few bytes at a
+   time; the sink gathers the pieces into blocks large enough for the
+   block-oriented hash engines before handing them over. */
+struct digest_sink {
+    cb_digest_update    update;
+    void               *ctxt;
+    size_t              nr_buffered;
+    unsigned char       buff[SZ_DIGEST_SINK_BUFF];
+};
+
+static ssize_t cb_digest_sink(void *ctxt, const void *buf, size_t count)
 {
-    pcutils_crc32_update(ctxt, buf, count);
+    struct digest_sink *sink = ctxt;
+
+    if (sink->nr_buffered + count > sizeof(sink->buff)) {
+        if (sink->nr_buffered > 0) {
+            sink->update(sink->ctxt, sink->buff, sink->nr_buffered);
+            sink->nr_buffered = 0;
+        }
+
+        if (count >= sizeof(sink->buff)) {
+            sink->update(sink->ctxt, buf, count);
+            return count;
+        }
+    }
+
+    memcpy(sink->buff + sink->nr_buffered, buf, count);
+    sink->nr_buffered += count;
     return count;
 }
 
+/* Feeds the stringified value to the hash context as it is generated,
+   without holding the whole string in memory. */
+static int
+digest_variant(purc_variant_t value, cb_digest_update update, void *ctxt)
+{
+    struct digest_sink sink;
+    sink.update = update;
+    sink.ctxt = ctxt;
+    sink.nr_buffered = 0;
+
+    purc_rwstream_t stream = purc_rwstream_new_for_dump(&sink, cb_digest_sink);
+    if (stream == NULL) {
+        purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
+        return -1;
+    }
+
+    ssize_t ret = purc_variant_stringify(stream, value,
+            PCVARIANT_STRINGIFY_OPT_BSEQUENCE_BAREBYTES, NULL);
+    purc_rwstream_destroy(stream);
+    if (ret < 0)
+        return -1;
+
+    if (sink.nr_buffered > 0)
+        update(ctxt, sink.buff, sink.nr_buffered);
+    return 0;
+}
+
+static void digest_crc32(void *ctxt, const void *data, size_t sz)
+{
+    pcutils_crc32_update(ctxt, data, sz);
+}
+
 static purc_variant_t
 crc32_getter(purc_variant_t root, size_t nr_args, purc_variant_t *argv,
         unsigned call_flags)
 {
     UNUSED_PARAM(root);
 
-    purc_rwstream_t stream = NULL;
-
     if (nr_args == 0) {
         purc_set_error(PURC_ERROR_ARGUMENT_MISSED);
         goto failed;
@@ -2279,20 +2338,9 @@ crc32_getter(purc_variant_t root, size_t nr_args, purc_variant_t *argv,
     }
 
     pcutils_crc32_ctxt ctxt;
-    stream = purc_rwstream_new_for_dump(&ctxt, cb_calc_crc32);
-    if (stream == NULL) {
-        purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
-        goto fatal;
-    }
-
     pcutils_crc32_begin(&ctxt, algo);
-
-    if (purc_variant_stringify(stream, argv[0],
-            PCVARIANT_STRINGIFY_OPT_BSEQUENCE_BAREBYTES, NULL) < 0) {
+    if (digest_variant(argv[0], digest_crc32, &ctxt))
         goto fatal;
-    }
-
-    purc_rwstream_destroy(stream);
 
     uint32_t crc32;
     pcutils_crc32_end(&ctxt, &crc32);
@@ -2319,16 +2367,12 @@ failed:
         return purc_variant_make_undefined();
 
 fatal:
-    if (stream)
-        purc_rwstream_destroy(stream);
     return PURC_VARIANT_INVALID;
 }
 
-static ssize_t cb_calc_md5(void *ctxt, const void *buf, size_t count)
+static void digest_md5(void *ctxt, const void *data, size_t sz)
 {
-    pcutils_md5_ctxt *md5_ctxt = ctxt;
-    pcutils_md5_hash(md5_ctxt, buf, count);
-    return count;
+    pcutils_md5_hash(ctxt, data, sz);
 }
 
 static purc_variant_t
@@ -2337,8 +2381,6 @@ md5_getter(purc_variant_t root, size_t nr_args, purc_variant_t *argv,
 {
     UNUSED_PARAM(root);
 
-    purc_rwstream_t stream = NULL;
-
     if (nr_args == 0) {
         purc_set_error(PURC_ERROR_ARGUMENT_MISSED);
         goto failed;
@@ -2364,19 +2406,9 @@ md5_getter(purc_variant_t root, size_t nr_args, purc_variant_t *argv,
     }
 
     pcutils_md5_ctxt md5_ctxt;
-    stream = purc_rwstream_new_for_dump(&md5_ctxt, cb_calc_md5);
-    if (stream == NULL) {
-        purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
-        goto fatal;
-    }
-
     pcutils_md5_begin(&md5_ctxt);
-    if (purc_variant_stringify(stream, argv[0],
-            PCVARIANT_STRINGIFY_OPT_BSEQUENCE_BAREBYTES, NULL) < 0) {
+    if (digest_variant(argv[0], digest_md5, &md5_ctxt))
         goto fatal;
-    }
-
-    purc_rwstream_destroy(stream);
 
     unsigned char md5[MD5_DIGEST_SIZE];
     pcutils_md5_end(&md5_ctxt, md5);
@@ -2400,16 +2432,12 @@ failed:
         return purc_variant_make_undefined();
 
 fatal:
-    if (stream)
-        purc_rwstream_destroy(stream);
     return PURC_VARIANT_INVALID;
 }
 
-static ssize_t cb_calc_sha1(void *ctxt, const void *buf, size_t count)
+static void digest_sha1(void *ctxt, const void *data, size_t sz)
 {
-    pcutils_sha1_ctxt *sha1_ctxt = ctxt;
-    pcutils_sha1_hash(sha1_ctxt, buf, count);
-    return count;
+    pcutils_sha1_hash(ctxt, data, sz);
 }
 
 static purc_variant_t
@@ -2418,8 +2446,6 @@ sha1_getter(purc_variant_t root, size_t nr_args, purc_variant_t *argv,
 {
     UNUSED_PARAM(root);
 
-    purc_rwstream_t stream = NULL;
-
     if (nr_args == 0) {
         purc_set_error(PURC_ERROR_ARGUMENT_MISSED);
         goto failed;
@@ -2445,19 +2471,9 @@ sha1_getter(purc_variant_t root, size_t nr_args, purc_variant_t *argv,
     }
 
     pcutils_sha1_ctxt sha1_ctxt;
-    stream = purc_rwstream_new_for_dump(&sha1_ctxt, cb_calc_sha1);
-    if (stream == NULL) {
-        purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
-        goto fatal;
-    }
-
     pcutils_sha1_begin(&sha1_ctxt);
-    if (purc_variant_stringify(stream, argv[0],
-            PCVARIANT_STRINGIFY_OPT_BSEQUENCE_BAREBYTES, NULL) < 0) {
+    if (digest_variant(argv[0], digest_sha1, &sha1_ctxt))
         goto fatal;
-    }
-
-    purc_rwstream_destroy(stream);
 
     unsigned char sha1[SHA1_DIGEST_SIZE];
     pcutils_sha1_end(&sha1_ctxt, sha1);
@@ -2482,8 +2498,6 @@ failed:
         return purc_variant_make_undefined();
 
 fatal:
-    if (stream)
-        purc_rwstream_destroy(stream);
     return PURC_VARIANT_INVALID;
 }
 
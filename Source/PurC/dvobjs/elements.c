@@ -542,11 +542,36 @@ visit_element(purc_document_t doc, pcdoc_element_t element, void *ud)
     return 0;
 }
 
+static int
+select_elements(purc_document_t doc, pcdoc_element_t root,
+        struct pcdvobjs_elements *elems, const char *css)
+{
+    pcdoc_elem_coll_t coll;
+    coll = pcdoc_elem_coll_new_from_descendants(doc, root, css);
+    if (coll == NULL)
+        return -1;
+
+    int r = 0;
+    size_t n = pcdoc_elem_coll_count(doc, coll);
+    for (size_t i = 0; i < n; i++) {
+        if (!add_element(elems, pcdoc_elem_coll_get(doc, coll, i))) {
+            r = -1;
+            break;
+        }
+    }
+
+    pcdoc_elem_coll_delete(doc, coll);
+    return r;
+}
+
 purc_variant_t
 pcdvobjs_query_elements(purc_document_t doc, pcdoc_element_t root,
         const char *css)
 {
-    if (strcmp(css, "*") != 0) {
+    /* the document has a native selector engine */
+    bool native = (doc->ops->elem_coll_select != NULL);
+
+    if (!native && strcmp(css, "*") != 0) {
         if (css[0] != '.' && css[0] != '#') {
             pcinst_set_error(PURC_ERROR_ARGUMENT_MISSED);
             return PURC_VARIANT_INVALID;
@@ -574,12 +599,19 @@ pcdvobjs_query_elements(purc_document_t doc, pcdoc_element_t root,
         return PURC_VARIANT_INVALID;
     }
 
-    struct visit_args args;
-    args.elements = (struct pcdvobjs_elements*)entity;
-    args.css      = css;
+    int r;
+    if (native) {
+        r = select_elements(doc, root, elems, css);
+    }
+    else {
+        struct visit_args args;
+        args.elements = elems;
+        args.css      = css;
+
+        r = pcdoc_travel_descendant_elements(doc, root,
+                visit_element, &args, NULL);
+    }
 
-    int r = pcdoc_travel_descendant_elements(doc, root,
-            visit_element, &args, NULL);
     if (r) {
         purc_variant_unref(elements);
         return PURC_VARIANT_INVALID;
@@ -1155,8 +1155,6 @@ substr_getter (purc_variant_t root, size_t nr_args, purc_variant_t *argv,
     UNUSED_PARAM(root);
     UNUSED_PARAM(call_flags);
 
-    purc_variant_t ret_var = PURC_VARIANT_INVALID;
-
     if ((argv == NULL) || (nr_args < 2)) {
         purc_set_error (PURC_ERROR_ARGUMENT_MISSED);
         return PURC_VARIANT_INVALID;
@@ -1166,9 +1164,10 @@ substr_getter (purc_variant_t root, size_t nr_args, purc_variant_t *argv,
         purc_set_error (PURC_ERROR_WRONG_DATA_TYPE);
         return PURC_VARIANT_INVALID;
     }
-    size_t str_len = 0;
-    purc_variant_string_bytes (argv[0], &str_len);
-    const char * src = purc_variant_get_string_const (argv[0]);
+
+    // the positions and the length are in characters
+    size_t nr_chars = 0;
+    purc_variant_string_chars (argv[0], &nr_chars);
 
     if (argv[1] == NULL || !(purc_variant_is_longint (argv[1])
             || purc_variant_is_number (argv[1]))) {
@@ -1179,16 +1178,16 @@ substr_getter (purc_variant_t root, size_t nr_args, purc_variant_t *argv,
     purc_variant_cast_to_longint (argv[1], &pos, false);
 
     // pos is valid
-    if ((int64_t)(str_len - 1) < (pos >= 0? pos : -pos))
+    if ((int64_t)nr_chars < (pos >= 0? pos : -pos))
         return purc_variant_make_string("", false);
 
     // get the start position
-    const char *start = NULL;
-    const char *end = src + str_len - 1;
+    int64_t start;
+    int64_t end = nr_chars;
     if (pos >= 0)
-        start = src + pos;
+        start = pos;
     else
-        start = src + str_len - 1 + pos;
+        start = nr_chars + pos;
 
     // get the length
     int64_t length = 0;
@@ -1216,19 +1215,8 @@ substr_getter (purc_variant_t root, size_t nr_args, purc_variant_t *argv,
     length = end - start;
     if (length == 0)
         return purc_variant_make_string("", false);
-    else {
-        char *buf = malloc (length + 1);
-        if (buf == NULL) {
-            purc_set_error (PURC_ERROR_OUT_OF_MEMORY);
-            return PURC_VARIANT_INVALID;
-        }
 
-        strncpy (buf, start, length);
-        buf[length] = 0x00;
-        ret_var = purc_variant_make_string_reuse_buff (buf, length, false);
-    }
-
-    return ret_var;
+    return purc_variant_make_substring (argv[0], start, length);
 }
 
 purc_variant_t purc_dvobj_string_new(void)
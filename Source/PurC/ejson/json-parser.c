@@ -0,0 +1,517 @@
+/*
+ * @file json-parser.c
+ * @author
+ * @date 2026/10/16
+ * @brief The fast path to build variants from plain JSON.
+ *
+ * Copyright (C) 2022 FMSoft <https://www.fmsoft.cn>
+ *
+ * This file is a part of PurC (short for Purring Cat), an HVML interpreter.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * This parser only accepts strict JSON (RFC 8259) and builds the variants
+ * directly while scanning the buffer. Anything it does not understand,
+ * including all eJSON extensions (variables in double-quoted strings,
+ * unquoted keys, single quotes, number suffixes, byte sequences, comments,
+ * and so on) as well as malformed input, makes it give up silently. The
+ * caller then runs the full eJSON tokenizer over the same input, so the
+ * result (or the error reported) is exactly the same as before.
+ */
+
+#include "config.h"
+#include "purc-utils.h"
+#include "purc-errors.h"
+#include "purc-variant.h"
+#include "private/ejson.h"
+#include "private/errors.h"
+#include "private/instance.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#define MAX_NUMBER_LEN          64
+#define MIN_STRBUF_SIZE         64
+
+struct json_parser {
+    const unsigned char *p;
+    const unsigned char *end;
+    unsigned depth;
+    unsigned max_depth;
+
+    /* scratch buffer for the strings containing escape sequences */
+    char   *strbuf;
+    size_t  sz_strbuf;
+    size_t  len_strbuf;
+};
+
+static inline bool is_json_ws(unsigned char c)
+{
+    return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+}
+
+static inline void skip_ws(struct json_parser *parser)
+{
+    while (parser->p < parser->end && is_json_ws(*parser->p))
+        parser->p++;
+}
+
+/*
+ * Returns true if the byte terminates a run of plain characters in a
+ * double-quoted string: the closing quote, a backslash, a dollar sign
+ * (eJSON variable), or a C0 control character (including the null byte).
+ */
+static inline bool is_special_in_string(unsigned char c)
+{
+    return c == '"' || c == '\\' || c == '$' || c < 0x20;
+}
+
+/* Find the end of the run of plain characters in a double-quoted string. */
+static const unsigned char *
+scan_string_run(const unsigned char *p, const unsigned char *end)
+{
+#if defined(__SSE2__)
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i bslash = _mm_set1_epi8('\\');
+    const __m128i dollar = _mm_set1_epi8('$');
+    /* c < 0x20 (unsigned) <=> (c ^ 0x80) < (0x20 ^ 0x80) (signed) */
+    const __m128i flip = _mm_set1_epi8((char)0x80);
+    const __m128i c0 = _mm_set1_epi8((char)(0x20 ^ 0x80));
+
+    while (end - p >= 16) {
+        __m128i chunk = _mm_loadu_si128((const __m128i *)p);
+        __m128i mask = _mm_or_si128(
+                _mm_or_si128(_mm_cmpeq_epi8(chunk, quote),
+                    _mm_cmpeq_epi8(chunk, bslash)),
+                _mm_or_si128(_mm_cmpeq_epi8(chunk, dollar),
+                    _mm_cmplt_epi8(_mm_xor_si128(chunk, flip), c0)));
+        int bits = _mm_movemask_epi8(mask);
+        if (bits)
+            return p + __builtin_ctz(bits);
+        p += 16;
+    }
+#endif
+
+    while (p < end && !is_special_in_string(*p))
+        p++;
+    return p;
+}
+
+static bool strbuf_append(struct json_parser *parser,
+        const void *data, size_t len)
+{
+    if (parser->len_strbuf + len > parser->sz_strbuf) {
+        size_t sz = parser->sz_strbuf ? parser->sz_strbuf : MIN_STRBUF_SIZE;
+        while (sz < parser->len_strbuf + len)
+            sz <<= 1;
+
+        char *buf = realloc(parser->strbuf, sz);
+        if (buf == NULL)
+            return false;
+        parser->strbuf = buf;
+        parser->sz_strbuf = sz;
+    }
+
+    memcpy(parser->strbuf + parser->len_strbuf, data, len);
+    parser->len_strbuf += len;
+    return true;
+}
+
+static inline int hex_value(unsigned char c)
+{
+    if (c >= '0' && c <= '9')
+        return c - '0';
+    if (c >= 'a' && c <= 'f')
+        return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F')
+        return c - 'A' + 10;
+    return -1;
+}
+
+/*
+ * Parse a double-quoted string; parser->p points to the byte after the
+ * opening quote. The escape sequences accepted are the same as the ones
+ * accepted by the eJSON tokenizer.
+ */
+static purc_variant_t parse_string(struct json_parser *parser)
+{
+    const unsigned char *start = parser->p;
+    const unsigned char *run_end = scan_string_run(start, parser->end);
+
+    if (run_end >= parser->end)
+        return PURC_VARIANT_INVALID;
+
+    if (*run_end == '"') {
+        /* the common case: no escape sequence at all */
+        parser->p = run_end + 1;
+        return purc_variant_make_string_ex((const char *)start,
+                run_end - start, true);
+    }
+
+    parser->len_strbuf = 0;
+    while (1) {
+        if (run_end > start &&
+                !strbuf_append(parser, start, run_end - start))
+            return PURC_VARIANT_INVALID;
+
+        if (run_end >= parser->end)
+            return PURC_VARIANT_INVALID;
+
+        unsigned char c = *run_end;
+        if (c == '"') {
+            parser->p = run_end + 1;
+            break;
+        }
+        else if (c != '\\') {
+            /* `$` or a control character: leave it to eJSON */
+            return PURC_VARIANT_INVALID;
+        }
+
+        const unsigned char *p = run_end + 1;
+        if (p >= parser->end)
+            return PURC_VARIANT_INVALID;
+
+        char ch;
+        switch (*p) {
+        case 'b': ch = '\b'; break;
+        case 'f': ch = '\f'; break;
+        case 'n': ch = '\n'; break;
+        case 'r': ch = '\r'; break;
+        case 't': ch = '\t'; break;
+        case '$':
+        case '{':
+        case '}':
+        case '<':
+        case '>':
+        case '/':
+        case '\\':
+        case '"':
+        case '\'':
+            ch = *p;
+            break;
+
+        case 'u': {
+            if (parser->end - p < 5)
+                return PURC_VARIANT_INVALID;
+
+            uint32_t uc = 0;
+            for (int i = 1; i <= 4; i++) {
+                int v = hex_value(p[i]);
+                if (v < 0)
+                    return PURC_VARIANT_INVALID;
+                uc = (uc << 4) | v;
+            }
+
+            /* eJSON rejects surrogates and truncates at the null char */
+            if (uc == 0 || (uc & 0xFFFFF800) == 0xD800)
+                return PURC_VARIANT_INVALID;
+
+            unsigned char mchar[8];
+            unsigned len = pcutils_unichar_to_utf8(uc, mchar);
+            if (!strbuf_append(parser, mchar, len))
+                return PURC_VARIANT_INVALID;
+            p += 4;
+            goto next;
+        }
+
+        default:
+            return PURC_VARIANT_INVALID;
+        }
+
+        if (!strbuf_append(parser, &ch, 1))
+            return PURC_VARIANT_INVALID;
+
+next:
+        start = p + 1;
+        run_end = scan_string_run(start, parser->end);
+    }
+
+    return purc_variant_make_string_ex(parser->strbuf,
+            parser->len_strbuf, true);
+}
+
+static inline bool is_digit(unsigned char c)
+{
+    return c >= '0' && c <= '9';
+}
+
+/*
+ * Parse a strict JSON number. Like eJSON, all plain numbers (integral
+ * or not) become numbers of type double.
+ */
+static purc_variant_t parse_number(struct json_parser *parser)
+{
+    const unsigned char *p = parser->p;
+    const unsigned char *end = parser->end;
+    const unsigned char *start = p;
+
+    if (p < end && *p == '-')
+        p++;
+
+    if (p >= end)
+        return PURC_VARIANT_INVALID;
+    if (*p == '0') {
+        p++;
+    }
+    else if (is_digit(*p)) {
+        while (p < end && is_digit(*p))
+            p++;
+    }
+    else
+        return PURC_VARIANT_INVALID;
+
+    if (p < end && *p == '.') {
+        p++;
+        if (p >= end || !is_digit(*p))
+            return PURC_VARIANT_INVALID;
+        while (p < end && is_digit(*p))
+            p++;
+    }
+
+    if (p < end && (*p == 'e' || *p == 'E')) {
+        p++;
+        if (p < end && (*p == '+' || *p == '-'))
+            p++;
+        if (p >= end || !is_digit(*p))
+            return PURC_VARIANT_INVALID;
+        while (p < end && is_digit(*p))
+            p++;
+    }
+
+    /* eJSON suffixes (L, UL, FL, ...) and other trailing garbage */
+    if (p < end && !is_json_ws(*p) && *p != ',' && *p != ']' && *p != '}'
+            && *p != '\0')
+        return PURC_VARIANT_INVALID;
+
+    size_t len = p - start;
+    if (len >= MAX_NUMBER_LEN)
+        return PURC_VARIANT_INVALID;
+
+    char buf[MAX_NUMBER_LEN];
+    memcpy(buf, start, len);
+    buf[len] = '\0';
+
+    parser->p = p;
+    return purc_variant_make_number(strtod(buf, NULL));
+}
+
+static bool match_keyword(struct json_parser *parser,
+        const char *keyword, size_t len)
+{
+    if ((size_t)(parser->end - parser->p) < len ||
+            memcmp(parser->p, keyword, len))
+        return false;
+
+    const unsigned char *p = parser->p + len;
+    if (p < parser->end && !is_json_ws(*p) && *p != ',' && *p != ']' &&
+            *p != '}' && *p != '\0')
+        return false;
+
+    parser->p = p;
+    return true;
+}
+
+static purc_variant_t parse_value(struct json_parser *parser);
+
+static purc_variant_t parse_array(struct json_parser *parser)
+{
+    purc_variant_t array = purc_variant_make_array_0();
+    if (array == PURC_VARIANT_INVALID)
+        return PURC_VARIANT_INVALID;
+
+    skip_ws(parser);
+    if (parser->p < parser->end && *parser->p == ']') {
+        parser->p++;
+        return array;
+    }
+
+    while (1) {
+        purc_variant_t v = parse_value(parser);
+        if (v == PURC_VARIANT_INVALID)
+            goto failed;
+
+        bool ok = purc_variant_array_append(array, v);
+        purc_variant_unref(v);
+        if (!ok)
+            goto failed;
+
+        skip_ws(parser);
+        if (parser->p >= parser->end)
+            goto failed;
+
+        unsigned char c = *parser->p++;
+        if (c == ']')
+            break;
+        if (c != ',')
+            goto failed;
+    }
+
+    return array;
+
+failed:
+    purc_variant_unref(array);
+    return PURC_VARIANT_INVALID;
+}
+
+static purc_variant_t parse_object(struct json_parser *parser)
+{
+    purc_variant_t object = purc_variant_make_object_0();
+    if (object == PURC_VARIANT_INVALID)
+        return PURC_VARIANT_INVALID;
+
+    skip_ws(parser);
+    if (parser->p < parser->end && *parser->p == '}') {
+        parser->p++;
+        return object;
+    }
+
+    while (1) {
+        skip_ws(parser);
+        if (parser->p >= parser->end || *parser->p != '"')
+            goto failed;
+        parser->p++;
+
+        purc_variant_t k = parse_string(parser);
+        if (k == PURC_VARIANT_INVALID)
+            goto failed;
+
+        skip_ws(parser);
+        if (parser->p >= parser->end || *parser->p != ':') {
+            purc_variant_unref(k);
+            goto failed;
+        }
+        parser->p++;
+
+        purc_variant_t v = parse_value(parser);
+        if (v == PURC_VARIANT_INVALID) {
+            purc_variant_unref(k);
+            goto failed;
+        }
+
+        bool ok = purc_variant_object_set(object, k, v);
+        purc_variant_unref(k);
+        purc_variant_unref(v);
+        if (!ok)
+            goto failed;
+
+        skip_ws(parser);
+        if (parser->p >= parser->end)
+            goto failed;
+
+        unsigned char c = *parser->p++;
+        if (c == '}')
+            break;
+        if (c != ',')
+            goto failed;
+    }
+
+    return object;
+
+failed:
+    purc_variant_unref(object);
+    return PURC_VARIANT_INVALID;
+}
+
+static purc_variant_t parse_value(struct json_parser *parser)
+{
+    purc_variant_t v = PURC_VARIANT_INVALID;
+
+    skip_ws(parser);
+    if (parser->p >= parser->end)
+        return PURC_VARIANT_INVALID;
+
+    switch (*parser->p) {
+    case '{':
+        if (++parser->depth > parser->max_depth)
+            break;
+        parser->p++;
+        v = parse_object(parser);
+        parser->depth--;
+        break;
+
+    case '[':
+        if (++parser->depth > parser->max_depth)
+            break;
+        parser->p++;
+        v = parse_array(parser);
+        parser->depth--;
+        break;
+
+    case '"':
+        parser->p++;
+        v = parse_string(parser);
+        break;
+
+    case 't':
+        if (match_keyword(parser, "true", 4))
+            v = purc_variant_make_boolean(true);
+        break;
+
+    case 'f':
+        if (match_keyword(parser, "false", 5))
+            v = purc_variant_make_boolean(false);
+        break;
+
+    case 'n':
+        if (match_keyword(parser, "null", 4))
+            v = purc_variant_make_null();
+        break;
+
+    default:
+        v = parse_number(parser);
+        break;
+    }
+
+    return v;
+}
+
+purc_variant_t
+pcejson_parse_plain_json(const char *json, size_t sz)
+{
+    struct json_parser parser = {
+        .p = (const unsigned char *)json,
+        .end = (const unsigned char *)json + sz,
+        .depth = 0,
+        .max_depth = PCEJSON_DEFAULT_DEPTH,
+    };
+
+    int last_error = purc_get_last_error();
+    purc_variant_t value = parse_value(&parser);
+    if (value == PURC_VARIANT_INVALID)
+        goto fallback;
+
+    /* only whitespaces are allowed after the value; a null byte means EOF */
+    skip_ws(&parser);
+    if (parser.p < parser.end && *parser.p != '\0') {
+        purc_variant_unref(value);
+        value = PURC_VARIANT_INVALID;
+        goto fallback;
+    }
+
+    free(parser.strbuf);
+    return value;
+
+fallback:
+    /* do not leak the errors raised when making variants to the caller */
+    if (purc_get_last_error() != last_error)
+        purc_set_error(last_error);
+    free(parser.strbuf);
+    return PURC_VARIANT_INVALID;
+}
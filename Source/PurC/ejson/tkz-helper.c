@@ -42,6 +42,14 @@
 #define NR_CONSUMED_LIST_LIMIT   128
 #define MIN_BUFFER_CAPACITY      32
 
+/* The size of the block read from the rwstream at once. */
+#define READER_BLOCK_SIZE        4096
+
+/* The size of the ring of decoded characters; must be a power of 2 and
+   larger than NR_CONSUMED_LIST_LIMIT. */
+#define READER_RING_SIZE         256
+#define READER_RING_MASK         (READER_RING_SIZE - 1)
+
 #if HAVE(GLIB)
 #define    PCHVML_ALLOC(sz)   g_slice_alloc0(sz)
 #define    PCHVML_FREE(p)     g_slice_free1(sizeof(*p), (gpointer)p)
@@ -50,11 +58,37 @@
 #define    PCHVML_FREE(p)     free(p)
 #endif
 
+/*
+ * The reader reads the rwstream block by block, and decodes the UTF-8
+ * characters in batches into a fixed ring. All indexes below are
+ * monotonic counters of characters; the slot of a character in the ring
+ * is given by (index & READER_RING_MASK).
+ *
+ *  - The characters in [next - nr_reconsumable, next) have been consumed,
+ *    and can be reconsumed by moving `next` back.
+ *  - The characters in [next, decoded) have been decoded (or reconsumed),
+ *    but not returned yet.
+ */
 struct tkz_reader {
     purc_rwstream_t rws;
-    struct list_head reconsume_list;
-    struct list_head consumed_list;
-    size_t nr_consumed_list;
+
+    uint8_t block[READER_BLOCK_SIZE];
+    size_t  block_len;
+    size_t  block_pos;
+    bool    eof;
+
+    struct tkz_uc ring[READER_RING_SIZE];
+    /* the number of bytes of each decoded character in the ring */
+    uint8_t ring_bytes[READER_RING_SIZE];
+    size_t  next;
+    size_t  decoded;
+    size_t  nr_reconsumable;
+    /* the highest index ever returned; used to rewind the rwstream */
+    size_t  high_water;
+
+    /* the error to set when returning the character at `error_index` */
+    int     error;
+    size_t  error_index;
 
     struct tkz_uc curr_uc;
     int line;
@@ -62,7 +96,6 @@ struct tkz_reader {
     int consumed;
 };
 
-
 struct tkz_unihan_area {
     uint32_t begin;
     uint32_t end;
@@ -90,157 +123,263 @@ bool is_unihan(uint32_t uc)
     return false;
 }
 
-struct tkz_uc *tkz_uc_new(void)
-{
-    return PCHVML_ALLOC(sizeof(struct tkz_uc));
-}
-
-void tkz_uc_destroy(struct tkz_uc *uc)
-{
-    if (uc) {
-        PCHVML_FREE(uc);
-    }
-}
-
 struct tkz_reader *tkz_reader_new(void)
 {
     struct tkz_reader *reader = PCHVML_ALLOC(sizeof(struct tkz_reader));
     if (!reader) {
         return NULL;
     }
-    INIT_LIST_HEAD(&reader->reconsume_list);
-    INIT_LIST_HEAD(&reader->consumed_list);
     reader->line = 1;
     reader->column = 0;
     reader->consumed = 0;
     return reader;
 }
 
+/*
+ * Give the bytes read ahead but not consumed back to the rwstream, so that
+ * the position of the rwstream is the same as if it were read character by
+ * character. This is the best effort; it does not work on pipes or sockets.
+ */
+static void
+tkz_reader_rewind_rwstream(struct tkz_reader *reader)
+{
+    if (reader->rws == NULL) {
+        return;
+    }
+
+    off_t unread = reader->block_len - reader->block_pos;
+    for (size_t i = reader->high_water; i < reader->decoded; i++) {
+        unread += reader->ring_bytes[i & READER_RING_MASK];
+    }
+
+    if (unread > 0) {
+        int last_error = purc_get_last_error();
+        if (purc_rwstream_seek(reader->rws, -unread, SEEK_CUR) < 0 &&
+                purc_get_last_error() != last_error) {
+            purc_set_error(last_error);
+        }
+    }
+}
+
 void tkz_reader_set_rwstream(struct tkz_reader *reader,
         purc_rwstream_t rws)
 {
+    if (reader->rws == rws) {
+        return;
+    }
+
+    tkz_reader_rewind_rwstream(reader);
     reader->rws = rws;
+    reader->block_len = 0;
+    reader->block_pos = 0;
+    reader->eof = false;
+
+    /* the characters to reconsume are kept, the ones read ahead from
+       the old rwstream have been given back to it; roll the position
+       back to the one before the first character given back */
+    if (reader->decoded > reader->high_water) {
+        struct tkz_uc *first =
+            reader->ring + (reader->high_water & READER_RING_MASK);
+        reader->line = first->line;
+        reader->column = first->column - 1;
+        reader->consumed = first->position - 1;
+    }
+    reader->decoded = reader->high_water;
+    if (reader->error && reader->error_index >= reader->decoded) {
+        reader->error = 0;
+    }
 }
 
-static struct tkz_uc*
-tkz_reader_read_from_rwstream(struct tkz_reader *reader)
+/* Read the next block; keep the `kept` bytes of a partial character. */
+static void
+tkz_reader_fill_block(struct tkz_reader *reader)
 {
-    char c[8] = {0};
-    uint32_t uc = 0;
-    int nr_c = purc_rwstream_read_utf8_char(reader->rws, c, &uc);
-    if (nr_c < 0) {
-        uc = TKZ_INVALID_CHARACTER;
+    size_t kept = reader->block_len - reader->block_pos;
+    if (kept > 0 && reader->block_pos > 0) {
+        memmove(reader->block, reader->block + reader->block_pos, kept);
     }
-    reader->column++;
-    reader->consumed++;
+    reader->block_pos = 0;
+    reader->block_len = kept;
 
-    reader->curr_uc.character = uc;
-    reader->curr_uc.line = reader->line;
-    reader->curr_uc.column = reader->column;
-    reader->curr_uc.position = reader->consumed;
-    if (uc == '\n') {
-        reader->line++;
-        reader->column = 0;
+    if (reader->rws == NULL) {
+        reader->eof = true;
+        return;
+    }
+
+    ssize_t n = purc_rwstream_read(reader->rws, reader->block + kept,
+            READER_BLOCK_SIZE - kept);
+    if (n <= 0) {
+        reader->eof = true;
+    }
+    else {
+        reader->block_len += n;
     }
-    return &reader->curr_uc;
 }
 
-static struct tkz_uc*
-tkz_reader_read_from_reconsume_list(struct tkz_reader *reader)
+/*
+ * Decode one character from the block. Returns the number of bytes of the
+ * character, 0 on EOF, or -1 on error (and sets *error). The validation
+ * follows purc_rwstream_read_utf8_char().
+ */
+static int
+tkz_reader_decode_one(struct tkz_reader *reader, uint32_t *uc, int *error)
 {
-    struct tkz_uc *puc = list_entry(reader->reconsume_list.next,
-            struct tkz_uc, list);
-    reader->curr_uc = *puc;
-    list_del_init(&puc->list);
-    tkz_uc_destroy(puc);
-    return &reader->curr_uc;
-}
+    if (reader->block_pos >= reader->block_len) {
+        if (reader->eof) {
+            return 0;
+        }
+        tkz_reader_fill_block(reader);
+        if (reader->block_pos >= reader->block_len) {
+            return 0;
+        }
+    }
 
-#define print_uc_list(uc_list, tag)                                         \
-    do {                                                                    \
-        PC_DEBUG("begin print %s list\n|", tag);                            \
-        struct list_head *p, *n;                                            \
-        list_for_each_safe(p, n, uc_list) {                                 \
-            struct tkz_uc *puc = list_entry(p, struct tkz_uc, list);        \
-            PC_DEBUG("%c", puc->character);                                 \
-        }                                                                   \
-        PC_DEBUG("|\nend print %s list\n", tag);                            \
-    } while(0)
+    const uint8_t *p = reader->block + reader->block_pos;
+    uint8_t c = p[0];
+    if (c < 0x80) {
+        reader->block_pos++;
+        *uc = c;
+        return 1;
+    }
 
-#define PRINT_CONSUMED_LIST(reader)    \
-        print_uc_list(&reader->consumed_list, "consumed")
+    if (c > 0xFD) {
+        reader->block_pos++;
+        *error = PCRWSTREAM_ERROR_IO;
+        return -1;
+    }
 
-#define PRINT_RECONSUM_LIST(reader)    \
-        print_uc_list(&reader->reconsume_list, "reconsume")
+    int ch_len = 1;
+    while (c & (0x80 >> ch_len))
+        ch_len++;
 
-static bool
-tkz_reader_add_consumed(struct tkz_reader *reader, struct tkz_uc *uc)
-{
-    struct tkz_uc *p = tkz_uc_new();
-    if (!p) {
-        pcinst_set_error(PURC_ERROR_OUT_OF_MEMORY);
-        return false;
+    if (ch_len < 2) {
+        reader->block_pos++;
+        *error = PURC_ERROR_BAD_ENCODING;
+        return -1;
+    }
+
+    if (reader->block_len - reader->block_pos < (size_t)ch_len &&
+            !reader->eof) {
+        tkz_reader_fill_block(reader);
+        p = reader->block + reader->block_pos;
     }
 
-    *p = *uc;
-    list_add_tail(&p->list, &reader->consumed_list);
-    reader->nr_consumed_list++;
+    size_t avail = reader->block_len - reader->block_pos;
+    for (int i = 1; i < ch_len; i++) {
+        if ((size_t)i >= avail || (p[i] & 0xC0) != 0x80) {
+            reader->block_pos += ((size_t)i < avail) ? (size_t)i + 1 : avail;
+            *error = PCRWSTREAM_ERROR_IO;
+            return -1;
+        }
+    }
+    reader->block_pos += ch_len;
 
-    if (reader->nr_consumed_list > NR_CONSUMED_LIST_LIMIT) {
-        struct tkz_uc *first = list_first_entry(
-                &reader->consumed_list, struct tkz_uc, list);
-        list_del_init(&first->list);
-        tkz_uc_destroy(first);
-        reader->nr_consumed_list--;
+    // FIXME: the same limitation as purc_rwstream_read_utf8_char()
+    size_t nr_chars;
+    if (ch_len > 3 || !pcutils_string_check_utf8_len((const char *)p,
+                ch_len, &nr_chars, NULL)) {
+        *error = PURC_ERROR_BAD_ENCODING;
+        return -1;
     }
-    return true;
+
+    uint32_t wc = c & ((1 << (8 - ch_len)) - 1);
+    for (int i = 1; i < ch_len; i++) {
+        wc = (wc << 6) | (p[i] & 0x3F);
+    }
+    *uc = wc;
+    return ch_len;
 }
 
-bool tkz_reader_reconsume_last_char(struct tkz_reader *reader)
+static inline void
+tkz_reader_put_char(struct tkz_reader *reader, uint32_t uc, int nr_bytes)
 {
-    if (!reader->nr_consumed_list) {
-        return true;
+    size_t slot = reader->decoded & READER_RING_MASK;
+    struct tkz_uc *puc = reader->ring + slot;
+
+    reader->column++;
+    reader->consumed++;
+
+    puc->character = uc;
+    puc->line = reader->line;
+    puc->column = reader->column;
+    puc->position = reader->consumed;
+    reader->ring_bytes[slot] = nr_bytes;
+    reader->decoded++;
+
+    if (uc == '\n') {
+        reader->line++;
+        reader->column = 0;
     }
+}
+
+/*
+ * Decode a batch of characters into the ring. Only called when all decoded
+ * characters have been returned (next == decoded); the slots of the
+ * characters which can still be reconsumed are kept.
+ */
+static void
+tkz_reader_decode_batch(struct tkz_reader *reader)
+{
+    size_t room = READER_RING_SIZE - reader->nr_reconsumable;
 
-    struct tkz_uc *last = list_last_entry(
-            &reader->consumed_list, struct tkz_uc, list);
-    list_del_init(&last->list);
-    reader->nr_consumed_list--;
+    for (size_t i = 0; i < room; i++) {
+        uint32_t uc = 0;
+        int error = 0;
+        int n = tkz_reader_decode_one(reader, &uc, &error);
+        if (n > 0) {
+            tkz_reader_put_char(reader, uc, n);
+            continue;
+        }
+
+        if (n < 0) {
+            reader->error = error;
+            reader->error_index = reader->decoded;
+            tkz_reader_put_char(reader, TKZ_INVALID_CHARACTER, 0);
+        }
+        else if (i == 0) {
+            /* like before, return one EOF character per call */
+            tkz_reader_put_char(reader, TKZ_END_OF_FILE, 0);
+        }
+        break;
+    }
+}
 
-    list_add(&last->list, &reader->reconsume_list);
+bool tkz_reader_reconsume_last_char(struct tkz_reader *reader)
+{
+    if (reader->nr_reconsumable) {
+        reader->next--;
+        reader->nr_reconsumable--;
+    }
     return true;
 }
 
 struct tkz_uc *tkz_reader_next_char(struct tkz_reader *reader)
 {
-    struct tkz_uc *ret = NULL;
-    if (list_empty(&reader->reconsume_list)) {
-        ret = tkz_reader_read_from_rwstream(reader);
+    if (reader->next == reader->decoded) {
+        tkz_reader_decode_batch(reader);
     }
-    else {
-        ret = tkz_reader_read_from_reconsume_list(reader);
+
+    size_t index = reader->next++;
+    if (reader->nr_reconsumable < NR_CONSUMED_LIST_LIMIT) {
+        reader->nr_reconsumable++;
     }
 
-    if (tkz_reader_add_consumed(reader, ret)) {
-        return ret;
+    if (index >= reader->high_water) {
+        reader->high_water = index + 1;
+        if (reader->error && index == reader->error_index) {
+            pcinst_set_error(reader->error);
+            reader->error = 0;
+        }
     }
-    return NULL;
+
+    reader->curr_uc = reader->ring[index & READER_RING_MASK];
+    return &reader->curr_uc;
 }
 
 void tkz_reader_destroy(struct tkz_reader *reader)
 {
     if (reader) {
-        struct list_head *p, *n;
-        list_for_each_safe(p, n, &reader->reconsume_list) {
-            struct tkz_uc *puc = list_entry(p, struct tkz_uc, list);
-            list_del_init(&puc->list);
-            tkz_uc_destroy(puc);
-        }
-        list_for_each_safe(p, n, &reader->consumed_list) {
-            struct tkz_uc *puc = list_entry(p, struct tkz_uc, list);
-            list_del_init(&puc->list);
-            tkz_uc_destroy(puc);
-        }
+        tkz_reader_rewind_rwstream(reader);
         PCHVML_FREE(reader);
     }
 }
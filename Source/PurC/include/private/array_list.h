@@ -199,6 +199,25 @@ pcutils_array_list_sort(struct pcutils_array_list *al,
         void *ud, int (*cmp)(struct pcutils_array_list_node *l,
                 struct pcutils_array_list_node *r, void *ud));
 
+/*
+ * Sort the array list by keys extracted once per node (decorate-sort-
+ * undecorate). `decorate` fills the `key_size` bytes of keys for a node,
+ * `cmp` compares two such key blocks, and `release` (optional) frees any
+ * resource held by a key block after sorting. Nodes with equal keys keep
+ * their original order. Large lists are sorted on several threads, so
+ * `cmp` must only touch the keys.
+ *
+ * Returns 0 on success, or -1 if `decorate` fails or there is not enough
+ * memory; the order of the list is unchanged on failure.
+ */
+int
+pcutils_array_list_sort_by_keys(struct pcutils_array_list *al,
+        size_t key_size, void *ud,
+        int (*decorate)(struct pcutils_array_list_node *node,
+                void *keys, void *ud),
+        int (*cmp)(const void *l, const void *r, void *ud),
+        void (*release)(void *keys, void *ud));
+
 PCA_EXTERN_C_END
 
 #endif // PURC_PRIVATE_ARRAY_LIST_H
@@ -67,6 +67,11 @@ struct const_str_atom {
 extern "C" {
 #endif  /* __cplusplus */
 
+/* Gets the number of the slots in the hash table of a bucket, and the
+   number of the sequence identifiers allocated by it (for testing). */
+void pcutils_atom_bucket_stats(int bucket,
+        size_t *nr_slots, size_t *nr_seq_ids) WTF_INTERNAL;
+
 #ifdef __cplusplus
 }
 #endif  /* __cplusplus */
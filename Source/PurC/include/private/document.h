@@ -162,6 +162,9 @@ struct purc_document {
     struct purc_document_ops *ops;
 
     void *impl;
+
+    /* the private data of the selector engine of the implementation */
+    void *sel_ctxt;
 };
 
 struct pcdoc_elem_coll {
@@ -181,6 +184,31 @@ extern struct purc_document_ops _pcdoc_void_ops WTF_INTERNAL;
 extern struct purc_document_ops _pcdoc_plain_ops WTF_INTERNAL;
 extern struct purc_document_ops _pcdoc_html_ops WTF_INTERNAL;
 
+/* the selector engine of html document (html-selector.c) */
+pcdoc_element_t
+pcdoc_html_find_elem(purc_document_t doc, pcdoc_element_t scope,
+        const char *selector) WTF_INTERNAL;
+
+int
+pcdoc_html_elem_coll_select(purc_document_t doc,
+        pcdoc_elem_coll_t coll, pcdoc_element_t scope,
+        const char *selector) WTF_INTERNAL;
+
+int
+pcdoc_html_elem_coll_filter(purc_document_t doc,
+        pcdoc_elem_coll_t dst_coll, pcdoc_elem_coll_t src_coll,
+        const char *selector) WTF_INTERNAL;
+
+/* Adds (@add is true) the element to or removes it from the id and class
+   indexes; the descendants are also handled if @deep is true.
+   Nothing is done if the indexes have not been built yet. */
+void
+pcdoc_html_update_indexes(purc_document_t doc, pcdoc_element_t elem,
+        bool deep, bool add) WTF_INTERNAL;
+
+void
+pcdoc_html_selector_cleanup(purc_document_t doc) WTF_INTERNAL;
+
 #ifdef __cplusplus
 }
 #endif  /* __cplusplus */
@@ -74,6 +74,14 @@ int pcejson_parse_full (struct pcvcm_node** vcm_tree, struct pcejson** parser,
                    struct tkz_reader *reader, uint32_t depth,
                    pcejson_parse_is_finished_fn is_finished);
 
+/*
+ * Build a variant directly from a buffer containing plain JSON, bypassing
+ * the eJSON tokenizer and the VCM tree. Returns PURC_VARIANT_INVALID without
+ * touching the last error if the buffer is not strict JSON (e.g. it uses
+ * eJSON extensions); the caller should then fall back to pcejson_parse().
+ */
+purc_variant_t pcejson_parse_plain_json(const char *json, size_t sz);
+
 int pcejson_set_state(struct pcejson *parser, int state);
 
 int pcejson_set_state_param_string(struct pcejson *parser);
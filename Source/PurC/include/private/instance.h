@@ -102,6 +102,8 @@ struct pcinst {
     struct pcexecutor_heap *executor_heap;
     struct pcintr_heap     *intr_heap;
     purc_runloop_t          running_loop;
+    struct pcinst_move_buffer *mvbuf;
+    struct pcregex_cache   *regex_cache;
 
     /* FIXME: enable the fields ONLY when NDEBUG is undefined */
     struct pcdebug_backtrace  *bt;
@@ -123,6 +125,10 @@ pcinst_get_session_variables(const char* name)
 struct pcrdr_msg *pcinst_get_message(void) WTF_INTERNAL;
 void pcinst_put_message(struct pcrdr_msg *msg) WTF_INTERNAL;
 
+/* waits for the messages moved to the current instance; returns 1 if there
+   are messages held, 0 on timeout, and -1 on error */
+int pcinst_move_buffer_wait(int timeout_ms) WTF_INTERNAL;
+
 int
 pcinst_broadcast_event(pcrdr_msg_event_reduce_opt reduce_op,
         purc_variant_t source_uri, purc_variant_t observed,
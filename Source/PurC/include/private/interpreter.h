@@ -118,15 +118,33 @@ struct pcintr_heap {
 
     struct list_head    crtns;
     struct list_head    stopped_crtns;
-    struct sorted_array *wait_timeout_crtns;
+
+    // coroutines which have work to do: ready to run, or having
+    // messages or tasks to handle; linked by pcintr_coroutine::ln_ready
+    struct list_head    ready_crtns;
+
+    // min-heap of stopped coroutines keyed by stopped_timeout
+    pcintr_coroutine_t *timeout_crtns;
+    size_t              nr_timeout_crtns;
+    size_t              sz_timeout_crtns;
+
+    // the one-shot timer for the nearest timeout/idle/polling deadline
+    pcintr_timer_t      sched_timer;
+    uintptr_t           rdr_monitor;    // the fd monitor of renderer
+    int                 rdr_monitor_fd;
 
     pcutils_map        *name_chan_map;  // name to channel map.
 
+    // the vDOMs returned by the loaders; see interpreter/hvml-loader.c
+    struct pcutils_arrlist *loaded_vdoms;
+
     purc_atom_t         move_buff;
     pcintr_timer_t     *event_timer;    // 10ms
 
     purc_cond_handler   cond_handler;
     unsigned int        keep_alive:1;
+    unsigned int        sched_pending:1;
+    unsigned int        sched_running:1;
     double              timestamp;
 };
 
@@ -179,6 +197,16 @@ struct pcintr_exception {
     struct pcdebug_backtrace  *bt;
 };
 
+#define PCINTR_OBSERVER_INDEX_SIZE      16
+
+/* the observers of a source indexed by the message type */
+struct pcintr_observer_index {
+    // the observers using the default matching function, by the type atom
+    struct list_head              by_type[PCINTR_OBSERVER_INDEX_SIZE];
+    // the observers using a specific matching function
+    struct list_head              others;
+};
+
 struct pcintr_stack {
     struct list_head              frames;
     // the number of stack frames.
@@ -235,6 +263,11 @@ struct pcintr_stack {
     /* create by hvml <observe on...> */
     struct list_head              hvml_observers;
 
+    struct pcintr_observer_index  intr_observer_index;
+    struct pcintr_observer_index  hvml_observer_index;
+    // the sequence number of the next observer registered
+    uint64_t                      observer_seq;
+
     // async request ids (array)
     purc_variant_t                async_request_ids;
 
@@ -293,8 +326,13 @@ struct pcintr_coroutine {
     purc_variant_t              doc_contents;
     purc_variant_t              doc_wrotten_len;
 
+    /* DOM changes not sent to the renderer (struct pcintr_dom_change) */
+    struct list_head            dom_changes;
+    size_t                      nr_dom_changes;
+
     struct rb_node              node;     /* heap::coroutines */
     struct list_head            ln;       /* heap::crtns, stopped_crtns */
+    struct list_head            ln_ready; /* heap::ready_crtns */
 
     struct list_head            children; /* struct pcintr_coroutine_child */
 
@@ -342,6 +380,7 @@ struct pcintr_coroutine {
     void                       *user_data;
     unsigned long               run_idx;
     time_t                      stopped_timeout;
+    size_t                      timeout_idx;  /* index in heap::timeout_crtns */
 };
 
 enum purc_symbol_var {
@@ -472,6 +511,10 @@ enum pcintr_observer_source {
 
 struct pcintr_observer {
     struct list_head            node;
+    // the node in the observer index of the stack
+    struct list_head            index_node;
+    // the registration order in the stack
+    uint64_t                    seq;
 
     enum pcintr_observer_source source;
     int                         cor_stage;
@@ -486,6 +529,8 @@ struct pcintr_observer {
 
     // the sub type of the message observed (cloned from the `for` attribute; nullable).
     char* sub_type;
+    // the sub type compiled as a regular expression; NULL if it is a literal.
+    struct pcregex *sub_type_regex;
 
     pcvdom_element_t scope;
     pcdoc_element_t  edom_element;
@@ -789,6 +834,14 @@ pcintr_coroutine_get_uri(pcintr_coroutine_t co)
 void
 pcintr_schedule(void *ctxt);
 
+/* queue the coroutine to be handled by the scheduler and wake it up */
+void
+pcintr_wakeup_coroutine(pcintr_coroutine_t co);
+
+/* wake up the scheduler of the instance; no-op if already pending */
+void
+pcintr_wakeup_scheduler(struct pcinst *inst);
+
 void
 pcintr_coroutine_set_result(pcintr_coroutine_t co, purc_variant_t result);
 
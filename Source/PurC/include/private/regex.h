@@ -70,6 +70,7 @@ enum pcregex_match_flags {
 
 struct pcregex;
 struct pcregex_match_info;
+struct pcregex_cache;
 
 #ifdef __cplusplus
 extern "C" {
@@ -95,8 +96,30 @@ struct pcregex *pcregex_new_ex(const char *pattern,
 
 struct pcregex *pcregex_new(const char *pattern);
 
+/*
+ * Returns a reference to the regular expression compiled from the pattern,
+ * taken from the per-instance cache of the recently used ones.
+ * Release it with pcregex_destroy().
+ */
+struct pcregex *pcregex_get_cached(const char *pattern,
+        enum pcregex_compile_flags compile_options,
+        enum pcregex_match_flags match_options);
+
+struct pcregex *pcregex_ref(struct pcregex *regex);
+
+/*
+ * Releases a reference to the regular expression.
+ */
 void pcregex_destroy(struct pcregex *regex);
 
+void pcregex_cache_destroy(struct pcregex_cache *cache);
+
+/*
+ * Returns whether the pattern contains no metacharacter, so that it
+ * matches exactly the strings containing it.
+ */
+bool pcregex_is_literal(const char *pattern);
+
 
 /*
  * Scans for a match in string for the pattern in regex.
@@ -25,5 +25,22 @@
 #ifndef PURC_PRIVATE_RWSTREAM_H
 #define PURC_PRIVATE_RWSTREAM_H
 
+#include "purc-rwstream.h"
+
+#include <stddef.h>
+
+PCA_EXTERN_C_BEGIN
+
+/*
+ * Get the pointer to the unread content of a memory-backed rwstream (created
+ * by purc_rwstream_new_from_mem() or purc_rwstream_new_buffer()), and
+ * the size of the unread content. Unlike purc_rwstream_get_mem_buffer_ex(),
+ * this function has no side effect: it returns NULL without setting any
+ * error for other types of rwstream.
+ */
+const char *pcrwstream_get_unread_mem(purc_rwstream_t rws, size_t *sz);
+
+PCA_EXTERN_C_END
+
 #endif /* not defined PURC_PRIVATE_RWSTREAM_H */
 
@@ -43,7 +43,6 @@
 
 struct tkz_reader;
 struct tkz_uc {
-    struct list_head list;
     uint32_t character;
     int line;
     int column;
@@ -30,12 +30,58 @@
 #include <stddef.h>
 #include <stdint.h>
 
+#include "config.h"
 #include "purc-utils.h"
 
+#if CPU(X86_64) && COMPILER(GCC_COMPATIBLE)
+#   define HAVE_UTF8_SIMD  1
+#endif
+
+/* The SIMD extensions which the UTF-8 validator and transcoders can use. */
+enum pcutils_utf8_simd {
+    PCUTILS_UTF8_SIMD_NONE = 0,
+    PCUTILS_UTF8_SIMD_SSE42,
+    PCUTILS_UTF8_SIMD_AVX2,
+};
+
+/* The inputs shorter than this are handled by the scalar code. */
+#define PCUTILS_UTF8_SIMD_MIN_LEN   32
+
 #ifdef __cplusplus
 extern "C" {
 #endif  /* __cplusplus */
 
+/* Returns the SIMD extension in use; it is selected according to the CPU
+   when called for the first time. */
+int pcutils_utf8_simd_level(void) WTF_INTERNAL;
+
+/* Changes the SIMD extension in use, but not to one the CPU does not
+   support, for tests and benchmarks. Returns the old one. */
+int pcutils_utf8_set_simd_level(int level) WTF_INTERNAL;
+
+/* Validates the UTF-8 string in blocks, and stops at the block which
+   contains a null byte or an invalid byte sequence, or which is not
+   complete. Returns the length of the valid characters in bytes, and
+   the number of them in `nr_chars`. */
+size_t pcutils_utf8_validate_simd(const char *str, size_t len,
+        size_t *nr_chars) WTF_INTERNAL;
+
+/* Converts the leading ASCII characters (excluding the null character)
+   of `str` to UTF-16 or UTF-32 in blocks, and returns the number of
+   characters converted. */
+size_t pcutils_utf8_ascii_to_utf16_simd(const char *str, size_t len,
+        unsigned char *bytes, bool big_endian) WTF_INTERNAL;
+size_t pcutils_utf8_ascii_to_utf32_simd(const char *str, size_t len,
+        unsigned char *bytes, bool big_endian) WTF_INTERNAL;
+
+/* Converts the leading UTF-16 or UTF-32 code units in the ASCII range
+   (excluding the null character) to UTF-8 in blocks, and returns the
+   number of code units converted. */
+size_t pcutils_utf8_ascii_from_utf16_simd(const unsigned char *bytes,
+        size_t nr_units, char *str, bool big_endian) WTF_INTERNAL;
+size_t pcutils_utf8_ascii_from_utf32_simd(const unsigned char *bytes,
+        size_t nr_units, char *str, bool big_endian) WTF_INTERNAL;
+
 #ifdef __cplusplus
 }
 #endif  /* __cplusplus */
@@ -145,12 +145,35 @@ typedef struct pcutils_crc32_ctxt {
     bool        refin;
     bool        refout;
 
+    /* one of pcutils_crc32_engine; always bytewise for custom contexts */
+    int         engine;
+    /* the slicing-by-8 tables; NULL for the bytewise engine */
+    const uint32_t (*slices)[256];
+
     union {
         const uint32_t *table_static;
         uint32_t       *table_alloc;
     };
 } pcutils_crc32_ctxt;
 
+enum pcutils_crc32_engine {
+    PCUTILS_CRC32_ENGINE_BYTEWISE = 0,
+    PCUTILS_CRC32_ENGINE_SLICING8,
+    /* the SSE4.2 crc32 instruction; CRC-32C and CRC-32/ISCSI only */
+    PCUTILS_CRC32_ENGINE_SSE42,
+    /* PCLMULQDQ folding; CRC-32 and CRC-32/JAMCRC only */
+    PCUTILS_CRC32_ENGINE_PCLMUL,
+};
+
+/* Returns the fastest engine available for the algorithm on this CPU. */
+int
+pcutils_crc32_engine(purc_crc32_algo_t algo) WTF_INTERNAL;
+
+/* Limits the engines used by the contexts begun later to the given one
+   and the ones before it (for tests); returns the previous limit. */
+int
+pcutils_crc32_set_engine_limit(int limit) WTF_INTERNAL;
+
 void
 pcutils_crc32_begin(pcutils_crc32_ctxt *ctxt, purc_crc32_algo_t algo);
 
@@ -198,6 +221,10 @@ void pcutils_sha1_hash(pcutils_sha1_ctxt *context, const void *data, size_t len)
 /* digest should be long enough (at least 20) to store the returned digest */
 void pcutils_sha1_end(pcutils_sha1_ctxt *context, uint8_t *digest);
 
+/* A fast non-cryptographic 64-bit hash (MurmurHash64A) of a byte array.
+   Pass the returned value as the seed to chain several byte arrays. */
+uint64_t pcutils_hash64(const void *data, size_t len, uint64_t seed);
+
 /* hex must be long enough to hold the heximal characters */
 void pcutils_bin2hex(const unsigned char *bin, size_t len, char *hex,
         bool uppercase);
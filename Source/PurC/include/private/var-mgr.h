@@ -56,7 +56,13 @@ int pcvarmgr_destroy(pcvarmgr_t mgr);
 bool pcvarmgr_add(pcvarmgr_t mgr, const char* name,
         purc_variant_t variant);
 
-purc_variant_t pcvarmgr_get(pcvarmgr_t mgr, const char* name);
+purc_variant_t pcvarmgr_get_ex(pcvarmgr_t mgr, const char* name,
+        bool silently);
+
+static inline purc_variant_t pcvarmgr_get(pcvarmgr_t mgr, const char* name)
+{
+    return pcvarmgr_get_ex(mgr, name, false);
+}
 
 bool pcvarmgr_remove_ex(pcvarmgr_t mgr, const char* name, bool silently);
 
@@ -40,6 +40,8 @@ PCA_EXTERN_C_BEGIN
 #define PCVARIANT_FLAG_NOFREE          PCVARIANT_FLAG_CONSTANT
 #define PCVARIANT_FLAG_EXTRA_SIZE      (0x01 << 1)  // when use extra space
 #define PCVARIANT_FLAG_STRING_STATIC   (0x01 << 2)  // make_string_static
+#define PCVARIANT_FLAG_FROZEN          (0x01 << 3)  // shared by instances
+#define PCVARIANT_FLAG_STRING_SUBSTR   (0x01 << 4)  // make_substring
 
 #define PVT(t)          (PURC_VARIANT_TYPE##t)
 #define IS_CONTAINER(t) (t == PURC_VARIANT_TYPE_OBJECT || \
@@ -102,6 +104,8 @@ struct pcvar_listener {
 };
 
 // structure for variant
+struct pcvar_str_index;
+
 struct purc_variant {
 
     /* variant type */
@@ -124,6 +128,16 @@ struct purc_variant {
 
         /* the list node for reserved variants. */
         struct list_head    reserved;
+
+        /* for string (listeners are only used by containers),
+              - `str_parent` stores the string which holds the buffer
+                of a substring;
+              - `str_index` stores the sparse character index built
+                lazily for a long string containing multi-byte characters. */
+        struct {
+            struct purc_variant    *str_parent;
+            struct pcvar_str_index *str_index;
+        };
     };
 
     /* value */
@@ -220,6 +234,13 @@ purc_variant_t pcvariant_move_heap_out(purc_variant_t v) WTF_INTERNAL;
 void pcvariant_use_move_heap(void) WTF_INTERNAL;
 void pcvariant_use_norm_heap(void) WTF_INTERNAL;
 
+/* A frozen variant lives in the move heap and is shared by instances as is;
+   its reference count is changed atomically, and it can not be changed. */
+static inline bool pcvariant_is_frozen(purc_variant_t v)
+{
+    return (v->flags & PCVARIANT_FLAG_FROZEN) != 0;
+}
+
 purc_variant *pcvariant_alloc(void) WTF_INTERNAL;
 purc_variant *pcvariant_alloc_0(void) WTF_INTERNAL;
 void pcvariant_free(purc_variant *v) WTF_INTERNAL;
@@ -245,7 +266,8 @@ struct set_node {
     struct rb_node                       rbnode;
     struct pcutils_array_list_node       alnode;
     purc_variant_t   val;  // actual variant-element
-    char             md5[33];
+    uint64_t         hash; // see pcvariant_hash_by_set()
+    struct set_node *hnext; // next node in the same hash bucket
 };
 
 struct variant_set {
@@ -255,6 +277,8 @@ struct variant_set {
     bool                    caseless;
     struct rb_root          elems;  // multiple-variant-elements stored in set
     struct pcutils_array_list al;    // struct set_node
+    struct set_node       **buckets; // hash index of elems, NULL if caseless
+    size_t                  nr_buckets; // a power of 2
 
     // key: arr_node/obj_node/set_node
     // val: parent
@@ -268,12 +292,19 @@ struct obj_node {
     struct rb_node   node;
     purc_variant_t   key;
     purc_variant_t   val;
+    // the hash value of the key string
+    uint32_t         hash;
 };
 
 struct variant_obj {
     struct rb_root          kvs;  // struct obj_node*
     size_t                  size;
 
+    // open-addressing index of the nodes by the hash values of the keys;
+    // only built when the object has more than OBJ_INDEX_THRESHOLD members.
+    struct obj_node       **index;
+    size_t                  sz_index;   // a power of 2
+
     // key: arr_node/obj_node/set_node
     // val: parent
     pcutils_map                     *rev_update_chain;
@@ -317,6 +348,41 @@ int pcvariant_array_sort(purc_variant_t value, void *ud,
 int pcvariant_set_sort(purc_variant_t value, void *ud,
         int (*cmp)(purc_variant_t l, purc_variant_t r, void *ud));
 
+/* A sort key extracted from a member once before sorting. */
+struct pcvariant_sort_key {
+    double                  d;
+    /* the stringified member; NULL if not extracted */
+    const char             *s;
+    /* the buffer allocated for `s`, if any */
+    char                   *owned;
+    /* whether the member is of a number type */
+    bool                    is_number;
+};
+
+#define PCVARIANT_SORT_KEY_NUMBER   0x01
+#define PCVARIANT_SORT_KEY_STRING   0x02
+
+/* Fills the sort key of `member` (which can be invalid) with the
+   number form, the string form, or both as specified by `forms`.
+   The string form is left NULL if the member can not be stringified. */
+void pcvariant_sort_key_extract(struct pcvariant_sort_key *key,
+        purc_variant_t member, unsigned int forms);
+void pcvariant_sort_key_release(struct pcvariant_sort_key *key);
+
+/* Fills `nr_keys` keys for a member; returns 0 on success. */
+typedef int (*pcvariant_sort_decorate_f)(purc_variant_t member,
+        struct pcvariant_sort_key *keys, void *ud);
+typedef int (*pcvariant_sort_keycmp_f)(const struct pcvariant_sort_key *l,
+        const struct pcvariant_sort_key *r, void *ud);
+
+/* Sorts the members by keys extracted once per member. */
+int pcvariant_array_sort_by_keys(purc_variant_t value, size_t nr_keys,
+        void *ud, pcvariant_sort_decorate_f decorate,
+        pcvariant_sort_keycmp_f cmp);
+int pcvariant_set_sort_by_keys(purc_variant_t value, size_t nr_keys,
+        void *ud, pcvariant_sort_decorate_f decorate,
+        pcvariant_sort_keycmp_f cmp);
+
 int pcvariant_diff(purc_variant_t l, purc_variant_t r);
 int pcvariant_diff_ex(purc_variant_t l, purc_variant_t r,
         enum purc_variant_compare_opt opt);
@@ -411,6 +477,12 @@ pcvariant_object_shallow_copy(purc_variant_t obj);
 bool
 pcvariant_object_clear(purc_variant_t object, bool silently);
 
+/* like purc_variant_object_get_by_ckey(), but a missing key sets no error
+   if @silently is true */
+purc_variant_t
+pcvariant_object_get_by_ckey_ex(purc_variant_t obj, const char* key,
+        bool silently);
+
 bool
 pcvariant_array_clear(purc_variant_t array, bool silently);
 
@@ -441,18 +513,21 @@ pcvariant_md5(char *md5, purc_variant_t val)
     pcvariant_md5_ex(md5, val, salt, caseless, serialize_flags);
 }
 
-// md5 shall be at least 33 bytes long
-void
-pcvariant_md5_by_set(char *md5, purc_variant_t val,
-        purc_variant_t set) WTF_INTERNAL;
-
-int
-pcvariant_diff_by_set(const char *md5l, purc_variant_t l,
-        const char *md5r, purc_variant_t r, purc_variant_t set);
+// the hash of the unique-key values of val in a case-sensitive set;
+// elements equal under the set's comparison have the same hash
+uint64_t
+pcvariant_hash_by_set(purc_variant_t val, purc_variant_t set) WTF_INTERNAL;
 
 bool
 pcvariant_is_sorted_array(purc_variant_t v);
 
+// the byte offset of the character at `char_idx` in a string variant;
+// `char_idx` equal to the number of characters gives the length in bytes.
+// Returns -1 if `char_idx` is out of range.
+ssize_t
+pcvariant_string_char_offset(purc_variant_t string,
+        size_t char_idx) WTF_INTERNAL;
+
 PCA_EXTERN_C_END
 
 #define PURC_VARIANT_SAFE_CLEAR(_v)             \
@@ -321,6 +321,17 @@ purc_variant_t
 pcvdom_tokenwised_eval_attr(enum pchvml_attr_operator op,
         purc_variant_t l, purc_variant_t r);
 
+/* The precompiled image of a document; see vdom/vdom-image.c.
+   The MD5 digest and the length of the HVML source are kept in the image,
+   and the image is rejected when they do not match the given ones. */
+int
+pcvdom_document_write_image(struct pcvdom_document *doc,
+        const unsigned char *md5, size_t src_length, purc_rwstream_t out);
+
+struct pcvdom_document*
+pcvdom_document_read_image(const void *image, size_t sz_image,
+        const unsigned char *md5, size_t src_length);
+
 #define PRINT_VDOM_NODE(_node)      \
     pcvdom_util_node_serialize(_node, pcvdom_util_fprintf, NULL)
 
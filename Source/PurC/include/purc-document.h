@@ -994,10 +994,11 @@ purc_document_serialize_contents_to_stream(purc_document_t doc,
 
 /**
  * Find the first element matching the CSS selector from the descendants.
+ * The ancestor itself is also checked.
  *
  * Returns: the pointer to the matching element or @NULL if no such one.
  *
- * Note: Unimplemented.
+ * Note: Only the HTML document supports CSS selectors.
  */
 PCA_EXPORT pcdoc_element_t
 pcdoc_find_element_in_descendants(purc_document_t doc,
@@ -1008,7 +1009,7 @@ pcdoc_find_element_in_descendants(purc_document_t doc,
  *
  * Returns: the pointer to the matching element or @NULL if no such one.
  *
- * Note: Unimplemented.
+ * Note: Only the HTML document supports CSS selectors.
  */
 static inline pcdoc_element_t
 pcdoc_find_element_in_document(purc_document_t doc, const char *selector)
@@ -1018,11 +1019,14 @@ pcdoc_find_element_in_document(purc_document_t doc, const char *selector)
 
 /**
  * Create an element collection by selecting the elements from the descendants
- * of the specified element according to the CSS selector.
+ * of the specified element according to the CSS selector. The ancestor itself
+ * is also checked. The elements in the collection are in document order.
  *
- * Returns: A pointer to the element collection; @NULL on failure.
+ * Returns: A pointer to the element collection; @NULL on failure
+ *  (for example, a bad selector).
  *
- * Note: Unimplemented.
+ * Note: Only the HTML document supports CSS selectors; the collection
+ *  is always empty for other documents.
  */
 PCA_EXPORT pcdoc_elem_coll_t
 pcdoc_elem_coll_new_from_descendants(purc_document_t doc,
@@ -1034,7 +1038,7 @@ pcdoc_elem_coll_new_from_descendants(purc_document_t doc,
  *
  * Returns: A pointer to the element collection; @NULL on failure.
  *
- * Note: Unimplemented.
+ * Note: Only the HTML document supports CSS selectors.
  */
 static inline pcdoc_elem_coll_t
 pcdoc_elem_coll_new_from_document(purc_document_t doc,
@@ -1049,16 +1053,35 @@ pcdoc_elem_coll_new_from_document(purc_document_t doc,
  *
  * Returns: A pointer to the new element collection; @NULL on failure.
  *
- * Note: Unimplemented.
+ * Note: Only the HTML document supports CSS selectors.
  */
 PCA_EXPORT pcdoc_elem_coll_t
 pcdoc_elem_coll_select(purc_document_t doc,
         pcdoc_elem_coll_t elem_coll, const char *selector);
 
 /**
- * Delete the speicified element collection.
+ * Get the number of the elements in the specified element collection.
+ *
+ * Returns: The number of the elements.
+ *
+ * Since: 0.9.2
+ */
+PCA_EXPORT size_t
+pcdoc_elem_coll_count(purc_document_t doc, pcdoc_elem_coll_t elem_coll);
+
+/**
+ * Get the element at the specified index in the element collection.
  *
- * Note: Unimplemented.
+ * Returns: The element or @NULL if @idx is out of range.
+ *
+ * Since: 0.9.2
+ */
+PCA_EXPORT pcdoc_element_t
+pcdoc_elem_coll_get(purc_document_t doc, pcdoc_elem_coll_t elem_coll,
+        size_t idx);
+
+/**
+ * Delete the speicified element collection.
  */
 PCA_EXPORT void
 pcdoc_elem_coll_delete(purc_document_t doc,
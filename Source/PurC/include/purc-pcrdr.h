@@ -42,10 +42,13 @@
 
 /* Constants */
 #define PCRDR_PURCMC_PROTOCOL_NAME              "PURCMC"
-#define PCRDR_PURCMC_PROTOCOL_VERSION_STRING    "110"
-#define PCRDR_PURCMC_PROTOCOL_VERSION           110
+#define PCRDR_PURCMC_PROTOCOL_VERSION_STRING    "120"
+#define PCRDR_PURCMC_PROTOCOL_VERSION           120
 #define PCRDR_PURCMC_MINIMAL_PROTOCOL_VERSION   110
 
+/* the minimal protocol version supporting the `applyChanges` operation */
+#define PCRDR_PURCMC_APPLYCHANGES_PROTOCOL_VERSION  120
+
 #define PCRDR_PURCMC_US_PATH                    "/var/tmp/purcmc.sock"
 #define PCRDR_PURCMC_WS_PORT                    "7702"
 #define PCRDR_PURCMC_WS_PORT_RESERVED           "7703"
@@ -130,9 +133,11 @@ enum {
 #define PCRDR_OPERATION_GETPROPERTY         "getProperty"
     PCRDR_K_OPERATION_SETPROPERTY,
 #define PCRDR_OPERATION_SETPROPERTY         "setProperty"
+    PCRDR_K_OPERATION_APPLYCHANGES,
+#define PCRDR_OPERATION_APPLYCHANGES        "applyChanges"
 
     /* XXX: change this when you append a new operation */
-    PCRDR_K_OPERATION_LAST = PCRDR_K_OPERATION_SETPROPERTY,
+    PCRDR_K_OPERATION_LAST = PCRDR_K_OPERATION_APPLYCHANGES,
 };
 
 #define PCRDR_NR_OPERATIONS \
@@ -193,6 +198,12 @@ enum {
 /* the maximal number of handles in a request message */
 #define PCRDR_MAX_HANDLES               128
 
+/* the default number of writeBegin/writeMore requests in flight when
+   loading a large document; override it with the environment variable */
+#define PCRDR_DEF_WRITE_WINDOW          8
+#define PCRDR_MAX_WRITE_WINDOW          64
+#define PURC_ENVV_RDR_WRITE_WINDOW      "PURC_RDR_WRITE_WINDOW"
+
 /* Protocol types */
 typedef enum {
     PURC_RDRCOMM_HEADLESS  = 0,
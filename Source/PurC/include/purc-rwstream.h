@@ -120,6 +120,29 @@ PCA_EXPORT purc_rwstream_t purc_rwstream_new_from_fp (FILE* fp);
 PCA_EXPORT purc_rwstream_t
 purc_rwstream_new_from_unix_fd (int fd);
 
+/**
+ * Creates a new purc_rwstream_t for the given file descriptor with
+ * a read-ahead buffer. The rwstream reads up to @sz_buf bytes with one
+ * read(2) call, and supports purc_rwstream_peek() and
+ * purc_rwstream_unread() even if the fd is a pipe or a socket.
+ *
+ * Note that the bytes read ahead are not visible to the poll(2) family
+ * on the fd; do not mix the rwstream with the readiness events of the fd.
+ *
+ * @param fd: file descriptor
+ * @param sz_buf: the size of the read-ahead buffer; 0 for no buffer,
+ *      that is, the same as purc_rwstream_new_from_unix_fd().
+ *
+ * @return A purc_rwstream_t on success, @NULL on failure and the error code
+ *         is set to indicate the error. The error code:
+ *  - @PURC_ERROR_OUT_OF_MEMORY: Out of memory
+ *  - @PURC_ERROR_NOT_IMPLEMENTED: Not implemented
+ *
+ * Since: 0.9.2
+ */
+PCA_EXPORT purc_rwstream_t
+purc_rwstream_new_from_unix_fd_ex (int fd, size_t sz_buf);
+
 /**
  * Creates a new purc_rwstream_t for the given socket on Windows (Win32 && GLIB).
  * The socket must be in blocking mode, otherwise the socket will be set in
@@ -284,6 +307,76 @@ PCA_EXPORT int
 purc_rwstream_read_utf8_char (purc_rwstream_t rws,
         char* buf_utf8, uint32_t* buf_wc);
 
+/**
+ * Reads up to @nr_wcs characters (UTF-8) from purc_rwstream_t and converts
+ * them to Unicode code points. For the memory rwstreams and the buffered
+ * fd rwstreams, the characters are decoded from the buffered bytes in
+ * bulk; for others, this function reads one character by calling
+ * purc_rwstream_read_utf8_char().
+ *
+ * This function blocks only when no character is available: once the
+ * buffered bytes run out, it returns the characters decoded so far
+ * instead of reading more from the underlying file, so it can be used
+ * on the pipes and the sockets.
+ *
+ * @param rws: purc_rwstream_t
+ * @param buf_wc: the buffer to receive the code points
+ * @param nr_wcs: the number of code points the buffer can hold
+ *
+ * @return the number of characters read, 0 on the end of stream,
+ *      or -1 if the first character is bad or can not be read, and
+ *      the error code is set as purc_rwstream_read_utf8_char() does.
+ *      The bad character following the characters read is reported
+ *      by the next call.
+ *
+ * Since: 0.9.2
+ */
+PCA_EXPORT ssize_t
+purc_rwstream_read_utf8_chars (purc_rwstream_t rws,
+        uint32_t* buf_wc, size_t nr_wcs);
+
+/**
+ * Copies the bytes to read next from purc_rwstream_t without consuming
+ * them. A buffered fd rwstream blocks until @count bytes are available
+ * or the stream ends, but it never returns more bytes than the size of
+ * its buffer.
+ *
+ * @param rws: purc_rwstream_t
+ * @param buf: the buffer to copy the bytes into
+ * @param count: the number of bytes to peek
+ *
+ * @return the number of bytes copied, or -1 on failure and the error code
+ *         is set to indicate the error. The error code:
+ *  - @PURC_ERROR_INVALID_VALUE: Invalid value
+ *  - @PURC_ERROR_NOT_SUPPORTED: Only the memory rwstreams and the buffered
+ *      fd rwstreams support peeking.
+ *
+ * Since: 0.9.2
+ */
+PCA_EXPORT ssize_t
+purc_rwstream_peek (purc_rwstream_t rws, void* buf, size_t count);
+
+/**
+ * Pushes the bytes back to purc_rwstream_t, so that the next read
+ * returns them first. A buffered fd rwstream accepts any bytes as long as
+ * they fit in its buffer with the bytes not read yet; a memory rwstream
+ * only accepts the bytes just read.
+ *
+ * @param rws: purc_rwstream_t
+ * @param buf: the bytes to push back
+ * @param count: the number of bytes to push back
+ *
+ * @return 0 on success, -1 on failure and the error code is set to
+ *         indicate the error. The error code:
+ *  - @PURC_ERROR_INVALID_VALUE: Invalid value
+ *  - @PURC_ERROR_NOT_SUPPORTED: Not supported by the rwstream
+ *  - @PURC_ERROR_TOO_SMALL_BUFF: No room left in the buffer
+ *
+ * Since: 0.9.2
+ */
+PCA_EXPORT int
+purc_rwstream_unread (purc_rwstream_t rws, const void* buf, size_t count);
+
 
 /**
  * Write data to purc_rwstream_t
@@ -402,10 +402,11 @@ static inline purc_atom_t purc_atom_try_string(const char* string) {
  * Removes the given string in the specified bucket, so that the next call
  * to purc_atom_try_string_ex() will return 0 on the same string. If you
  * use purc_atom_from_string_ex() or purc_atom_from_static_string_ex() on the
- * same string in the same bucket after calling this function, you will get
- * another atom value. Note that the old atom value will be invalid, i.e.,
- * you cannot get the string by calling purc_atom_to_string() by using the
- * old atom value.
+ * same string in the same bucket after calling this function, you may get
+ * the old atom value again. Note that the old atom value will be invalid,
+ * i.e., you cannot get the string by calling purc_atom_to_string() by using
+ * the old atom value, the string got before must not be used any more, and
+ * the old atom value may be associated with another string later.
  *
  * This function must not be used before library constructors have finished
  * running.
@@ -423,10 +424,11 @@ purc_atom_remove_string_ex(int bucket, const char* string);
  * Removes the given string in the default bucket, so that the next call
  * to purc_atom_try_string() will return 0 on the same string. If you
  * use purc_atom_from_string() or purc_atom_from_static_string() on the
- * same string after calling this function, you will get
- * another atom value. Note that the old atom value will be invalid, i.e.,
- * you cannot get the string by calling purc_atom_to_string() by using the
- * old atom value.
+ * same string after calling this function, you may get
+ * the old atom value again. Note that the old atom value will be invalid,
+ * i.e., you cannot get the string by calling purc_atom_to_string() by using
+ * the old atom value, the string got before must not be used any more, and
+ * the old atom value may be associated with another string later.
  *
  * This function must not be used before library constructors have finished
  * running.
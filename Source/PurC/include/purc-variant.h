@@ -288,6 +288,30 @@ PCA_EXPORT purc_variant_t
 purc_variant_make_string_reuse_buff(char* str_utf8, size_t sz_buff,
         bool check_encoding);
 
+/**
+ * purc_variant_make_substring:
+ *
+ * @string: A string variant.
+ * @from: The index of the first character of the substring.
+ * @nr_chars: The number of characters to take at most.
+ *
+ * Creates a variant which represents the substring of @string starting at
+ * the character @from. Both @from and @nr_chars count in characters, not
+ * in bytes. A substring which ends with @string and is not a short one
+ * does not copy the characters: it refers to the buffer of @string and
+ * holds a reference to the variant which owns the buffer.
+ *
+ * Returns: A variant which represents the substring,
+ *      or %PURC_VARIANT_INVALID on failure; the error will be
+ *      %PCVARIANT_ERROR_OUT_OF_BOUNDS if @from is larger than
+ *      the number of characters of @string.
+ *
+ * Since: 0.9.2
+ */
+PCA_EXPORT purc_variant_t
+purc_variant_make_substring(purc_variant_t string, size_t from,
+        size_t nr_chars);
+
 /**
  * purc_variant_make_string_ex:
  *
@@ -800,6 +824,27 @@ purc_variant_make_array_0(void)
     return purc_variant_make_array(0, PURC_VARIANT_INVALID);
 }
 
+/**
+ * purc_variant_make_array_from:
+ *
+ * @sz: The number of the initial members.
+ * @values: A C array of the initial members; can be %NULL if @sz is zero.
+ *
+ * Creates an array variant with the members given by a C array.
+ * Since the new array can not be observed or be a member of a set yet,
+ * the members are put in place without firing any event, which makes
+ * this function faster than appending the members one by one.
+ *
+ * Note that undefined members are skipped as purc_variant_make_array() does.
+ *
+ * Returns: An array variant contains the specified initial members,
+ *      or %PURC_VARIANT_INVALID on failure.
+ *
+ * Since: 0.9.2
+ */
+PCA_EXPORT purc_variant_t
+purc_variant_make_array_from(size_t sz, purc_variant_t *values);
+
 /**
  * purc_variant_array_append:
  *
@@ -992,6 +1037,26 @@ PCA_EXPORT purc_variant_t
 purc_variant_make_object(size_t nr_kv_pairs,
         purc_variant_t key0, purc_variant_t value0, ...);
 
+/**
+ * purc_variant_make_object_from:
+ *
+ * @nr_kv_pairs: The number of the initial key/value pairs.
+ * @keys: A C array of the keys (string variants) of the properties.
+ * @values: A C array of the values of the properties.
+ *
+ * Creates an object variant with the key/value pairs given by two C arrays.
+ * Like purc_variant_make_array_from(), the properties are put in place
+ * without firing any event. A later pair overrides an earlier one with
+ * the same key.
+ *
+ * Returns: An object variant, or %PURC_VARIANT_INVALID on failure.
+ *
+ * Since: 0.9.2
+ */
+PCA_EXPORT purc_variant_t
+purc_variant_make_object_from(size_t nr_kv_pairs,
+        purc_variant_t *keys, purc_variant_t *values);
+
 /**
  * purc_variant_make_object_0:
  *
@@ -2961,6 +3026,43 @@ purc_variant_container_clone(purc_variant_t ctnr);
 PCA_EXPORT purc_variant_t
 purc_variant_container_clone_recursively(purc_variant_t ctnr);
 
+/**
+ * purc_variant_freeze:
+ *
+ * @value: The source variant.
+ *
+ * Freezes a variant and all its descendants into an immutable copy which
+ * can be shared by the instances in the current process. Moving a frozen
+ * variant to another instance only passes a reference; it is neither cloned
+ * nor locked. Any attempt to change a frozen container fails with
+ * %PURC_ERROR_ACCESS_DENIED.
+ *
+ * If @value is already frozen, this function returns a new reference of it.
+ * Dynamic and native variants can not be frozen.
+ *
+ * Returns: The frozen variant on success,
+ *      or %PURC_VARIANT_INVALID on failure.
+ *
+ * Since: 0.9.2
+ */
+PCA_EXPORT purc_variant_t
+purc_variant_freeze(purc_variant_t value);
+
+/**
+ * purc_variant_is_frozen:
+ *
+ * @value: A variant value.
+ *
+ * Checks whether @value is a frozen variant.
+ *
+ * Returns: @true if @value was made by purc_variant_freeze(),
+ *      otherwise @false.
+ *
+ * Since: 0.9.2
+ */
+PCA_EXPORT bool
+purc_variant_is_frozen(purc_variant_t value);
+
 struct purc_ejson_parsing_tree;
 
 /**
@@ -370,12 +370,25 @@ typedef struct pcvdom_document* purc_vdom_t;
 PCA_EXPORT purc_vdom_t
 purc_load_hvml_from_string(const char* string);
 
+/**
+ * PURC_ENVV_VDOM_CACHE_PATH:
+ *
+ * The environment variable to specify the directory for the precompiled
+ * vDOM images. When it is set, purc_load_hvml_from_file() loads the vDOM
+ * from the image in this directory if the image was made from the same
+ * source, and writes the image after parsing the source otherwise.
+ *
+ * Since 0.9.2
+ */
+#define PURC_ENVV_VDOM_CACHE_PATH   "PURC_VDOM_CACHE_PATH"
+
 /**
  * purc_load_hvml_from_file:
  *
  * @file: The pointer to the string contains the file name.
  *
- * Loads a HVML program from a file.
+ * Loads a HVML program from a file. See %PURC_ENVV_VDOM_CACHE_PATH for
+ * the precompiled vDOM images.
  *
  * Returns: A valid pointer to the vDOM tree for success; @NULL for failure.
  *
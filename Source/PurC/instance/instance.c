@@ -41,6 +41,7 @@
 #include "private/atom-buckets.h"
 #include "private/fetcher.h"
 #include "private/pcrdr.h"
+#include "private/regex.h"
 #include "private/msg-queue.h"
 #include "private/runners.h"
 #include "purc-runloop.h"
@@ -414,6 +415,11 @@ static void cleanup_instance(struct pcinst *curr_inst)
         curr_inst->fp_log = NULL;
     }
 
+    if (curr_inst->regex_cache) {
+        pcregex_cache_destroy(curr_inst->regex_cache);
+        curr_inst->regex_cache = NULL;
+    }
+
     if (curr_inst->bt) {
         pcdebug_backtrace_unref(curr_inst->bt);
         curr_inst->bt = NULL;
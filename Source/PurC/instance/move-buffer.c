@@ -35,27 +35,64 @@
 
 #include "private/instance.h"
 #include "private/list.h"
-#include "private/sorted-array.h"
 #include "private/utils.h"
 #include "private/ports.h"
 #include "private/debug.h"
 
 #include <stdatomic.h>
 #include <assert.h>
+#include <errno.h>
+#include <sched.h>
+#include <unistd.h>
+
+#if HAVE(SYS_EVENTFD_H)
+#include <sys/eventfd.h>
+#include <poll.h>
+#endif
 
 #if HAVE(GLIB)
     #include <gmodule.h>
 #endif
 
 #define NR_DEF_MAX_MSGS     4
+#define NR_MIN_MB_SLOTS     16
+
+/* a cell of the ring; `seq` tells whether the cell is free or filled
+   for the current lap of the producers or the consumer */
+struct mb_cell {
+    atomic_size_t       seq;
+    pcrdr_msg          *msg;
+};
 
+/*
+ * A move buffer is a bounded ring for multiple producers and a single
+ * consumer (the owner instance). The producers claim cells by CAS on
+ * `enqueue_pos` and never lock. The consumer moves the messages out of the
+ * ring into the `held` list, so that they can be retrieved by index; it
+ * stops once `max_nr_msgs` messages are held, so that the ring fills up and
+ * the producers fail instead of queuing the messages without bound.
+ */
 struct pcinst_move_buffer {
-    struct purc_rwlock  lock;
-    struct list_head    msgs;
+    atomic_size_t       enqueue_pos;
+    size_t              dequeue_pos;    /* only used by the owner */
+    size_t              mask;
 
     unsigned int        flags;
+
+    /* the messages taken out of the ring, but not taken away yet */
+    struct list_head    held;
+    size_t              nr_held;
     size_t              max_nr_msgs;
-    size_t              nr_msgs;
+
+    /* the runloop of the owner instance; used to wake up its scheduler */
+    purc_runloop_t      runloop;
+    atomic_bool         dispatching;
+
+    /* set by the owner before it sleeps on the eventfd */
+    atomic_bool         waiting;
+    int                 efd;
+
+    struct mb_cell      cells[];
 };
 
 /* the header of the struct pcrdr_msg */
@@ -74,33 +111,171 @@ _COMPILE_TIME_ASSERT(list_head,
         sizeof(struct list_head) == (sizeof(void *) * 2));
 #undef _COMPILE_TIME_ASSERT
 
-static struct purc_rwlock      mb_lock;
-static struct sorted_array    *mb_atom2buff_map;
+/*
+ * The map from the atoms of the instances to their move buffers is an
+ * open-addressing table read without locks. The slot of a destroyed move
+ * buffer keeps the atom with a NULL buffer. When the table grows, the old
+ * one is retired and freed at exit, since a reader may still use it.
+ */
+struct mb_slot {
+    _Atomic(purc_atom_t)                        atom;
+    _Atomic(struct pcinst_move_buffer *)        mb;
+};
+
+struct mb_table {
+    struct mb_table    *retired;
+    size_t              mask;
+    size_t              nr_used;
+    struct mb_slot      slots[];
+};
+
+static _Atomic(struct mb_table *)   mb_table;
+static purc_mutex                   mb_writer_lock;
+
+/*
+ * The senders count themselves in one of the two reader counters while
+ * they use a move buffer. Before freeing an unpublished move buffer, the
+ * owner flips the epoch twice and waits for the counters of the old epochs
+ * to drop to zero, so no sender can still hold the buffer.
+ */
+static atomic_uint                  mb_epoch;
+static atomic_uint                  mb_readers[2];
+
+static inline unsigned mb_read_lock(void)
+{
+    unsigned idx = atomic_load(&mb_epoch) & 1;
+    atomic_fetch_add(&mb_readers[idx], 1);
+    return idx;
+}
+
+static inline void mb_read_unlock(unsigned idx)
+{
+    atomic_fetch_sub(&mb_readers[idx], 1);
+}
+
+static void mb_synchronize(void)
+{
+    for (int i = 0; i < 2; i++) {
+        unsigned idx = atomic_fetch_add(&mb_epoch, 1) & 1;
+        while (atomic_load(&mb_readers[idx]) > 0) {
+            sched_yield();
+        }
+    }
+}
+
+static inline size_t mb_hash(purc_atom_t atom)
+{
+    return (size_t)atom * 0x9E3779B97F4A7C15ULL;
+}
+
+static struct mb_slot *
+mb_table_find_slot(struct mb_table *table, purc_atom_t atom)
+{
+    size_t i = mb_hash(atom) & table->mask;
+    for (;;) {
+        purc_atom_t a = atomic_load(&table->slots[i].atom);
+        if (a == atom)
+            return &table->slots[i];
+        if (a == 0)
+            return NULL;
+        i = (i + 1) & table->mask;
+    }
+}
+
+static struct pcinst_move_buffer *
+mb_lookup(purc_atom_t atom)
+{
+    struct mb_table *table = atomic_load(&mb_table);
+    struct mb_slot *slot;
+
+    if (table == NULL || (slot = mb_table_find_slot(table, atom)) == NULL)
+        return NULL;
+    return atomic_load(&slot->mb);
+}
+
+static struct mb_table *mb_table_new(size_t nr_slots)
+{
+    struct mb_table *table = calloc(1,
+            sizeof(*table) + sizeof(struct mb_slot) * nr_slots);
+    if (table) {
+        table->mask = nr_slots - 1;
+    }
+    return table;
+}
+
+static void mb_table_put(struct mb_table *table, purc_atom_t atom,
+        struct pcinst_move_buffer *mb)
+{
+    size_t i = mb_hash(atom) & table->mask;
+    while (atomic_load(&table->slots[i].atom) != 0)
+        i = (i + 1) & table->mask;
+
+    atomic_store(&table->slots[i].mb, mb);
+    atomic_store(&table->slots[i].atom, atom);
+    table->nr_used++;
+}
+
+/* must be called with mb_writer_lock held */
+static int mb_register(purc_atom_t atom, struct pcinst_move_buffer *mb)
+{
+    struct mb_table *table = atomic_load(&mb_table);
+    struct mb_slot *slot = mb_table_find_slot(table, atom);
+
+    if (slot) {
+        if (atomic_load(&slot->mb))
+            return PURC_ERROR_DUPLICATED;
+        atomic_store(&slot->mb, mb);
+        return 0;
+    }
+
+    if ((table->nr_used + 1) * 4 > (table->mask + 1) * 3) {
+        struct mb_table *bigger = mb_table_new((table->mask + 1) * 2);
+        if (bigger == NULL)
+            return PURC_ERROR_OUT_OF_MEMORY;
+
+        for (size_t i = 0; i <= table->mask; i++) {
+            struct pcinst_move_buffer *p = atomic_load(&table->slots[i].mb);
+            if (p) {
+                mb_table_put(bigger, atomic_load(&table->slots[i].atom), p);
+            }
+        }
+
+        bigger->retired = table;
+        atomic_store(&mb_table, bigger);
+        table = bigger;
+    }
+
+    mb_table_put(table, atom, mb);
+    return 0;
+}
 
 static void mvbuf_cleanup_once(void)
 {
-    if (mb_lock.native_impl) {
-        purc_rwlock_clear(&mb_lock);
-        mb_lock.native_impl = NULL;
+    struct mb_table *table = atomic_load(&mb_table);
+    while (table) {
+        struct mb_table *retired = table->retired;
+        free(table);
+        table = retired;
     }
+    atomic_store(&mb_table, NULL);
 
-    if (mb_atom2buff_map) {
-        pcutils_sorted_array_destroy(mb_atom2buff_map);
-        mb_atom2buff_map = NULL;
+    if (mb_writer_lock.native_impl) {
+        purc_mutex_clear(&mb_writer_lock);
+        mb_writer_lock.native_impl = NULL;
     }
 }
 
 static int mvbuf_init_once(void)
 {
     int r = 0;
-    purc_rwlock_init(&mb_lock);
-    if (mb_lock.native_impl == NULL)
+    purc_mutex_init(&mb_writer_lock);
+    if (mb_writer_lock.native_impl == NULL)
         goto fail_lock;
 
-    mb_atom2buff_map = pcutils_sorted_array_create(SAFLAG_DEFAULT, 0,
-            NULL, NULL);
-    if (mb_atom2buff_map == NULL)
+    struct mb_table *table = mb_table_new(NR_MIN_MB_SLOTS);
+    if (table == NULL)
         goto fail_map;
+    atomic_store(&mb_table, table);
 
     r = atexit(mvbuf_cleanup_once);
     if (r)
@@ -109,10 +284,11 @@ static int mvbuf_init_once(void)
     return 0;
 
 fail_atexit:
-    pcutils_sorted_array_destroy(mb_atom2buff_map);
+    atomic_store(&mb_table, NULL);
+    free(table);
 
 fail_map:
-    purc_rwlock_clear(&mb_lock);
+    purc_mutex_clear(&mb_writer_lock);
 
 fail_lock:
     return -1;
@@ -171,6 +347,72 @@ pcinst_put_message(pcrdr_msg *msg)
     }
 }
 
+/* claims a cell for a new message; returns NULL if the ring is full */
+static struct mb_cell *
+mb_ring_claim(struct pcinst_move_buffer *mb, size_t *pos_claimed)
+{
+    size_t pos = atomic_load_explicit(&mb->enqueue_pos, memory_order_relaxed);
+
+    for (;;) {
+        struct mb_cell *cell = &mb->cells[pos & mb->mask];
+        size_t seq = atomic_load_explicit(&cell->seq, memory_order_acquire);
+        intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+
+        if (diff == 0) {
+            if (atomic_compare_exchange_weak_explicit(&mb->enqueue_pos,
+                        &pos, pos + 1,
+                        memory_order_relaxed, memory_order_relaxed)) {
+                *pos_claimed = pos;
+                return cell;
+            }
+        }
+        else if (diff < 0) {
+            return NULL;
+        }
+        else {
+            pos = atomic_load_explicit(&mb->enqueue_pos,
+                    memory_order_relaxed);
+        }
+    }
+}
+
+static inline void
+mb_ring_publish(struct mb_cell *cell, size_t pos, pcrdr_msg *msg)
+{
+    cell->msg = msg;
+    atomic_store_explicit(&cell->seq, pos + 1, memory_order_release);
+}
+
+/* only called by the owner */
+static pcrdr_msg *
+mb_ring_pop(struct pcinst_move_buffer *mb)
+{
+    size_t pos = mb->dequeue_pos;
+    struct mb_cell *cell = &mb->cells[pos & mb->mask];
+    size_t seq = atomic_load_explicit(&cell->seq, memory_order_acquire);
+
+    if (seq != pos + 1)
+        return NULL;
+
+    pcrdr_msg *msg = cell->msg;
+    atomic_store_explicit(&cell->seq, pos + mb->mask + 1,
+            memory_order_release);
+    mb->dequeue_pos = pos + 1;
+    return msg;
+}
+
+/* moves the messages in the ring to the held list, up to the limit */
+static void
+mb_drain(struct pcinst_move_buffer *mb)
+{
+    pcrdr_msg *msg;
+    while (mb->nr_held < mb->max_nr_msgs && (msg = mb_ring_pop(mb))) {
+        struct pcrdr_msg_hdr *hdr = (struct pcrdr_msg_hdr *)msg;
+        list_add_tail(&hdr->ln, &mb->held);
+        mb->nr_held++;
+    }
+}
+
 purc_atom_t
 purc_inst_create_move_buffer(unsigned int flags, size_t max_msgs)
 {
@@ -184,54 +426,99 @@ purc_inst_create_move_buffer(unsigned int flags, size_t max_msgs)
     int errcode = 0;
     struct pcinst_move_buffer *mb = NULL;
 
-    purc_rwlock_writer_lock(&mb_lock);
-
-    if (pcutils_sorted_array_find(mb_atom2buff_map,
-                (void *)(uintptr_t)atom, (void **)&mb)) {
-        mb = NULL;
+    if (inst->mvbuf) {
         errcode = PURC_ERROR_DUPLICATED;
-        goto done;
+        goto failed;
     }
 
-    if ((mb = malloc(sizeof(*mb))) == NULL) {
+    size_t nr_cells = 2;
+    if (max_msgs == 0)
+        max_msgs = NR_DEF_MAX_MSGS;
+    while (nr_cells < max_msgs)
+        nr_cells <<= 1;
+
+    mb = malloc(sizeof(*mb) + sizeof(struct mb_cell) * nr_cells);
+    if (mb == NULL) {
         errcode = PURC_ERROR_OUT_OF_MEMORY;
-        goto done;
+        goto failed;
     }
 
-    purc_rwlock_init(&mb->lock);
-    if (mb->lock.native_impl == NULL) {
+    for (size_t i = 0; i < nr_cells; i++) {
+        atomic_init(&mb->cells[i].seq, i);
+        mb->cells[i].msg = NULL;
+    }
+    atomic_init(&mb->enqueue_pos, 0);
+    mb->dequeue_pos = 0;
+    mb->mask = nr_cells - 1;
+    mb->flags = flags;
+    list_head_init(&mb->held);
+    mb->nr_held = 0;
+    mb->max_nr_msgs = max_msgs;
+    mb->runloop = inst->running_loop;
+    atomic_init(&mb->dispatching, false);
+    atomic_init(&mb->waiting, false);
+
+#if HAVE(SYS_EVENTFD_H)
+    mb->efd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (mb->efd < 0) {
         errcode = PURC_ERROR_BAD_SYSTEM_CALL;
-        goto done;
+        goto failed;
     }
+#else
+    mb->efd = -1;
+#endif
 
-    if (pcutils_sorted_array_add(mb_atom2buff_map,
-                (void *)(uintptr_t)atom, mb) < 0) {
-        errcode = PURC_ERROR_OUT_OF_MEMORY;
-        goto done;
-    }
+    purc_mutex_lock(&mb_writer_lock);
+    errcode = mb_register(atom, mb);
+    purc_mutex_unlock(&mb_writer_lock);
+    if (errcode)
+        goto failed;
 
-    mb->flags = flags;
-    mb->nr_msgs = 0;
-    mb->max_nr_msgs = (max_msgs > 0) ? max_msgs : NR_DEF_MAX_MSGS;
-    list_head_init(&mb->msgs);
+    inst->mvbuf = mb;
+    return atom;
 
-done:
-    purc_rwlock_writer_unlock(&mb_lock);
+failed:
+    if (mb) {
+        if (mb->efd >= 0)
+            close(mb->efd);
+        free(mb);
+    }
 
-    if (errcode) {
-        if (mb) {
-            if (mb->lock.native_impl) {
-                purc_rwlock_clear(&mb->lock);
-            }
+    purc_set_error(errcode);
+    return 0;
+}
 
-            free(mb);
-        }
+static void
+wakeup_scheduler(void *ctxt)
+{
+    UNUSED_PARAM(ctxt);
 
-        purc_set_error(errcode);
-        return 0;
+    /* called in the thread of the owner instance */
+    struct pcinst *inst = pcinst_current();
+    if (inst->mvbuf) {
+        atomic_store(&inst->mvbuf->dispatching, false);
     }
+    pcintr_wakeup_scheduler(inst);
+}
 
-    return atom;
+/* must be called in a read-side section, so the runloop is still alive;
+   the notifications are coalesced until the owner handles them */
+static inline void
+wakeup_owner(struct pcinst_move_buffer *mb)
+{
+    if (mb->runloop && !atomic_exchange(&mb->dispatching, true)) {
+        purc_runloop_dispatch(mb->runloop, wakeup_scheduler, NULL);
+    }
+
+#if HAVE(SYS_EVENTFD_H)
+    if (atomic_exchange(&mb->waiting, false)) {
+        uint64_t one = 1;
+        if (write(mb->efd, &one, sizeof(one)) < 0 && errno != EAGAIN) {
+            PC_ERROR("Failed to signal eventfd of move buffer: %s\n",
+                    strerror(errno));
+        }
+    }
+#endif
 }
 
 static void
@@ -268,49 +555,47 @@ purc_inst_destroy_move_buffer(void)
     if (inst == NULL)
         return -1;
 
-    purc_atom_t atom = inst->endpoint_atom;
-    int errcode = 0;
-    struct pcinst_move_buffer *mb = NULL;
+    struct pcinst_move_buffer *mb = inst->mvbuf;
+    if (mb == NULL) {
+        purc_set_error(PURC_ERROR_NOT_EXISTS);
+        return -1;
+    }
 
-    purc_rwlock_writer_lock(&mb_lock);
+    purc_mutex_lock(&mb_writer_lock);
+    struct mb_slot *slot = mb_table_find_slot(atomic_load(&mb_table),
+            inst->endpoint_atom);
+    assert(slot && atomic_load(&slot->mb) == mb);
+    atomic_store(&slot->mb, NULL);
+    purc_mutex_unlock(&mb_writer_lock);
 
-    if (!pcutils_sorted_array_find(mb_atom2buff_map,
-                (void *)(uintptr_t)atom, (void **)&mb)) {
-        mb = NULL;
-        errcode = PURC_ERROR_NOT_EXISTS;
-        goto done;
-    }
+    /* no sender can get the buffer now; wait for the ones using it */
+    mb_synchronize();
+    inst->mvbuf = NULL;
+
+    /* discard all the messages, including those over the limit */
+    mb->max_nr_msgs = SIZE_MAX;
+    mb_drain(mb);
 
     struct list_head *p, *n;
-    purc_rwlock_writer_lock(&mb->lock);
     pcvariant_use_move_heap();
-    list_for_each_safe(p, n, &mb->msgs) {
+    list_for_each_safe(p, n, &mb->held) {
 
         struct pcrdr_msg_hdr *hdr;
 
         hdr = list_entry(p, struct pcrdr_msg_hdr, ln);
 
         list_del(p);
-        mb->nr_msgs--;
+        mb->nr_held--;
 
         pcinst_grind_message((pcrdr_msg *)hdr);
         nr++;
     }
     pcvariant_use_norm_heap();
-    purc_rwlock_writer_unlock(&mb->lock);
 
-    pcutils_sorted_array_remove(mb_atom2buff_map, (void *)(uintptr_t)atom);
-    purc_rwlock_clear(&mb->lock);
+    if (mb->efd >= 0)
+        close(mb->efd);
     free(mb);
 
-done:
-    purc_rwlock_writer_unlock(&mb_lock);
-
-    if (errcode) {
-        purc_set_error(errcode);
-        return -1;
-    }
-
     return nr;
 }
 
@@ -338,12 +623,75 @@ do_take_message(struct pcinst* inst, pcrdr_msg *msg)
     }
 }
 
+/* makes a copy of the message with frozen variants, so that all recipients
+   of a broadcast share the variants instead of cloning them one by one */
+static pcrdr_msg *
+freeze_message(const pcrdr_msg *msg)
+{
+    pcrdr_msg *shared = pcrdr_clone_message(msg);
+    if (shared == NULL)
+        return NULL;
+
+    for (int i = 0; i < PCRDR_NR_MSG_VARIANTS; i++) {
+        purc_variant_t v = shared->variants[i];
+        if (v == PURC_VARIANT_INVALID || purc_variant_is_frozen(v))
+            continue;
+
+        purc_variant_t frozen = purc_variant_freeze(v);
+        if (frozen) {
+            purc_variant_unref(v);
+            shared->variants[i] = frozen;
+        }
+        else {
+            /* not freezable (e.g., a native entity); clone it as before */
+            purc_clr_error();
+        }
+    }
+
+    return shared;
+}
+
+static size_t
+broadcast_message(struct pcinst* inst, pcrdr_msg *msg)
+{
+    size_t nr = 0;
+    struct mb_table *table = atomic_load(&mb_table);
+
+    for (size_t i = 0; i <= table->mask; i++) {
+        struct pcinst_move_buffer *mb = atomic_load(&table->slots[i].mb);
+        if (mb == NULL || !(mb->flags & PCINST_MOVE_BUFFER_BROADCAST))
+            continue;
+
+        pcrdr_msg *my_msg = pcrdr_clone_message(msg);
+        if (my_msg == NULL) {
+            PC_ERROR("failed to clone message to broadcast: %p\n", msg);
+            break;
+        }
+
+        size_t pos;
+        struct mb_cell *cell = mb_ring_claim(mb, &pos);
+        if (cell == NULL) {
+            pcrdr_release_message(my_msg);
+            continue;
+        }
+
+        do_move_message(inst, my_msg);
+        /* drop our reference before publishing: the receiver may take
+           and release the message as soon as it is published */
+        pcrdr_release_message(my_msg);
+        mb_ring_publish(cell, pos, my_msg);
+        wakeup_owner(mb);
+        nr++;
+    }
+
+    return nr;
+}
+
 size_t
 purc_inst_move_message(purc_atom_t inst_to, pcrdr_msg *msg)
 {
     int errcode = 0;
     size_t nr = 0;
-    struct pcinst_move_buffer *mb;
     struct pcinst* inst = pcinst_current();
 
     if (inst == NULL) {
@@ -355,77 +703,44 @@ purc_inst_move_message(purc_atom_t inst_to, pcrdr_msg *msg)
         return 0;
     }
 
-    purc_rwlock_reader_lock(&mb_lock);
+    pcrdr_msg *shared = NULL;
+    if (inst_to == (purc_atom_t)PURC_EVENT_TARGET_BROADCAST) {
+        shared = freeze_message(msg);
+        if (shared == NULL)
+            return 0;
+    }
+
+    unsigned idx = mb_read_lock();
 
-    if (inst_to != (purc_atom_t)PURC_EVENT_TARGET_BROADCAST) {
-        if (!pcutils_sorted_array_find(mb_atom2buff_map,
-                    (void *)(uintptr_t)inst_to, (void **)&mb)) {
+    if (shared == NULL) {
+        struct pcinst_move_buffer *mb = mb_lookup(inst_to);
+        if (mb == NULL) {
             errcode = PURC_ERROR_NOT_EXISTS;
             goto done;
         }
 
-        if (mb->nr_msgs >= mb->max_nr_msgs) {
+        size_t pos;
+        struct mb_cell *cell = mb_ring_claim(mb, &pos);
+        if (cell == NULL) {
             errcode = PURC_ERROR_TOO_SMALL_BUFF;
             goto done;
         }
 
         do_move_message(inst, msg);
-
-        purc_rwlock_writer_lock(&mb->lock);
-        struct pcrdr_msg_hdr *hdr = (struct pcrdr_msg_hdr *)msg;
-        list_add_tail(&hdr->ln, &mb->msgs);
-        mb->nr_msgs++;
-        purc_rwlock_writer_unlock(&mb->lock);
-
+        mb_ring_publish(cell, pos, msg);
+        wakeup_owner(mb);
         nr++;
     }
     else {
-        size_t count = pcutils_sorted_array_count(mb_atom2buff_map);
-
-        for (size_t i = 0; i < count; i++) {
-            pcutils_sorted_array_get(mb_atom2buff_map, i, (void **)&mb);
-            if (mb->flags & PCINST_MOVE_BUFFER_BROADCAST &&
-                    mb->nr_msgs < mb->max_nr_msgs) {
-
-                pcrdr_msg *my_msg;
-
-                if (i == count - 1) {
-                    my_msg = msg;
-                    do_move_message(inst, msg);
-                    // FIXME: if count > 1 and flags without PCINST_MOVE_BUFFER_BROADCAST
-                    // not reatch here
-                    msg = NULL;
-                }
-                else {
-                    my_msg = pcrdr_clone_message(msg);
-                    if (my_msg) {
-                        do_move_message(inst, my_msg);
-                        pcrdr_release_message(my_msg);
-                    }
-                    else {
-                        PC_ERROR("failed to clone message to broadcast: %p\n",
-                                msg);
-                        break;
-                    }
-                }
-
-                purc_rwlock_writer_lock(&mb->lock);
-                struct pcrdr_msg_hdr *hdr = (struct pcrdr_msg_hdr *)my_msg;
-                list_add_tail(&hdr->ln, &mb->msgs);
-                mb->nr_msgs++;
-                purc_rwlock_writer_unlock(&mb->lock);
-                nr++;
-            }
-        }
-
-        // FIXME:
-        if (msg) {
-            pcrdr_release_message(msg);
-        }
+        /* every recipient gets a clone; the caller keeps the original */
+        nr = broadcast_message(inst, shared);
     }
 
 done:
-    purc_rwlock_reader_unlock(&mb_lock);
+    mb_read_unlock(idx);
+
+    if (shared)
+        pcrdr_release_message(shared);
 
     if (errcode) {
         purc_set_error(errcode);
@@ -443,28 +758,65 @@ purc_inst_holding_messages_count(size_t *nr)
         return PURC_ERROR_NO_INSTANCE;
     }
 
-    int errcode = 0;
-    struct pcinst_move_buffer *mb;
+    struct pcinst_move_buffer *mb = inst->mvbuf;
+    if (mb == NULL) {
+        purc_set_error(PURC_ERROR_NOT_EXISTS);
+        return PURC_ERROR_NOT_EXISTS;
+    }
 
-    purc_rwlock_reader_lock(&mb_lock);
+    mb_drain(mb);
+    *nr = mb->nr_held;
+    return 0;
+}
 
-    if (!pcutils_sorted_array_find(mb_atom2buff_map,
-                (void *)(uintptr_t)inst->endpoint_atom, (void **)&mb)) {
-        errcode = PURC_ERROR_NOT_EXISTS;
-        goto done;
+int
+pcinst_move_buffer_wait(int timeout_ms)
+{
+    struct pcinst* inst = pcinst_current();
+    struct pcinst_move_buffer *mb = inst ? inst->mvbuf : NULL;
+    if (mb == NULL) {
+        purc_set_error(PURC_ERROR_NOT_EXISTS);
+        return -1;
     }
 
-    /* no need to lock the buffer */
-    *nr = mb->nr_msgs;
+    mb_drain(mb);
+    if (mb->nr_held > 0 || timeout_ms <= 0)
+        return mb->nr_held > 0;
+
+#if HAVE(SYS_EVENTFD_H)
+    /* a sender checks the flag after publishing a message,
+       so check the ring again after setting it */
+    atomic_store(&mb->waiting, true);
+    mb_drain(mb);
+    if (mb->nr_held == 0) {
+        struct pollfd pfd = { mb->efd, POLLIN, 0 };
+        if (poll(&pfd, 1, timeout_ms) < 0 && errno != EINTR) {
+            atomic_store(&mb->waiting, false);
+            purc_set_error(PURC_ERROR_BAD_SYSTEM_CALL);
+            return -1;
+        }
 
-done:
-    purc_rwlock_reader_unlock(&mb_lock);
+        uint64_t count;
+        if (read(mb->efd, &count, sizeof(count)) < 0 && errno != EAGAIN) {
+            PC_ERROR("Failed to read eventfd of move buffer: %s\n",
+                    strerror(errno));
+        }
+        mb_drain(mb);
+    }
+    atomic_store(&mb->waiting, false);
+#else
+    if (timeout_ms > 1000) {
+        pcutils_sleep(timeout_ms / 1000);
+    }
 
-    if (errcode) {
-        purc_set_error(errcode);
+    unsigned int ms = timeout_ms % 1000;
+    if (ms) {
+        pcutils_usleep(ms * 1000);
     }
+    mb_drain(mb);
+#endif
 
-    return errcode;
+    return mb->nr_held > 0;
 }
 
 const pcrdr_msg *
@@ -474,44 +826,27 @@ purc_inst_retrieve_message(size_t index)
     if (inst == NULL)
         return NULL;
 
-    int errcode = 0;
-    const pcrdr_msg *msg = NULL;
-    struct pcinst_move_buffer *mb;
-
-    purc_rwlock_reader_lock(&mb_lock);
-
-    if (!pcutils_sorted_array_find(mb_atom2buff_map,
-                (void *)(uintptr_t)inst->endpoint_atom, (void **)&mb)) {
-        errcode = PURC_ERROR_NOT_EXISTS;
-        goto done;
+    struct pcinst_move_buffer *mb = inst->mvbuf;
+    if (mb == NULL) {
+        purc_set_error(PURC_ERROR_NOT_EXISTS);
+        return NULL;
     }
 
-    purc_rwlock_reader_lock(&mb->lock);
-    if (index < mb->nr_msgs) {
+    mb_drain(mb);
+    if (index < mb->nr_held) {
         struct list_head *p;
-        struct pcrdr_msg_hdr *hdr;
         size_t i = 0;
 
-        list_for_each(p, &mb->msgs) {
-            hdr = list_entry(p, struct pcrdr_msg_hdr, ln);
+        list_for_each(p, &mb->held) {
             if (i == index) {
-                msg = (pcrdr_msg *)hdr;
-                break;
+                return (pcrdr_msg *)list_entry(p, struct pcrdr_msg_hdr, ln);
             }
 
             i++;
         }
     }
-    purc_rwlock_reader_unlock(&mb->lock);
-
-done:
-    purc_rwlock_reader_unlock(&mb_lock);
-
-    if (errcode) {
-        purc_set_error(errcode);
-    }
 
-    return msg;
+    return NULL;
 }
 
 pcrdr_msg *
@@ -523,52 +858,45 @@ purc_inst_take_away_message(size_t index)
         return NULL;
     }
 
-    int errcode = 0;
-    pcrdr_msg *msg = NULL;
-    struct pcinst_move_buffer *mb;
-
-    purc_rwlock_reader_lock(&mb_lock);
-
-    if (!pcutils_sorted_array_find(mb_atom2buff_map,
-                (void *)(uintptr_t)inst->endpoint_atom, (void **)&mb)) {
-        errcode = PURC_ERROR_NOT_EXISTS;
-        goto done;
+    struct pcinst_move_buffer *mb = inst->mvbuf;
+    if (mb == NULL) {
+        purc_set_error(PURC_ERROR_NOT_EXISTS);
+        return NULL;
     }
 
-    purc_rwlock_writer_lock(&mb->lock);
-    if (index < mb->nr_msgs) {
-        struct list_head *p, *n;
-        struct pcrdr_msg_hdr *hdr;
-        size_t i = 0;
+    pcrdr_msg *msg = NULL;
+    struct pcrdr_msg_hdr *hdr;
+    if (index == 0 && mb->nr_held == 0) {
+        /* the common case: take the first one from the ring directly */
+        msg = mb_ring_pop(mb);
+    }
+    else {
+        mb_drain(mb);
+        if (index < mb->nr_held) {
+            struct list_head *p;
+            size_t i = 0;
+
+            list_for_each(p, &mb->held) {
+                if (i == index) {
+                    msg = (pcrdr_msg *)list_entry(p, struct pcrdr_msg_hdr, ln);
+                    list_del(p);
+                    mb->nr_held--;
+                    break;
+                }
 
-        list_for_each_safe(p, n, &mb->msgs) {
-            hdr = list_entry(p, struct pcrdr_msg_hdr, ln);
-            if (i == index) {
-                msg = (pcrdr_msg *)hdr;
-                list_del(p);
-                hdr->ln.next = hdr->ln.prev = NULL; /* mark as not linked */
-                mb->nr_msgs--;
-                break;
+                i++;
             }
-
-            i++;
         }
     }
-    else {
-        errcode = PURC_ERROR_NOT_EXISTS;
-    }
-    purc_rwlock_writer_unlock(&mb->lock);
 
-    if (msg)
-        do_take_message(inst, msg);
-
-done:
-    purc_rwlock_reader_unlock(&mb_lock);
-
-    if (errcode) {
-        purc_set_error(errcode);
+    if (msg == NULL) {
+        purc_set_error(PURC_ERROR_NOT_EXISTS);
+        return NULL;
     }
 
+    hdr = (struct pcrdr_msg_hdr *)msg;
+    hdr->ln.next = hdr->ln.prev = NULL; /* mark as not linked */
+    do_take_message(inst, msg);
     return msg;
 }
 
@@ -627,6 +955,14 @@ purc_inst_move_message(purc_atom_t inst_to, pcrdr_msg *msg)
     return 0;
 }
 
+int
+pcinst_move_buffer_wait(int timeout_ms)
+{
+    UNUSED_PARAM(timeout_ms);
+    purc_set_error(PURC_ERROR_NOT_SUPPORTED);
+    return -1;
+}
+
 int
 purc_inst_holding_messages_count(size_t *nr)
 {
@@ -382,7 +382,9 @@ purc_inst_post_event(purc_atom_t inst_to, pcrdr_msg *msg)
             list_for_each_entry_safe(p, q, crtns, ln) {
                 pcintr_coroutine_t co = p;
                 if (co->cid == msg->targetValue) {
-                    return pcinst_msg_queue_append(co->mq, msg);
+                    int ret = pcinst_msg_queue_append(co->mq, msg);
+                    pcintr_wakeup_coroutine(co);
+                    return ret;
                 }
             }
 
@@ -390,7 +392,9 @@ purc_inst_post_event(purc_atom_t inst_to, pcrdr_msg *msg)
             list_for_each_entry_safe(p, q, crtns, ln) {
                 pcintr_coroutine_t co = p;
                 if (co->cid == msg->targetValue) {
-                    return pcinst_msg_queue_append(co->mq, msg);
+                    int ret = pcinst_msg_queue_append(co->mq, msg);
+                    pcintr_wakeup_coroutine(co);
+                    return ret;
                 }
             }
             pcrdr_release_message(msg);
@@ -402,6 +406,7 @@ purc_inst_post_event(purc_atom_t inst_to, pcrdr_msg *msg)
                 pcrdr_msg *my_msg = pcrdr_clone_message(msg);
                 my_msg->targetValue = co->cid;
                 pcinst_msg_queue_append(co->mq, my_msg);
+                pcintr_wakeup_coroutine(co);
             }
 
             crtns = &heap->stopped_crtns;
@@ -410,6 +415,7 @@ purc_inst_post_event(purc_atom_t inst_to, pcrdr_msg *msg)
                 pcrdr_msg *my_msg = pcrdr_clone_message(msg);
                 my_msg->targetValue = co->cid;
                 pcinst_msg_queue_append(co->mq, my_msg);
+                pcintr_wakeup_coroutine(co);
             }
             pcrdr_release_message(msg);
         }
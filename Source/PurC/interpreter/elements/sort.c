@@ -310,79 +310,44 @@ comp_string(const char *l, const char *r, bool ascendingly, bool casesensitively
     return ascendingly ? ret : -ret;
 }
 
-static char *
-variant_to_string(purc_variant_t v)
-{
-    if (!v) {
-        return NULL;
-    }
-
-    char *buf = NULL;
-    int total = purc_variant_stringify_alloc(&buf, v);
-    if (total < 0) {
-        return NULL;
-    }
-    return buf;
-}
-
+/* extract the sort keys of a member once before sorting */
 static int
-comp_raw(purc_variant_t l, purc_variant_t r, bool by_number,
-        bool ascendingly, bool casesensitively)
+sort_decorate(purc_variant_t member, struct pcvariant_sort_key *keys,
+        void *data)
 {
-    if (by_number) {
-        double dl = l ? purc_variant_numerify(l) : 0.0f;
-        double dr = r ? purc_variant_numerify(r) : 0.0f;
-        return comp_number(dl, dr, ascendingly);
-    }
-
-    char *buf_l = variant_to_string(l);
-    char *buf_r = variant_to_string(r);
-    int ret = comp_string(buf_l, buf_r, ascendingly, casesensitively);
-
-    if (buf_l) {
-        free(buf_l);
-    }
-    if (buf_r) {
-        free(buf_r);
-    }
-
-    return ret;
-}
-
-static int
-comp_by_key(purc_variant_t l, purc_variant_t r, const char *key, bool by_number,
-        bool ascendingly, bool casesensitively)
-{
-    purc_variant_t lv = PURC_VARIANT_INVALID;
-    purc_variant_t rv = PURC_VARIANT_INVALID;
-    if (purc_variant_is_object(l)) {
-        lv = purc_variant_object_get_by_ckey(l, key);
-        purc_clr_error();
-    }
+    struct ctxt_for_sort *ctxt = data;
+    size_t nr_keys = pcutils_arrlist_length(ctxt->keys);
+    for (size_t i = 0; i < nr_keys; i++) {
+        struct sort_key *key = pcutils_arrlist_get_idx(ctxt->keys, i);
+        purc_variant_t v = member;
+        if (key->key) {
+            v = PURC_VARIANT_INVALID;
+            if (purc_variant_is_object(member)) {
+                v = pcvariant_object_get_by_ckey_ex(member, key->key, true);
+            }
+        }
 
-    if (purc_variant_is_object(r)) {
-        rv = purc_variant_object_get_by_ckey(r, key);
-        purc_clr_error();
+        pcvariant_sort_key_extract(keys + i, v, key->by_number ?
+                PCVARIANT_SORT_KEY_NUMBER : PCVARIANT_SORT_KEY_STRING);
     }
-
-    return comp_raw(lv, rv, by_number, ascendingly, casesensitively);
+    return 0;
 }
 
 static int
-sort_cmp(purc_variant_t l, purc_variant_t r, void *data)
+sort_keycmp(const struct pcvariant_sort_key *l,
+        const struct pcvariant_sort_key *r, void *data)
 {
     struct ctxt_for_sort *ctxt = data;
     size_t nr_keys = pcutils_arrlist_length(ctxt->keys);
     for (size_t i = 0; i < nr_keys; i++) {
         struct sort_key *key = pcutils_arrlist_get_idx(ctxt->keys, i);
-        int ret = 0;
-        if (key->key == NULL) {
-            ret = comp_raw(l, r, key->by_number, ctxt->ascendingly,
-                    ctxt->casesensitively);
+        int ret;
+        if (key->by_number) {
+            ret = comp_number(l[i].d, r[i].d, ctxt->ascendingly);
         }
         else {
-            ret = comp_by_key(l, r, key->key, key->by_number,
-                    ctxt->ascendingly, ctxt->casesensitively);
+            ret = comp_string(l[i].s, r[i].s, ctxt->ascendingly,
+                    ctxt->casesensitively);
         }
         if (ret != 0) {
             return ret;
@@ -457,7 +422,8 @@ sort_array(struct ctxt_for_sort *ctxt, purc_variant_t array,
             }
         }
     }
-    pcvariant_array_sort(array, ctxt, sort_cmp);
+    pcvariant_array_sort_by_keys(array, pcutils_arrlist_length(ctxt->keys),
+            ctxt, sort_decorate, sort_keycmp);
 }
 
 
@@ -510,7 +476,8 @@ sort_set(struct ctxt_for_sort *ctxt, purc_variant_t set, purc_variant_t against)
             }
         }
     }
-    pcvariant_set_sort(set, ctxt, sort_cmp);
+    pcvariant_set_sort_by_keys(set, pcutils_arrlist_length(ctxt->keys),
+            ctxt, sort_decorate, sort_keycmp);
 }
 
 static int
@@ -26,11 +26,19 @@
 
 #include "private/hvml.h"
 #include "private/map.h"
+#include "private/list.h"
 #include "private/fetcher.h"
+#include "private/interpreter.h"
 #include "private/ports.h"
 #include "../hvml/hvml-gen.h"
 
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
 #include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 purc_vdom_t
 purc_load_hvml_from_rwstream(purc_rwstream_t stm)
@@ -88,16 +96,26 @@ end:
 }
 
 /*
- * TODO:
- * When total_orig_size reaches a number (say 64KB), we can shrink the cached
- * by emoving some vDOMs according to LRU.
+ * The parsed vDOMs are cached by the MD5 digest of their sources, and the
+ * cache is bounded by the total size of the sources: when it grows beyond
+ * VDOM_CACHE_MAX_SIZE, the least recently used vDOMs are dropped.
  *
- * By now, we keep all vDOMs until the program exits.
+ * The loaders return a vDOM without a reference for the caller, so every
+ * instance keeps a reference to the vDOMs it has got (see pin_vdom());
+ * dropping a vDOM from the cache never frees one which is still in use.
  */
+#define VDOM_CACHE_MAX_SIZE     (1024 * 512)
+
+#define VDOM_IMAGE_SUFFIX       ".vdom"
+
+static purc_mutex cache_lock;
+static struct list_head lru_list;   // the most recently used first
 static size_t total_orig_size;
 static pcutils_map* md5_vdom_map;
 
 struct vdom_entry {
+    struct list_head ln;
+    unsigned char md5[MD5_DIGEST_SIZE];
     time_t expire;
     size_t length;
     purc_vdom_t vdom;
@@ -123,15 +141,17 @@ static int cmp_md5_keys(const void *key1, const void *key2)
 
 static void *copy_entry(const void *val)
 {
-    const struct vdom_entry *entry = val;
+    struct vdom_entry *entry = (struct vdom_entry *)val;
     total_orig_size += entry->length;
-    return (void *)val;
+    list_add(&entry->ln, &lru_list);
+    return entry;
 }
 
 static void free_entry(void *val)
 {
     struct vdom_entry *entry = val;
     total_orig_size -= entry->length;
+    list_del(&entry->ln);
     pcvdom_document_unref(entry->vdom);
     free(val);
 }
@@ -145,15 +165,20 @@ static void cleanup_loader_once(void)
             (unsigned long long)n);
 #endif
     pcutils_map_destroy(md5_vdom_map);
+    purc_mutex_clear(&cache_lock);
 }
 
 int pcintr_init_loader_once(void)
 {
+    list_head_init(&lru_list);
+
+    /* all accesses are serialized by cache_lock */
     md5_vdom_map = pcutils_map_create(copy_md5_key, free_md5_key,
-            copy_entry, free_entry, cmp_md5_keys, true);
+            copy_entry, free_entry, cmp_md5_keys, false);
     if (md5_vdom_map == NULL)
         goto failed;
 
+    purc_mutex_init(&cache_lock);
     if (atexit(cleanup_loader_once))
         goto failed;
 
@@ -165,11 +190,59 @@ failed:
     return -1;
 }
 
+static void unpin_vdom(void *vdom)
+{
+    pcvdom_document_unref((purc_vdom_t)vdom);
+}
+
+/* takes over the reference of vdom held by the caller */
+static void pin_vdom(purc_vdom_t vdom)
+{
+    struct pcintr_heap *heap = pcintr_get_heap();
+    if (heap == NULL) {
+        /* not an interpreter instance: keep the reference forever */
+        return;
+    }
+
+    if (heap->loaded_vdoms == NULL) {
+        heap->loaded_vdoms = pcutils_arrlist_new(unpin_vdom);
+        if (heap->loaded_vdoms == NULL)
+            return;
+    }
+
+    size_t n = pcutils_arrlist_length(heap->loaded_vdoms);
+    for (size_t i = 0; i < n; i++) {
+        if (pcutils_arrlist_get_idx(heap->loaded_vdoms, i) == vdom) {
+            pcvdom_document_unref(vdom);
+            return;
+        }
+    }
+
+    pcutils_arrlist_append(heap->loaded_vdoms, vdom);
+}
+
+/* the caller holds cache_lock */
+static void shrink_cache(struct vdom_entry *keep)
+{
+    while (total_orig_size > VDOM_CACHE_MAX_SIZE) {
+        struct vdom_entry *lru;
+        lru = list_last_entry(&lru_list, struct vdom_entry, ln);
+        if (lru == keep)
+            break;
+
+        unsigned char md5[MD5_DIGEST_SIZE];
+        memcpy(md5, lru->md5, MD5_DIGEST_SIZE);
+        pcutils_map_erase(md5_vdom_map, md5);
+    }
+}
+
 static bool
 cache_vdom(unsigned char *md5, unsigned expire_after, size_t length,
         purc_vdom_t vdom)
 {
     struct vdom_entry *entry = calloc(1, sizeof(*entry));
+    if (entry == NULL)
+        return false;
 
     time_t expire;
     if (expire_after)
@@ -177,15 +250,22 @@ cache_vdom(unsigned char *md5, unsigned expire_after, size_t length,
     else
        expire = purc_monotonic_time_after(3600);
 
+    memcpy(entry->md5, md5, MD5_DIGEST_SIZE);
     entry->expire = expire;
     entry->length = length;
     entry->vdom = vdom;
 
     pcvdom_document_ref(vdom);
+
+    purc_mutex_lock(&cache_lock);
     if (pcutils_map_find_replace_or_insert(md5_vdom_map, md5, entry, NULL)) {
+        purc_mutex_unlock(&cache_lock);
         pcvdom_document_unref(vdom);
+        free(entry);
         return false;
     }
+    shrink_cache(entry);
+    purc_mutex_unlock(&cache_lock);
 
     return true;
 }
@@ -194,25 +274,124 @@ static purc_vdom_t find_vdom_in_cache(unsigned char *md5)
 {
     purc_vdom_t vdom = NULL;
 
+    purc_mutex_lock(&cache_lock);
     pcutils_map_entry* entry;
-    entry = pcutils_map_find_and_lock(md5_vdom_map, md5);
+    entry = pcutils_map_find(md5_vdom_map, md5);
     if (entry) {
         time_t t = purc_get_monotoic_time();
         struct vdom_entry *vdom_entry = entry->val;
         if (t >= vdom_entry->expire) {
-            pcutils_map_erase_entry_nolock(md5_vdom_map, entry);
+            pcutils_map_erase(md5_vdom_map, md5);
         }
         else {
-            struct vdom_entry *vdom_entry = entry->val;
+            list_move(&vdom_entry->ln, &lru_list);
             vdom = vdom_entry->vdom;
+            /* for pin_vdom(); before any other thread can drop it */
+            pcvdom_document_ref(vdom);
         }
+    }
+    purc_mutex_unlock(&cache_lock);
+
+    if (vdom)
+        pin_vdom(vdom);
+
+    return vdom;
+}
+
+/* a newly loaded vdom: pin it, then share it through the cache */
+static void
+keep_vdom(unsigned char *md5, unsigned expire_after, size_t length,
+        purc_vdom_t vdom)
+{
+    pin_vdom(pcvdom_document_ref(vdom));
+    cache_vdom(md5, expire_after, length, vdom);
+}
+
+static char *
+vdom_image_path(const unsigned char *md5)
+{
+    const char *dir = getenv(PURC_ENVV_VDOM_CACHE_PATH);
+    if (dir == NULL || dir[0] == 0)
+        return NULL;
+
+    char hex[MD5_DIGEST_SIZE * 2 + 1];
+    pcutils_bin2hex(md5, MD5_DIGEST_SIZE, hex, false);
+
+    size_t len = strlen(dir) + 1 + sizeof(hex) + sizeof(VDOM_IMAGE_SUFFIX);
+    char *path = malloc(len);
+    if (path)
+        snprintf(path, len, "%s/%s" VDOM_IMAGE_SUFFIX, dir, hex);
+    return path;
+}
+
+static purc_vdom_t
+load_vdom_image(const char *path, unsigned char *md5, size_t length)
+{
+    purc_vdom_t vdom = NULL;
 
-        pcutils_map_unlock(md5_vdom_map);
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+        return NULL;
+
+    struct stat st;
+    if (fstat(fd, &st) == 0 && st.st_size > 0) {
+        void *image = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (image != MAP_FAILED) {
+            vdom = pcvdom_document_read_image(image, st.st_size, md5, length);
+            munmap(image, st.st_size);
+        }
     }
 
+    close(fd);
     return vdom;
 }
 
+/* the image is written to a temporary file and renamed at last, so other
+   processes never see a partial image */
+static void
+save_vdom_image(const char *path, unsigned char *md5, size_t length,
+        purc_vdom_t vdom)
+{
+    purc_rwstream_t out = purc_rwstream_new_buffer(4096, 0);
+    if (!out)
+        return;
+
+    size_t len = strlen(path) + sizeof(".XXXXXX");
+    char *tmp = malloc(len);
+    int fd = -1;
+    if (tmp == NULL)
+        goto done;
+
+    snprintf(tmp, len, "%s.XXXXXX", path);
+    if (pcvdom_document_write_image(vdom, md5, length, out))
+        goto done;
+
+    fd = mkstemp(tmp);
+    if (fd < 0)
+        goto done;
+
+    size_t sz = 0;
+    const char *image = purc_rwstream_get_mem_buffer(out, &sz);
+    while (sz > 0) {
+        ssize_t n = write(fd, image, sz);
+        if (n < 0) {
+            if (errno == EINTR)
+                continue;
+            break;
+        }
+        image += n;
+        sz -= n;
+    }
+
+    close(fd);
+    if (sz > 0 || rename(tmp, path))
+        unlink(tmp);
+
+done:
+    free(tmp);
+    purc_rwstream_destroy(out);
+}
+
 purc_vdom_t
 purc_load_hvml_from_string(const char* string)
 {
@@ -236,7 +415,7 @@ purc_load_hvml_from_string(const char* string)
         }
 
         if ((vdom = purc_load_hvml_from_rwstream(in))) {
-            cache_vdom(md5, 0, length, vdom);
+            keep_vdom(md5, 0, length, vdom);
         }
 
         purc_rwstream_destroy(in);
@@ -260,16 +439,27 @@ purc_load_hvml_from_file(const char* file)
 
     vdom = find_vdom_in_cache(md5);
     if (vdom == NULL) {
+        char *image_path = vdom_image_path(md5);
+        if (image_path && (vdom = load_vdom_image(image_path, md5, length))) {
+            keep_vdom(md5, 0, length, vdom);
+            free(image_path);
+            return vdom;
+        }
+
         purc_rwstream_t in;
         in = purc_rwstream_new_from_file(file, "r");
         if (!in) {
+            free(image_path);
             goto failed;
         }
 
         if ((vdom = purc_load_hvml_from_rwstream(in))) {
-            cache_vdom(md5, 0, length, vdom);
+            keep_vdom(md5, 0, length, vdom);
+            if (image_path)
+                save_vdom_image(image_path, md5, length, vdom);
         }
         purc_rwstream_destroy(in);
+        free(image_path);
     }
 
     return vdom;
@@ -307,7 +497,7 @@ purc_load_hvml_from_url(const char* url)
             vdom = purc_load_hvml_from_rwstream(resp);
             if (vdom) {
                 size_t length = purc_rwstream_tell(resp);
-                cache_vdom(md5, 60, length, vdom);
+                keep_vdom(md5, 60, length, vdom);
             }
             purc_rwstream_destroy(resp);
         }
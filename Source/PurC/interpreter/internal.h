@@ -80,6 +80,18 @@ PCA_EXTERN_C_BEGIN
 void
 pcintr_destroy_observer_list(struct list_head *observer_list);
 
+void
+pcintr_init_observer_index(struct pcintr_observer_index *index);
+
+// the list of the observers using the default matching function which
+// may match the message type
+static inline struct list_head *
+pcintr_observer_index_bucket(struct pcintr_observer_index *index,
+        purc_atom_t msg_type_atom)
+{
+    return &index->by_type[msg_type_atom % PCINTR_OBSERVER_INDEX_SIZE];
+}
+
 struct pcintr_stack_frame_normal *
 pcintr_push_stack_frame_normal(pcintr_stack_t stack);
 
@@ -307,6 +319,10 @@ pcintr_rdr_send_dom_req_raw(pcintr_stack_t stack, pcdoc_operation op,
         pcdoc_element_t element, const char* property,
         pcrdr_msg_data_type data_type, const char *data, size_t len);
 
+/* The DOM changes made by the functions below are recorded in the journal
+   of the coroutine and sent to the renderer in a batch without waiting. */
+#define PCINTR_MAX_PENDING_DOM_CHANGES      1024
+
 bool
 pcintr_rdr_send_dom_req_simple(pcintr_stack_t stack, pcdoc_operation op,
         pcdoc_element_t element, const char* property,
@@ -317,6 +333,11 @@ pcintr_rdr_send_dom_req_simple_raw(pcintr_stack_t stack, pcdoc_operation op,
         pcdoc_element_t element, const char *property,
         pcrdr_msg_data_type data_type, const char *data, size_t len);
 
+void
+pcintr_rdr_flush_dom_changes(pcintr_coroutine_t co);
+
+void
+pcintr_rdr_discard_dom_changes(pcintr_coroutine_t co);
 
 #define pcintr_rdr_dom_append_content(stack, element, content)          \
     pcintr_rdr_send_dom_req_simple_raw(stack, PCDOC_OP_APPEND,          \
@@ -421,6 +442,22 @@ void pcintr_coroutine_set_state_with_location(pcintr_coroutine_t co,
 int
 pcintr_coroutine_clear_tasks(pcintr_coroutine_t co);
 
+int
+pcintr_scheduler_init(struct pcinst *inst);
+
+void
+pcintr_scheduler_cleanup(struct pcinst *inst);
+
+/* remove the coroutine from the ready queue and the timeout heap */
+void
+pcintr_unschedule_coroutine(pcintr_coroutine_t co);
+
+/* like purc_runloop_add_fd_monitor(), but not bound to a coroutine */
+uintptr_t
+pcintr_runloop_add_fd_monitor(purc_runloop_t runloop, int fd,
+        purc_runloop_io_event event, purc_runloop_io_callback callback,
+        void *ctxt);
+
 void
 pcintr_coroutine_add_sub_exit_observer(pcintr_coroutine_t co);
 
@@ -399,11 +399,13 @@ coroutine_release(pcintr_coroutine_t co)
         struct pcintr_heap *heap = pcintr_get_heap();
         PC_ASSERT(heap && co->owner == heap);
 
+        pcintr_unschedule_coroutine(co);
         stack_release(&co->stack);
         pcvdom_document_unref(co->vdom);
 
         PURC_VARIANT_SAFE_CLEAR(co->doc_contents);
         PURC_VARIANT_SAFE_CLEAR(co->doc_wrotten_len);
+        pcintr_rdr_discard_dom_changes(co);
 
         struct list_head *children = &co->children;
         struct list_head *p, *n;
@@ -489,6 +491,8 @@ stack_init(pcintr_stack_t stack)
     list_head_init(&stack->frames);
     list_head_init(&stack->intr_observers);
     list_head_init(&stack->hvml_observers);
+    pcintr_init_observer_index(&stack->intr_observer_index);
+    pcintr_init_observer_index(&stack->hvml_observer_index);
     stack->scoped_variables = RB_ROOT;
 
     stack->mode = STACK_VDOM_BEFORE_HVML;
@@ -518,7 +522,7 @@ static void _cleanup_instance(struct pcinst* inst)
         coroutine_destroy(pco);
     }
 
-    pcutils_sorted_array_destroy(heap->wait_timeout_crtns);
+    pcintr_scheduler_cleanup(inst);
 
     if (heap->move_buff) {
         size_t n = purc_inst_destroy_move_buffer();
@@ -536,6 +540,11 @@ static void _cleanup_instance(struct pcinst* inst)
         heap->name_chan_map = NULL;
     }
 
+    if (heap->loaded_vdoms) {
+        pcutils_arrlist_free(heap->loaded_vdoms);
+        heap->loaded_vdoms = NULL;
+    }
+
     free(heap);
     inst->intr_heap = NULL;
 }
@@ -557,6 +566,8 @@ static int _init_instance(struct pcinst* inst,
     if (!heap)
         return PURC_ERROR_OUT_OF_MEMORY;
 
+    // the move buffer wakes up the scheduler via the running loop
+    inst->running_loop = purc_runloop_get_current();
     heap->move_buff = purc_inst_create_move_buffer(
             PCINST_MOVE_BUFFER_BROADCAST, PCINTR_MOVE_BUFFER_SIZE);
     if (!heap->move_buff) {
@@ -569,7 +580,6 @@ static int _init_instance(struct pcinst* inst,
         return purc_get_last_error();
     }
 
-    inst->running_loop = purc_runloop_get_current();
     inst->intr_heap = heap;
     heap->owner     = inst;
 
@@ -577,8 +587,13 @@ static int _init_instance(struct pcinst* inst,
 
     list_head_init(&heap->crtns);
     list_head_init(&heap->stopped_crtns);
-    heap->wait_timeout_crtns = pcutils_sorted_array_create(
-            SAFLAG_ORDER_ASC | SAFLAG_DUPLCATE_SORTV, 0, NULL, NULL);
+    if (pcintr_scheduler_init(inst)) {
+        purc_inst_destroy_move_buffer();
+        heap->move_buff = 0;
+        inst->intr_heap = NULL;
+        free(heap);
+        return PURC_ERROR_OUT_OF_MEMORY;
+    }
 
     heap->name_chan_map =
         pcutils_map_create(NULL, NULL, NULL,
@@ -586,6 +601,7 @@ static int _init_instance(struct pcinst* inst,
 
     heap->event_timer = pcintr_timer_create(NULL, NULL, event_timer_fire, inst);
     if (!heap->event_timer) {
+        pcintr_scheduler_cleanup(inst);
         purc_inst_destroy_move_buffer();
         heap->move_buff = 0;
         free(heap);
@@ -1805,11 +1821,14 @@ coroutine_create(purc_vdom_t vdom, pcintr_coroutine_t parent,
 
     pcvdom_document_ref(vdom);
     co->vdom = vdom;
+    co->stopped_timeout = -1;
+    list_head_init(&co->ln_ready);
     pcintr_coroutine_set_state(co, CO_STATE_READY);
     list_head_init(&co->children);
     list_head_init(&co->ln_stopped);
     list_head_init(&co->registered_cancels);
     list_head_init(&co->tasks);
+    list_head_init(&co->dom_changes);
 
     co->mq = pcinst_msg_queue_create();
     if (!co->mq) {
@@ -1862,7 +1881,7 @@ coroutine_create(purc_vdom_t vdom, pcintr_coroutine_t parent,
                 (void *)(uintptr_t)co->cid);
     }
 
-    co->stopped_timeout = -1;
+    pcintr_wakeup_coroutine(co);
 
     return co;
 
@@ -2015,7 +2034,7 @@ purc_run(purc_cond_handler handler)
     heap->keep_alive = 0;
     heap->cond_handler = handler;
 
-    purc_runloop_set_idle_func(runloop, pcintr_schedule, inst);
+    pcintr_wakeup_scheduler(inst);
     purc_runloop_run();
 
     return 0;
@@ -3328,6 +3347,11 @@ pcintr_coroutine_set_state_with_location(pcintr_coroutine_t co,
     UNUSED_PARAM(line);
     UNUSED_PARAM(func);
     co->state = state;
+
+    // the scheduler does not care about the running state
+    if (state != CO_STATE_RUNNING) {
+        pcintr_wakeup_coroutine(co);
+    }
 }
 
 int
@@ -309,7 +309,9 @@ dispatch_move_buffer_event(struct pcinst *inst, const pcrdr_msg *msg)
         list_for_each_entry_safe(p, q, crtns, ln) {
             pcintr_coroutine_t co = p;
             if (co->cid == msg->targetValue) {
-                return pcinst_msg_queue_append(co->mq, msg_clone);
+                int ret = pcinst_msg_queue_append(co->mq, msg_clone);
+                pcintr_wakeup_coroutine(co);
+                return ret;
             }
         }
 
@@ -317,7 +319,9 @@ dispatch_move_buffer_event(struct pcinst *inst, const pcrdr_msg *msg)
         list_for_each_entry_safe(p, q, crtns, ln) {
             pcintr_coroutine_t co = p;
             if (co->cid == msg->targetValue) {
-                return pcinst_msg_queue_append(co->mq, msg_clone);
+                int ret = pcinst_msg_queue_append(co->mq, msg_clone);
+                pcintr_wakeup_coroutine(co);
+                return ret;
             }
         }
         pcrdr_release_message(msg_clone);
@@ -329,6 +333,7 @@ dispatch_move_buffer_event(struct pcinst *inst, const pcrdr_msg *msg)
             pcrdr_msg *my_msg = pcrdr_clone_message(msg_clone);
             my_msg->targetValue = co->cid;
             pcinst_msg_queue_append(co->mq, my_msg);
+            pcintr_wakeup_coroutine(co);
         }
 
         crtns = &heap->stopped_crtns;
@@ -337,6 +342,7 @@ dispatch_move_buffer_event(struct pcinst *inst, const pcrdr_msg *msg)
             pcrdr_msg *my_msg = pcrdr_clone_message(msg_clone);
             my_msg->targetValue = co->cid;
             pcinst_msg_queue_append(co->mq, my_msg);
+            pcintr_wakeup_coroutine(co);
         }
         pcrdr_release_message(msg_clone);
     }
@@ -42,6 +42,7 @@ release_observer(struct pcintr_observer *observer)
         return;
 
     list_del(&observer->node);
+    list_del(&observer->index_node);
 
     if (observer->on_revoke) {
         observer->on_revoke(observer, observer->on_revoke_data);
@@ -65,6 +66,8 @@ release_observer(struct pcintr_observer *observer)
 
     free(observer->sub_type);
     observer->sub_type = NULL;
+    pcregex_destroy(observer->sub_type_regex);
+    observer->sub_type_regex = NULL;
 }
 
 
@@ -78,13 +81,37 @@ free_observer(struct pcintr_observer *observer)
     free(observer);
 }
 
+static bool
+is_match_default(struct pcintr_observer *observer, pcrdr_msg *msg,
+        purc_variant_t observed, purc_atom_t type, const char *sub_type);
+
+void
+pcintr_init_observer_index(struct pcintr_observer_index *index)
+{
+    for (size_t i = 0; i < PCA_TABLESIZE(index->by_type); i++) {
+        list_head_init(&index->by_type[i]);
+    }
+    list_head_init(&index->others);
+}
+
 static void
 add_observer_into_list(pcintr_stack_t stack, struct list_head *list,
+        struct pcintr_observer_index *index,
         struct pcintr_observer* observer)
 {
     observer->list = list;
     list_add_tail(&observer->node, list);
 
+    /* only the default matching function is known to check the type */
+    observer->seq = stack->observer_seq++;
+    if (observer->is_match == is_match_default) {
+        list_add_tail(&observer->index_node,
+                pcintr_observer_index_bucket(index, observer->msg_type_atom));
+    }
+    else {
+        list_add_tail(&observer->index_node, &index->others);
+    }
+
     // TODO:
     PC_ASSERT(stack);
     PC_ASSERT(stack->co->waits >= 0);
@@ -126,10 +153,18 @@ is_match_default(struct pcintr_observer *observer, pcrdr_msg *msg,
     UNUSED_PARAM(msg);
     if ((is_variant_match_observe(observer->observed, observed)) &&
                 (observer->msg_type_atom == type)) {
-        if (observer->sub_type == sub_type ||
-                pcregex_is_match(observer->sub_type, sub_type)) {
+        if (observer->sub_type == sub_type) {
             return true;
         }
+        if (observer->sub_type == NULL || sub_type == NULL) {
+            return false;
+        }
+        if (observer->sub_type_regex) {
+            return pcregex_match(observer->sub_type_regex, sub_type, NULL);
+        }
+        /* a literal pattern matches wherever it occurs in the sub type */
+        return pcregex_is_literal(observer->sub_type) &&
+            strstr(sub_type, observer->sub_type) != NULL;
     }
     return false;
 }
@@ -168,6 +203,7 @@ observer_handle_default(pcintr_coroutine_t co, struct pcintr_observer *p,
     }
 
     list_add_tail(&task->ln, &co->tasks);
+    pcintr_wakeup_coroutine(co);
     return 0;
 }
 
@@ -199,11 +235,14 @@ pcintr_register_observer(pcintr_stack_t  stack,
         )
 {
     struct list_head *list = NULL;
+    struct pcintr_observer_index *index = NULL;
     if (source == OBSERVER_SOURCE_INTR) {
         list = &stack->intr_observers;
+        index = &stack->intr_observer_index;
     }
     else {
         list = &stack->hvml_observers;
+        index = &stack->hvml_observer_index;
     }
 
 
@@ -225,6 +264,13 @@ pcintr_register_observer(pcintr_stack_t  stack,
     observer->pos = pos;
     observer->msg_type_atom = msg_type_atom;
     observer->sub_type = sub_type ? strdup(sub_type) : NULL;
+    if (sub_type && !pcregex_is_literal(sub_type)) {
+        /* a bad pattern never matches, as with pcregex_is_match() */
+        int errcode = purc_get_last_error();
+        observer->sub_type_regex = pcregex_get_cached(sub_type, 0, 0);
+        if (observer->sub_type_regex == NULL)
+            purc_set_error(errcode);
+    }
     observer->on_revoke = on_revoke;
     observer->on_revoke_data = on_revoke_data;
     observer->is_match = is_match ? is_match : is_match_default;
@@ -232,7 +278,7 @@ pcintr_register_observer(pcintr_stack_t  stack,
     observer->handle_data = handle_data;
     observer->auto_remove = auto_remove;
     observer->timestamp = get_timestamp_us();
-    add_observer_into_list(stack, list, observer);
+    add_observer_into_list(stack, list, index, observer);
 
     // observe idle
     purc_variant_t hvml = pcintr_get_coroutine_variable(stack->co,
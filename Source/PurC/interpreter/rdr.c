@@ -116,6 +116,10 @@ pcrdr_msg *pcintr_rdr_send_request_and_wait_response(struct pcrdr_conn *conn,
         purc_variant_t data, size_t data_len)
 {
     pcrdr_msg *response_msg = NULL;
+
+    /* the pending DOM changes go ahead to keep the order of requests */
+    pcintr_rdr_flush_dom_changes(pcintr_get_coroutine());
+
     pcrdr_msg *msg = pcrdr_make_request_message(
             target,                             /* target */
             target_value,                       /* target_value */
@@ -811,108 +815,280 @@ pcintr_attach_to_renderer(pcintr_coroutine_t cor,
     return true;
 }
 
-static pcrdr_msg *
-rdr_page_control_load_large_page(struct pcrdr_conn *conn,
-        pcrdr_msg_target target, uint64_t target_value,
-        pcrdr_msg_data_type data_type,
-        const char *doc_content, size_t len_content)
+/* The serialized document is sent in chunks while being serialized;
+   a window of chunks are sent without waiting for the responses. */
+struct page_writer {
+    struct pcrdr_conn          *conn;
+    pcrdr_msg_target            target;
+    uint64_t                    target_value;
+    pcrdr_msg_data_type         data_type;
+
+    /* the serialized contents not sent yet */
+    char                       *buf;
+    size_t                      len;
+    size_t                      sz;
+
+    size_t                      nr_chunks;      /* number of chunks sent */
+    unsigned                    window;
+    unsigned                    nr_in_flight;
+
+    int                         ret_code;       /* the first failure */
+    uint64_t                    result_value;   /* of the last response */
+    bool                        abandoned;
+};
+
+static unsigned
+get_write_window(void)
 {
-    pcrdr_msg *response_msg = NULL;
-    pcrdr_msg_element_type element_type = PCRDR_MSG_ELEMENT_TYPE_VOID;
-    purc_variant_t data;
-    size_t len_wrotten;
-    size_t len_to_write = 0;
+    const char *env = getenv(PURC_ENVV_RDR_WRITE_WINDOW);
+    if (env) {
+        long window = strtol(env, NULL, 10);
+        if (window > 0) {
+            return (window > PCRDR_MAX_WRITE_WINDOW) ?
+                PCRDR_MAX_WRITE_WINDOW : (unsigned)window;
+        }
+    }
+
+    return PCRDR_DEF_WRITE_WINDOW;
+}
 
-    // writeBegin
-    const char *start = doc_content;
-    const char *end;
-    pcutils_string_check_utf8_len(start, DEF_LEN_ONE_WRITE, NULL, &end);
-    if (end > start) {
-        len_to_write = end - start;
+static void
+page_writer_free(struct page_writer *writer)
+{
+    free(writer->buf);
+    free(writer);
+}
 
-        data = purc_variant_make_string_static(start, false);
-        len_wrotten = len_to_write;
+static int
+page_writer_response_handler(pcrdr_conn* conn,
+        const char *request_id, int state,
+        void *context, const pcrdr_msg *response_msg)
+{
+    struct page_writer *writer = context;
+
+    UNUSED_PARAM(conn);
+    UNUSED_PARAM(request_id);
+
+    writer->nr_in_flight--;
+    if (state != PCRDR_RESPONSE_RESULT) {
+        if (writer->ret_code == PCRDR_SC_OK) {
+            writer->ret_code = PCRDR_SC_CALLEE_TIMEOUT;
+        }
+    }
+    else if (response_msg->retCode != PCRDR_SC_OK) {
+        if (writer->ret_code == PCRDR_SC_OK) {
+            writer->ret_code = response_msg->retCode;
+        }
     }
     else {
-        LOG_ERROR("No valid character in document content\n");
-        goto failed;
+        writer->result_value = response_msg->resultValue;
     }
 
-    response_msg = pcintr_rdr_send_request_and_wait_response(
-            conn, target, target_value, PCRDR_OPERATION_WRITEBEGIN,
-            element_type, NULL, NULL, data_type, data, len_to_write);
-    if (response_msg == NULL) {
-        goto failed;
+    /* the loader gave up waiting, e.g., the connection was lost */
+    if (writer->abandoned && writer->nr_in_flight == 0) {
+        page_writer_free(writer);
     }
 
-    if (response_msg->retCode != PCRDR_SC_OK) {
-        PC_ERROR("failed to write content to rdr\n");
-        goto failed;
+    return 0;
+}
+
+static bool
+page_writer_wait(struct page_writer *writer, unsigned max_in_flight)
+{
+    while (writer->nr_in_flight > max_in_flight) {
+        if (pcrdr_wait_and_dispatch_message(writer->conn, 1000) < 0) {
+            int err = purc_get_last_error();
+            if (err != PCRDR_ERROR_TIMEOUT) {
+                return false;
+            }
+            /* the timeout of a request is checked in the call */
+            purc_clr_error();
+        }
     }
 
-    if (len_wrotten == len_content) {
-        goto done;
+    return true;
+}
+
+static bool
+page_writer_send(struct page_writer *writer, const char *operation,
+        const char *text, size_t len)
+{
+    /* keep the window of the requests in flight */
+    if (!page_writer_wait(writer, writer->window - 1)) {
+        return false;
     }
 
-writting:
-    len_to_write = 0;
-    if (len_wrotten + DEF_LEN_ONE_WRITE > len_content) {
-        // writeEnd
-        data = purc_variant_make_string_static(doc_content + len_wrotten,
-                false);
-        response_msg = pcintr_rdr_send_request_and_wait_response(
-                conn, target, target_value, PCRDR_OPERATION_WRITEEND,
-                element_type, NULL, NULL, data_type, data, 0);
-        if (response_msg == NULL) {
-            goto failed;
-        }
+    if (writer->ret_code != PCRDR_SC_OK) {
+        return false;
+    }
 
-        if (response_msg->retCode != PCRDR_SC_OK) {
-            PC_ERROR("failed to write content to rdr\n");
-            goto failed;
+    pcrdr_msg *msg = pcrdr_make_request_message(
+            writer->target,                     /* target */
+            writer->target_value,               /* target_value */
+            operation,                          /* operation */
+            NULL,                               /* request_id */
+            NULL,                               /* source_uri */
+            PCRDR_MSG_ELEMENT_TYPE_VOID,        /* element_type */
+            NULL,                               /* element */
+            NULL,                               /* property */
+            PCRDR_MSG_DATA_TYPE_VOID,           /* data_type */
+            NULL,                               /* data */
+            0                                   /* data_len */
+            );
+    if (msg == NULL) {
+        purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
+        return false;
+    }
+
+    msg->dataType = writer->data_type;
+    msg->data = purc_variant_make_string_ex(text, len, false);
+    if (msg->data == PURC_VARIANT_INVALID) {
+        pcrdr_release_message(msg);
+        return false;
+    }
+
+    int ret = pcrdr_send_request(writer->conn, msg, PCRDR_TIME_DEF_EXPECTED,
+            writer, page_writer_response_handler);
+    pcrdr_release_message(msg);
+    if (ret) {
+        return false;
+    }
+
+    writer->nr_in_flight++;
+    writer->nr_chunks++;
+    return true;
+}
+
+/* send the complete characters in the buffer except the last chunk,
+   which may be the one to end the writing */
+static ssize_t
+page_writer_write(void *ctxt, const void *buf, size_t count)
+{
+    struct page_writer *writer = ctxt;
+
+    if (writer->ret_code != PCRDR_SC_OK) {
+        return -1;
+    }
+
+    if (writer->len + count > writer->sz) {
+        size_t sz = pcutils_get_next_fibonacci_number(writer->len + count);
+        char *p = realloc(writer->buf, sz);
+        if (p == NULL) {
+            purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
+            writer->ret_code = PCRDR_SC_INSUFFICIENT_STORAGE;
+            return -1;
         }
-        goto done;
+        writer->buf = p;
+        writer->sz = sz;
     }
-    else {
-        // writeMore
-        start = doc_content + len_wrotten;
+    memcpy(writer->buf + writer->len, buf, count);
+    writer->len += count;
+
+    size_t sent = 0;
+    while (writer->len - sent > DEF_LEN_ONE_WRITE) {
+        const char *start = writer->buf + sent;
+        const char *end;
         pcutils_string_check_utf8_len(start, DEF_LEN_ONE_WRITE, NULL, &end);
-        if (end > start) {
-            len_to_write = end - start;
-            len_wrotten += len_to_write;
-            data = purc_variant_make_string_static(start, false);
-        }
-        else {
+        if (end <= start) {
             PC_WARN("no valid character for rdr\n");
-            goto failed;
+            writer->ret_code = PCRDR_SC_BAD_REQUEST;
+            return -1;
         }
 
-        response_msg = pcintr_rdr_send_request_and_wait_response(
-                conn, target, target_value, PCRDR_OPERATION_WRITEMORE,
-                element_type, NULL, NULL, data_type, data, len_to_write);
-        if (response_msg == NULL) {
-            goto failed;
+        if (!page_writer_send(writer, writer->nr_chunks ?
+                    PCRDR_OPERATION_WRITEMORE : PCRDR_OPERATION_WRITEBEGIN,
+                    start, end - start)) {
+            if (writer->ret_code == PCRDR_SC_OK)
+                writer->ret_code = PCRDR_SC_SERVICE_UNAVAILABLE;
+            return -1;
         }
+        sent += end - start;
+    }
 
-        if (response_msg->retCode != PCRDR_SC_OK) {
-            PC_ERROR("failed to write content to rdr\n");
-            goto failed;
-        }
+    if (sent) {
+        memmove(writer->buf, writer->buf + sent, writer->len - sent);
+        writer->len -= sent;
+    }
 
-        if (len_wrotten == len_content) {
-            goto done;
+    return count;
+}
+
+/* Returns the response code, and the handle of the DOM in @dom_handle. */
+static int
+rdr_page_control_load_stream(struct pcrdr_conn *conn,
+        pcrdr_msg_target target, uint64_t target_value,
+        pcrdr_msg_data_type data_type, purc_document_t doc,
+        unsigned opt, uint64_t *dom_handle)
+{
+    int ret_code = PCRDR_SC_INSUFFICIENT_STORAGE;
+    purc_rwstream_t out = NULL;
+    struct page_writer *writer = calloc(1, sizeof(*writer));
+    if (writer == NULL) {
+        purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
+        goto failed;
+    }
+
+    writer->conn = conn;
+    writer->target = target;
+    writer->target_value = target_value;
+    writer->data_type = data_type;
+    writer->window = get_write_window();
+    writer->ret_code = PCRDR_SC_OK;
+
+    out = purc_rwstream_new_for_dump(writer, page_writer_write);
+    if (out == NULL) {
+        goto failed;
+    }
+
+    int sret = purc_document_serialize_contents_to_stream(doc, opt, out);
+    purc_rwstream_destroy(out);
+    if (sret != 0 && writer->ret_code == PCRDR_SC_OK) {
+        writer->ret_code = PCRDR_SC_INTERNAL_SERVER_ERROR;
+    }
+
+    if (writer->ret_code == PCRDR_SC_OK) {
+        if (writer->nr_chunks == 0) {
+            /* a small document is loaded at once */
+            purc_variant_t data = purc_variant_make_string_ex(writer->buf,
+                    writer->len, false);
+            pcrdr_msg *response_msg = NULL;
+            if (data) {
+                response_msg = pcintr_rdr_send_request_and_wait_response(
+                        conn, target, target_value, PCRDR_OPERATION_LOAD,
+                        PCRDR_MSG_ELEMENT_TYPE_VOID, NULL, NULL,
+                        data_type, data, 0);
+            }
+
+            if (response_msg) {
+                writer->ret_code = response_msg->retCode;
+                writer->result_value = response_msg->resultValue;
+                pcrdr_release_message(response_msg);
+            }
+            else {
+                writer->ret_code = PCRDR_SC_SERVICE_UNAVAILABLE;
+            }
+        }
+        else if (!page_writer_send(writer, PCRDR_OPERATION_WRITEEND,
+                    writer->buf, writer->len) &&
+                writer->ret_code == PCRDR_SC_OK) {
+            writer->ret_code = PCRDR_SC_SERVICE_UNAVAILABLE;
         }
-        goto writting;
     }
 
-done:
-    return response_msg;
+    /* the responses refer to the writer, so wait for all of them */
+    if (!page_writer_wait(writer, 0)) {
+        writer->abandoned = true;
+        return PCRDR_SC_SERVICE_UNAVAILABLE;
+    }
+
+    ret_code = writer->ret_code;
+    *dom_handle = writer->result_value;
 
 failed:
-    if (response_msg) {
-        pcrdr_release_message(response_msg);
+    if (writer) {
+        page_writer_free(writer);
     }
-    return NULL;
+    return ret_code;
 }
 
 bool
@@ -923,7 +1099,7 @@ pcintr_rdr_page_control_load(pcintr_stack_t stack)
     }
 
     int ret_code;
-    pcrdr_msg *response_msg = NULL;
+    uint64_t dom_handle = 0;
 
     purc_document_t doc = stack->doc;
 
@@ -933,7 +1109,6 @@ pcintr_rdr_page_control_load(pcintr_stack_t stack)
     const pcrdr_msg_element_type element_type = PCRDR_MSG_ELEMENT_TYPE_VOID;
     pcrdr_msg_data_type data_type = doc->def_text_type;// VW
     purc_variant_t req_data = PURC_VARIANT_INVALID;
-    purc_rwstream_t out = NULL;
 
     switch (stack->co->target_page_type) {
     case PCRDR_PAGE_TYPE_NULL:
@@ -960,85 +1135,40 @@ pcintr_rdr_page_control_load(pcintr_stack_t stack)
         /* XXX: pass the document entity directly
            when the connection type is move buffer. */
         req_data = purc_variant_make_native(doc, NULL);
-        response_msg = pcintr_rdr_send_request_and_wait_response(
+        pcrdr_msg *response_msg = pcintr_rdr_send_request_and_wait_response(
                 inst->conn_to_rdr, target, target_value, operation,
                 element_type, NULL, NULL,
                 PCRDR_MSG_DATA_TYPE_JSON, req_data, 0);
+        if (response_msg == NULL) {
+            goto failed;
+        }
+
+        ret_code = response_msg->retCode;
+        dom_handle = response_msg->resultValue;
+        pcrdr_release_message(response_msg);
     }
     else {
         unsigned opt = 0;
 
-        out = purc_rwstream_new_buffer(BUFF_MIN, BUFF_MAX);
-        if (out == NULL) {
-            goto failed;
-        }
-
         opt |= PCDOC_SERIALIZE_OPT_UNDEF;
         opt |= PCDOC_SERIALIZE_OPT_SKIP_WS_NODES;
         opt |= PCDOC_SERIALIZE_OPT_WITHOUT_TEXT_INDENT;
         opt |= PCDOC_SERIALIZE_OPT_FULL_DOCTYPE;
         opt |= PCDOC_SERIALIZE_OPT_WITH_HVML_HANDLE;
 
-        if (0 != purc_document_serialize_contents_to_stream(doc, opt, out)) {
-            goto failed;
-        }
-
-        size_t sz_content = 0;
-        size_t sz_buff = 0;
-        char *p = (char*)purc_rwstream_get_mem_buffer_ex(out, &sz_content,
-                &sz_buff,true);
-        req_data = purc_variant_make_string_reuse_buff(p, sz_content, false);
-        if (req_data == PURC_VARIANT_INVALID) {
-            free(p);
-            purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
-            goto failed;
-        }
-
-        if (sz_content > DEF_LEN_ONE_WRITE) {
-            response_msg = rdr_page_control_load_large_page(inst->conn_to_rdr,
-                        target, target_value, data_type,
-                        p, sz_content);
-        }
-        else {
-            response_msg = pcintr_rdr_send_request_and_wait_response(
-                    inst->conn_to_rdr, target, target_value, operation,
-                    element_type, NULL, NULL, data_type, req_data, 0);
-        }
-
-        if (out) {
-            purc_rwstream_destroy(out);
-            out = NULL;
-        }
-    }
-
-    if (response_msg == NULL) {
-        goto failed;
-    }
-
-    ret_code = response_msg->retCode;
-    if (ret_code == PCRDR_SC_OK) {
-        stack->co->target_dom_handle = response_msg->resultValue;
+        ret_code = rdr_page_control_load_stream(inst->conn_to_rdr,
+                target, target_value, data_type, doc, opt, &dom_handle);
     }
 
-    pcrdr_release_message(response_msg);
-
     if (ret_code != PCRDR_SC_OK) {
         purc_set_error(PCRDR_ERROR_SERVER_REFUSED);
         goto failed;
     }
 
+    stack->co->target_dom_handle = dom_handle;
     return true;
 
 failed:
-    if (out) {
-        purc_rwstream_destroy(out);
-    }
-
-    /* VW: double free here
-    if (req_data != PURC_VARIANT_INVALID) {
-        purc_variant_unref(req_data);
-    } */
-
     return false;
 }
 
@@ -1054,29 +1184,24 @@ static const char *rdr_ops[] = {
     "",     // unknown
 };
 
-pcrdr_msg *
-pcintr_rdr_send_dom_req(pcintr_stack_t stack, pcdoc_operation op,
-        pcdoc_element_t element, const char* property,
-        pcrdr_msg_data_type data_type, purc_variant_t data)
+// whether the changes of the eDOM should be synchronized to the renderer;
+// a coroutine inheriting the document borrows the handles of its curator
+static bool
+is_dom_target_ready(pcintr_coroutine_t co)
 {
-    if (!stack) {
-        return NULL;
-    }
-
-    pcintr_coroutine_t co = stack->co;
     if (co->target_page_handle == 0 || co->target_dom_handle == 0) {
         if (!co->stack.inherit) {
-            return NULL;
+            return false;
         }
 
         pcintr_coroutine_t parent = pcintr_coroutine_get_by_id(co->curator);
         if (!parent || parent->stack.doc != co->stack.doc) {
-            return NULL;
+            return false;
         }
 
         if (parent->target_page_handle == 0
                 || parent->target_page_handle == 0) {
-            return NULL;
+            return false;
         }
 
         co->target_workspace_handle = parent->target_workspace_handle;
@@ -1086,6 +1211,18 @@ pcintr_rdr_send_dom_req(pcintr_stack_t stack, pcdoc_operation op,
     }
 
     if (co->stage != CO_STAGE_OBSERVING && !co->stack.inherit) {
+        return false;
+    }
+
+    return true;
+}
+
+pcrdr_msg *
+pcintr_rdr_send_dom_req(pcintr_stack_t stack, pcdoc_operation op,
+        pcdoc_element_t element, const char* property,
+        pcrdr_msg_data_type data_type, purc_variant_t data)
+{
+    if (!stack || !is_dom_target_ready(stack->co)) {
         return NULL;
     }
 
@@ -1143,33 +1280,7 @@ pcintr_rdr_send_dom_req_raw(pcintr_stack_t stack, pcdoc_operation op,
         pcdoc_element_t element, const char* property,
         pcrdr_msg_data_type data_type, const char *data, size_t len)
 {
-    if (!stack) {
-        return NULL;
-    }
-
-    pcintr_coroutine_t co = stack->co;
-    if (co->target_page_handle == 0 || co->target_dom_handle == 0) {
-        if (!co->stack.inherit) {
-            return NULL;
-        }
-
-        pcintr_coroutine_t parent = pcintr_coroutine_get_by_id(co->curator);
-        if (!parent || parent->stack.doc != co->stack.doc) {
-            return NULL;
-        }
-
-        if (parent->target_page_handle == 0
-                || parent->target_page_handle == 0) {
-            return NULL;
-        }
-
-        co->target_workspace_handle = parent->target_workspace_handle;
-        co->target_page_type = parent->target_page_type;
-        co->target_page_handle = parent->target_page_handle;
-        co->target_dom_handle = parent->target_dom_handle;
-    }
-
-    if (co->stage != CO_STAGE_OBSERVING && !co->stack.inherit) {
+    if (!stack || !is_dom_target_ready(stack->co)) {
         return NULL;
     }
 
@@ -1201,18 +1312,223 @@ failed:
     return ret;
 }
 
+struct pcintr_dom_change {
+    struct list_head        ln;     /* pcintr_coroutine::dom_changes */
+
+    pcdoc_operation         op;
+    pcdoc_element_t         element;
+    char                   *property;
+    pcrdr_msg_data_type     data_type;
+
+    /* the data is either a variant or a null-terminated text */
+    purc_variant_t          data;
+    char                   *text;
+    size_t                  len;
+    size_t                  sz;
+};
+
+static void
+dom_change_free(pcintr_coroutine_t co, struct pcintr_dom_change *change)
+{
+    list_del(&change->ln);
+    co->nr_dom_changes--;
+
+    if (change->data)
+        purc_variant_unref(change->data);
+    free(change->text);
+    free(change->property);
+    free(change);
+}
+
+static bool
+dom_change_append_text(struct pcintr_dom_change *change,
+        const char *text, size_t len)
+{
+    if (change->len + len + 1 > change->sz) {
+        size_t sz = pcutils_get_next_fibonacci_number(change->len + len + 1);
+        char *buf = realloc(change->text, sz);
+        if (buf == NULL) {
+            purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
+            return false;
+        }
+
+        change->text = buf;
+        change->sz = sz;
+    }
+
+    memcpy(change->text + change->len, text, len);
+    change->len += len;
+    change->text[change->len] = '\0';
+    return true;
+}
+
+static inline bool
+is_content_property(const char *property)
+{
+    return property == NULL || strcmp(property, "textContent") == 0;
+}
+
+static bool
+is_same_property(const char *p1, const char *p2)
+{
+    if (is_content_property(p1))
+        return is_content_property(p2);
+    return p2 && strcmp(p1, p2) == 0;
+}
+
+// whether an earlier change has no effect once the new one is applied
+static bool
+is_superseded(struct pcintr_dom_change *earlier, pcdoc_operation op,
+        const char *property)
+{
+    switch (earlier->op) {
+    case PCDOC_OP_INSERTBEFORE:
+    case PCDOC_OP_INSERTAFTER:
+        /* the siblings survive whatever happens to the element */
+        return false;
+    case PCDOC_OP_ERASE:
+        if (earlier->property == NULL)
+            return false;
+        break;
+    default:
+        break;
+    }
+
+    if (op == PCDOC_OP_ERASE && property == NULL) {
+        return true;
+    }
+
+    return is_same_property(earlier->property, property);
+}
+
+/*
+ * Merges the new change into the tail of the journal:
+ *  - the texts appended to the same target one by one are concatenated;
+ *  - a change replacing, clearing or erasing the target drops the
+ *    earlier changes on it, as far as the tail changes the same element.
+ * Returns true if the new change was absorbed by the tail.
+ */
+static bool
+merge_dom_change(pcintr_coroutine_t co, pcdoc_operation op,
+        pcdoc_element_t element, const char *property,
+        pcrdr_msg_data_type data_type, const char *text, size_t len)
+{
+    struct list_head *changes = &co->dom_changes;
+    struct pcintr_dom_change *tail;
+
+    if (list_empty(changes))
+        return false;
+
+    tail = list_last_entry(changes, struct pcintr_dom_change, ln);
+    if (op == PCDOC_OP_APPEND) {
+        if (text && tail->op == PCDOC_OP_APPEND && tail->element == element
+                && tail->data_type == data_type && tail->text
+                && (tail->property == property || (tail->property && property
+                        && strcmp(tail->property, property) == 0))) {
+            return dom_change_append_text(tail, text, len);
+        }
+        return false;
+    }
+
+    if (op != PCDOC_OP_DISPLACE && op != PCDOC_OP_UPDATE &&
+            op != PCDOC_OP_CLEAR && op != PCDOC_OP_ERASE) {
+        return false;
+    }
+
+    struct pcintr_dom_change *p, *n;
+    list_for_each_entry_reverse_safe(p, n, changes, ln) {
+        if (p->element != element)
+            break;
+
+        if (is_superseded(p, op, property))
+            dom_change_free(co, p);
+    }
+
+    return false;
+}
+
+static bool
+record_dom_change(pcintr_stack_t stack, pcdoc_operation op,
+        pcdoc_element_t element, const char *property,
+        pcrdr_msg_data_type data_type, purc_variant_t data,
+        const char *text, size_t len)
+{
+    if (!stack || !is_dom_target_ready(stack->co)) {
+        return false;
+    }
+
+    pcintr_coroutine_t co = stack->co;
+    if (property && op == PCDOC_OP_DISPLACE) {
+        // VW: use 'update' operation when displace property
+        op = PCDOC_OP_UPDATE;
+    }
+
+    if (merge_dom_change(co, op, element, property, data_type, text, len)) {
+        return true;
+    }
+
+    struct pcintr_dom_change *change = calloc(1, sizeof(*change));
+    if (change == NULL) {
+        goto failed;
+    }
+
+    change->op = op;
+    change->element = element;
+    change->data_type = data_type;
+    if (property && (change->property = strdup(property)) == NULL) {
+        goto failed;
+    }
+
+    if (data) {
+        change->data = purc_variant_ref(data);
+    }
+    else if (text && !dom_change_append_text(change, text, len)) {
+        goto failed;
+    }
+
+    list_add_tail(&change->ln, &co->dom_changes);
+    co->nr_dom_changes++;
+    if (co->nr_dom_changes >= PCINTR_MAX_PENDING_DOM_CHANGES) {
+        pcintr_rdr_flush_dom_changes(co);
+    }
+    return true;
+
+failed:
+    if (change) {
+        free(change->property);
+        free(change);
+    }
+    purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
+    return false;
+}
+
+// whether the renderer accepts the changes in a batch (`applyChanges`);
+// if not, every change is sent in a separate request immediately
+static bool
+rdr_accepts_dom_changes(void)
+{
+    struct pcinst *inst = pcinst_current();
+    return inst && inst->rdr_caps && inst->rdr_caps->prot_version >=
+        PCRDR_PURCMC_APPLYCHANGES_PROTOCOL_VERSION;
+}
+
 bool
 pcintr_rdr_send_dom_req_simple(pcintr_stack_t stack, pcdoc_operation op,
         pcdoc_element_t element, const char *property,
         pcrdr_msg_data_type data_type, purc_variant_t data)
 {
-    pcrdr_msg *response_msg = pcintr_rdr_send_dom_req(stack, op,
-            element, property, data_type, data);
-    if (response_msg != NULL) {
-        pcrdr_release_message(response_msg);
-        return true;
+    if (!rdr_accepts_dom_changes()) {
+        pcrdr_msg *response_msg = pcintr_rdr_send_dom_req(stack, op,
+                element, property, data_type, data);
+        if (response_msg != NULL) {
+            pcrdr_release_message(response_msg);
+            return true;
+        }
+        return false;
     }
-    return false;
+
+    return record_dom_change(stack, op, element, property, data_type,
+            data, NULL, 0);
 }
 
 bool
@@ -1229,13 +1545,197 @@ pcintr_rdr_send_dom_req_simple_raw(pcintr_stack_t stack,
         data = " ";
         len = 1;
     }
-    pcrdr_msg *response_msg = pcintr_rdr_send_dom_req_raw(stack, op,
-            element, property, data_type, data, len);
 
-    if (response_msg != NULL) {
-        pcrdr_release_message(response_msg);
-        return true;
+    if (!rdr_accepts_dom_changes()) {
+        pcrdr_msg *response_msg = pcintr_rdr_send_dom_req_raw(stack, op,
+                element, property, data_type, data, len);
+        if (response_msg != NULL) {
+            pcrdr_release_message(response_msg);
+            return true;
+        }
+        return false;
     }
-    return false;
+
+    if (data_type == PCRDR_MSG_DATA_TYPE_JSON) {
+        purc_variant_t req_data = purc_variant_make_from_json_string(data, len);
+        if (req_data == PURC_VARIANT_INVALID) {
+            purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
+            return false;
+        }
+
+        bool ret = record_dom_change(stack, op, element, property,
+                data_type, req_data, NULL, 0);
+        purc_variant_unref(req_data);
+        return ret;
+    }
+
+    return record_dom_change(stack, op, element, property, data_type,
+            PURC_VARIANT_INVALID, data, len);
+}
+
+static int
+dom_changes_response_handler(pcrdr_conn* conn,
+        const char *request_id, int state,
+        void *context, const pcrdr_msg *response_msg)
+{
+    purc_atom_t cid = (purc_atom_t)(uintptr_t)context;
+    const char *uri = purc_atom_to_string(cid);
+
+    UNUSED_PARAM(conn);
+
+    if (state == PCRDR_RESPONSE_RESULT) {
+        if (response_msg->retCode != PCRDR_SC_OK) {
+            purc_log_error("Renderer refused change #%u of %s: %d\n",
+                    (unsigned)response_msg->resultValue,
+                    uri ? uri : "a gone coroutine", response_msg->retCode);
+        }
+    }
+    else {
+        purc_log_error("No response to the DOM changes of %s (%s): %s\n",
+                uri ? uri : "a gone coroutine", request_id,
+                state == PCRDR_RESPONSE_TIMEOUT ? "timeout" : "cancelled");
+    }
+
+    return 0;
+}
+
+static purc_variant_t
+dom_change_to_variant(struct pcintr_dom_change *change)
+{
+    purc_variant_t obj = purc_variant_make_object_0();
+    if (obj == PURC_VARIANT_INVALID) {
+        return PURC_VARIANT_INVALID;
+    }
+
+    char elem[LEN_BUFF_LONGLONGINT];
+    snprintf(elem, sizeof(elem),
+            "%llx", (unsigned long long int)(uint64_t)change->element);
+
+    purc_variant_t v;
+    v = purc_variant_make_string_static(rdr_ops[change->op], false);
+    if (!v || !purc_variant_object_set_by_static_ckey(obj, "operation", v))
+        goto failed;
+    purc_variant_unref(v);
+
+    v = purc_variant_make_string(elem, false);
+    if (!v || !purc_variant_object_set_by_static_ckey(obj, "element", v))
+        goto failed;
+    purc_variant_unref(v);
+
+    if (change->property) {
+        v = purc_variant_make_string(change->property, false);
+        if (!v || !purc_variant_object_set_by_static_ckey(obj, "property", v))
+            goto failed;
+        purc_variant_unref(v);
+    }
+
+    if (change->data || change->text) {
+        v = purc_variant_make_string_static(
+                pcintr_rdr_data_types[change->data_type].type_name, false);
+        if (!v || !purc_variant_object_set_by_static_ckey(obj, "dataType", v))
+            goto failed;
+        purc_variant_unref(v);
+
+        if (change->data) {
+            v = purc_variant_ref(change->data);
+        }
+        else {
+            /* the variant takes over the buffer */
+            v = purc_variant_make_string_reuse_buff(change->text,
+                    change->sz, false);
+            if (v) {
+                change->text = NULL;
+            }
+        }
+        if (!v || !purc_variant_object_set_by_static_ckey(obj, "data", v))
+            goto failed;
+        purc_variant_unref(v);
+    }
+
+    return obj;
+
+failed:
+    if (v)
+        purc_variant_unref(v);
+    purc_variant_unref(obj);
+    return PURC_VARIANT_INVALID;
 }
 
+void
+pcintr_rdr_flush_dom_changes(pcintr_coroutine_t co)
+{
+    struct pcrdr_conn *conn = pcinst_current()->conn_to_rdr;
+    purc_variant_t changes = PURC_VARIANT_INVALID;
+    pcrdr_msg *msg = NULL;
+
+    if (co == NULL || co->nr_dom_changes == 0) {
+        return;
+    }
+
+    if (conn == NULL || co->target_dom_handle == 0) {
+        goto done;
+    }
+
+    changes = purc_variant_make_array_0();
+    if (changes == PURC_VARIANT_INVALID) {
+        goto done;
+    }
+
+    struct pcintr_dom_change *p;
+    list_for_each_entry(p, &co->dom_changes, ln) {
+        purc_variant_t change = dom_change_to_variant(p);
+        if (change == PURC_VARIANT_INVALID) {
+            goto done;
+        }
+
+        bool ok = purc_variant_array_append(changes, change);
+        purc_variant_unref(change);
+        if (!ok) {
+            goto done;
+        }
+    }
+
+    msg = pcrdr_make_request_message(
+            PCRDR_MSG_TARGET_DOM,               /* target */
+            co->target_dom_handle,              /* target_value */
+            PCRDR_OPERATION_APPLYCHANGES,       /* operation */
+            NULL,                               /* request_id */
+            NULL,                               /* source_uri */
+            PCRDR_MSG_ELEMENT_TYPE_VOID,        /* element_type */
+            NULL,                               /* element */
+            NULL,                               /* property */
+            PCRDR_MSG_DATA_TYPE_VOID,           /* data_type */
+            NULL,                               /* data */
+            0                                   /* data_len */
+            );
+    if (msg == NULL) {
+        goto done;
+    }
+
+    /* the message takes over the changes */
+    msg->dataType = PCRDR_MSG_DATA_TYPE_JSON;
+    msg->data = changes;
+    changes = PURC_VARIANT_INVALID;
+
+    if (pcrdr_send_request(conn, msg, PCRDR_TIME_DEF_EXPECTED,
+                (void *)(uintptr_t)co->cid, dom_changes_response_handler)) {
+        purc_log_error("Failed to send %u DOM changes to renderer\n",
+                (unsigned)co->nr_dom_changes);
+    }
+    pcrdr_release_message(msg);
+
+done:
+    if (changes) {
+        purc_variant_unref(changes);
+    }
+    pcintr_rdr_discard_dom_changes(co);
+}
+
+void
+pcintr_rdr_discard_dom_changes(pcintr_coroutine_t co)
+{
+    struct pcintr_dom_change *p, *n;
+    list_for_each_entry_safe(p, n, &co->dom_changes, ln) {
+        dom_change_free(co, p);
+    }
+}
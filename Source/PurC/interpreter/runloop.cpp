@@ -170,6 +170,20 @@ uintptr_t purc_runloop_add_fd_monitor(purc_runloop_t runloop, int fd,
         });
 }
 
+uintptr_t pcintr_runloop_add_fd_monitor(purc_runloop_t runloop, int fd,
+        purc_runloop_io_event event, purc_runloop_io_callback callback,
+        void *ctxt)
+{
+    RunLoop *runLoop = (RunLoop*)runloop;
+
+    return runLoop->addFdMonitor(fd, to_gio_condition(event),
+            [callback, ctxt] (gint fd, GIOCondition condition) -> gboolean {
+            purc_runloop_io_event io_event;
+            io_event = to_runloop_io_event(condition);
+            return callback(fd, io_event, ctxt);
+        });
+}
+
 void purc_runloop_remove_fd_monitor(purc_runloop_t runloop, uintptr_t handle)
 {
     if (!runloop) {
@@ -41,9 +41,12 @@
 
 #include <sys/time.h>
 
-#define SCHEDULE_SLEEP          10 * 1000       // usec
 #define IDLE_EVENT_TIMEOUT      100             // ms
 #define TIME_SLIECE             0.005           // s
+#define SCHEDULE_BUDGET         0.010           // s
+#define REQUEST_POLL_INTERVAL   100             // ms
+#define TIMEOUT_HEAP_MIN_SIZE   16
+#define MAX_DRAINED_MESSAGES    64
 
 #define BUILTIN_VAR_CRTN        PURC_PREDEF_VARNAME_CRTN
 
@@ -98,6 +101,17 @@ broadcast_idle_event(struct pcinst *inst)
     }
 }
 
+static void
+stop_monitoring_renderer(struct pcinst *inst)
+{
+    struct pcintr_heap *heap = inst->intr_heap;
+    if (heap->rdr_monitor) {
+        purc_runloop_remove_fd_monitor(inst->running_loop, heap->rdr_monitor);
+        heap->rdr_monitor = 0;
+    }
+    heap->rdr_monitor_fd = -1;
+}
+
 static void
 handle_rdr_conn_lost(struct pcinst *inst)
 {
@@ -139,6 +153,8 @@ handle_rdr_conn_lost(struct pcinst *inst)
                 PURC_VARIANT_INVALID, PURC_VARIANT_INVALID);
     }
 
+    stop_monitoring_renderer(inst);
+
     // FIXME:
     // pcrdr_disconnect(inst->conn_to_rdr);
     pcrdr_free_connection(inst->conn_to_rdr);
@@ -493,74 +509,131 @@ execute_one_step_for_ready_co(struct pcinst *inst, pcintr_coroutine_t co)
     pcintr_set_current_co(NULL);
 }
 
-// execute one step for all ready coroutines of the inst
-// return whether busy
-static bool
-execute_one_step(struct pcinst *inst)
+// execute the ready coroutine for a time slice
+static void
+execute_ready_co(struct pcinst *inst, pcintr_coroutine_t co)
 {
-    bool busy = false;
-    struct pcintr_heap *heap = inst->intr_heap;
-
-    pcintr_coroutine_t p, q;
-    pcintr_coroutine_t co;
-    struct list_head *crtns;
+    struct timespec begin;
+    clock_gettime(CLOCK_MONOTONIC, &begin);
+    struct pcintr_stack_frame *frame;
+    while (co->state == CO_STATE_READY) {
+        frame = pcintr_stack_get_bottom_frame(&co->stack);
+        bool must_yield = frame ? frame->must_yield : false;
+        execute_one_step_for_ready_co(inst, co);
+        if (must_yield) {
+            break;
+        }
+        double diff = purc_get_elapsed_seconds(&begin, NULL);
+        if (diff > TIME_SLIECE) {
+            break;
+        }
+    }
+}
 
-    time_t now = pcintr_monotonic_time_ms();
+static void
+timeout_heap_swap(struct pcintr_heap *heap, size_t i, size_t j)
+{
+    pcintr_coroutine_t *slots = heap->timeout_crtns;
+    pcintr_coroutine_t tmp = slots[i];
+    slots[i] = slots[j];
+    slots[j] = tmp;
+    slots[i]->timeout_idx = i;
+    slots[j]->timeout_idx = j;
+}
 
-    pcutils_array_t *cos = pcutils_array_create();
-    if (!cos) {
-        purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
-        return false;
+static void
+timeout_heap_sift_up(struct pcintr_heap *heap, size_t i)
+{
+    pcintr_coroutine_t *slots = heap->timeout_crtns;
+    while (i > 0) {
+        size_t parent = (i - 1) / 2;
+        if (slots[parent]->stopped_timeout <= slots[i]->stopped_timeout) {
+            break;
+        }
+        timeout_heap_swap(heap, i, parent);
+        i = parent;
     }
+}
 
-    size_t nr = pcutils_sorted_array_count(heap->wait_timeout_crtns);
-    for (size_t i = 0; i < nr; i++) {
-        pcutils_sorted_array_get(heap->wait_timeout_crtns, i, (void **)&co);
-        if (now < co->stopped_timeout) {
+static void
+timeout_heap_sift_down(struct pcintr_heap *heap, size_t i)
+{
+    pcintr_coroutine_t *slots = heap->timeout_crtns;
+    size_t nr = heap->nr_timeout_crtns;
+    while (true) {
+        size_t left = 2 * i + 1;
+        size_t right = left + 1;
+        size_t min = i;
+        if (left < nr &&
+                slots[left]->stopped_timeout < slots[min]->stopped_timeout) {
+            min = left;
+        }
+        if (right < nr &&
+                slots[right]->stopped_timeout < slots[min]->stopped_timeout) {
+            min = right;
+        }
+        if (min == i) {
             break;
         }
-        co->stack.timeout = true;
-        pcutils_array_push(cos, co);
+        timeout_heap_swap(heap, i, min);
+        i = min;
     }
+}
 
-    nr = pcutils_array_length(cos);
-    for (size_t i = 0; i < nr; i++) {
-        co = pcutils_array_get(cos, i);
-        pcintr_resume_coroutine(co);
+static int
+timeout_heap_push(struct pcintr_heap *heap, pcintr_coroutine_t co)
+{
+    if (heap->nr_timeout_crtns == heap->sz_timeout_crtns) {
+        size_t sz = heap->sz_timeout_crtns ?
+            heap->sz_timeout_crtns * 2 : TIMEOUT_HEAP_MIN_SIZE;
+        pcintr_coroutine_t *slots = (pcintr_coroutine_t *)realloc(
+                heap->timeout_crtns, sz * sizeof(*slots));
+        if (!slots) {
+            purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
+            return -1;
+        }
+        heap->timeout_crtns = slots;
+        heap->sz_timeout_crtns = sz;
     }
-    pcutils_array_destroy(cos, true);
 
+    co->timeout_idx = heap->nr_timeout_crtns++;
+    heap->timeout_crtns[co->timeout_idx] = co;
+    timeout_heap_sift_up(heap, co->timeout_idx);
+    return 0;
+}
 
-    crtns = &heap->crtns;
-    list_for_each_entry_safe(p, q, crtns, ln) {
-        pcintr_coroutine_t co = p;
-        if (co->state != CO_STATE_READY) {
-            continue;
-        }
+static void
+timeout_heap_remove(struct pcintr_heap *heap, pcintr_coroutine_t co)
+{
+    size_t idx = co->timeout_idx;
+    size_t last = --heap->nr_timeout_crtns;
+    PC_ASSERT(heap->timeout_crtns[idx] == co);
+
+    if (idx != last) {
+        heap->timeout_crtns[idx] = heap->timeout_crtns[last];
+        heap->timeout_crtns[idx]->timeout_idx = idx;
+        timeout_heap_sift_down(heap, idx);
+        timeout_heap_sift_up(heap, idx);
+    }
+}
 
-#if 1
-        struct timespec begin;
-        clock_gettime(CLOCK_MONOTONIC, &begin);
-        struct pcintr_stack_frame *frame;
-        while (co->state == CO_STATE_READY) {
-            frame = pcintr_stack_get_bottom_frame(&co->stack);
-            bool must_yield = frame ? frame->must_yield : false;
-            execute_one_step_for_ready_co(inst, co);
-            if (must_yield) {
-                break;
-            }
-            double diff = purc_get_elapsed_seconds(&begin, NULL);
-            if (diff > TIME_SLIECE) {
-                break;
-            }
-        }
-#else
-            execute_one_step_for_ready_co(inst, co);
-#endif
-        busy = true;
+// resume the stopped coroutines whose timeout expired
+static void
+resume_timeout_coroutines(struct pcintr_heap *heap)
+{
+    if (heap->nr_timeout_crtns == 0) {
+        return;
     }
 
-    return busy;
+    time_t now = pcintr_monotonic_time_ms();
+    while (heap->nr_timeout_crtns > 0) {
+        pcintr_coroutine_t co = heap->timeout_crtns[0];
+        if (now < co->stopped_timeout) {
+            break;
+        }
+        co->stack.timeout = true;
+        pcintr_resume_coroutine(co);
+    }
 }
 
 
@@ -588,15 +661,41 @@ check_and_dispatch_event_from_conn(struct pcinst *inst)
     }
 }
 
+static struct pcintr_observer *
+next_indexed_observer(struct pcintr_observer *observer, struct list_head *list)
+{
+    struct list_head *next = observer ? observer->index_node.next : list->next;
+    if (next == list)
+        return NULL;
+    return list_entry(next, struct pcintr_observer, index_node);
+}
+
+// visit the observers which may match the message type in the
+// registration order, by merging the indexed list with the others
 static int
-handle_event_by_observer_list(purc_coroutine_t co, struct list_head *list,
+handle_event_by_observer_index(purc_coroutine_t co,
+        struct pcintr_observer_index *index,
         pcrdr_msg *msg, purc_atom_t event_type,
         const char *event_sub_type, bool *event_observed, bool *busy)
 {
     int ret = PURC_ERROR_INCOMPLETED;
     purc_variant_t observed = msg->elementValue;
-    struct pcintr_observer *observer, *next;
-    list_for_each_entry_safe(observer, next, list, node) {
+    struct list_head *typed = pcintr_observer_index_bucket(index, event_type);
+    struct list_head *others = &index->others;
+    struct pcintr_observer *t = next_indexed_observer(NULL, typed);
+    struct pcintr_observer *o = next_indexed_observer(NULL, others);
+
+    while (t || o) {
+        struct pcintr_observer *observer;
+        if (o == NULL || (t && t->seq < o->seq)) {
+            observer = t;
+            t = next_indexed_observer(t, typed);
+        }
+        else {
+            observer = o;
+            o = next_indexed_observer(o, others);
+        }
+
         bool match = observer->is_match(observer, msg, observed, event_type,
                 event_sub_type);
         if ((co->stage & observer->cor_stage) &&
@@ -621,7 +720,6 @@ handle_coroutine_event(pcintr_coroutine_t co)
     int handle_ret = PURC_ERROR_INCOMPLETED;
     bool busy = false;
     bool msg_observed = false;
-    char *type = NULL;
     purc_atom_t event_type = 0;
     const char *event_sub_type = NULL;
 
@@ -633,23 +731,30 @@ handle_coroutine_event(pcintr_coroutine_t co)
 
     if (msg && msg->eventName) {
         const char *event = purc_variant_get_string_const(msg->eventName);
-        const char *separator = strchr(event, MSG_EVENT_SEPARATOR);
+        const char *separator = event ?
+            strchr(event, MSG_EVENT_SEPARATOR) : NULL;
+        size_t nr_type = 0;
         if (separator) {
             event_sub_type = separator + 1;
+            nr_type = separator - event;
+        }
+        else if (event) {
+            nr_type = strlen(event);
         }
 
-        size_t nr_type = separator - event;
         if (nr_type) {
-            type = strndup(event, separator - event);
-            if (!type) {
-                purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
-                goto out;
+            /* the known types are identifiers; no need to allocate */
+            char type[PURC_LEN_IDENTIFIER + 1];
+            if (nr_type < sizeof(type)) {
+                memcpy(type, event, nr_type);
+                type[nr_type] = '\0';
+                event_type = purc_atom_try_string_ex(ATOM_BUCKET_MSG, type);
             }
 
-            event_type = purc_atom_try_string_ex(ATOM_BUCKET_MSG, type);
             if (!event_type) {
                 purc_set_error(PURC_ERROR_INVALID_VALUE);
                 PC_WARN("unknown event '%s'\n", event);
+                pcrdr_release_message(msg);
                 goto out;
             }
         }
@@ -657,18 +762,18 @@ handle_coroutine_event(pcintr_coroutine_t co)
 
     // observer
     if (msg) {
-        handle_ret = handle_event_by_observer_list(co,
-                &co->stack.intr_observers, msg, event_type, event_sub_type,
-                &msg_observed, &busy);
+        handle_ret = handle_event_by_observer_index(co,
+                &co->stack.intr_observer_index, msg, event_type,
+                event_sub_type, &msg_observed, &busy);
 
         if (handle_ret == PURC_ERROR_OK) {
             pcrdr_release_message(msg);
             msg = NULL;
         }
         else {
-            handle_ret = handle_event_by_observer_list(co,
-                    &co->stack.hvml_observers, msg, event_type, event_sub_type,
-                    &msg_observed, &busy);
+            handle_ret = handle_event_by_observer_index(co,
+                    &co->stack.hvml_observer_index, msg, event_type,
+                    event_sub_type, &msg_observed, &busy);
 
             if (handle_ret == PURC_ERROR_OK) {
                 pcrdr_release_message(msg);
@@ -699,108 +804,328 @@ handle_coroutine_event(pcintr_coroutine_t co)
     }
 
 out:
-    if (type) {
-        free(type);
+    return busy;
+}
+
+// run the coroutine taken from the ready queue and return whether busy;
+// the coroutine is queued again only if it may still have work to do
+static bool
+run_coroutine(struct pcinst *inst, pcintr_coroutine_t co)
+{
+    bool busy = false;
+
+    if (co->state == CO_STATE_READY) {
+        execute_ready_co(inst, co);
+        busy = true;
+    }
+
+    size_t nr_msgs = pcinst_msg_queue_count(co->mq);
+    if (handle_coroutine_event(co)) {
+        busy = true;
     }
+
+    // send the DOM changes made in this step to the renderer in a batch
+    pcintr_rdr_flush_dom_changes(co);
+
+    if (co->stack.exited && co->stack.last_msg_read) {
+        // the coroutine will be destroyed
+        pcintr_run_exiting_co(co);
+        return true;
+    }
+
+    /* A message observed but not handled is appended again, so only
+       requeue the coroutine if something really changed. */
+    size_t nr_left = pcinst_msg_queue_count(co->mq);
+    bool progress = busy || nr_left < nr_msgs;
+    if (co->state == CO_STATE_READY ||
+            (progress && (nr_left > 0 || !list_empty(&co->tasks)))) {
+        if (list_empty(&co->ln_ready)) {
+            list_add_tail(&co->ln_ready, &co->owner->ready_crtns);
+        }
+    }
+
     return busy;
 }
 
 static bool
-dispatch_event(struct pcinst *inst)
+run_ready_coroutines(struct pcinst *inst)
 {
-    UNUSED_PARAM(inst);
+    bool busy = false;
+    struct pcintr_heap *heap = inst->intr_heap;
 
-    struct timespec begin;
-    bool is_busy = false;
+    // the coroutines queued while running will be handled in next round
+    struct list_head batch;
+    list_head_init(&batch);
+    list_splice_init(&heap->ready_crtns, &batch);
+
+    while (!list_empty(&batch)) {
+        pcintr_coroutine_t co = list_first_entry(&batch,
+                struct pcintr_coroutine, ln_ready);
+        list_del_init(&co->ln_ready);
+        if (run_coroutine(inst, co)) {
+            busy = true;
+        }
+    }
 
-#if 1
-again:
-    is_busy = false;
-    clock_gettime(CLOCK_MONOTONIC, &begin);
-#endif
+    return busy;
+}
+
+static void
+dispatch_event_from_conn(struct pcinst *inst)
+{
     check_and_dispatch_event_from_conn(inst);
 
-    bool co_is_busy = false;
+    // drain the messages moved from other instances
+    size_t n;
+    for (int i = 0; i < MAX_DRAINED_MESSAGES && inst->conn_to_rdr; i++) {
+        if (purc_inst_holding_messages_count(&n) || n == 0) {
+            break;
+        }
+        check_and_dispatch_event_from_conn(inst);
+    }
+}
+
+static bool
+renderer_io_callback(int fd, purc_runloop_io_event event, void *ctxt)
+{
+    UNUSED_PARAM(fd);
+    UNUSED_PARAM(event);
+    pcintr_wakeup_scheduler((struct pcinst *)ctxt);
+    return true;
+}
+
+// wake up the scheduler when the socket to the renderer becomes readable
+static void
+monitor_renderer(struct pcinst *inst)
+{
     struct pcintr_heap *heap = inst->intr_heap;
-    struct list_head *crtns = &heap->crtns;
-    pcintr_coroutine_t p, q;
-    list_for_each_entry_safe(p, q, crtns, ln) {
-        pcintr_coroutine_t co = p;
-        co_is_busy = handle_coroutine_event(co);
+    struct pcrdr_conn *conn = inst->conn_to_rdr;
+    int fd = -1;
+
+    if (conn && pcrdr_conn_comm_method(conn) == PURC_RDRCOMM_SOCKET) {
+        fd = pcrdr_conn_fd(conn);
+    }
 
-        if (co->stack.exited && co->stack.last_msg_read) {
-            pcintr_run_exiting_co(co);
+    if (fd == heap->rdr_monitor_fd) {
+        return;
+    }
+
+    stop_monitoring_renderer(inst);
+    if (fd >= 0) {
+        heap->rdr_monitor = pcintr_runloop_add_fd_monitor(inst->running_loop,
+                fd, PCRUNLOOP_IO_IN | PCRUNLOOP_IO_HUP | PCRUNLOOP_IO_ERR,
+                renderer_io_callback, inst);
+        if (heap->rdr_monitor) {
+            heap->rdr_monitor_fd = fd;
         }
+    }
+}
 
-        if (co_is_busy) {
-            is_busy = true;
+static bool
+is_idle_observed(struct pcintr_heap *heap)
+{
+    pcintr_coroutine_t p;
+    list_for_each_entry(p, &heap->crtns, ln) {
+        if (p->stack.observe_idle) {
+            return true;
         }
     }
+    list_for_each_entry(p, &heap->stopped_crtns, ln) {
+        if (p->stack.observe_idle) {
+            return true;
+        }
+    }
+    return false;
+}
 
-    crtns = &heap->stopped_crtns;
-    list_for_each_entry_safe(p, q, crtns, ln) {
-        pcintr_coroutine_t co = p;
-        co_is_busy = handle_coroutine_event(co);
+// arm the scheduler timer for the nearest deadline, if any
+static void
+arm_sched_timer(struct pcinst *inst)
+{
+    struct pcintr_heap *heap = inst->intr_heap;
+    bool armed = false;
+    double delay = 0;
+
+    if (heap->nr_timeout_crtns > 0) {
+        delay = heap->timeout_crtns[0]->stopped_timeout -
+            pcintr_monotonic_time_ms();
+        armed = true;
+    }
 
-        if (co->stack.exited && co->stack.last_msg_read) {
-            pcintr_run_exiting_co(co);
+    if (is_idle_observed(heap)) {
+        double d = heap->timestamp + IDLE_EVENT_TIMEOUT -
+            pcintr_get_current_time();
+        if (!armed || d < delay) {
+            delay = d;
         }
+        armed = true;
+    }
 
-        if (co_is_busy) {
-            is_busy = true;
+    // the timeout of the pending requests is checked by polling
+    struct pcrdr_conn *conn = inst->conn_to_rdr;
+    if (conn && pcrdr_conn_pending_requests_count(conn) > 0) {
+        if (!armed || REQUEST_POLL_INTERVAL < delay) {
+            delay = REQUEST_POLL_INTERVAL;
         }
+        armed = true;
     }
 
-#if 1
-    double diff = purc_get_elapsed_seconds(&begin, NULL);
-    if (diff < TIME_SLIECE && is_busy) {
-        goto again;
+    if (!armed) {
+        pcintr_timer_stop(heap->sched_timer);
+        return;
+    }
+
+    pcintr_timer_set_interval(heap->sched_timer,
+            delay < 1 ? 1 : (uint32_t)delay + 1);
+    pcintr_timer_start_oneshot(heap->sched_timer);
+}
+
+static void
+sched_timer_fire(pcintr_timer_t timer, const char *id, void *data)
+{
+    UNUSED_PARAM(timer);
+    UNUSED_PARAM(id);
+    pcintr_wakeup_scheduler((struct pcinst *)data);
+}
+
+int
+pcintr_scheduler_init(struct pcinst *inst)
+{
+    struct pcintr_heap *heap = inst->intr_heap;
+
+    list_head_init(&heap->ready_crtns);
+    heap->rdr_monitor = 0;
+    heap->rdr_monitor_fd = -1;
+    heap->sched_timer = pcintr_timer_create(inst->running_loop, NULL,
+            sched_timer_fire, inst);
+    if (!heap->sched_timer) {
+        return PURC_ERROR_OUT_OF_MEMORY;
+    }
+
+    return 0;
+}
+
+void
+pcintr_scheduler_cleanup(struct pcinst *inst)
+{
+    struct pcintr_heap *heap = inst->intr_heap;
+
+    stop_monitoring_renderer(inst);
+
+    if (heap->sched_timer) {
+        pcintr_timer_destroy(heap->sched_timer);
+        heap->sched_timer = NULL;
+    }
+
+    free(heap->timeout_crtns);
+    heap->timeout_crtns = NULL;
+    heap->nr_timeout_crtns = 0;
+    heap->sz_timeout_crtns = 0;
+}
+
+void
+pcintr_wakeup_scheduler(struct pcinst *inst)
+{
+    struct pcintr_heap *heap = inst ? inst->intr_heap : NULL;
+    if (!heap || heap->sched_pending) {
+        return;
+    }
+
+    heap->sched_pending = 1;
+    if (!heap->sched_running) {
+        purc_runloop_dispatch(inst->running_loop, pcintr_schedule, inst);
+    }
+}
+
+void
+pcintr_wakeup_coroutine(pcintr_coroutine_t co)
+{
+    struct pcintr_heap *heap = co->owner;
+    if (!heap) {
+        return;
+    }
+
+    if (list_empty(&co->ln_ready)) {
+        list_add_tail(&co->ln_ready, &heap->ready_crtns);
+    }
+    pcintr_wakeup_scheduler(heap->owner);
+}
+
+void
+pcintr_unschedule_coroutine(pcintr_coroutine_t co)
+{
+    if (!list_empty(&co->ln_ready)) {
+        list_del_init(&co->ln_ready);
+    }
+
+    if (co->stopped_timeout != -1) {
+        timeout_heap_remove(co->owner, co);
+        co->stopped_timeout = -1;
     }
-#endif
-    return is_busy;
 }
 
 void
 pcintr_schedule(void *ctxt)
 {
-    bool step_is_busy;
-    bool event_is_busy;
     struct pcinst *inst = (struct pcinst *)ctxt;
-    if (!inst) {
-        goto out_sleep;
+    if (!inst || inst != pcinst_current()) {
+        return;
     }
 
     struct pcintr_heap *heap = inst->intr_heap;
-    if (!heap) {
-        goto out_sleep;
+    if (!heap || heap->sched_running) {
+        return;
     }
 
-again:
+    heap->sched_running = 1;
+    heap->sched_pending = 0;
+
+    bool busy = false;
+    struct timespec begin;
+    clock_gettime(CLOCK_MONOTONIC, &begin);
+
+    do {
+        // 1. dispatch the messages from renderer and other instances
+        dispatch_event_from_conn(inst);
 
-    // 1. exec one step for all ready coroutines and
-    // return whether step is busy
-    step_is_busy = execute_one_step(inst);
+        // 2. resume the coroutines whose timeout expired
+        resume_timeout_coroutines(heap);
 
-    // 2. dispatch event for observing / stopped coroutines
-    event_is_busy = dispatch_event(inst);
+        if (list_empty(&heap->ready_crtns)) {
+            break;
+        }
+
+        // 3. run the ready coroutines and dispatch events to them
+        if (run_ready_coroutines(inst)) {
+            busy = true;
+        }
+    } while (purc_get_elapsed_seconds(&begin, NULL) < SCHEDULE_BUDGET);
 
-    // 3. its busy, goto next scheduler without sleep
-    if (step_is_busy || event_is_busy) {
+    if (busy) {
         pcintr_update_timestamp(inst);
-        goto again;
     }
 
-    // 5. broadcast idle event
-    double now = pcintr_get_current_time();
-    if (now - IDLE_EVENT_TIMEOUT > heap->timestamp) {
-        broadcast_idle_event(inst);
-        pcintr_update_timestamp(inst);
+    // 4. broadcast idle event
+    if (list_empty(&heap->ready_crtns)) {
+        double now = pcintr_get_current_time();
+        if (now - IDLE_EVENT_TIMEOUT > heap->timestamp) {
+            broadcast_idle_event(inst);
+            pcintr_update_timestamp(inst);
+        }
     }
 
-out_sleep:
-    pcutils_usleep(SCHEDULE_SLEEP);
+    heap->sched_running = 0;
 
-    return;
+    monitor_renderer(inst);
+
+    // 5. yield to the runloop if still busy, otherwise wait for a wakeup
+    if (heap->sched_pending || !list_empty(&heap->ready_crtns)) {
+        heap->sched_pending = 0;
+        pcintr_wakeup_scheduler(inst);
+    }
+    else {
+        arm_sched_timer(inst);
+    }
 }
 
 int pcintr_yield(
@@ -1010,6 +1335,10 @@ void pcintr_stop_coroutine(pcintr_coroutine_t crtn,
     pcintr_heap_t heap = crtn->owner;
     list_add_tail(&crtn->ln, &heap->stopped_crtns);
 
+    if (crtn->stopped_timeout != -1) {
+        timeout_heap_remove(heap, crtn);
+    }
+
     if (timeout) {
         time_t curr = pcintr_monotonic_time_ms();
         crtn->stopped_timeout = curr + timespec_to_ms(timeout);
@@ -1018,9 +1347,8 @@ void pcintr_stop_coroutine(pcintr_coroutine_t crtn,
         crtn->stopped_timeout = -1;
     }
     if (crtn->stopped_timeout != -1) {
-        if (pcutils_sorted_array_add(heap->wait_timeout_crtns,
-                    (void *)(uintptr_t)crtn->stopped_timeout, crtn) < 0) {
-            purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
+        if (timeout_heap_push(heap, crtn) < 0) {
+            crtn->stopped_timeout = -1;
         }
     }
 
@@ -1036,15 +1364,7 @@ void pcintr_resume_coroutine(pcintr_coroutine_t crtn)
     list_add_tail(&crtn->ln, &heap->crtns);
 
     if (crtn->stopped_timeout != -1) {
-        size_t nr = pcutils_sorted_array_count(heap->wait_timeout_crtns);
-        for (size_t i = 0; i < nr; i++) {
-            pcintr_coroutine_t co;
-            pcutils_sorted_array_get(heap->wait_timeout_crtns, i, (void **)&co);
-            if (co == crtn) {
-                pcutils_sorted_array_delete(heap->wait_timeout_crtns, i);
-                break;
-            }
-        }
+        timeout_heap_remove(heap, crtn);
     }
 
     crtn->stopped_timeout = -1;
@@ -316,7 +316,8 @@ bool pcvarmgr_add(pcvarmgr_t mgr, const char* name,
     return ret;
 }
 
-purc_variant_t pcvarmgr_get(pcvarmgr_t mgr, const char* name)
+purc_variant_t pcvarmgr_get_ex(pcvarmgr_t mgr, const char* name,
+        bool silently)
 {
     if (mgr == NULL || name == NULL) {
         PC_ASSERT(0); // FIXME: still recoverable???
@@ -324,8 +325,8 @@ purc_variant_t pcvarmgr_get(pcvarmgr_t mgr, const char* name)
     }
 
     purc_variant_t v;
-    v = purc_variant_object_get_by_ckey(mgr->object, name);
-    if (v) {
+    v = pcvariant_object_get_by_ckey_ex(mgr->object, name, silently);
+    if (v || silently) {
         return v;
     }
 
@@ -361,92 +362,72 @@ bool pcvarmgr_dispatch_except(pcvarmgr_t mgr, const char* name,
     return true;
 }
 
+/*
+ * The lookups below run for every `$name` reference, so the misses on the
+ * intermediate levels set no error; only pcintr_find_named_var() reports
+ * the final miss.
+ */
 static purc_variant_t
-_find_named_scope_var_in_vdom(purc_coroutine_t cor,
-        pcvdom_element_t elem, const char* name, pcvarmgr_t* mgr)
+find_scope_var_silently(purc_coroutine_t cor, pcvdom_element_t elem,
+        const char* name)
 {
-    if (!elem || !name) {
-        PC_ASSERT(name); // FIXME: still recoverable???
-        purc_set_error_with_info(PCVARIANT_ERROR_NOT_FOUND, "name:%s", name);
+    pcvarmgr_t mgr = pcintr_get_scoped_variables(cor,
+            pcvdom_ele_cast_to_node(elem));
+    if (!mgr)
         return PURC_VARIANT_INVALID;
-    }
 
+    return pcvarmgr_get_ex(mgr, name, true);
+}
+
+static purc_variant_t
+_find_named_scope_var_in_vdom(purc_coroutine_t cor,
+        pcvdom_element_t elem, const char* name)
+{
     purc_variant_t v;
 
-again:
+    while (elem) {
+        v = find_scope_var_silently(cor, elem, name);
+        if (v)
+            return v;
 
-    v = pcintr_get_scope_variable(cor, elem, name);
-    if (v) {
-        if (mgr) {
-            *mgr = pcintr_get_scope_variables(cor, elem);
-        }
-        return v;
+        elem = pcvdom_element_parent(elem);
     }
 
-    elem = pcvdom_element_parent(elem);
-    if (elem)
-        goto again;
-
-    purc_set_error_with_info(PCVARIANT_ERROR_NOT_FOUND, "name:%s", name);
     return PURC_VARIANT_INVALID;
 }
 
 static purc_variant_t
 _find_named_scope_var(purc_coroutine_t cor,
-        struct pcintr_stack_frame *frame, const char* name, pcvarmgr_t* mgr)
+        struct pcintr_stack_frame *frame, const char* name)
 {
-    if (frame->scope)
-        return _find_named_scope_var_in_vdom(cor, frame->scope, name, mgr);
-
-    pcvdom_element_t elem = frame->pos;
-
-    if (!elem || !name) {
-        PC_ASSERT(name); // FIXME: still recoverable???
-        purc_set_error_with_info(PCVARIANT_ERROR_NOT_FOUND, "name:%s", name);
-        return PURC_VARIANT_INVALID;
-    }
-
     purc_variant_t v;
 
-again:
+    while (frame) {
+        if (frame->scope)
+            return _find_named_scope_var_in_vdom(cor, frame->scope, name);
 
-    v = pcintr_get_scope_variable(cor, elem, name);
-    if (v) {
-        if (mgr) {
-            *mgr = pcintr_get_scope_variables(cor, elem);
-        }
-        return v;
-    }
+        pcvdom_element_t elem = frame->pos;
+        if (!elem)
+            break;
 
-    frame = pcintr_stack_frame_get_parent(frame);
-    if (frame) {
-        if (frame->scope)
-            return _find_named_scope_var_in_vdom(cor, frame->scope, name, mgr);
+        v = find_scope_var_silently(cor, elem, name);
+        if (v)
+            return v;
 
-        elem = frame->pos;
-        if (elem)
-            goto again;
+        frame = pcintr_stack_frame_get_parent(frame);
     }
 
-    purc_set_error_with_info(PCVARIANT_ERROR_NOT_FOUND, "name:%s", name);
     return PURC_VARIANT_INVALID;
 }
 
 static purc_variant_t
 find_cor_level_var(purc_coroutine_t cor, const char* name)
 {
-    PC_ASSERT(name);
-    if (!cor) {
-        purc_set_error_with_info(PCVARIANT_ERROR_NOT_FOUND, "name:%s", name);
+    if (!cor || !cor->vdom) {
         return PURC_VARIANT_INVALID;
     }
 
-    purc_variant_t v = purc_coroutine_get_variable(cor, name);
-    if (v) {
-        return v;
-    }
-    purc_set_error_with_info(PCVARIANT_ERROR_NOT_FOUND, "name:%s", name);
-    return PURC_VARIANT_INVALID;
+    return pcvarmgr_get_ex(cor->variables, name, true);
 }
 
 purc_variant_t
@@ -472,7 +453,12 @@ purc_get_runner_variable(const char* name)
 static inline purc_variant_t
 find_inst_var(const char *name)
 {
-    return purc_get_runner_variable(name);
+    pcvarmgr_t varmgr = pcinst_get_variables();
+    if (varmgr == NULL) {
+        return PURC_VARIANT_INVALID;
+    }
+
+    return pcvarmgr_get_ex(varmgr, name, true);
 }
 
 static purc_variant_t
@@ -480,33 +466,20 @@ _find_named_temp_var(struct pcintr_stack_frame *frame, const char *name)
 {
     struct pcintr_stack_frame *p = frame;
 
-again:
-
-    if (p == NULL) {
-        purc_set_error(PURC_ERROR_ENTITY_NOT_FOUND);
-        return PURC_VARIANT_INVALID;
-    }
-
-    do {
+    while (p) {
         purc_variant_t tmp;
         tmp = pcintr_get_exclamation_var(p);
-        if (tmp == PURC_VARIANT_INVALID)
-            break;
-
-        if (purc_variant_is_object(tmp) == false)
-            break;
-
-        purc_variant_t v;
-        v = purc_variant_object_get_by_ckey(tmp, name);
-        if (v == PURC_VARIANT_INVALID)
-            break;
-
-        return v;
-    } while (0);
+        if (tmp != PURC_VARIANT_INVALID && purc_variant_is_object(tmp)) {
+            purc_variant_t v;
+            v = pcvariant_object_get_by_ckey_ex(tmp, name, true);
+            if (v != PURC_VARIANT_INVALID)
+                return v;
+        }
 
-    p = pcintr_stack_frame_get_parent(p);
+        p = pcintr_stack_frame_get_parent(p);
+    }
 
-    goto again;
+    return PURC_VARIANT_INVALID;
 }
 
 purc_variant_t
@@ -527,7 +500,7 @@ pcintr_find_named_var(pcintr_stack_t stack, const char* name)
         return v;
     }
 
-    v = _find_named_scope_var(stack->co, frame, name, NULL);
+    v = _find_named_scope_var(stack->co, frame, name);
     if (v) {
         purc_clr_error();
         return v;
@@ -290,11 +290,20 @@ handle_response_message(pcrdr_conn* conn, const pcrdr_msg *msg)
     int retval = -1;
 
     if (!list_empty(&conn->pending_requests)) {
+        /* The responses to the requests sent without waiting (e.g. the
+           batches of DOM changes) may come in any order, so match the
+           response against all pending requests by the request identifier
+           instead of assuming it belongs to the first one. */
         struct pending_request *pr;
-        pr = list_first_entry(&conn->pending_requests,
-                struct pending_request, list);
+        bool found = false;
+        list_for_each_entry(pr, &conn->pending_requests, list) {
+            if (variant_strcmp(msg->requestId, pr->request_id) == 0) {
+                found = true;
+                break;
+            }
+        }
 
-        if (variant_strcmp(msg->requestId, pr->request_id) == 0) {
+        if (found) {
             const char *request_id =
                 purc_variant_get_string_const(msg->requestId);
             if (pr->response_handler && pr->response_handler(conn,
@@ -310,7 +319,7 @@ handle_response_message(pcrdr_conn* conn, const pcrdr_msg *msg)
             free(pr);
         }
         else {
-            purc_log_error("response not matched the first pending request\n");
+            purc_log_error("response not matched any pending request\n");
             purc_set_error(PCRDR_ERROR_UNEXPECTED);
         }
     }
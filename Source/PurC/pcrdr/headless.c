@@ -50,12 +50,12 @@
 
 #define __STRING(x) #x
 
-#define RENDERER_FEATURES                           \
-    "HEADLESS:100\n"                                \
-    "HTML:5.3/XGML:1.0/XML:1.0\n"                   \
-    "workspace:" __STRING(8)                        \
-    "/tabbedWindow:" __STRING(8)                    \
-    "/widgetInTabbedWindow:" __STRING(32)           \
+#define RENDERER_FEATURES                                   \
+    "HEADLESS:" PCRDR_PURCMC_PROTOCOL_VERSION_STRING "\n"   \
+    "HTML:5.3/XGML:1.0/XML:1.0\n"                           \
+    "workspace:" __STRING(8)                                \
+    "/tabbedWindow:" __STRING(8)                            \
+    "/widgetInTabbedWindow:" __STRING(32)                   \
     "/plainWindow:" __STRING(256)
 
 struct tabbed_window_info {
@@ -1082,48 +1082,27 @@ static void on_load(struct pcrdr_prot_data *prot_data,
 static void on_write_begin(struct pcrdr_prot_data *prot_data,
         const pcrdr_msg *msg, unsigned int op_id, struct result_info *result)
 {
-    void **domdocs = NULL;
+    void **domdocs;
 
     UNUSED_PARAM(op_id);
-    if (find_domdoc_ptr(prot_data, msg, result) == NULL) {
+    if ((domdocs = find_domdoc_ptr(prot_data, msg, result)) == NULL) {
         return;
     }
 
     *domdocs = domdocs;
 
     result->retCode = PCRDR_SC_OK;
-    result->resultValue = msg->targetValue;
+    result->resultValue = (uint64_t)(uintptr_t)domdocs;
 }
 
+/* writeMore and writeEnd follow a writeBegin */
 static void on_write_more(struct pcrdr_prot_data *prot_data,
         const pcrdr_msg *msg, unsigned int op_id, struct result_info *result)
 {
-    void **domdocs = NULL;
-
-    UNUSED_PARAM(op_id);
-    if (find_domdoc_ptr(prot_data, msg, result) == NULL) {
-        return;
-    }
-
-    if (*domdocs == NULL) {
-        result->retCode = PCRDR_SC_PRECONDITION_FAILED;
-        result->resultValue = msg->targetValue;
-        return;
-    }
-
-    *domdocs = domdocs;
-
-    result->retCode = PCRDR_SC_OK;
-    result->resultValue = msg->targetValue;
-}
-
-static void on_write_end(struct pcrdr_prot_data *prot_data,
-        const pcrdr_msg *msg, unsigned int op_id, struct result_info *result)
-{
-    void **domdocs = NULL;
+    void **domdocs;
 
     UNUSED_PARAM(op_id);
-    if (find_domdoc_ptr(prot_data, msg, result) == NULL) {
+    if ((domdocs = find_domdoc_ptr(prot_data, msg, result)) == NULL) {
         return;
     }
 
@@ -1133,28 +1112,24 @@ static void on_write_end(struct pcrdr_prot_data *prot_data,
         return;
     }
 
-    *domdocs = domdocs;
-
     result->retCode = PCRDR_SC_OK;
-    result->resultValue = msg->targetValue;
+    result->resultValue = (uint64_t)(uintptr_t)domdocs;
 }
 
-static void on_operate_dom(struct pcrdr_prot_data *prot_data,
-        const pcrdr_msg *msg, unsigned int op_id, struct result_info *result)
+static bool check_dom_target(struct pcrdr_prot_data *prot_data,
+        const pcrdr_msg *msg, struct result_info *result)
 {
-    UNUSED_PARAM(op_id);
-
     if (msg->target != PCRDR_MSG_TARGET_DOM ||
             msg->targetValue == 0) {
         result->retCode = PCRDR_SC_BAD_REQUEST;
         result->resultValue = 0;
-        return;
+        return false;
     }
 
     if (prot_data->session == 0) {
         result->retCode = PCRDR_SC_TOO_EARLY;
         result->resultValue = 0;
-        return;
+        return false;
     }
 
     bool found = false;
@@ -1190,6 +1165,18 @@ found:
     if (!found) {
         result->retCode = PCRDR_SC_NOT_FOUND;
         result->resultValue = msg->targetValue;
+        return false;
+    }
+
+    return true;
+}
+
+static void on_operate_dom(struct pcrdr_prot_data *prot_data,
+        const pcrdr_msg *msg, unsigned int op_id, struct result_info *result)
+{
+    UNUSED_PARAM(op_id);
+
+    if (!check_dom_target(prot_data, msg, result)) {
         return;
     }
 
@@ -1197,6 +1184,64 @@ found:
     result->resultValue = msg->targetValue;
 }
 
+static bool is_valid_change(purc_variant_t change)
+{
+    if (!purc_variant_is_object(change)) {
+        return false;
+    }
+
+    purc_variant_t v = purc_variant_object_get_by_ckey(change, "operation");
+    const char *op = v ? purc_variant_get_string_const(v) : NULL;
+    purc_atom_t op_atom = op ? pcrdr_try_operation_atom(op) : 0;
+    unsigned int op_id;
+    if (op_atom == 0 || pcrdr_operation_from_atom(op_atom, &op_id) == NULL ||
+            op_id < PCRDR_K_OPERATION_APPEND ||
+            op_id > PCRDR_K_OPERATION_CLEAR) {
+        return false;
+    }
+
+    v = purc_variant_object_get_by_ckey(change, "element");
+    if (v == PURC_VARIANT_INVALID ||
+            purc_variant_get_string_const(v) == NULL) {
+        return false;
+    }
+
+    return true;
+}
+
+/* The changes are checked in order; the index of the first bad one is
+   returned as the result value. */
+static void on_apply_changes(struct pcrdr_prot_data *prot_data,
+        const pcrdr_msg *msg, unsigned int op_id, struct result_info *result)
+{
+    UNUSED_PARAM(op_id);
+
+    if (!check_dom_target(prot_data, msg, result)) {
+        return;
+    }
+
+    size_t nr_changes;
+    if (msg->dataType != PCRDR_MSG_DATA_TYPE_JSON ||
+            !purc_variant_array_size(msg->data, &nr_changes)) {
+        result->retCode = PCRDR_SC_BAD_REQUEST;
+        result->resultValue = 0;
+        return;
+    }
+
+    for (size_t i = 0; i < nr_changes; i++) {
+        purc_variant_t change = purc_variant_array_get(msg->data, i);
+        if (!is_valid_change(change)) {
+            purc_clr_error();
+            result->retCode = PCRDR_SC_BAD_REQUEST;
+            result->resultValue = i;
+            return;
+        }
+    }
+
+    result->retCode = PCRDR_SC_OK;
+    result->resultValue = nr_changes;
+}
+
 static void on_call_method(struct pcrdr_prot_data *prot_data,
         const pcrdr_msg *msg, unsigned int op_id, struct result_info *result)
 {
@@ -1306,7 +1351,7 @@ static request_handler handlers[] = {
     on_load,
     on_write_begin,
     on_write_more,
-    on_write_end,
+    on_write_more,
     on_operate_dom,
     on_operate_dom,
     on_operate_dom,
@@ -1318,6 +1363,7 @@ static request_handler handlers[] = {
     on_call_method,
     on_get_property,
     on_set_property,
+    on_apply_changes,
 };
 
 /* make sure the number of operation handlers matches the enumulators */
@@ -86,6 +86,7 @@ static struct pcrdr_opatom {
     { PCRDR_OPERATION_CALLMETHOD,           0 }, // "callMethod"
     { PCRDR_OPERATION_GETPROPERTY,          0 }, // "getProperty"
     { PCRDR_OPERATION_SETPROPERTY,          0 }, // "setProperty"
+    { PCRDR_OPERATION_APPLYCHANGES,         0 }, // "applyChanges"
 };
 
 /* make sure the number of operations matches the enumulators */
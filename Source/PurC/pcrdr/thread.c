@@ -30,6 +30,7 @@
 #include "private/debug.h"
 #include "private/utils.h"
 #include "private/ports.h"
+#include "private/instance.h"
 
 #include "connect.h"
 
@@ -47,29 +48,9 @@ struct pcrdr_prot_data {
 
 static int my_wait_message(pcrdr_conn* conn, int timeout_ms)
 {
-    size_t count = 0;
     UNUSED_PARAM(conn);
 
-    if (purc_inst_holding_messages_count(&count))
-        return -1;
-
-    if (count == 0) {
-        if (timeout_ms > 1000) {
-            pcutils_sleep(timeout_ms / 1000);
-        }
-
-        if (timeout_ms > 0) {
-            unsigned int ms = timeout_ms % 1000;
-            if (ms) {
-                pcutils_usleep(ms * 1000);
-            }
-        }
-
-        if (purc_inst_holding_messages_count(&count))
-            return -1;
-    }
-
-    return (count > 0) ? 1 : 0;
+    return pcinst_move_buffer_wait(timeout_ms);
 }
 
 static pcrdr_msg *my_read_message(pcrdr_conn* conn)
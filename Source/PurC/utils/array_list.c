@@ -25,6 +25,8 @@
 
 #define _GNU_SOURCE
 
+#include "config.h"
+
 #include "private/array_list.h"
 
 #include "private/debug.h"
@@ -32,6 +34,11 @@
 #include <stdlib.h>
 #include <string.h>
 
+#if USE(PTHREADS)
+#include <pthread.h>
+#include <unistd.h>
+#endif
+
 static inline size_t
 align(size_t n)
 {
@@ -261,3 +268,258 @@ pcutils_array_list_sort(struct pcutils_array_list *al,
     }
 }
 
+
+/* one node together with the keys extracted from it */
+struct sort_record {
+    struct pcutils_array_list_node     *node;
+    size_t                              idx;
+    /* the keys follow at offset `keys_off` */
+};
+
+struct keyed_sort_data {
+    int (*cmp)(const void *l, const void *r, void *ud);
+    void *ud;
+    size_t keys_off;
+};
+
+static inline void *
+record_keys(const struct sort_record *rec, size_t keys_off)
+{
+    return (char *)rec + keys_off;
+}
+
+static inline int
+keyed_cmp(const struct sort_record *l, const struct sort_record *r,
+        const struct keyed_sort_data *d)
+{
+    int ret = d->cmp(record_keys(l, d->keys_off),
+            record_keys(r, d->keys_off), d->ud);
+    if (ret == 0) {
+        /* keep the original order of equal nodes */
+        ret = (l->idx > r->idx) - (l->idx < r->idx);
+    }
+    return ret;
+}
+
+#if OS(HURD) || OS(LINUX)
+static int keyed_cmp_f(const void *l, const void *r, void *ud)
+{
+    return keyed_cmp(*(struct sort_record **)l, *(struct sort_record **)r,
+            (struct keyed_sort_data *)ud);
+}
+#else
+static int keyed_cmp_f(void *ud, const void *l, const void *r)
+{
+    return keyed_cmp(*(struct sort_record **)l, *(struct sort_record **)r,
+            (struct keyed_sort_data *)ud);
+}
+#endif
+
+static void
+sort_records(struct sort_record **recs, size_t nr,
+        struct keyed_sort_data *d)
+{
+#if OS(HURD) || OS(LINUX)
+    qsort_r(recs, nr, sizeof(*recs), keyed_cmp_f, d);
+#elif OS(DARWIN) || OS(FREEBSD) || OS(NETBSD) || OS(OPENBSD)
+    qsort_r(recs, nr, sizeof(*recs), d, keyed_cmp_f);
+#elif OS(WINDOWS)
+    qsort_s(recs, nr, sizeof(*recs), keyed_cmp_f, d);
+#endif
+}
+
+#if USE(PTHREADS)          /* { */
+
+/* the minimal number of nodes for each sorting thread */
+#define MIN_NODES_PER_THREAD        16384
+#define MAX_SORT_THREADS            8
+
+struct sort_task {
+    struct sort_record        **src;
+    struct sort_record        **dst;
+    size_t                      lo, mid, hi;
+    struct keyed_sort_data     *d;
+};
+
+static void *
+sort_chunk(void *arg)
+{
+    struct sort_task *task = arg;
+    sort_records(task->src + task->lo, task->hi - task->lo, task->d);
+    return NULL;
+}
+
+static void *
+merge_chunks(void *arg)
+{
+    struct sort_task *task = arg;
+    struct sort_record **src = task->src;
+    struct sort_record **dst = task->dst + task->lo;
+    size_t i = task->lo, j = task->mid;
+
+    while (i < task->mid && j < task->hi) {
+        if (keyed_cmp(src[j], src[i], task->d) < 0)
+            *dst++ = src[j++];
+        else
+            *dst++ = src[i++];
+    }
+
+    if (i < task->mid)
+        memcpy(dst, src + i, sizeof(*src) * (task->mid - i));
+    else if (j < task->hi)
+        memcpy(dst, src + j, sizeof(*src) * (task->hi - j));
+    return NULL;
+}
+
+/* run the tasks on separate threads; the first one on the caller's */
+static void
+run_tasks(struct sort_task *tasks, size_t nr_tasks, void *(*fn)(void *))
+{
+    pthread_t ths[MAX_SORT_THREADS];
+    bool started[MAX_SORT_THREADS];
+
+    for (size_t i = 1; i < nr_tasks; i++) {
+        started[i] = (pthread_create(ths + i, NULL, fn, tasks + i) == 0);
+        if (!started[i])
+            fn(tasks + i);
+    }
+
+    fn(tasks);
+
+    for (size_t i = 1; i < nr_tasks; i++) {
+        if (started[i])
+            pthread_join(ths[i], NULL);
+    }
+}
+
+static size_t
+nr_sort_threads(size_t nr)
+{
+    long nr_cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    size_t nr_threads = 1;
+
+    /* a power of two to merge the chunks pairwise */
+    while (nr_threads * 2 <= MAX_SORT_THREADS &&
+            (long)nr_threads * 2 <= nr_cpus &&
+            nr / (nr_threads * 2) >= MIN_NODES_PER_THREAD) {
+        nr_threads *= 2;
+    }
+
+    return nr_threads;
+}
+
+/* returns the buffer holding the sorted records: `recs` or `scratch` */
+static struct sort_record **
+parallel_sort_records(struct sort_record **recs, struct sort_record **scratch,
+        size_t nr, size_t nr_chunks, struct keyed_sort_data *d)
+{
+    struct sort_task tasks[MAX_SORT_THREADS];
+    size_t bounds[MAX_SORT_THREADS + 1];
+
+    for (size_t i = 0; i <= nr_chunks; i++) {
+        bounds[i] = nr * i / nr_chunks;
+    }
+
+    for (size_t i = 0; i < nr_chunks; i++) {
+        tasks[i].src = recs;
+        tasks[i].lo = bounds[i];
+        tasks[i].hi = bounds[i + 1];
+        tasks[i].d = d;
+    }
+    run_tasks(tasks, nr_chunks, sort_chunk);
+
+    struct sort_record **src = recs, **dst = scratch;
+    while (nr_chunks > 1) {
+        size_t nr_merges = nr_chunks / 2;
+        for (size_t i = 0; i < nr_merges; i++) {
+            tasks[i].src = src;
+            tasks[i].dst = dst;
+            tasks[i].lo = bounds[i * 2];
+            tasks[i].mid = bounds[i * 2 + 1];
+            tasks[i].hi = bounds[i * 2 + 2];
+            tasks[i].d = d;
+        }
+        run_tasks(tasks, nr_merges, merge_chunks);
+
+        for (size_t i = 0; i <= nr_merges; i++) {
+            bounds[i] = bounds[i * 2];
+        }
+        nr_chunks = nr_merges;
+
+        struct sort_record **tmp = src;
+        src = dst;
+        dst = tmp;
+    }
+
+    return src;
+}
+
+#endif                      /* } USE(PTHREADS) */
+
+int
+pcutils_array_list_sort_by_keys(struct pcutils_array_list *al,
+        size_t key_size, void *ud,
+        int (*decorate)(struct pcutils_array_list_node *node,
+                void *keys, void *ud),
+        int (*cmp)(const void *l, const void *r, void *ud),
+        void (*release)(void *keys, void *ud))
+{
+    size_t nr = al->nr;
+    if (nr < 2)
+        return 0;
+
+    struct keyed_sort_data d = {
+        .cmp      = cmp,
+        .ud       = ud,
+        .keys_off = align(sizeof(struct sort_record)),
+    };
+    size_t rec_size = d.keys_off + align(key_size);
+
+    /* the records, followed by two arrays of pointers to them */
+    char *buf = malloc(rec_size * nr + sizeof(struct sort_record *) * nr * 2);
+    if (buf == NULL)
+        return -1;
+
+    struct sort_record **recs;
+    recs = (struct sort_record **)(buf + rec_size * nr);
+
+    int ret = 0;
+    size_t nr_decorated;
+    for (nr_decorated = 0; nr_decorated < nr; nr_decorated++) {
+        struct sort_record *rec;
+        rec = (struct sort_record *)(buf + rec_size * nr_decorated);
+        rec->node = al->nodes[nr_decorated];
+        rec->idx = nr_decorated;
+        if (decorate(rec->node, record_keys(rec, d.keys_off), ud)) {
+            ret = -1;
+            goto done;
+        }
+        recs[nr_decorated] = rec;
+    }
+
+    struct sort_record **sorted = recs;
+#if USE(PTHREADS)
+    size_t nr_threads = nr_sort_threads(nr);
+    if (nr_threads > 1) {
+        sorted = parallel_sort_records(recs, recs + nr, nr, nr_threads, &d);
+    }
+    else
+#endif
+    {
+        sort_records(recs, nr, &d);
+    }
+
+    for (size_t i = 0; i < nr; i++) {
+        al->nodes[i] = sorted[i]->node;
+        al->nodes[i]->idx = i;
+    }
+
+done:
+    if (release) {
+        for (size_t i = 0; i < nr_decorated; i++) {
+            release(buf + rec_size * i + d.keys_off, ud);
+        }
+    }
+    free(buf);
+    return ret;
+}
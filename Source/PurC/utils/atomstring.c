@@ -22,29 +22,96 @@
  * along with this program.  If not, see <https://www.gnu.org/licenses/>.
  */
 
+#include "config.h"
+
 #include <stdbool.h>
 #include <stddef.h>
 #include <stdlib.h>
 #include <string.h>
 #include <assert.h>
+#include <sched.h>
 
 #include "purc-ports.h"
 #include "purc-utils.h"
 #include "purc-errors.h"
 #include "private/instance.h"
-#include "private/map.h"
 #include "private/utils.h"
+#include "private/atom-buckets.h"
+
+/* this feature needs C11 (stdatomic.h) or above */
+#if HAVE(STDATOMIC_H)           /* { */
+#include <stdatomic.h>
+#else                           /* }{ */
+#error "Not implemented for this platform."
+#endif                          /* } */
 
 #if PURC_ATOM_BUCKET_BITS > 16
 #error "Too many bits reserved for bucket"
 #endif
 
+/*
+ * Every bucket maps the strings to the atoms with an open-addressing hash
+ * table, which can be read without any lock: a slot is published by
+ * storing its atom (with release semantics) after the hash and the string,
+ * and is never emptied once published. A removed string keeps its slot
+ * with the atom ATOM_REMOVED, and is revived with its old atom if it is
+ * added again.
+ *
+ * The writers of a bucket are serialized by the mutex of the bucket.
+ * When the table is full, it is rebuilt without the removed slots, and
+ * their sequence identifiers are reused by the new atoms; so the string of
+ * a removed atom must not be used any more, and the removed atom may be
+ * given to another string later.
+ *
+ * The old table or quarks array is retired rather than freed, because
+ * a reader may still be using it; the retired ones are freed by the writer
+ * after a grace period, i.e., once the readers entered before are gone
+ * (see atom_reclaim()).
+ */
+#define ATOM_REMOVED            ((purc_atom_t)-1)
+
+struct atom_slot {
+    _Atomic(purc_atom_t)    atom;
+    bool                    need_free;
+    uint64_t                hash;
+    const char             *string;
+    /* the atom of a removed slot; only used by the writers */
+    purc_atom_t             removed_atom;
+};
+
+struct atom_table {
+    struct atom_table      *retired;
+    size_t                  mask;
+    /* the number of the slots published, including the removed ones */
+    size_t                  nr_used;
+    size_t                  nr_removed;
+    struct atom_slot        slots[];
+};
+
+struct atom_quarks {
+    struct atom_quarks     *retired;
+    size_t                  size;
+    _Atomic(char *)         strings[];
+};
+
 static struct atom_bucket {
-    purc_atom_t     bucket_bits;
-    purc_atom_t     atom_seq_id;
+    purc_atom_t                     bucket_bits;
+    _Atomic(purc_atom_t)            atom_seq_id;
+
+    _Atomic(struct atom_table *)    table;
+    _Atomic(struct atom_quarks *)   quarks;
 
-    pcutils_map    *atom_map;
-    char**          quarks;
+    _Atomic(unsigned)               epoch;
+    _Atomic(size_t)                 nr_readers[2];
+
+    purc_mutex                      lock;
+    char                           *atom_block;
+    size_t                          atom_block_offset;
+
+    /* the sequence identifiers of the reclaimed slots */
+    purc_atom_t                    *free_seqs;
+    size_t                          nr_free_seqs;
+    size_t                          sz_free_seqs;
 } atom_buckets[PURC_ATOM_BUCKETS_NR];
 
 #define ATOM_BITS_NR        (sizeof(purc_atom_t) << 3)
@@ -63,25 +130,65 @@ static struct atom_bucket {
 
 #define ATOM_BLOCK_SIZE         (1024 >> PURC_ATOM_BUCKET_BITS)
 #define ATOM_STRING_BLOCK_SIZE  (4096 - sizeof (size_t))
+#define ATOM_TABLE_MIN_SIZE     (ATOM_BLOCK_SIZE * 2)
 
-static inline purc_atom_t
-atom_new(struct atom_bucket *bucket, char *string, bool need_free);
+static inline uint64_t
+atom_hash(const char *string)
+{
+    return pcutils_hash64(string, strlen(string), 0);
+}
+
+static struct atom_table *
+atom_table_new(size_t size)
+{
+    struct atom_table *table;
+    table = calloc(1, sizeof(*table) + sizeof(struct atom_slot) * size);
+    if (table)
+        table->mask = size - 1;
+    return table;
+}
+
+static struct atom_quarks *
+atom_quarks_new(size_t size)
+{
+    struct atom_quarks *quarks;
+    quarks = calloc(1, sizeof(*quarks) + sizeof(_Atomic(char *)) * size);
+    if (quarks)
+        quarks->size = size;
+    return quarks;
+}
+
+/* frees the table and the strings owned by it */
+static void
+atom_table_delete(struct atom_table *table)
+{
+    for (size_t i = 0; i <= table->mask; i++) {
+        struct atom_slot *slot = table->slots + i;
+        if (slot->need_free)
+            free((char *)slot->string);
+    }
 
-static purc_rwlock atom_rwlock;
-static char *atom_block = NULL;
-static int  atom_block_offset = 0;
+    free(table);
+}
 
-static void atom_init_bucket(struct atom_bucket *bucket)
+static bool atom_init_bucket(struct atom_bucket *bucket, int id)
 {
-    assert (bucket->atom_seq_id == 0);
+    assert (atomic_load(&bucket->atom_seq_id) == 0);
 
-    bucket->atom_map = pcutils_map_create(NULL, NULL, NULL, NULL,
-            comp_key_string, false);
-    bucket->quarks = (char **)malloc(sizeof(char *) * ATOM_BLOCK_SIZE);
-    bucket->quarks[0] = NULL;
-    bucket->atom_seq_id = 1;
+    struct atom_table *table = atom_table_new(ATOM_TABLE_MIN_SIZE);
+    struct atom_quarks *quarks = atom_quarks_new(ATOM_BLOCK_SIZE);
+    if (table == NULL || quarks == NULL) {
+        free(table);
+        free(quarks);
+        return false;
+    }
 
-    assert(bucket->quarks != NULL);
+    purc_mutex_init(&bucket->lock);
+    bucket->bucket_bits = BUCKET_BITS(id);
+    atomic_store(&bucket->table, table);
+    atomic_store(&bucket->quarks, quarks);
+    atomic_store(&bucket->atom_seq_id, 1);
+    return true;
 }
 
 static inline struct atom_bucket *atom_get_bucket(int bucket)
@@ -89,9 +196,10 @@ static inline struct atom_bucket *atom_get_bucket(int bucket)
     assert(bucket >= 0 && bucket < PURC_ATOM_BUCKETS_NR);
 
     struct atom_bucket *atom_bucket = atom_buckets + bucket;
-    if (UNLIKELY(atom_bucket->atom_seq_id == 0)) {
-        atom_init_bucket(atom_bucket);
-        atom_bucket->bucket_bits = BUCKET_BITS(bucket);
+    if (UNLIKELY(atomic_load_explicit(&atom_bucket->atom_seq_id,
+                    memory_order_relaxed) == 0)) {
+        /* all buckets are initialized by atom_init_once() */
+        return NULL;
     }
 
     return atom_bucket;
@@ -102,30 +210,127 @@ static inline void atom_put_bucket(int bucket)
     assert(bucket >= 0 && bucket < PURC_ATOM_BUCKETS_NR);
 
     struct atom_bucket *atom_bucket = atom_buckets + bucket;
-    if (LIKELY(atom_bucket->atom_map)) {
-        pcutils_map_destroy(atom_bucket->atom_map);
-        free(atom_bucket->quarks);
+    struct atom_table *table = atomic_load(&atom_bucket->table);
+    if (LIKELY(table)) {
+        while (table) {
+            struct atom_table *retired = table->retired;
+            atom_table_delete(table);
+            table = retired;
+        }
+
+        struct atom_quarks *quarks = atomic_load(&atom_bucket->quarks);
+        while (quarks) {
+            struct atom_quarks *retired = quarks->retired;
+            free(quarks);
+            quarks = retired;
+        }
+
+        if (atom_bucket->atom_block)
+            free(atom_bucket->atom_block);
+        free(atom_bucket->free_seqs);
+        purc_mutex_clear(&atom_bucket->lock);
         memset(atom_bucket, 0, sizeof(*atom_bucket));
     }
 }
 
+/* Returns the slot of the string, or the empty slot to hold it. The atom
+   loaded from the slot when it was compared is returned via `atom`: 0 for
+   an empty slot. The lock-free readers must use this value instead of
+   loading the slot again, as a writer may have filled an empty slot with
+   another string since. */
+static struct atom_slot *
+atom_find_slot(struct atom_table *table, const char *string, uint64_t hash,
+        purc_atom_t *atom)
+{
+    size_t i = (size_t)hash & table->mask;
+
+    while (true) {
+        struct atom_slot *slot = table->slots + i;
+
+        *atom = atomic_load_explicit(&slot->atom, memory_order_acquire);
+        if (*atom == 0)
+            return slot;
+
+        if (slot->hash == hash && strcmp(slot->string, string) == 0)
+            return slot;
+
+        i = (i + 1) & table->mask;
+    }
+
+    return NULL;
+}
+
+/* The lock-free readers count themselves in the counter selected by the
+   parity of the epoch. All the operations on the epoch, the counters, and
+   the pointers to the table and the quarks array are sequentially
+   consistent, so that a reader which enters after a writer advanced the
+   epoch always sees the current table and quarks array. */
+static inline unsigned atom_read_lock(struct atom_bucket *bucket)
+{
+    unsigned idx = atomic_load(&bucket->epoch) & 1;
+    atomic_fetch_add(&bucket->nr_readers[idx], 1);
+    return idx;
+}
+
+static inline void atom_read_unlock(struct atom_bucket *bucket, unsigned idx)
+{
+    atomic_fetch_sub(&bucket->nr_readers[idx], 1);
+}
+
+/* Frees the retired tables and quarks arrays once no reader uses them.
+   HOLDS: the lock of the bucket */
+static void
+atom_reclaim(struct atom_bucket *bucket)
+{
+    struct atom_table *table;
+    struct atom_quarks *quarks;
+    table = atomic_load_explicit(&bucket->table, memory_order_relaxed);
+    quarks = atomic_load_explicit(&bucket->quarks, memory_order_relaxed);
+    if (table->retired == NULL && quarks->retired == NULL)
+        return;
+
+    /* wait for the readers entered before each of two advances; a reader
+       loading the epoch before the first one may be counted after it */
+    for (int i = 0; i < 2; i++) {
+        unsigned idx = atomic_fetch_add(&bucket->epoch, 1) & 1;
+        while (atomic_load(&bucket->nr_readers[idx]) > 0) {
+            sched_yield();
+        }
+    }
+
+    struct atom_table *retired_table = table->retired;
+    table->retired = NULL;
+    while (retired_table) {
+        struct atom_table *retired = retired_table->retired;
+        atom_table_delete(retired_table);
+        retired_table = retired;
+    }
+
+    struct atom_quarks *retired_quarks = quarks->retired;
+    quarks->retired = NULL;
+    while (retired_quarks) {
+        struct atom_quarks *retired = retired_quarks->retired;
+        free(retired_quarks);
+        retired_quarks = retired;
+    }
+}
+
 purc_atom_t
 purc_atom_try_string_ex(int bucket, const char *string)
 {
     struct atom_bucket *atom_bucket = atom_get_bucket(bucket);
-    const pcutils_map_entry* entry = NULL;
-    purc_atom_t atom = 0;
 
     if (string == NULL || atom_bucket == NULL)
         return 0;
 
-    purc_rwlock_reader_lock(&atom_rwlock);
-    if ((entry = pcutils_map_find(atom_bucket->atom_map, string))) {
-        atom = (purc_atom_t)(uintptr_t)entry->val;
-    }
-    purc_rwlock_reader_unlock(&atom_rwlock);
+    uint64_t hash = atom_hash(string);
+    unsigned idx = atom_read_lock(atom_bucket);
 
-    return atom;
+    purc_atom_t atom;
+    atom_find_slot(atomic_load(&atom_bucket->table), string, hash, &atom);
+
+    atom_read_unlock(atom_bucket, idx);
+    return (atom == ATOM_REMOVED) ? 0 : atom;
 }
 
 bool
@@ -136,29 +341,40 @@ purc_atom_remove_string_ex(int bucket, const char *string)
     if (string == NULL || atom_bucket == NULL)
         return false;
 
-    const pcutils_map_entry* entry;
-    bool ret;
-    purc_atom_t atom;
+    bool ret = false;
 
-    purc_rwlock_writer_lock(&atom_rwlock);
-    if ((entry = pcutils_map_find(atom_bucket->atom_map, string))) {
-        atom = (purc_atom_t)(uintptr_t)entry->val;
-        pcutils_map_erase(atom_bucket->atom_map, (void *)string);
-        atom = ATOM_TO_SEQUENCE(atom);
-        atom_bucket->quarks[atom] = NULL;
+    purc_mutex_lock(&atom_bucket->lock);
+
+    struct atom_table *table;
+    table = atomic_load_explicit(&atom_bucket->table, memory_order_relaxed);
+
+    purc_atom_t atom;
+    struct atom_slot *slot;
+    slot = atom_find_slot(table, string, atom_hash(string), &atom);
+    if (atom != 0 && atom != ATOM_REMOVED) {
+        /* keep the slot for the readers; it is reclaimed on rebuilding */
+        slot->removed_atom = atom;
+        atomic_store_explicit(&slot->atom, ATOM_REMOVED,
+                memory_order_release);
+        table->nr_removed++;
+
+        struct atom_quarks *quarks;
+        quarks = atomic_load_explicit(&atom_bucket->quarks,
+                memory_order_relaxed);
+        atomic_store_explicit(&quarks->strings[ATOM_TO_SEQUENCE(atom)],
+                NULL, memory_order_release);
         ret = true;
     }
-    else {
-        ret = false;
-    }
-    purc_rwlock_writer_unlock(&atom_rwlock);
+
+    atom_reclaim(atom_bucket);
+    purc_mutex_unlock(&atom_bucket->lock);
 
     return ret;
 }
 
-/* HOLDS: atom_rwlock_lock */
+/* HOLDS: the lock of the bucket */
 static char *
-atom_strdup(const char *string, bool *need_free)
+atom_strdup(struct atom_bucket *bucket, const char *string, bool *need_free)
 {
     char *copy;
     size_t len;
@@ -168,51 +384,219 @@ atom_strdup(const char *string, bool *need_free)
     /* For strings longer than half the block size, fall back
        to strdup so that we fill our blocks at least 50%. */
     if (len > ATOM_STRING_BLOCK_SIZE / 2 ||
-            atom_block_offset + len > ATOM_STRING_BLOCK_SIZE) {
+            bucket->atom_block_offset + len > ATOM_STRING_BLOCK_SIZE) {
         *need_free = true;
         return strdup(string);
     }
 
     *need_free = false;
-    if (atom_block == NULL) {
-        atom_block = malloc(ATOM_STRING_BLOCK_SIZE);
+    if (bucket->atom_block == NULL) {
+        bucket->atom_block = malloc(ATOM_STRING_BLOCK_SIZE);
+        if (bucket->atom_block == NULL) {
+            *need_free = true;
+            return strdup(string);
+        }
     }
 
-    copy = atom_block + atom_block_offset;
+    copy = bucket->atom_block + bucket->atom_block_offset;
     memcpy(copy, string, len);
-    atom_block_offset += len;
+    bucket->atom_block_offset += len;
 
     return copy;
 }
 
-/* HOLDS: purc_atom_rwlock_writer_lock */
+/* HOLDS: the lock of the bucket */
+static void
+atom_free_seq(struct atom_bucket *bucket, purc_atom_t seq_id)
+{
+    if (bucket->nr_free_seqs == bucket->sz_free_seqs) {
+        size_t sz = bucket->sz_free_seqs ? bucket->sz_free_seqs * 2 :
+            ATOM_BLOCK_SIZE;
+        purc_atom_t *seqs = realloc(bucket->free_seqs, sizeof(*seqs) * sz);
+        /* the sequence identifier is lost if out of memory */
+        if (seqs == NULL)
+            return;
+
+        bucket->free_seqs = seqs;
+        bucket->sz_free_seqs = sz;
+    }
+
+    bucket->free_seqs[bucket->nr_free_seqs++] = seq_id;
+}
+
+/* HOLDS: the lock of the bucket */
+static bool
+atom_rebuild_table(struct atom_bucket *bucket, size_t size)
+{
+    struct atom_table *old_table, *table;
+    old_table = atomic_load_explicit(&bucket->table, memory_order_relaxed);
+
+    table = atom_table_new(size);
+    if (table == NULL)
+        return false;
+
+    for (size_t i = 0; i <= old_table->mask; i++) {
+        struct atom_slot *old_slot = old_table->slots + i;
+        purc_atom_t atom;
+
+        atom = atomic_load_explicit(&old_slot->atom, memory_order_relaxed);
+        if (atom == 0)
+            continue;
+
+        if (atom == ATOM_REMOVED) {
+            /* reclaim the slot; its string is freed with the old table */
+            atom_free_seq(bucket, ATOM_TO_SEQUENCE(old_slot->removed_atom));
+            continue;
+        }
+
+        struct atom_slot *slot;
+        purc_atom_t empty;
+        slot = atom_find_slot(table, old_slot->string, old_slot->hash,
+                &empty);
+        slot->hash = old_slot->hash;
+        slot->string = old_slot->string;
+        slot->need_free = old_slot->need_free;
+        atomic_store_explicit(&slot->atom, atom, memory_order_relaxed);
+        table->nr_used++;
+
+        /* the new table owns the string now */
+        old_slot->need_free = false;
+    }
+
+    table->retired = old_table;
+    atomic_store(&bucket->table, table);
+    return true;
+}
+
+/* HOLDS: the lock of the bucket */
+static bool
+atom_grow_quarks(struct atom_bucket *bucket, purc_atom_t seq_id)
+{
+    struct atom_quarks *old_quarks, *quarks;
+    old_quarks = atomic_load_explicit(&bucket->quarks, memory_order_relaxed);
+
+    quarks = atom_quarks_new(old_quarks->size * 2);
+    if (quarks == NULL)
+        return false;
+
+    for (purc_atom_t i = 0; i < seq_id; i++) {
+        atomic_store_explicit(&quarks->strings[i],
+                atomic_load_explicit(&old_quarks->strings[i],
+                    memory_order_relaxed),
+                memory_order_relaxed);
+    }
+
+    quarks->retired = old_quarks;
+    atomic_store(&bucket->quarks, quarks);
+    return true;
+}
+
+/* Publishes the slot with a new atom, or with the sequence identifier
+   `seq` if it is not zero.
+   HOLDS: the lock of the bucket */
+static purc_atom_t
+atom_new(struct atom_bucket *bucket, struct atom_slot *slot, purc_atom_t seq)
+{
+    purc_atom_t seq_id;
+    seq_id = atomic_load_explicit(&bucket->atom_seq_id, memory_order_relaxed);
+
+    struct atom_quarks *quarks;
+    quarks = atomic_load_explicit(&bucket->quarks, memory_order_relaxed);
+
+    bool fresh = false;
+    if (seq == 0 && bucket->nr_free_seqs > 0) {
+        seq = bucket->free_seqs[--bucket->nr_free_seqs];
+    }
+    else if (seq == 0) {
+        seq = seq_id;
+        fresh = true;
+        assert(IS_VALID_SEQ_ID(seq));
+
+        if (seq >= quarks->size) {
+            if (!atom_grow_quarks(bucket, seq_id))
+                return 0;
+            quarks = atomic_load_explicit(&bucket->quarks,
+                    memory_order_relaxed);
+        }
+    }
+
+    atomic_store_explicit(&quarks->strings[seq], (char *)slot->string,
+            memory_order_release);
+    if (fresh) {
+        /* publish the string before the sequence identifier */
+        atomic_store_explicit(&bucket->atom_seq_id, seq_id + 1,
+                memory_order_release);
+    }
+
+    purc_atom_t atom = seq | bucket->bucket_bits;
+    atomic_store_explicit(&slot->atom, atom, memory_order_release);
+    return atom;
+}
+
+/* HOLDS: the lock of the bucket */
 static inline purc_atom_t
 atom_from_string(struct atom_bucket *bucket, const char *string,
         bool duplicate, bool *newly_created)
 {
-    purc_atom_t atom = 0;
-    pcutils_map_entry* entry;
-
-    entry = pcutils_map_find(bucket->atom_map, string);
-    if (entry) {
-        atom = (purc_atom_t)(uintptr_t)entry->val;
-        assert(atom);
+    uint64_t hash = atom_hash(string);
+    struct atom_table *table;
+    table = atomic_load_explicit(&bucket->table, memory_order_relaxed);
 
+    purc_atom_t atom;
+    struct atom_slot *slot = atom_find_slot(table, string, hash, &atom);
+    if (atom != 0 && atom != ATOM_REMOVED) {
         if (newly_created)
             *newly_created = false;
+        return atom;
     }
-    else {
-        bool need_free;
-        if (duplicate)
-            string = atom_strdup(string, &need_free);
-        else
-            need_free = false;
-        atom = atom_new(bucket, (char *)string, need_free);
 
-        if (newly_created)
-            *newly_created = true;
+    bool revived = (atom == ATOM_REMOVED);
+    if (!revived) {
+        /* keep the load factor under 1/2; the removed slots are dropped
+           by rebuilding, and the size is doubled only if the others need */
+        if ((table->nr_used + 1) * 2 > table->mask + 1) {
+            size_t size = table->mask + 1;
+            if ((table->nr_used - table->nr_removed + 1) * 4 > size)
+                size *= 2;
+
+            if (!atom_rebuild_table(bucket, size))
+                return 0;
+            table = atomic_load_explicit(&bucket->table,
+                    memory_order_relaxed);
+            slot = atom_find_slot(table, string, hash, &atom);
+        }
+
+        bool need_free = false;
+        const char *copy = string;
+        if (duplicate) {
+            copy = atom_strdup(bucket, string, &need_free);
+            if (copy == NULL)
+                return 0;
+        }
+
+        slot->hash = hash;
+        slot->string = copy;
+        slot->need_free = need_free;
+        table->nr_used++;
+    }
+    /* else revive the removed slot with its string and its old atom */
+
+    atom = atom_new(bucket, slot,
+            revived ? ATOM_TO_SEQUENCE(slot->removed_atom) : 0);
+    if (revived)
+        table->nr_removed--;
+    else if (atom == 0) {
+        /* the slot was not published; give it up */
+        if (slot->need_free)
+            free((char *)slot->string);
+        slot->string = NULL;
+        slot->need_free = false;
+        table->nr_used--;
     }
 
+    if (newly_created)
+        *newly_created = (atom != 0);
+
     return atom;
 }
 
@@ -221,9 +605,10 @@ atom_from_string_locked(struct atom_bucket *bucket, const char *string,
         bool duplicate, bool *newly_created)
 {
     purc_atom_t atom = 0;
-    purc_rwlock_writer_lock(&atom_rwlock);
+    purc_mutex_lock(&bucket->lock);
     atom = atom_from_string(bucket, string, duplicate, newly_created);
-    purc_rwlock_writer_unlock(&atom_rwlock);
+    atom_reclaim(bucket);
+    purc_mutex_unlock(&bucket->lock);
 
     return atom;
 }
@@ -231,10 +616,11 @@ atom_from_string_locked(struct atom_bucket *bucket, const char *string,
 purc_atom_t
 purc_atom_from_string_ex2(int bucket, const char *string, bool *newly_created)
 {
-    if (!string)
+    struct atom_bucket *atom_bucket = atom_get_bucket(bucket);
+    if (!string || !atom_bucket)
         return 0;
 
-    return atom_from_string_locked(atom_get_bucket(bucket), string,
+    return atom_from_string_locked(atom_bucket, string,
             true, newly_created);
 }
 
@@ -242,10 +628,11 @@ purc_atom_t
 purc_atom_from_static_string_ex2(int bucket, const char *string,
         bool *newly_created)
 {
-    if (!string)
+    struct atom_bucket *atom_bucket = atom_get_bucket(bucket);
+    if (!string || !atom_bucket)
         return 0;
 
-    return atom_from_string_locked(atom_get_bucket(bucket), string,
+    return atom_from_string_locked(atom_bucket, string,
             false, newly_created);
 }
 
@@ -260,62 +647,39 @@ purc_atom_to_string(purc_atom_t atom)
 
     bucket = ATOM_TO_BUCKET(atom);
     struct atom_bucket *atom_bucket = atom_get_bucket(bucket);
+    if (atom_bucket == NULL)
+        return NULL;
+
     atom = ATOM_TO_SEQUENCE(atom);
-    purc_rwlock_reader_lock(&atom_rwlock);
-    if (atom < atom_bucket->atom_seq_id)
-        result = atom_bucket->quarks[atom];
-    purc_rwlock_reader_unlock(&atom_rwlock);
+    if (atom < atomic_load_explicit(&atom_bucket->atom_seq_id,
+                memory_order_acquire)) {
+        unsigned idx = atom_read_lock(atom_bucket);
+        struct atom_quarks *quarks = atomic_load(&atom_bucket->quarks);
+        result = atomic_load_explicit(&quarks->strings[atom],
+                memory_order_acquire);
+        atom_read_unlock(atom_bucket, idx);
+    }
 
     return result;
 }
 
-static void free_dup_key(void *key, void *data)
-{
-    UNUSED_PARAM(data);
-    if (key)
-        free(key);
-}
-
-/* HOLDS: purc_atom_rwlock_writer_lock */
-static inline purc_atom_t
-atom_new(struct atom_bucket *bucket, char *string, bool need_free)
+void
+pcutils_atom_bucket_stats(int bucket, size_t *nr_slots, size_t *nr_seq_ids)
 {
-    purc_atom_t atom;
-    char **atoms_new;
-
-    if (bucket->atom_seq_id % ATOM_BLOCK_SIZE == 0) {
-        atoms_new = (char **)malloc(sizeof (char *) *
-                (bucket->atom_seq_id + ATOM_BLOCK_SIZE));
-        if (bucket->atom_seq_id != 0)
-            memcpy(atoms_new, bucket->quarks,
-                    sizeof (char *) * bucket->atom_seq_id);
-        memset(atoms_new + bucket->atom_seq_id, 0,
-                sizeof (char *) * ATOM_BLOCK_SIZE);
-
-        /*
-         * The implementation in glib did not free the old quarks array.
-         * The author said: `This leaks the old quarks array. Its unfortunate,
-         * but it allows us to do lockless lookup of the arrays, and there
-         * shouldn't be that many quarks in an app`.
-         *
-         * In our implementation, we do free the old quarks.
-         * Indeed, we can use realloc() instead of malloc() and memcpy()
-         */
-        free(bucket->quarks);
-        bucket->quarks = atoms_new;
+    struct atom_bucket *atom_bucket = atom_get_bucket(bucket);
+    if (atom_bucket == NULL) {
+        *nr_slots = 0;
+        *nr_seq_ids = 0;
+        return;
     }
 
-    atom = bucket->atom_seq_id;
-    bucket->quarks[atom] = string;
-    atom |= bucket->bucket_bits;
-    pcutils_map_insert_ex(bucket->atom_map,
-                string, (void *)(uintptr_t)atom,
-                need_free ? free_dup_key : NULL);
-    bucket->atom_seq_id++;
-
-    assert(IS_VALID_SEQ_ID(bucket->atom_seq_id));
-
-    return atom;
+    purc_mutex_lock(&atom_bucket->lock);
+    struct atom_table *table;
+    table = atomic_load_explicit(&atom_bucket->table, memory_order_relaxed);
+    *nr_slots = table->mask + 1;
+    *nr_seq_ids = atomic_load_explicit(&atom_bucket->atom_seq_id,
+            memory_order_relaxed);
+    purc_mutex_unlock(&atom_bucket->lock);
 }
 
 static void
@@ -326,43 +690,28 @@ atom_cleanup_once(void)
     for (bucket = 0; bucket < PURC_ATOM_BUCKETS_NR; bucket++) {
         atom_put_bucket(bucket);
     }
-
-    if (atom_rwlock.native_impl)
-        purc_rwlock_clear(&atom_rwlock);
-    if (atom_block)
-        free(atom_block);
 }
 
 static int
 atom_init_once(void)
 {
     int r = 0;
+    int bucket;
 
-    purc_rwlock_init(&atom_rwlock);
-    if (atom_rwlock.native_impl == NULL)
-        goto fail_lock;
-
-    /* init the default bucket only */
-    if (!atom_get_bucket(0))
-        goto fail_atom;
+    /* init all buckets, so that the readers never need a lock */
+    for (bucket = 0; bucket < PURC_ATOM_BUCKETS_NR; bucket++) {
+        if (!atom_init_bucket(atom_buckets + bucket, bucket))
+            goto fail_atom;
+    }
 
     r = atexit(atom_cleanup_once);
     if (r)
-        goto fail_atexit;
+        goto fail_atom;
 
     return 0;
 
-fail_atexit:
-    atom_put_bucket(0);
-    if (atom_block) {
-        free(atom_block);
-        atom_block = NULL;
-    }
-
 fail_atom:
-    purc_rwlock_clear(&atom_rwlock);
-
-fail_lock:
+    atom_cleanup_once();
     return -1;
 }
 
@@ -373,4 +722,3 @@ struct pcmodule _module_atom = {
     .init_once       = atom_init_once,
     .init_instance   = NULL,
 };
-
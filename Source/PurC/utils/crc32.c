@@ -28,6 +28,14 @@
 #include "private/utils.h"
 #include "private/debug.h"
 
+#include <pthread.h>
+#include <string.h>
+
+#if CPU(X86_64) && COMPILER(GCC_COMPATIBLE)
+#define HAVE_CRC32_SIMD 1
+#include <immintrin.h>
+#endif
+
 /*
 
 // program to generate the crc32_table.
@@ -471,6 +479,325 @@ static const uint32_t crc32_table_000000af[] =
   0x00006494, 0x0000643b, 0x000065ca, 0x00006565
 };
 
+/*
+ * Slicing-by-8: the tables for the k-th byte ahead are derived from the
+ * bytewise table, so that eight bytes are consumed per iteration with
+ * eight independent table lookups. See "A Systematic Approach to Building
+ * High Performance, Software-based, CRC Generators" by M. E. Kounavis
+ * and F. L. Berry.
+ */
+static const struct {
+    const uint32_t *table;
+    bool            reflected;
+} base_tables[] = {
+    { crc32_table_04c11db7_reflected,   true },
+    { crc32_table_1edc6f41_reflected,   true },
+    { crc32_table_a833982b_reflected,   true },
+    { crc32_table_04c11db7,             false },
+    { crc32_table_000000af,             false },
+    { crc32_table_814141ab,             false },
+};
+
+static uint32_t slicing_tables[PCA_TABLESIZE(base_tables)][8][256];
+
+static void init_slicing_tables_once(void)
+{
+    for (size_t t = 0; t < PCA_TABLESIZE(base_tables); t++) {
+        const uint32_t *base = base_tables[t].table;
+        uint32_t (*slices)[256] = slicing_tables[t];
+
+        memcpy(slices[0], base, sizeof(slices[0]));
+        for (int k = 1; k < 8; k++) {
+            for (int i = 0; i < 256; i++) {
+                uint32_t c = slices[k - 1][i];
+                if (base_tables[t].reflected)
+                    slices[k][i] = (c >> 8) ^ base[c & 0xFF];
+                else
+                    slices[k][i] = (c << 8) ^ base[c >> 24];
+            }
+        }
+    }
+}
+
+static const uint32_t (*get_slicing_tables(const uint32_t *table))[256]
+{
+    static pthread_once_t once = PTHREAD_ONCE_INIT;
+    pthread_once(&once, init_slicing_tables_once);
+
+    for (size_t t = 0; t < PCA_TABLESIZE(base_tables); t++) {
+        if (base_tables[t].table == table)
+            return (const uint32_t (*)[256])slicing_tables[t];
+    }
+
+    PC_ASSERT(0);
+    return NULL;
+}
+
+static uint32_t
+update_slicing8_reflected(const uint32_t (*t)[256], uint32_t crc,
+        const uint8_t *buf, size_t n)
+{
+    while (n >= 8) {
+        uint32_t one = (buf[0] | buf[1] << 8 | buf[2] << 16 |
+                (uint32_t)buf[3] << 24) ^ crc;
+        uint32_t two = buf[4] | buf[5] << 8 | buf[6] << 16 |
+                (uint32_t)buf[7] << 24;
+
+        crc = t[7][one & 0xFF] ^ t[6][(one >> 8) & 0xFF] ^
+            t[5][(one >> 16) & 0xFF] ^ t[4][one >> 24] ^
+            t[3][two & 0xFF] ^ t[2][(two >> 8) & 0xFF] ^
+            t[1][(two >> 16) & 0xFF] ^ t[0][two >> 24];
+
+        buf += 8;
+        n -= 8;
+    }
+
+    while (n--) {
+        crc = (crc >> 8) ^ t[0][(crc ^ *buf) & 0xFF];
+        buf++;
+    }
+
+    return crc;
+}
+
+static uint32_t
+update_slicing8(const uint32_t (*t)[256], uint32_t crc,
+        const uint8_t *buf, size_t n)
+{
+    while (n >= 8) {
+        uint32_t one = ((uint32_t)buf[0] << 24 | buf[1] << 16 |
+                buf[2] << 8 | buf[3]) ^ crc;
+        uint32_t two = (uint32_t)buf[4] << 24 | buf[5] << 16 |
+                buf[6] << 8 | buf[7];
+
+        crc = t[7][one >> 24] ^ t[6][(one >> 16) & 0xFF] ^
+            t[5][(one >> 8) & 0xFF] ^ t[4][one & 0xFF] ^
+            t[3][two >> 24] ^ t[2][(two >> 16) & 0xFF] ^
+            t[1][(two >> 8) & 0xFF] ^ t[0][two & 0xFF];
+
+        buf += 8;
+        n -= 8;
+    }
+
+    while (n--) {
+        crc = (crc << 8) ^ t[0][((crc >> 24) ^ *buf) & 0xFF];
+        buf++;
+    }
+
+    return crc;
+}
+
+#if HAVE(CRC32_SIMD)
+
+#define CPU_HAS_SSE42       0x01
+#define CPU_HAS_PCLMUL      0x02
+
+static int cpu_features = -1;
+
+static int get_cpu_features(void)
+{
+    if (UNLIKELY(cpu_features < 0)) {
+        int features = 0;
+
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("sse4.2")) {
+            features |= CPU_HAS_SSE42;
+            if (__builtin_cpu_supports("pclmul"))
+                features |= CPU_HAS_PCLMUL;
+        }
+
+        cpu_features = features;
+    }
+
+    return cpu_features;
+}
+
+/* The crc32 instruction implements the reflected CRC-32C update. */
+__attribute__((target("sse4.2")))
+static uint32_t update_sse42(uint32_t crc, const uint8_t *buf, size_t n)
+{
+    while (n > 0 && ((uintptr_t)buf & 7)) {
+        crc = _mm_crc32_u8(crc, *buf++);
+        n--;
+    }
+
+    uint64_t crc64 = crc;
+    while (n >= 8) {
+        uint64_t v;
+        memcpy(&v, buf, sizeof(v));
+        crc64 = _mm_crc32_u64(crc64, v);
+        buf += 8;
+        n -= 8;
+    }
+
+    crc = (uint32_t)crc64;
+    while (n--) {
+        crc = _mm_crc32_u8(crc, *buf++);
+    }
+
+    return crc;
+}
+
+/*
+ * Folds 64-byte blocks with carry-less multiplications, then does the
+ * Barrett reduction; for the reflected polynomial 0x04C11DB7 only. See
+ * "Fast CRC Computation for Generic Polynomials Using PCLMULQDQ
+ * Instruction" by V. Gopal et al. The length must be a multiple of 16
+ * and not less than 64.
+ */
+__attribute__((target("pclmul,sse4.1")))
+static uint32_t update_pclmul(uint32_t crc, const uint8_t *buf, size_t n)
+{
+    static const uint64_t k1k2[] __attribute__((aligned(16))) =
+        { 0x0154442bd4, 0x01c6e41596 };
+    static const uint64_t k3k4[] __attribute__((aligned(16))) =
+        { 0x01751997d0, 0x00ccaa009e };
+    static const uint64_t k5k0[] __attribute__((aligned(16))) =
+        { 0x0163cd6124, 0x0000000000 };
+    static const uint64_t poly[] __attribute__((aligned(16))) =
+        { 0x01db710641, 0x01f7011641 };
+
+    __m128i x0, x1, x2, x3, x4, x5, x6, x7, x8, y5, y6, y7, y8;
+
+    x1 = _mm_loadu_si128((const __m128i *)(buf + 0x00));
+    x2 = _mm_loadu_si128((const __m128i *)(buf + 0x10));
+    x3 = _mm_loadu_si128((const __m128i *)(buf + 0x20));
+    x4 = _mm_loadu_si128((const __m128i *)(buf + 0x30));
+    x1 = _mm_xor_si128(x1, _mm_cvtsi32_si128(crc));
+    x0 = _mm_load_si128((const __m128i *)k1k2);
+    buf += 64;
+    n -= 64;
+
+    /* fold four 128-bit lanes in parallel */
+    while (n >= 64) {
+        x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+        x6 = _mm_clmulepi64_si128(x2, x0, 0x00);
+        x7 = _mm_clmulepi64_si128(x3, x0, 0x00);
+        x8 = _mm_clmulepi64_si128(x4, x0, 0x00);
+
+        x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+        x2 = _mm_clmulepi64_si128(x2, x0, 0x11);
+        x3 = _mm_clmulepi64_si128(x3, x0, 0x11);
+        x4 = _mm_clmulepi64_si128(x4, x0, 0x11);
+
+        y5 = _mm_loadu_si128((const __m128i *)(buf + 0x00));
+        y6 = _mm_loadu_si128((const __m128i *)(buf + 0x10));
+        y7 = _mm_loadu_si128((const __m128i *)(buf + 0x20));
+        y8 = _mm_loadu_si128((const __m128i *)(buf + 0x30));
+
+        x1 = _mm_xor_si128(_mm_xor_si128(x1, x5), y5);
+        x2 = _mm_xor_si128(_mm_xor_si128(x2, x6), y6);
+        x3 = _mm_xor_si128(_mm_xor_si128(x3, x7), y7);
+        x4 = _mm_xor_si128(_mm_xor_si128(x4, x8), y8);
+
+        buf += 64;
+        n -= 64;
+    }
+
+    /* fold the four lanes into one */
+    x0 = _mm_load_si128((const __m128i *)k3k4);
+
+    x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+    x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+    x1 = _mm_xor_si128(_mm_xor_si128(x1, x2), x5);
+
+    x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+    x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+    x1 = _mm_xor_si128(_mm_xor_si128(x1, x3), x5);
+
+    x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+    x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+    x1 = _mm_xor_si128(_mm_xor_si128(x1, x4), x5);
+
+    /* fold the remaining 16-byte blocks */
+    while (n >= 16) {
+        x2 = _mm_loadu_si128((const __m128i *)buf);
+
+        x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+        x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+        x1 = _mm_xor_si128(_mm_xor_si128(x1, x2), x5);
+
+        buf += 16;
+        n -= 16;
+    }
+
+    /* fold 128 bits to 64 bits */
+    x2 = _mm_clmulepi64_si128(x1, x0, 0x10);
+    x3 = _mm_setr_epi32(~0, 0, ~0, 0);
+    x1 = _mm_srli_si128(x1, 8);
+    x1 = _mm_xor_si128(x1, x2);
+
+    x0 = _mm_loadl_epi64((const __m128i *)k5k0);
+
+    x2 = _mm_srli_si128(x1, 4);
+    x1 = _mm_and_si128(x1, x3);
+    x1 = _mm_clmulepi64_si128(x1, x0, 0x00);
+    x1 = _mm_xor_si128(x1, x2);
+
+    /* Barrett reduction to 32 bits */
+    x0 = _mm_load_si128((const __m128i *)poly);
+
+    x2 = _mm_and_si128(x1, x3);
+    x2 = _mm_clmulepi64_si128(x2, x0, 0x10);
+    x2 = _mm_and_si128(x2, x3);
+    x2 = _mm_clmulepi64_si128(x2, x0, 0x00);
+    x1 = _mm_xor_si128(x1, x2);
+
+    return (uint32_t)_mm_extract_epi32(x1, 1);
+}
+
+#endif  /* HAVE(CRC32_SIMD) */
+
+static int engine_limit = PCUTILS_CRC32_ENGINE_PCLMUL;
+
+int pcutils_crc32_engine(purc_crc32_algo_t algo)
+{
+    int engine = PCUTILS_CRC32_ENGINE_SLICING8;
+
+#if HAVE(CRC32_SIMD)
+    int features = get_cpu_features();
+
+    switch (algo) {
+        case PURC_K_ALGO_CRC32_ISCSI:
+        case PURC_K_ALGO_CRC32C:
+            if (features & CPU_HAS_SSE42)
+                engine = PCUTILS_CRC32_ENGINE_SSE42;
+            break;
+
+        case PURC_K_ALGO_CRC32:
+        case PURC_K_ALGO_CRC32_JAMCRC:
+            if (features & CPU_HAS_PCLMUL)
+                engine = PCUTILS_CRC32_ENGINE_PCLMUL;
+            break;
+
+        default:
+            break;
+    }
+#else
+    UNUSED_PARAM(algo);
+#endif
+
+    if (engine > engine_limit) {
+        engine = (engine_limit > PCUTILS_CRC32_ENGINE_BYTEWISE) ?
+            PCUTILS_CRC32_ENGINE_SLICING8 : PCUTILS_CRC32_ENGINE_BYTEWISE;
+    }
+
+    return engine;
+}
+
+int pcutils_crc32_set_engine_limit(int limit)
+{
+    int old_limit = engine_limit;
+
+    if (limit < PCUTILS_CRC32_ENGINE_BYTEWISE)
+        limit = PCUTILS_CRC32_ENGINE_BYTEWISE;
+    else if (limit > PCUTILS_CRC32_ENGINE_PCLMUL)
+        limit = PCUTILS_CRC32_ENGINE_PCLMUL;
+
+    engine_limit = limit;
+    return old_limit;
+}
+
 /* For the parameters of different CRC32 algorithms, see
    <https://crccalc.com/> */
 void pcutils_crc32_begin(pcutils_crc32_ctxt *ctxt, purc_crc32_algo_t algo)
@@ -566,6 +893,10 @@ void pcutils_crc32_begin(pcutils_crc32_ctxt *ctxt, purc_crc32_algo_t algo)
     }
 
     ctxt->crc32 = ctxt->init;
+    ctxt->engine = pcutils_crc32_engine(algo);
+    ctxt->slices = NULL;
+    if (ctxt->engine != PCUTILS_CRC32_ENGINE_BYTEWISE)
+        ctxt->slices = get_slicing_tables(ctxt->table_static);
 }
 
 void pcutils_crc32_update(pcutils_crc32_ctxt *ctxt,
@@ -573,6 +904,34 @@ void pcutils_crc32_update(pcutils_crc32_ctxt *ctxt,
 {
     const uint8_t *buf = data;
 
+    switch (ctxt->engine) {
+#if HAVE(CRC32_SIMD)
+        case PCUTILS_CRC32_ENGINE_SSE42:
+            ctxt->crc32 = update_sse42(ctxt->crc32, buf, n);
+            return;
+
+        case PCUTILS_CRC32_ENGINE_PCLMUL:
+            if (n >= 64) {
+                size_t nr_folded = n & ~(size_t)15;
+                ctxt->crc32 = update_pclmul(ctxt->crc32, buf, nr_folded);
+                buf += nr_folded;
+                n -= nr_folded;
+            }
+            // fall through
+#endif
+        case PCUTILS_CRC32_ENGINE_SLICING8:
+            if (ctxt->refout)
+                ctxt->crc32 = update_slicing8_reflected(ctxt->slices,
+                        ctxt->crc32, buf, n);
+            else
+                ctxt->crc32 = update_slicing8(ctxt->slices,
+                        ctxt->crc32, buf, n);
+            return;
+
+        default:
+            break;
+    }
+
     while (n--) {
         uint8_t ch;
         ch = *buf;
@@ -678,6 +1037,8 @@ pcutils_crc32_begin_custom(uint32_t poly, uint32_t init, uint32_t xorout,
         ctxt->xorout = xorout;
         ctxt->refin = true;
         ctxt->refout = refout;
+        ctxt->engine = PCUTILS_CRC32_ENGINE_BYTEWISE;
+        ctxt->slices = NULL;
         if (refin) {
             calc_crc32_table(ctxt->table_alloc, poly, refin);
         }
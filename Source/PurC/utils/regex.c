@@ -31,6 +31,8 @@
 #include "purc-utils.h"
 #include "purc-errors.h"
 #include "private/errors.h"
+#include "private/instance.h"
+#include "private/list.h"
 #include "private/regex.h"
 
 #if HAVE(GLIB)
@@ -41,6 +43,7 @@
 
 struct pcregex {
     GRegex *g_regex;
+    unsigned int refc;
 };
 
 struct pcregex_match_info {
@@ -233,6 +236,176 @@ void set_error_code_from_gerror(GError *err)
     g_error_free(err);
 }
 
+static GRegex *compile_regex(const char *pattern,
+        enum pcregex_compile_flags compile_options,
+        enum pcregex_match_flags match_options, GError **err)
+{
+    return g_regex_new(pattern,
+            to_g_regex_compile_flags(compile_options),
+            to_g_regex_match_flags(match_options),
+            err);
+}
+
+static struct pcregex *wrap_regex(GRegex *g_regex)
+{
+    struct pcregex *regex = (struct pcregex *) malloc(sizeof(struct pcregex));
+    if (!regex) {
+        g_regex_unref(g_regex);
+        purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
+        return NULL;
+    }
+
+    regex->g_regex = g_regex;
+    regex->refc = 1;
+    return regex;
+}
+
+#define REGEX_CACHE_SIZE        32
+
+struct regex_cache_entry {
+    struct list_head            ln;
+    unsigned long               hash;
+    enum pcregex_compile_flags  compile_options;
+    enum pcregex_match_flags    match_options;
+    char                       *pattern;
+    struct pcregex             *regex;
+};
+
+/* The compiled regular expressions of an instance, most recently used first */
+struct pcregex_cache {
+    struct list_head            lru;
+    size_t                      nr_entries;
+};
+
+static unsigned long hash_pattern(const char *pattern)
+{
+    /* FNV-1a */
+    unsigned long hash = 2166136261UL;
+    for (const unsigned char *p = (const unsigned char *)pattern; *p; p++) {
+        hash ^= *p;
+        hash *= 16777619UL;
+    }
+    return hash;
+}
+
+static void free_cache_entry(struct regex_cache_entry *entry)
+{
+    list_del(&entry->ln);
+    pcregex_destroy(entry->regex);
+    free(entry->pattern);
+    free(entry);
+}
+
+void pcregex_cache_destroy(struct pcregex_cache *cache)
+{
+    if (!cache) {
+        return;
+    }
+
+    struct regex_cache_entry *p, *n;
+    list_for_each_entry_safe(p, n, &cache->lru, ln) {
+        free_cache_entry(p);
+    }
+    free(cache);
+}
+
+/*
+ * Returns the compiled regular expression from the cache of the current
+ * instance, compiling and caching it on a miss; the result is owned by the
+ * cache. Without an instance, or if the entry cannot be allocated, the
+ * result is a new regular expression which is handed over in *owned.
+ */
+static struct pcregex *lookup_regex(const char *pattern,
+        enum pcregex_compile_flags compile_options,
+        enum pcregex_match_flags match_options,
+        struct pcregex **owned, GError **err)
+{
+    struct pcinst *inst = pcinst_current();
+    struct pcregex_cache *cache = inst ? inst->regex_cache : NULL;
+    unsigned long hash = hash_pattern(pattern);
+
+    *owned = NULL;
+    if (cache) {
+        struct regex_cache_entry *p;
+        list_for_each_entry(p, &cache->lru, ln) {
+            if (p->hash == hash && p->compile_options == compile_options &&
+                    p->match_options == match_options &&
+                    strcmp(p->pattern, pattern) == 0) {
+                list_move(&p->ln, &cache->lru);
+                return p->regex;
+            }
+        }
+    }
+    else if (inst) {
+        cache = (struct pcregex_cache *)malloc(sizeof(*cache));
+        if (cache) {
+            list_head_init(&cache->lru);
+            cache->nr_entries = 0;
+            inst->regex_cache = cache;
+        }
+    }
+
+    GRegex *g_regex = compile_regex(pattern, compile_options, match_options,
+            err);
+    if (!g_regex) {
+        return NULL;
+    }
+
+    struct pcregex *regex = wrap_regex(g_regex);
+    if (!regex) {
+        return NULL;
+    }
+
+    struct regex_cache_entry *entry = NULL;
+    if (cache) {
+        entry = (struct regex_cache_entry *)malloc(sizeof(*entry));
+        if (entry && (entry->pattern = strdup(pattern)) == NULL) {
+            free(entry);
+            entry = NULL;
+        }
+    }
+
+    if (!entry) {
+        *owned = regex;
+        return regex;
+    }
+
+    if (cache->nr_entries == REGEX_CACHE_SIZE) {
+        free_cache_entry(list_last_entry(&cache->lru,
+                    struct regex_cache_entry, ln));
+        cache->nr_entries--;
+    }
+
+    entry->hash = hash;
+    entry->compile_options = compile_options;
+    entry->match_options = match_options;
+    entry->regex = regex;
+    list_add(&entry->ln, &cache->lru);
+    cache->nr_entries++;
+    return regex;
+}
+
+struct pcregex *pcregex_get_cached(const char *pattern,
+        enum pcregex_compile_flags compile_options,
+        enum pcregex_match_flags match_options)
+{
+    if (!pattern) {
+        purc_set_error(PURC_ERROR_INVALID_VALUE);
+        return NULL;
+    }
+
+    struct pcregex *owned;
+    GError *err = NULL;
+    struct pcregex *regex = lookup_regex(pattern, compile_options,
+            match_options, &owned, &err);
+    if (!regex) {
+        set_error_code_from_gerror(err);
+        return NULL;
+    }
+
+    return owned ? owned : pcregex_ref(regex);
+}
+
 bool pcregex_is_match_ex(const char *pattern, const char *str,
         enum pcregex_compile_flags compile_options,
         enum pcregex_match_flags match_options)
@@ -240,9 +413,24 @@ bool pcregex_is_match_ex(const char *pattern, const char *str,
     if (!pattern || !str) {
         return false;
     }
-    return g_regex_match_simple(pattern, str,
-            to_g_regex_compile_flags(compile_options),
-            to_g_regex_match_flags(match_options));
+
+    /* like g_regex_match_simple(), a bad pattern simply does not match */
+    struct pcregex *owned;
+    GError *err = NULL;
+    struct pcregex *regex = lookup_regex(pattern, compile_options,
+            match_options, &owned, &err);
+    if (!regex) {
+        if (err) {
+            g_error_free(err);
+        }
+        return false;
+    }
+
+    bool ret = g_regex_match(regex->g_regex, str, 0, NULL);
+    if (owned) {
+        pcregex_destroy(owned);
+    }
+    return ret;
 }
 
 bool pcregex_is_match(const char *pattern, const char *str)
@@ -254,22 +442,13 @@ struct pcregex *pcregex_new_ex(const char *pattern,
         enum pcregex_compile_flags compile_options,
         enum pcregex_match_flags match_options)
 {
-    struct pcregex *regex = (struct pcregex *) malloc(sizeof(struct pcregex));
-    if (!regex) {
-        purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
-        return NULL;
-    }
-
     GError *err = NULL;
-    regex->g_regex = g_regex_new(pattern,
-            to_g_regex_compile_flags(compile_options),
-            to_g_regex_match_flags(match_options),
+    GRegex *g_regex = compile_regex(pattern, compile_options, match_options,
             &err);
-    if (regex->g_regex) {
-        return regex;
+    if (g_regex) {
+        return wrap_regex(g_regex);
     }
 
-    free(regex);
     set_error_code_from_gerror(err);
     return NULL;
 }
@@ -279,9 +458,17 @@ struct pcregex *pcregex_new(const char *pattern)
     return pcregex_new_ex(pattern, 0, 0);
 }
 
+struct pcregex *pcregex_ref(struct pcregex *regex)
+{
+    if (regex) {
+        regex->refc++;
+    }
+    return regex;
+}
+
 void pcregex_destroy(struct pcregex *regex)
 {
-    if (!regex) {
+    if (!regex || --regex->refc) {
         return;
     }
     g_regex_unref(regex->g_regex);
@@ -419,6 +606,25 @@ struct pcregex *pcregex_new(const char *pattern)
     return pcregex_new_ex(pattern, 0, 0);
 }
 
+struct pcregex *pcregex_get_cached(const char *pattern,
+        enum pcregex_compile_flags compile_options,
+        enum pcregex_match_flags match_options)
+{
+    return pcregex_new_ex(pattern, compile_options, match_options);
+}
+
+void pcregex_cache_destroy(struct pcregex_cache *cache)
+{
+    UNUSED_PARAM(cache);
+}
+
+struct pcregex *pcregex_ref(struct pcregex *regex)
+{
+    UNUSED_PARAM(regex);
+    purc_set_error(PURC_ERROR_NOT_IMPLEMENTED);
+    return NULL;
+}
+
 void pcregex_destroy(struct pcregex *regex)
 {
     UNUSED_PARAM(regex);
@@ -467,3 +673,8 @@ void pcregex_match_info_destroy(struct pcregex_match_info *match_info)
 }
 
 #endif /* HAVA(GLIB) */
+
+bool pcregex_is_literal(const char *pattern)
+{
+    return pattern && pattern[strcspn(pattern, "\\^$.|?*+()[]{}")] == 0;
+}
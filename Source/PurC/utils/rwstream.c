@@ -28,6 +28,7 @@
 #include "purc-utils.h"
 #include "private/errors.h"
 #include "private/instance.h"
+#include "private/rwstream.h"
 
 #include <stdio.h>
 #include <stdlib.h>
@@ -85,6 +86,14 @@ typedef struct rwstream_funcs
     int     (*destroy) (purc_rwstream_t rws);
     void*   (*get_mem_buffer) (purc_rwstream_t rws, size_t *sz_content,
             size_t *sz_buffer, bool res_buff);
+
+    /* The following are for the streams having the bytes not read yet in
+       memory. peek_mem() returns them, reading ahead to have at least
+       sz_min of them unless the stream ends; consume() skips them. */
+    const uint8_t* (*peek_mem) (purc_rwstream_t rws, size_t sz_min,
+            size_t *sz_avail);
+    void    (*consume) (purc_rwstream_t rws, size_t count);
+    int     (*unread) (purc_rwstream_t rws, const void* buf, size_t count);
 } rwstream_funcs;
 
 struct purc_rwstream
@@ -124,6 +133,13 @@ struct fd_rwstream
 {
     purc_rwstream rwstream;
     int fd;
+
+    /* the read-ahead buffer of a buffered fd rwstream */
+    uint8_t* rbuf;
+    size_t sz_rbuf;
+    size_t rpos;        // the position of the next byte to read
+    size_t rlen;        // the length of the valid bytes in rbuf
+    off_t consumed;     // the bytes read so far; for unseekable fds
 };
 #endif // OS(LINUX) || OS(UNIX) || OS(DARWIN)
 
@@ -141,6 +157,9 @@ static rwstream_funcs stdio_funcs = {
     stdio_write,
     stdio_flush,
     stdio_destroy,
+    NULL,
+    NULL,
+    NULL,
     NULL
 };
 
@@ -152,6 +171,10 @@ static ssize_t mem_flush (purc_rwstream_t rws);
 static int mem_destroy (purc_rwstream_t rws);
 static void* mem_get_mem_buffer (purc_rwstream_t rws,
         size_t *sz_content, size_t *sz_buffer, bool res_buff);
+static const uint8_t* mem_peek_mem (purc_rwstream_t rws, size_t sz_min,
+        size_t *sz_avail);
+static void mem_consume (purc_rwstream_t rws, size_t count);
+static int mem_unread (purc_rwstream_t rws, const void* buf, size_t count);
 
 static rwstream_funcs mem_funcs = {
     mem_seek,
@@ -160,7 +183,10 @@ static rwstream_funcs mem_funcs = {
     mem_write,
     mem_flush,
     mem_destroy,
-    mem_get_mem_buffer
+    mem_get_mem_buffer,
+    mem_peek_mem,
+    mem_consume,
+    mem_unread,
 };
 
 static off_t buffer_seek (purc_rwstream_t rws, off_t offset, int whence);
@@ -171,6 +197,10 @@ static ssize_t buffer_flush (purc_rwstream_t rws);
 static int buffer_destroy (purc_rwstream_t rws);
 static void* buffer_get_mem_buffer (purc_rwstream_t rws,
         size_t *sz_content, size_t *sz_buffer, bool res_buff);
+static const uint8_t* buffer_peek_mem (purc_rwstream_t rws, size_t sz_min,
+        size_t *sz_avail);
+static void buffer_consume (purc_rwstream_t rws, size_t count);
+static int buffer_unread (purc_rwstream_t rws, const void* buf, size_t count);
 
 static rwstream_funcs buffer_funcs = {
     buffer_seek,
@@ -179,7 +209,10 @@ static rwstream_funcs buffer_funcs = {
     buffer_write,
     buffer_flush,
     buffer_destroy,
-    buffer_get_mem_buffer
+    buffer_get_mem_buffer,
+    buffer_peek_mem,
+    buffer_consume,
+    buffer_unread,
 };
 
 
@@ -199,6 +232,33 @@ static rwstream_funcs fd_funcs = {
     NULL,           // flush
     fd_destroy,
     NULL,
+    NULL,
+    NULL,
+    NULL,
+};
+
+static off_t fdbuf_seek (purc_rwstream_t rws, off_t offset, int whence);
+static off_t fdbuf_tell (purc_rwstream_t rws);
+static ssize_t fdbuf_read (purc_rwstream_t rws, void* buf, size_t count);
+static ssize_t fdbuf_write (purc_rwstream_t rws, const void* buf,
+        size_t count);
+static int fdbuf_destroy (purc_rwstream_t rws);
+static const uint8_t* fdbuf_peek_mem (purc_rwstream_t rws, size_t sz_min,
+        size_t *sz_avail);
+static void fdbuf_consume (purc_rwstream_t rws, size_t count);
+static int fdbuf_unread (purc_rwstream_t rws, const void* buf, size_t count);
+
+static rwstream_funcs fdbuf_funcs = {
+    fdbuf_seek,
+    fdbuf_tell,
+    fdbuf_read,
+    fdbuf_write,
+    NULL,           // flush
+    fdbuf_destroy,
+    NULL,
+    fdbuf_peek_mem,
+    fdbuf_consume,
+    fdbuf_unread,
 };
 #endif // OS(LINUX) || OS(UNIX) || OS(DARWIN)
 
@@ -296,6 +356,40 @@ purc_rwstream_t purc_rwstream_new_from_unix_fd (int fd)
 #endif
 }
 
+purc_rwstream_t purc_rwstream_new_from_unix_fd_ex (int fd, size_t sz_buf)
+{
+    if (sz_buf == 0)
+        return purc_rwstream_new_from_unix_fd(fd);
+
+#if OS(LINUX) || OS(UNIX) || OS(DARWIN)
+    if (sz_buf < MIN_BUFFER_SIZE)
+        sz_buf = MIN_BUFFER_SIZE;
+
+    struct fd_rwstream* fd_rws = (struct fd_rwstream*) calloc(
+            1, sizeof(struct fd_rwstream));
+    if (fd_rws == NULL) {
+        pcinst_set_error(PURC_ERROR_OUT_OF_MEMORY);
+        return NULL;
+    }
+
+    fd_rws->rbuf = malloc(sz_buf);
+    if (fd_rws->rbuf == NULL) {
+        free(fd_rws);
+        pcinst_set_error(PURC_ERROR_OUT_OF_MEMORY);
+        return NULL;
+    }
+
+    fd_rws->rwstream.funcs = &fdbuf_funcs;
+    fd_rws->fd = fd;
+    fd_rws->sz_rbuf = sz_buf;
+    return (purc_rwstream_t)fd_rws;
+#else
+    UNUSED_PARAM(fd);
+    pcinst_set_error(PURC_ERROR_NOT_IMPLEMENTED);
+    return NULL;
+#endif
+}
+
 purc_rwstream_t purc_rwstream_new_from_win32_socket (int socket, size_t sz_buf)
 {
     UNUSED_PARAM(socket);
@@ -336,6 +430,9 @@ static rwstream_funcs wo_funcs = {
     wo_write,
     NULL,
     NULL,
+    NULL,
+    NULL,
+    NULL,
     NULL
 };
 
@@ -389,6 +486,9 @@ static rwstream_funcs ro_funcs = {
     NULL,
     NULL,
     NULL,
+    NULL,
+    NULL,
+    NULL,
     NULL
 };
 
@@ -557,6 +657,134 @@ int purc_rwstream_read_utf8_char (purc_rwstream_t rws, char* buf_utf8,
     return ch_len;
 }
 
+ssize_t purc_rwstream_peek (purc_rwstream_t rws, void* buf, size_t count)
+{
+    if (rws == NULL) {
+        pcinst_set_error(PURC_ERROR_INVALID_VALUE);
+        return -1;
+    }
+
+    if (rws->funcs->peek_mem == NULL) {
+        pcinst_set_error(PURC_ERROR_NOT_SUPPORTED);
+        return -1;
+    }
+
+    size_t sz_avail;
+    const uint8_t* p = rws->funcs->peek_mem(rws, count, &sz_avail);
+    if (p == NULL)
+        return -1;
+
+    if (count > sz_avail)
+        count = sz_avail;
+    memcpy(buf, p, count);
+    return count;
+}
+
+int purc_rwstream_unread (purc_rwstream_t rws, const void* buf, size_t count)
+{
+    if (rws == NULL) {
+        pcinst_set_error(PURC_ERROR_INVALID_VALUE);
+        return -1;
+    }
+
+    if (rws->funcs->unread == NULL) {
+        pcinst_set_error(PURC_ERROR_NOT_SUPPORTED);
+        return -1;
+    }
+
+    if (count == 0)
+        return 0;
+    return rws->funcs->unread(rws, buf, count);
+}
+
+/*
+ * Decodes a non-ASCII character at the start of the bytes; the validation
+ * follows purc_rwstream_read_utf8_char(). Returns the length of the
+ * character, 0 if the bytes end within the character, or -1 if the
+ * character is bad.
+ */
+static int decode_utf8_char (const uint8_t* p, size_t len, uint32_t* wc)
+{
+    uint8_t c = p[0];
+    if (c > 0xFD)
+        return -1;
+
+    int ch_len = 1;
+    while (c & (0x80 >> ch_len))
+        ch_len++;
+    if (ch_len < 2 || ch_len > 3)
+        return -1;
+
+    for (int i = 1; i < ch_len; i++) {
+        if ((size_t)i >= len)
+            return 0;
+        if ((p[i] & 0xC0) != 0x80)
+            return -1;
+    }
+
+    size_t nr_chars;
+    if (!pcutils_string_check_utf8_len((const char*)p, ch_len,
+                &nr_chars, NULL))
+        return -1;
+
+    *wc = utf8_to_uint32_t(p, ch_len);
+    return ch_len;
+}
+
+ssize_t purc_rwstream_read_utf8_chars (purc_rwstream_t rws,
+        uint32_t* buf_wc, size_t nr_wcs)
+{
+    if (rws == NULL || buf_wc == NULL) {
+        pcinst_set_error(PURC_ERROR_INVALID_VALUE);
+        return -1;
+    }
+
+    /* Never read more from the underlying file once a character is
+       decoded: the read would block on a pipe or a socket which has no
+       more bytes for now. Without the buffered bytes, we can only tell
+       whether the stream has more for the first character. */
+    if (nr_wcs == 0)
+        return 0;
+
+    char utf8[8];
+    if (rws->funcs->peek_mem == NULL) {
+        int ret = purc_rwstream_read_utf8_char(rws, utf8, buf_wc);
+        return (ret <= 0) ? ret : 1;
+    }
+
+    size_t sz_avail;
+    const uint8_t* p = rws->funcs->peek_mem(rws, 1, &sz_avail);
+    if (p == NULL)
+        return -1;
+
+    size_t n = 0, i = 0;
+    while (n < nr_wcs && i < sz_avail) {
+        if (p[i] < 0x80) {
+            buf_wc[n++] = p[i++];
+            continue;
+        }
+
+        int ch_len = decode_utf8_char(p + i, sz_avail - i, buf_wc + n);
+        if (ch_len <= 0)
+            break;
+        n++;
+        i += ch_len;
+    }
+    rws->funcs->consume(rws, i);
+
+    if (n == 0 && i < sz_avail) {
+        /* the first character is split at the end of the buffered bytes
+           or a bad one; leave it to purc_rwstream_read_utf8_char(), so
+           that the errors are the same */
+        int ret = purc_rwstream_read_utf8_char(rws, utf8, buf_wc);
+        if (ret <= 0)
+            return ret;
+        n++;
+    }
+
+    return n;
+}
+
 ssize_t purc_rwstream_write (purc_rwstream_t rws, const void* buf, size_t count)
 {
     if (rws == NULL) {
@@ -651,6 +879,25 @@ void* purc_rwstream_get_mem_buffer_ex (purc_rwstream_t rws,
     return rws->funcs->get_mem_buffer(rws, sz_content, sz_buffer, res_buff);
 }
 
+const char *pcrwstream_get_unread_mem(purc_rwstream_t rws, size_t *sz)
+{
+    if (rws == NULL)
+        return NULL;
+
+    if (rws->funcs == &mem_funcs) {
+        struct mem_rwstream* mem = (struct mem_rwstream *)rws;
+        *sz = mem->stop - mem->here;
+        return (const char *)mem->here;
+    }
+    else if (rws->funcs == &buffer_funcs) {
+        struct buffer_rwstream* buffer = (struct buffer_rwstream *)rws;
+        *sz = buffer->stop - buffer->here;
+        return (const char *)buffer->here;
+    }
+
+    return NULL;
+}
+
 /* stdio rwstream functions */
 static off_t stdio_seek (purc_rwstream_t rws, off_t offset, int whence)
 {
@@ -802,6 +1049,35 @@ static void* mem_get_mem_buffer (purc_rwstream_t rws,
 }
 
 /* buffer rwstream functions */
+static const uint8_t* mem_peek_mem (purc_rwstream_t rws, size_t sz_min,
+        size_t *sz_avail)
+{
+    UNUSED_PARAM(sz_min);
+    struct mem_rwstream* mem = (struct mem_rwstream *)rws;
+    *sz_avail = mem->stop - mem->here;
+    return mem->here;
+}
+
+static void mem_consume (purc_rwstream_t rws, size_t count)
+{
+    struct mem_rwstream* mem = (struct mem_rwstream *)rws;
+    mem->here += count;
+}
+
+/* The memory may be read-only; only the bytes just read can be unread. */
+static int mem_unread (purc_rwstream_t rws, const void* buf, size_t count)
+{
+    struct mem_rwstream* mem = (struct mem_rwstream *)rws;
+    if ((size_t)(mem->here - mem->base) < count ||
+            memcmp(mem->here - count, buf, count)) {
+        pcinst_set_error(PURC_ERROR_NOT_SUPPORTED);
+        return -1;
+    }
+
+    mem->here -= count;
+    return 0;
+}
+
 static int buffer_extend (struct buffer_rwstream* buffer, size_t size)
 {
     if (buffer->sz > size || buffer->sz == buffer->sz_max) {
@@ -948,6 +1224,34 @@ static void* buffer_get_mem_buffer (purc_rwstream_t rws,
     return buffer->base;
 }
 
+static const uint8_t* buffer_peek_mem (purc_rwstream_t rws, size_t sz_min,
+        size_t *sz_avail)
+{
+    UNUSED_PARAM(sz_min);
+    struct buffer_rwstream* buffer = (struct buffer_rwstream *)rws;
+    *sz_avail = buffer->stop - buffer->here;
+    return buffer->here;
+}
+
+static void buffer_consume (purc_rwstream_t rws, size_t count)
+{
+    struct buffer_rwstream* buffer = (struct buffer_rwstream *)rws;
+    buffer->here += count;
+}
+
+static int buffer_unread (purc_rwstream_t rws, const void* buf, size_t count)
+{
+    struct buffer_rwstream* buffer = (struct buffer_rwstream *)rws;
+    if ((size_t)(buffer->here - buffer->base) < count ||
+            memcmp(buffer->here - count, buf, count)) {
+        pcinst_set_error(PURC_ERROR_NOT_SUPPORTED);
+        return -1;
+    }
+
+    buffer->here -= count;
+    return 0;
+}
+
 #if OS(LINUX) || OS(UNIX) || OS(DARWIN)
 
 static off_t fd_seek (purc_rwstream_t rws, off_t offset, int whence)
@@ -996,4 +1300,207 @@ static int fd_destroy (purc_rwstream_t rws)
     return 0;
 }
 
+/*
+ * The buffered fd rwstream reads ahead up to sz_rbuf bytes with one
+ * read(2) call. The bytes read already are kept in the buffer until it
+ * is refilled, so that they can be unread or sought back to even if the
+ * fd is a pipe or a socket.
+ */
+static ssize_t fdbuf_fill (struct fd_rwstream* fd_rws, size_t sz_min)
+{
+    if (sz_min > fd_rws->sz_rbuf)
+        sz_min = fd_rws->sz_rbuf;
+
+    size_t avail = fd_rws->rlen - fd_rws->rpos;
+    if (avail == 0) {
+        fd_rws->rpos = 0;
+        fd_rws->rlen = 0;
+    }
+    else if (fd_rws->rpos + sz_min > fd_rws->sz_rbuf) {
+        memmove(fd_rws->rbuf, fd_rws->rbuf + fd_rws->rpos, avail);
+        fd_rws->rpos = 0;
+        fd_rws->rlen = avail;
+    }
+
+    while (avail < sz_min) {
+        ssize_t ret = read(fd_rws->fd, fd_rws->rbuf + fd_rws->rlen,
+                fd_rws->sz_rbuf - fd_rws->rlen);
+        if (ret == -1) {
+            if (errno == EINTR)
+                continue;
+            purc_set_error(purc_error_from_errno(errno));
+            return -1;
+        }
+        if (ret == 0)
+            break;
+
+        fd_rws->rlen += ret;
+        avail += ret;
+    }
+
+    return avail;
+}
+
+/* Gives the bytes read ahead back to a seekable fd. */
+static int fdbuf_sync (struct fd_rwstream* fd_rws)
+{
+    size_t avail = fd_rws->rlen - fd_rws->rpos;
+    if (avail > 0 &&
+            lseek(fd_rws->fd, -(off_t)avail, SEEK_CUR) == -1) {
+        return -1;
+    }
+
+    fd_rws->rpos = 0;
+    fd_rws->rlen = 0;
+    return 0;
+}
+
+static off_t fdbuf_seek (purc_rwstream_t rws, off_t offset, int whence)
+{
+    struct fd_rwstream* fd_rws = (struct fd_rwstream *)rws;
+
+    if (whence == SEEK_CUR && offset >= -(off_t)fd_rws->rpos &&
+            offset <= (off_t)(fd_rws->rlen - fd_rws->rpos)) {
+        fd_rws->rpos += offset;
+        fd_rws->consumed += offset;
+        return fdbuf_tell(rws);
+    }
+
+    if (whence == SEEK_CUR)
+        offset -= fd_rws->rlen - fd_rws->rpos;
+
+    off_t ret = lseek(fd_rws->fd, offset, whence);
+    if (ret == -1) {
+        purc_set_error(purc_error_from_errno(errno));
+        return -1;
+    }
+
+    fd_rws->rpos = 0;
+    fd_rws->rlen = 0;
+    fd_rws->consumed = ret;
+    return ret;
+}
+
+static off_t fdbuf_tell (purc_rwstream_t rws)
+{
+    struct fd_rwstream* fd_rws = (struct fd_rwstream *)rws;
+    off_t ret = lseek(fd_rws->fd, 0, SEEK_CUR);
+    if (ret == -1) {
+        if (errno == ESPIPE)
+            return fd_rws->consumed;
+        purc_set_error(purc_error_from_errno(errno));
+        return -1;
+    }
+
+    return ret - (off_t)(fd_rws->rlen - fd_rws->rpos);
+}
+
+static ssize_t fdbuf_read (purc_rwstream_t rws, void* buf, size_t count)
+{
+    struct fd_rwstream* fd_rws = (struct fd_rwstream *)rws;
+    size_t avail = fd_rws->rlen - fd_rws->rpos;
+
+    if (avail == 0) {
+        if (count >= fd_rws->sz_rbuf) {
+            /* no need to copy the bytes through the buffer */
+            ssize_t ret = read(fd_rws->fd, buf, count);
+            if (ret == -1) {
+                purc_set_error(purc_error_from_errno(errno));
+                return -1;
+            }
+            fd_rws->consumed += ret;
+            return ret;
+        }
+
+        ssize_t ret = fdbuf_fill(fd_rws, 1);
+        if (ret <= 0)
+            return ret;
+        avail = ret;
+    }
+
+    if (count > avail)
+        count = avail;
+    memcpy(buf, fd_rws->rbuf + fd_rws->rpos, count);
+    fd_rws->rpos += count;
+    fd_rws->consumed += count;
+    return count;
+}
+
+static ssize_t fdbuf_write (purc_rwstream_t rws, const void* buf,
+        size_t count)
+{
+    struct fd_rwstream* fd_rws = (struct fd_rwstream *)rws;
+
+    /* for a regular file, write at the position read to; the reading and
+       writing of a pipe or a socket are independent */
+    if (fdbuf_sync(fd_rws) && errno != ESPIPE) {
+        purc_set_error(purc_error_from_errno(errno));
+        return -1;
+    }
+
+    ssize_t ret = write(fd_rws->fd, buf, count);
+    if (ret == -1) {
+        purc_set_error(purc_error_from_errno(errno));
+    }
+    return ret;
+}
+
+static int fdbuf_destroy (purc_rwstream_t rws)
+{
+    struct fd_rwstream* fd_rws = (struct fd_rwstream *)rws;
+
+    /* the best effort to leave a seekable fd at the position read to */
+    fdbuf_sync(fd_rws);
+    free(fd_rws->rbuf);
+    free(fd_rws);
+    return 0;
+}
+
+static const uint8_t* fdbuf_peek_mem (purc_rwstream_t rws, size_t sz_min,
+        size_t *sz_avail)
+{
+    struct fd_rwstream* fd_rws = (struct fd_rwstream *)rws;
+    size_t avail = fd_rws->rlen - fd_rws->rpos;
+
+    if (avail == 0 || avail < sz_min) {
+        ssize_t ret = fdbuf_fill(fd_rws, sz_min ? sz_min : 1);
+        if (ret < 0)
+            return NULL;
+        avail = ret;
+    }
+
+    *sz_avail = avail;
+    return fd_rws->rbuf + fd_rws->rpos;
+}
+
+static void fdbuf_consume (purc_rwstream_t rws, size_t count)
+{
+    struct fd_rwstream* fd_rws = (struct fd_rwstream *)rws;
+    fd_rws->rpos += count;
+    fd_rws->consumed += count;
+}
+
+static int fdbuf_unread (purc_rwstream_t rws, const void* buf, size_t count)
+{
+    struct fd_rwstream* fd_rws = (struct fd_rwstream *)rws;
+    size_t avail = fd_rws->rlen - fd_rws->rpos;
+
+    if (count <= fd_rws->rpos) {
+        fd_rws->rpos -= count;
+    }
+    else if (avail + count <= fd_rws->sz_rbuf) {
+        memmove(fd_rws->rbuf + count, fd_rws->rbuf + fd_rws->rpos, avail);
+        fd_rws->rpos = 0;
+        fd_rws->rlen = avail + count;
+    }
+    else {
+        pcinst_set_error(PURC_ERROR_TOO_SMALL_BUFF);
+        return -1;
+    }
+
+    memmove(fd_rws->rbuf + fd_rws->rpos, buf, count);
+    fd_rws->consumed -= count;
+    return 0;
+}
+
 #endif // OS(LINUX) || OS(UNIX) || OS(DARWIN)
@@ -0,0 +1,533 @@
+/*
+ * @file utf8-simd.c
+ * @author
+ * @date 2026/10/16
+ * @brief The SIMD implementation of the UTF-8 validator and transcoders.
+ *
+ * Copyright (C) 2022 FMSoft <https://www.fmsoft.cn>
+ *
+ * This file is a part of PurC (short for Purring Cat), an HVML interpreter.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * The validator uses the lookup algorithm described in
+ * "Validating UTF-8 In Less Than One Instruction Per Byte"
+ * by John Keiser and Daniel Lemire.
+ */
+
+// #undef NDEBUG
+
+#include "config.h"
+
+#include "private/utf8.h"
+#include "private/utils.h"
+
+#include <string.h>
+
+#if HAVE(UTF8_SIMD)
+
+#include <immintrin.h>
+
+static int simd_level = -1;
+
+int pcutils_utf8_simd_level(void)
+{
+    if (UNLIKELY(simd_level < 0)) {
+        int level = PCUTILS_UTF8_SIMD_NONE;
+
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2"))
+            level = PCUTILS_UTF8_SIMD_AVX2;
+        else if (__builtin_cpu_supports("sse4.2"))
+            level = PCUTILS_UTF8_SIMD_SSE42;
+
+        simd_level = level;
+    }
+
+    return simd_level;
+}
+
+int pcutils_utf8_set_simd_level(int level)
+{
+    static int max_level = -1;
+    int old_level = pcutils_utf8_simd_level();
+
+    if (max_level < 0)
+        max_level = old_level;
+
+    if (level < PCUTILS_UTF8_SIMD_NONE)
+        level = PCUTILS_UTF8_SIMD_NONE;
+    else if (level > max_level)
+        level = max_level;
+
+    simd_level = level;
+    return old_level;
+}
+
+/* The error bits looked up by the high and low nibbles of a byte and the
+   high nibble of the byte following it. */
+#define TOO_SHORT       (0x01 << 0)     /* 11______ 0_______ */
+                                        /* 11______ 11______ */
+#define TOO_LONG        (0x01 << 1)     /* 0_______ 10______ */
+#define OVERLONG_3      (0x01 << 2)     /* 11100000 100_____ */
+#define TOO_LARGE       (0x01 << 3)     /* 11110100 1001____ */
+                                        /* 11110100 101_____ */
+                                        /* 11110101 1001____ */
+                                        /* 11110101 101_____ */
+                                        /* 1111011_ 1001____ */
+                                        /* 1111011_ 101_____ */
+                                        /* 11111___ 1001____ */
+                                        /* 11111___ 101_____ */
+#define SURROGATE       (0x01 << 4)     /* 11101101 101_____ */
+#define OVERLONG_2      (0x01 << 5)     /* 1100000_ 10______ */
+#define TOO_LARGE_1000  (0x01 << 6)     /* 11110101 1000____ */
+                                        /* 1111011_ 1000____ */
+                                        /* 11111___ 1000____ */
+#define OVERLONG_4      (0x01 << 6)     /* 11110000 1000____ */
+#define TWO_CONTS       (0x01 << 7)     /* 10______ 10______ */
+
+#define CARRY           (TOO_SHORT | TOO_LONG | TWO_CONTS)
+
+#define BYTE_1_HIGH_TABLE                                               \
+    /* 0_______ ________ */                                             \
+    TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG,                             \
+    TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG,                             \
+    /* 10______ ________ */                                             \
+    TWO_CONTS, TWO_CONTS, TWO_CONTS, TWO_CONTS,                         \
+    /* 1100____ ________ */                                             \
+    TOO_SHORT | OVERLONG_2,                                             \
+    /* 1101____ ________ */                                             \
+    TOO_SHORT,                                                          \
+    /* 1110____ ________ */                                             \
+    TOO_SHORT | OVERLONG_3 | SURROGATE,                                 \
+    /* 1111____ ________ */                                             \
+    TOO_SHORT | TOO_LARGE | TOO_LARGE_1000 | OVERLONG_4
+
+#define BYTE_1_LOW_TABLE                                                \
+    /* ____0000 ________ */                                             \
+    CARRY | OVERLONG_3 | OVERLONG_2 | OVERLONG_4,                       \
+    /* ____0001 ________ */                                             \
+    CARRY | OVERLONG_2,                                                 \
+    /* ____001_ ________ */                                             \
+    CARRY,                                                              \
+    CARRY,                                                              \
+    /* ____0100 ________ */                                             \
+    CARRY | TOO_LARGE,                                                  \
+    /* ____0101 ________ */                                             \
+    CARRY | TOO_LARGE | TOO_LARGE_1000,                                 \
+    /* ____011_ ________ */                                             \
+    CARRY | TOO_LARGE | TOO_LARGE_1000,                                 \
+    CARRY | TOO_LARGE | TOO_LARGE_1000,                                 \
+    /* ____1___ ________ */                                             \
+    CARRY | TOO_LARGE | TOO_LARGE_1000,                                 \
+    CARRY | TOO_LARGE | TOO_LARGE_1000,                                 \
+    CARRY | TOO_LARGE | TOO_LARGE_1000,                                 \
+    CARRY | TOO_LARGE | TOO_LARGE_1000,                                 \
+    CARRY | TOO_LARGE | TOO_LARGE_1000,                                 \
+    /* ____1101 ________ */                                             \
+    CARRY | TOO_LARGE | TOO_LARGE_1000 | SURROGATE,                     \
+    CARRY | TOO_LARGE | TOO_LARGE_1000,                                 \
+    CARRY | TOO_LARGE | TOO_LARGE_1000
+
+#define BYTE_2_HIGH_TABLE                                               \
+    /* ________ 0_______ */                                             \
+    TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT,                         \
+    TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT,                         \
+    /* ________ 1000____ */                                             \
+    TOO_LONG | OVERLONG_2 | TWO_CONTS | OVERLONG_3 | TOO_LARGE_1000 |   \
+        OVERLONG_4,                                                     \
+    /* ________ 1001____ */                                             \
+    TOO_LONG | OVERLONG_2 | TWO_CONTS | OVERLONG_3 | TOO_LARGE,         \
+    /* ________ 101_____ */                                             \
+    TOO_LONG | OVERLONG_2 | TWO_CONTS | SURROGATE | TOO_LARGE,          \
+    TOO_LONG | OVERLONG_2 | TWO_CONTS | SURROGATE | TOO_LARGE,          \
+    /* ________ 11______ */                                             \
+    TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT
+
+/* All bytes before `pos` are valid, but the last character may continue
+   in the block at `pos`; returns the position to restart from. */
+static size_t
+back_to_char_boundary(const char *str, size_t pos, size_t *nr_chars)
+{
+    size_t i = pos;
+
+    while (i > 0 && pos - i < 4) {
+        unsigned char c = (unsigned char)str[--i];
+        if ((c & 0xC0) != 0x80) {
+            /* a bad lead byte is only checked with the byte following it */
+            size_t len = (c < 0x80) ? 1 : (c < 0xE0) ? 2 : (c < 0xF0) ? 3 : 4;
+            if (i + len > pos) {
+                /* the lead byte of an incomplete character was counted */
+                (*nr_chars)--;
+                return i;
+            }
+            break;
+        }
+    }
+
+    return pos;
+}
+
+__attribute__((target("sse4.2")))
+static size_t
+validate_sse42(const char *str, size_t len, size_t *nr_chars)
+{
+    const __m128i tbl_1_high = _mm_setr_epi8(BYTE_1_HIGH_TABLE);
+    const __m128i tbl_1_low = _mm_setr_epi8(BYTE_1_LOW_TABLE);
+    const __m128i tbl_2_high = _mm_setr_epi8(BYTE_2_HIGH_TABLE);
+    const __m128i nibble = _mm_set1_epi8(0x0F);
+    const __m128i zero = _mm_setzero_si128();
+    /* the bytes larger than these ones start an incomplete character */
+    const __m128i max_tail = _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1,
+            -1, -1, -1, -1, -1, (char)0xEF, (char)0xDF, (char)0xBF);
+
+    __m128i prev = zero;
+    __m128i prev_incomplete = zero;
+    size_t pos = 0, n = 0;
+
+    while (pos + 16 <= len) {
+        __m128i in = _mm_loadu_si128((const __m128i *)(str + pos));
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(in, zero)))
+            break;
+
+        if (_mm_movemask_epi8(in) == 0) {
+            /* ASCII only; valid unless the last character is incomplete */
+            if (!_mm_testz_si128(prev_incomplete, prev_incomplete))
+                break;
+
+            n += 16;
+        }
+        else {
+            __m128i prev1 = _mm_alignr_epi8(in, prev, 15);
+            __m128i sc = _mm_and_si128(
+                    _mm_and_si128(
+                        _mm_shuffle_epi8(tbl_1_high, _mm_and_si128(
+                                _mm_srli_epi16(prev1, 4), nibble)),
+                        _mm_shuffle_epi8(tbl_1_low,
+                            _mm_and_si128(prev1, nibble))),
+                    _mm_shuffle_epi8(tbl_2_high, _mm_and_si128(
+                            _mm_srli_epi16(in, 4), nibble)));
+
+            /* the third and fourth bytes must be continuations */
+            __m128i prev2 = _mm_alignr_epi8(in, prev, 14);
+            __m128i prev3 = _mm_alignr_epi8(in, prev, 13);
+            __m128i must23 = _mm_or_si128(
+                    _mm_subs_epu8(prev2, _mm_set1_epi8(0xE0 - 0x80)),
+                    _mm_subs_epu8(prev3, _mm_set1_epi8(0xF0 - 0x80)));
+            must23 = _mm_and_si128(must23, _mm_set1_epi8((char)0x80));
+
+            __m128i error = _mm_xor_si128(must23, sc);
+            if (!_mm_testz_si128(error, error))
+                break;
+
+            /* count the bytes which are not continuations */
+            n += __builtin_popcount(_mm_movemask_epi8(
+                        _mm_cmpgt_epi8(in, _mm_set1_epi8((char)0xBF))));
+        }
+
+        prev_incomplete = _mm_subs_epu8(in, max_tail);
+        prev = in;
+        pos += 16;
+    }
+
+    pos = back_to_char_boundary(str, pos, &n);
+    *nr_chars = n;
+    return pos;
+}
+
+__attribute__((target("avx2")))
+static size_t
+validate_avx2(const char *str, size_t len, size_t *nr_chars)
+{
+    const __m256i tbl_1_high = _mm256_broadcastsi128_si256(
+            _mm_setr_epi8(BYTE_1_HIGH_TABLE));
+    const __m256i tbl_1_low = _mm256_broadcastsi128_si256(
+            _mm_setr_epi8(BYTE_1_LOW_TABLE));
+    const __m256i tbl_2_high = _mm256_broadcastsi128_si256(
+            _mm_setr_epi8(BYTE_2_HIGH_TABLE));
+    const __m256i nibble = _mm256_set1_epi8(0x0F);
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i max_tail = _mm256_setr_epi8(
+            -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+            -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+            (char)0xEF, (char)0xDF, (char)0xBF);
+
+    __m256i prev = zero;
+    __m256i prev_incomplete = zero;
+    size_t pos = 0, n = 0;
+
+    while (pos + 32 <= len) {
+        __m256i in = _mm256_loadu_si256((const __m256i *)(str + pos));
+        if (_mm256_movemask_epi8(_mm256_cmpeq_epi8(in, zero)))
+            break;
+
+        if (_mm256_movemask_epi8(in) == 0) {
+            if (!_mm256_testz_si256(prev_incomplete, prev_incomplete))
+                break;
+
+            n += 32;
+        }
+        else {
+            /* the high lane of `prev` and the low lane of `in` */
+            __m256i shifted = _mm256_permute2x128_si256(prev, in, 0x21);
+            __m256i prev1 = _mm256_alignr_epi8(in, shifted, 15);
+            __m256i sc = _mm256_and_si256(
+                    _mm256_and_si256(
+                        _mm256_shuffle_epi8(tbl_1_high, _mm256_and_si256(
+                                _mm256_srli_epi16(prev1, 4), nibble)),
+                        _mm256_shuffle_epi8(tbl_1_low,
+                            _mm256_and_si256(prev1, nibble))),
+                    _mm256_shuffle_epi8(tbl_2_high, _mm256_and_si256(
+                            _mm256_srli_epi16(in, 4), nibble)));
+
+            __m256i prev2 = _mm256_alignr_epi8(in, shifted, 14);
+            __m256i prev3 = _mm256_alignr_epi8(in, shifted, 13);
+            __m256i must23 = _mm256_or_si256(
+                    _mm256_subs_epu8(prev2, _mm256_set1_epi8(0xE0 - 0x80)),
+                    _mm256_subs_epu8(prev3, _mm256_set1_epi8(0xF0 - 0x80)));
+            must23 = _mm256_and_si256(must23, _mm256_set1_epi8((char)0x80));
+
+            __m256i error = _mm256_xor_si256(must23, sc);
+            if (!_mm256_testz_si256(error, error))
+                break;
+
+            n += __builtin_popcount((unsigned)_mm256_movemask_epi8(
+                        _mm256_cmpgt_epi8(in, _mm256_set1_epi8((char)0xBF))));
+        }
+
+        prev_incomplete = _mm256_subs_epu8(in, max_tail);
+        prev = in;
+        pos += 32;
+    }
+
+    pos = back_to_char_boundary(str, pos, &n);
+    *nr_chars = n;
+    return pos;
+}
+
+size_t pcutils_utf8_validate_simd(const char *str, size_t len,
+        size_t *nr_chars)
+{
+    switch (pcutils_utf8_simd_level()) {
+    case PCUTILS_UTF8_SIMD_AVX2:
+        return validate_avx2(str, len, nr_chars);
+    case PCUTILS_UTF8_SIMD_SSE42:
+        return validate_sse42(str, len, nr_chars);
+    default:
+        break;
+    }
+
+    *nr_chars = 0;
+    return 0;
+}
+
+/* The transcoders only convert runs of ASCII characters; the bandwidth of
+   the stores, not the width of the registers, bounds them, so both SIMD
+   levels use the 128-bit registers. The callers check the SIMD level. */
+
+__attribute__((target("sse4.2")))
+static inline bool
+is_ascii_block(__m128i in)
+{
+    /* a byte with the high bit set or a null byte */
+    return _mm_movemask_epi8(_mm_or_si128(in,
+                _mm_cmpeq_epi8(in, _mm_setzero_si128()))) == 0;
+}
+
+__attribute__((target("sse4.2")))
+size_t pcutils_utf8_ascii_to_utf16_simd(const char *str, size_t len,
+        unsigned char *bytes, bool big_endian)
+{
+    const __m128i zero = _mm_setzero_si128();
+    size_t pos = 0;
+
+    while (pos + 16 <= len) {
+        __m128i in = _mm_loadu_si128((const __m128i *)(str + pos));
+        if (!is_ascii_block(in))
+            break;
+
+        __m128i lo, hi;
+        if (big_endian) {
+            lo = _mm_unpacklo_epi8(zero, in);
+            hi = _mm_unpackhi_epi8(zero, in);
+        }
+        else {
+            lo = _mm_unpacklo_epi8(in, zero);
+            hi = _mm_unpackhi_epi8(in, zero);
+        }
+
+        _mm_storeu_si128((__m128i *)(bytes + pos * 2), lo);
+        _mm_storeu_si128((__m128i *)(bytes + pos * 2 + 16), hi);
+        pos += 16;
+    }
+
+    return pos;
+}
+
+__attribute__((target("sse4.2")))
+size_t pcutils_utf8_ascii_to_utf32_simd(const char *str, size_t len,
+        unsigned char *bytes, bool big_endian)
+{
+    const __m128i zero = _mm_setzero_si128();
+    size_t pos = 0;
+
+    while (pos + 16 <= len) {
+        __m128i in = _mm_loadu_si128((const __m128i *)(str + pos));
+        if (!is_ascii_block(in))
+            break;
+
+        __m128i words[2], dwords[4];
+        if (big_endian) {
+            words[0] = _mm_unpacklo_epi8(zero, in);
+            words[1] = _mm_unpackhi_epi8(zero, in);
+            for (int i = 0; i < 2; i++) {
+                dwords[i * 2] = _mm_unpacklo_epi16(zero, words[i]);
+                dwords[i * 2 + 1] = _mm_unpackhi_epi16(zero, words[i]);
+            }
+        }
+        else {
+            words[0] = _mm_unpacklo_epi8(in, zero);
+            words[1] = _mm_unpackhi_epi8(in, zero);
+            for (int i = 0; i < 2; i++) {
+                dwords[i * 2] = _mm_unpacklo_epi16(words[i], zero);
+                dwords[i * 2 + 1] = _mm_unpackhi_epi16(words[i], zero);
+            }
+        }
+
+        for (int i = 0; i < 4; i++)
+            _mm_storeu_si128((__m128i *)(bytes + pos * 4 + i * 16),
+                    dwords[i]);
+        pos += 16;
+    }
+
+    return pos;
+}
+
+__attribute__((target("sse4.2")))
+size_t pcutils_utf8_ascii_from_utf16_simd(const unsigned char *bytes,
+        size_t nr_units, char *str, bool big_endian)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i non_ascii = _mm_set1_epi16((short)0xFF80);
+    size_t pos = 0;
+
+    while (pos + 8 <= nr_units) {
+        __m128i in = _mm_loadu_si128((const __m128i *)(bytes + pos * 2));
+        if (big_endian)
+            in = _mm_or_si128(_mm_slli_epi16(in, 8), _mm_srli_epi16(in, 8));
+
+        __m128i high = _mm_and_si128(in, non_ascii);
+        if (!_mm_testz_si128(high, high) ||
+                _mm_movemask_epi8(_mm_cmpeq_epi16(in, zero)))
+            break;
+
+        _mm_storel_epi64((__m128i *)(str + pos), _mm_packus_epi16(in, in));
+        pos += 8;
+    }
+
+    return pos;
+}
+
+__attribute__((target("sse4.2")))
+size_t pcutils_utf8_ascii_from_utf32_simd(const unsigned char *bytes,
+        size_t nr_units, char *str, bool big_endian)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i non_ascii = _mm_set1_epi32((int)0xFFFFFF80);
+    const __m128i swap = _mm_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4,
+            11, 10, 9, 8, 15, 14, 13, 12);
+    size_t pos = 0;
+
+    while (pos + 4 <= nr_units) {
+        __m128i in = _mm_loadu_si128((const __m128i *)(bytes + pos * 4));
+        if (big_endian)
+            in = _mm_shuffle_epi8(in, swap);
+
+        __m128i high = _mm_and_si128(in, non_ascii);
+        if (!_mm_testz_si128(high, high) ||
+                _mm_movemask_epi8(_mm_cmpeq_epi32(in, zero)))
+            break;
+
+        __m128i packed = _mm_packus_epi16(_mm_packus_epi32(in, in), zero);
+        uint32_t chars = (uint32_t)_mm_cvtsi128_si32(packed);
+        memcpy(str + pos, &chars, sizeof(chars));
+        pos += 4;
+    }
+
+    return pos;
+}
+
+#else   /* HAVE(UTF8_SIMD) */
+
+int pcutils_utf8_simd_level(void)
+{
+    return PCUTILS_UTF8_SIMD_NONE;
+}
+
+int pcutils_utf8_set_simd_level(int level)
+{
+    UNUSED_PARAM(level);
+    return PCUTILS_UTF8_SIMD_NONE;
+}
+
+size_t pcutils_utf8_validate_simd(const char *str, size_t len,
+        size_t *nr_chars)
+{
+    UNUSED_PARAM(str);
+    UNUSED_PARAM(len);
+    *nr_chars = 0;
+    return 0;
+}
+
+size_t pcutils_utf8_ascii_to_utf16_simd(const char *str, size_t len,
+        unsigned char *bytes, bool big_endian)
+{
+    UNUSED_PARAM(str);
+    UNUSED_PARAM(len);
+    UNUSED_PARAM(bytes);
+    UNUSED_PARAM(big_endian);
+    return 0;
+}
+
+size_t pcutils_utf8_ascii_to_utf32_simd(const char *str, size_t len,
+        unsigned char *bytes, bool big_endian)
+{
+    UNUSED_PARAM(str);
+    UNUSED_PARAM(len);
+    UNUSED_PARAM(bytes);
+    UNUSED_PARAM(big_endian);
+    return 0;
+}
+
+size_t pcutils_utf8_ascii_from_utf16_simd(const unsigned char *bytes,
+        size_t nr_units, char *str, bool big_endian)
+{
+    UNUSED_PARAM(bytes);
+    UNUSED_PARAM(nr_units);
+    UNUSED_PARAM(str);
+    UNUSED_PARAM(big_endian);
+    return 0;
+}
+
+size_t pcutils_utf8_ascii_from_utf32_simd(const unsigned char *bytes,
+        size_t nr_units, char *str, bool big_endian)
+{
+    UNUSED_PARAM(bytes);
+    UNUSED_PARAM(nr_units);
+    UNUSED_PARAM(str);
+    UNUSED_PARAM(big_endian);
+    return 0;
+}
+
+#endif  /* !HAVE(UTF8_SIMD) */
@@ -203,9 +203,19 @@ error:
 bool pcutils_string_check_utf8_len(const char* str, size_t max_len,
         size_t *nr_chars, const char **end)
 {
-    const char *p;
+    const char *p = str;
+    size_t n = 0, m;
+
+#if HAVE(UTF8_SIMD)
+    /* the SIMD validator leaves the tail and the errors to the scalar one */
+    if (max_len >= PCUTILS_UTF8_SIMD_MIN_LEN &&
+            pcutils_utf8_simd_level() != PCUTILS_UTF8_SIMD_NONE)
+        p += pcutils_utf8_validate_simd(str, max_len, &n);
+#endif
 
-    p = fast_validate_len(str, max_len, nr_chars);
+    p = fast_validate_len(p, max_len - (p - str), &m);
+    if (nr_chars)
+        *nr_chars = n + m;
 
     if (end)
         *end = p;
@@ -224,6 +234,13 @@ bool pcutils_string_check_utf8(const char *str, ssize_t max_len,
     if (max_len >= 0)
         return pcutils_string_check_utf8_len(str, max_len, nr_chars, end);
 
+#if HAVE(UTF8_SIMD)
+    if (pcutils_utf8_simd_level() != PCUTILS_UTF8_SIMD_NONE) {
+        /* strlen() is vectorized; the validator stops at the null byte */
+        return pcutils_string_check_utf8_len(str, strlen(str), nr_chars, end);
+    }
+#endif
+
     p = fast_validate(str, nr_chars);
 
     if (end)
@@ -391,6 +408,65 @@ pcutils_utf8_to_unichar(const unsigned char* mchar)
     return uc;
 }
 
+#if HAVE(UTF8_SIMD)
+/* Converts the run of ASCII characters at `p` with SIMD; `unit` is the size
+   of a code unit (2 or 4) in bytes. Returns the number of characters
+   converted. */
+static size_t
+encode_ascii_run(const char *utf8, size_t len, const char *p, size_t nr_chars,
+        unsigned char *bytes, size_t max_bytes, size_t unit, bool big_endian)
+{
+    size_t limit;
+
+    if (*(const unsigned char *)p >= 0x80 || (size_t)(p - utf8) >= len ||
+            pcutils_utf8_simd_level() == PCUTILS_UTF8_SIMD_NONE)
+        return 0;
+
+    limit = len - (p - utf8);
+    if (limit > nr_chars)
+        limit = nr_chars;
+    if (limit > max_bytes / unit)
+        limit = max_bytes / unit;
+    if (limit < 16)
+        return 0;
+
+    if (unit == 2)
+        return pcutils_utf8_ascii_to_utf16_simd(p, limit, bytes, big_endian);
+    return pcutils_utf8_ascii_to_utf32_simd(p, limit, bytes, big_endian);
+}
+
+/* Converts the run of code units in the ASCII range at `bytes` with SIMD,
+   and appends the characters to `mystr`. Returns the number of code units
+   converted, or -1 on failure. */
+static ssize_t
+decode_ascii_run(struct pcutils_mystring *mystr, const unsigned char *bytes,
+        size_t nr_left, size_t unit, bool big_endian)
+{
+    char ascii[256];
+    size_t nr_units = nr_left / unit;
+
+    if (nr_units < 16 ||
+            pcutils_utf8_simd_level() == PCUTILS_UTF8_SIMD_NONE)
+        return 0;
+
+    if (nr_units > sizeof(ascii))
+        nr_units = sizeof(ascii);
+
+    if (unit == 2)
+        nr_units = pcutils_utf8_ascii_from_utf16_simd(bytes, nr_units,
+                ascii, big_endian);
+    else
+        nr_units = pcutils_utf8_ascii_from_utf32_simd(bytes, nr_units,
+                ascii, big_endian);
+
+    if (nr_units && pcutils_mystring_append_mchar(mystr,
+                (const unsigned char *)ascii, nr_units))
+        return -1;
+
+    return nr_units;
+}
+#endif
+
 static char *
 string_decode_utf16(const unsigned char* bytes, size_t max_len,
         size_t *sz_space, size_t *consumed, bool silently, bool le_or_be)
@@ -402,6 +478,18 @@ string_decode_utf16(const unsigned char* bytes, size_t max_len,
 
     *consumed = 0;
     while (nr_left > 1) {
+#if HAVE(UTF8_SIMD)
+        ssize_t nr_ascii = decode_ascii_run(&mystr, bytes + *consumed,
+                nr_left, 2, !le_or_be);
+        if (nr_ascii < 0)
+            goto fatal;
+        else if (nr_ascii > 0) {
+            *consumed += nr_ascii * 2;
+            nr_left -= nr_ascii * 2;
+            continue;
+        }
+#endif
+
         uint16_t w1, w2;
 
         if (le_or_be)
@@ -501,6 +589,18 @@ string_decode_utf32(const unsigned char* bytes, size_t max_len,
 
     *consumed = 0;
     while (nr_left > 3) {
+#if HAVE(UTF8_SIMD)
+        ssize_t nr_ascii = decode_ascii_run(&mystr, bytes + *consumed,
+                nr_left, 4, !le_or_be);
+        if (nr_ascii < 0)
+            goto fatal;
+        else if (nr_ascii > 0) {
+            *consumed += nr_ascii * 4;
+            nr_left -= nr_ascii * 4;
+            continue;
+        }
+#endif
+
         if (le_or_be)
             uc = MAKEDWORD32(bytes[*consumed], bytes[*consumed + 1],
                     bytes[*consumed + 2], bytes[*consumed + 3]);
@@ -615,6 +715,18 @@ pcutils_string_encode_utf16le(const char* utf8, size_t len, size_t nr_chars,
     size_t nr_bytes = 0;
 
     while (nr_chars > 0 && *p) {
+#if HAVE(UTF8_SIMD)
+        size_t nr_ascii = encode_ascii_run(utf8, len, p, nr_chars,
+                bytes, max_bytes - nr_bytes, 2, false);
+        if (nr_ascii > 0) {
+            p += nr_ascii;
+            nr_bytes += nr_ascii * 2;
+            bytes += nr_ascii * 2;
+            nr_chars -= nr_ascii;
+            continue;
+        }
+#endif
+
         uint32_t uc;
         uint16_t w1, w2;
         size_t len;
@@ -677,6 +789,18 @@ pcutils_string_encode_utf32le(const char* utf8, size_t len, size_t nr_chars,
     size_t nr_bytes = 0;
 
     while (nr_chars > 0 && *p) {
+#if HAVE(UTF8_SIMD)
+        size_t nr_ascii = encode_ascii_run(utf8, len, p, nr_chars,
+                bytes, max_bytes - nr_bytes, 4, false);
+        if (nr_ascii > 0) {
+            p += nr_ascii;
+            nr_bytes += nr_ascii * 4;
+            bytes += nr_ascii * 4;
+            nr_chars -= nr_ascii;
+            continue;
+        }
+#endif
+
         uint32_t uc;
 
         uc = pcutils_utf8_to_unichar((const unsigned char *)p);
@@ -719,6 +843,18 @@ pcutils_string_encode_utf16be(const char* utf8, size_t len, size_t nr_chars,
     size_t nr_bytes = 0;
 
     while (nr_chars > 0 && *p) {
+#if HAVE(UTF8_SIMD)
+        size_t nr_ascii = encode_ascii_run(utf8, len, p, nr_chars,
+                bytes, max_bytes - nr_bytes, 2, true);
+        if (nr_ascii > 0) {
+            p += nr_ascii;
+            nr_bytes += nr_ascii * 2;
+            bytes += nr_ascii * 2;
+            nr_chars -= nr_ascii;
+            continue;
+        }
+#endif
+
         uint32_t uc;
         uint16_t w1, w2;
         size_t len;
@@ -781,6 +917,18 @@ pcutils_string_encode_utf32be(const char* utf8, size_t len, size_t nr_chars,
     size_t nr_bytes = 0;
 
     while (nr_chars > 0 && *p) {
+#if HAVE(UTF8_SIMD)
+        size_t nr_ascii = encode_ascii_run(utf8, len, p, nr_chars,
+                bytes, max_bytes - nr_bytes, 4, true);
+        if (nr_ascii > 0) {
+            p += nr_ascii;
+            nr_bytes += nr_ascii * 4;
+            bytes += nr_ascii * 4;
+            nr_chars -= nr_ascii;
+            continue;
+        }
+#endif
+
         uint32_t uc;
 
         uc = pcutils_utf8_to_unichar((const unsigned char *)p);
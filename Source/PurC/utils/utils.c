@@ -214,6 +214,45 @@ size_t pcutils_get_next_fibonacci_number(size_t n)
     return fib_n;
 }
 
+uint64_t pcutils_hash64(const void *data, size_t len, uint64_t seed)
+{
+    const uint64_t m = 0xc6a4a7935bd1e995ULL;
+    const int r = 47;
+    const unsigned char *p = (const unsigned char *)data;
+    const unsigned char *end = p + (len & ~(size_t)7);
+    uint64_t h = seed ^ (len * m);
+
+    while (p != end) {
+        uint64_t k;
+        memcpy(&k, p, sizeof(k));
+        p += sizeof(k);
+
+        k *= m;
+        k ^= k >> r;
+        k *= m;
+
+        h ^= k;
+        h *= m;
+    }
+
+    switch (len & 7) {
+    case 7: h ^= (uint64_t)p[6] << 48;  /* fall through */
+    case 6: h ^= (uint64_t)p[5] << 40;  /* fall through */
+    case 5: h ^= (uint64_t)p[4] << 32;  /* fall through */
+    case 4: h ^= (uint64_t)p[3] << 24;  /* fall through */
+    case 3: h ^= (uint64_t)p[2] << 16;  /* fall through */
+    case 2: h ^= (uint64_t)p[1] << 8;   /* fall through */
+    case 1: h ^= (uint64_t)p[0];
+            h *= m;
+    }
+
+    h ^= h >> r;
+    h *= m;
+    h ^= h >> r;
+
+    return h;
+}
+
 #define MAX_NUMBER_STRING       128
 
 #ifndef MIN
@@ -229,6 +229,8 @@ purc_variant_make_string_ex(const char* str_utf8, size_t len,
     value->flags = 0;
     value->refc = 1;
     value->extra_size = nr_chars;
+    value->str_parent = NULL;
+    value->str_index = NULL;
 
     if (len < sz_bytes) {
         memcpy(value->bytes, str_utf8, len);
@@ -296,6 +298,8 @@ purc_variant_t purc_variant_make_string_reuse_buff(char* str_utf8,
     value->flags = PCVARIANT_FLAG_EXTRA_SIZE;
     value->refc = 1;
     value->extra_size = nr_chars;
+    value->str_parent = NULL;
+    value->str_index = NULL;
 
     value->sz_ptr[1] = (uintptr_t)(str_utf8);
     pcvariant_stat_set_extra_size(value, len);
@@ -333,6 +337,8 @@ purc_variant_t purc_variant_make_string_static(const char* str_utf8,
     value->flags = PCVARIANT_FLAG_STRING_STATIC;
     value->refc = 1;
     value->extra_size = nr_chars;
+    value->str_parent = NULL;
+    value->str_index = NULL;
     value->sz_ptr[0] = (uintptr_t)strlen(str_utf8) + 1;
     value->sz_ptr[1] = (uintptr_t)str_utf8;
 
@@ -410,12 +416,166 @@ bool purc_variant_string_chars(purc_variant_t string, size_t *nr_chars)
     return false;
 }
 
+/* The sparse character index of a long string: `offsets[i]` is the byte
+   offset of the character at `i * PCVAR_STR_INDEX_STEP`. */
+#define PCVAR_STR_INDEX_STEP        64
+#define PCVAR_STR_INDEX_MIN_BYTES   256
+
+struct pcvar_str_index {
+    size_t      nr_marks;
+    size_t      offsets[0];
+};
+
+static struct pcvar_str_index *
+string_char_index(purc_variant_t string, const char *str, size_t len)
+{
+    if (string->str_index)
+        return string->str_index;
+
+    /* a frozen string is shared by instances, and can not be changed */
+    if (pcvariant_is_frozen(string))
+        return NULL;
+
+    size_t nr_marks = string->extra_size / PCVAR_STR_INDEX_STEP + 1;
+    struct pcvar_str_index *index;
+    index = malloc(sizeof(*index) + sizeof(size_t) * nr_marks);
+    if (index == NULL)
+        return NULL;
+
+    const char *p = str;
+    const char *end = str + len;
+    size_t nr_chars = 0;
+
+    index->nr_marks = 0;
+    while (index->nr_marks < nr_marks) {
+        if (nr_chars % PCVAR_STR_INDEX_STEP == 0)
+            index->offsets[index->nr_marks++] = p - str;
+
+        if (p >= end)
+            break;
+        p = pcutils_utf8_next_char(p);
+        nr_chars++;
+    }
+
+    string->str_index = index;
+    return index;
+}
+
+ssize_t
+pcvariant_string_char_offset(purc_variant_t string, size_t char_idx)
+{
+    size_t len;
+    const char *str = purc_variant_get_string_const_ex(string, &len);
+
+    if (str == NULL || !IS_TYPE(string, PURC_VARIANT_TYPE_STRING))
+        return -1;
+
+    size_t nr_chars = string->extra_size;
+    if (char_idx > nr_chars)
+        return -1;
+
+    /* no multi-byte characters */
+    if (len == nr_chars)
+        return char_idx;
+
+    if (char_idx == nr_chars)
+        return len;
+
+    size_t from_char = 0;
+    const char *p = str;
+    if (len >= PCVAR_STR_INDEX_MIN_BYTES) {
+        struct pcvar_str_index *index;
+        index = string_char_index(string, str, len);
+
+        size_t mark = char_idx / PCVAR_STR_INDEX_STEP;
+        if (index && mark < index->nr_marks) {
+            from_char = mark * PCVAR_STR_INDEX_STEP;
+            p = str + index->offsets[mark];
+        }
+    }
+
+    for (size_t n = from_char; n < char_idx; n++)
+        p = pcutils_utf8_next_char(p);
+
+    return p - str;
+}
+
+purc_variant_t
+purc_variant_make_substring(purc_variant_t string, size_t from,
+        size_t nr_chars)
+{
+    static const size_t sz_bytes = MAX(sizeof(long double), sizeof(void*) * 2);
+
+    PCVARIANT_CHECK_FAIL_RET(string, PURC_VARIANT_INVALID);
+
+    if (!IS_TYPE(string, PURC_VARIANT_TYPE_STRING)) {
+        pcinst_set_error(PCVARIANT_ERROR_INVALID_TYPE);
+        return PURC_VARIANT_INVALID;
+    }
+
+    size_t total = string->extra_size;
+    if (from > total) {
+        pcinst_set_error(PCVARIANT_ERROR_OUT_OF_BOUNDS);
+        return PURC_VARIANT_INVALID;
+    }
+
+    if (nr_chars > total - from)
+        nr_chars = total - from;
+
+    if (from == 0 && nr_chars == total)
+        return purc_variant_ref(string);
+
+    size_t len;
+    const char *str = purc_variant_get_string_const_ex(string, &len);
+    size_t start = (size_t)pcvariant_string_char_offset(string, from);
+    size_t end = (size_t)pcvariant_string_char_offset(string,
+            from + nr_chars);
+
+    purc_variant_t value;
+    if (end < len || end - start < sz_bytes) {
+        /* not null-terminated in place or short enough; copy it */
+        value = purc_variant_make_string_ex(str + start, end - start, false);
+        return value;
+    }
+
+    /* a suffix shares the buffer of the string which owns it */
+    purc_variant_t parent = string;
+    if (string->flags & PCVARIANT_FLAG_STRING_SUBSTR)
+        parent = string->str_parent;
+
+    value = pcvariant_get(PURC_VARIANT_TYPE_STRING);
+    if (value == NULL) {
+        pcinst_set_error(PURC_ERROR_OUT_OF_MEMORY);
+        return PURC_VARIANT_INVALID;
+    }
+
+    value->type = PURC_VARIANT_TYPE_STRING;
+    value->flags = PCVARIANT_FLAG_STRING_STATIC | PCVARIANT_FLAG_STRING_SUBSTR;
+    value->refc = 1;
+    value->extra_size = nr_chars;
+    value->str_parent = purc_variant_ref(parent);
+    value->str_index = NULL;
+    value->sz_ptr[0] = (uintptr_t)(end - start) + 1;
+    value->sz_ptr[1] = (uintptr_t)(str + start);
+
+    return value;
+}
+
 void pcvariant_string_release (purc_variant_t string)
 {
     PC_ASSERT(string);
 
     if (IS_TYPE (string, PURC_VARIANT_TYPE_STRING)) {
-        if (string->flags & PCVARIANT_FLAG_EXTRA_SIZE) {
+        if (string->str_index) {
+            free(string->str_index);
+            string->str_index = NULL;
+        }
+
+        if (string->flags & PCVARIANT_FLAG_STRING_SUBSTR) {
+            purc_variant_unref(string->str_parent);
+            string->str_parent = NULL;
+        }
+        else if (string->flags & PCVARIANT_FLAG_EXTRA_SIZE) {
             // VWNOTE: sz_ptr[0] will be set in pcvariant_stat_set_extra_size
             pcvariant_stat_set_extra_size (string, 0);
             free ((void *)string->sz_ptr[1]);
@@ -551,6 +551,10 @@ pcvar_adjust_set_by_descendant(purc_variant_t val)
 
     struct reverse_checker checker = {};
 
+    /* nothing to wind up: do not pay for the two maps */
+    if (!pcvar_container_belongs_to_set(val))
+        return;
+
     bool threads = false;
     checker.input = pcutils_map_create(copy_key, free_key,
             copy_val, free_val, comp_key, threads);
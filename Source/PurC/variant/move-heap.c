@@ -38,6 +38,12 @@
 static struct purc_mutex        mh_lock;
 static struct pcvariant_heap    move_heap;
 
+/* the constants used by frozen variants; they are never released */
+static struct purc_variant      frozen_undefined;
+static struct purc_variant      frozen_null;
+static struct purc_variant      frozen_false;
+static struct purc_variant      frozen_true;
+
 static void mvheap_cleanup_once(void)
 {
     if (mh_lock.native_impl)
@@ -101,6 +107,21 @@ static int mvheap_init_once(void)
     stat->nr_total_values = 4;
     stat->sz_total_mem = 4 * sizeof(purc_variant);
 
+    struct purc_variant *frozen_consts[] = {
+        &frozen_undefined, &frozen_null, &frozen_false, &frozen_true };
+    for (size_t i = 0; i < PCA_TABLESIZE(frozen_consts); i++) {
+        frozen_consts[i]->refc = 1;
+        frozen_consts[i]->flags =
+            PCVARIANT_FLAG_NOFREE | PCVARIANT_FLAG_FROZEN;
+        INIT_LIST_HEAD(&frozen_consts[i]->listeners);
+    }
+    frozen_undefined.type = PURC_VARIANT_TYPE_UNDEFINED;
+    frozen_null.type = PURC_VARIANT_TYPE_NULL;
+    frozen_false.type = PURC_VARIANT_TYPE_BOOLEAN;
+    frozen_false.b = false;
+    frozen_true.type = PURC_VARIANT_TYPE_BOOLEAN;
+    frozen_true.b = true;
+
     stat->nr_reserved = 0;
     stat->nr_max_reserved = 0;  // no need to reserve variants for move heap.
 
@@ -136,6 +157,10 @@ struct pcmodule _module_mvheap = {
 static void
 move_variant_in(struct pcinst *inst, purc_variant_t v)
 {
+    /* frozen variants are always in the move heap */
+    if (pcvariant_is_frozen(v))
+        return;
+
     /* move directly and change the stat info */
 
     if (IS_CONTAINER(v->type) ||
@@ -168,6 +193,9 @@ move_or_clone_immutable(struct pcinst *inst, purc_variant_t v)
     if (IS_CONTAINER(v->type))
         return retv;
 
+    if (pcvariant_is_frozen(v))
+        return v;
+
     if (v == &inst->org_vrt_heap->v_undefined) {
         retv = &move_heap.v_undefined;
         v->refc--;
@@ -188,6 +216,13 @@ move_or_clone_immutable(struct pcinst *inst, purc_variant_t v)
         v->refc--;
         retv->refc++;
     }
+    else if (v->type == PURC_VARIANT_TYPE_STRING &&
+            (v->flags & PCVARIANT_FLAG_STRING_SUBSTR)) {
+        /* the parent of a substring stays in the instance; copy it */
+        size_t len;
+        const char *str = purc_variant_get_string_const_ex(v, &len);
+        retv = purc_variant_make_string_ex(str, len, false);
+    }
     else if (v->refc == 1) {
         PC_DEBUG("Move in variant type %s (%u): %s\n",
                 purc_variant_typename(v->type),
@@ -207,6 +242,8 @@ move_or_clone_immutable(struct pcinst *inst, purc_variant_t v)
         retv = pcvariant_alloc();
         memcpy(retv, v, sizeof(*retv));
         retv->refc = 1;
+        if (v->type == PURC_VARIANT_TYPE_STRING)
+            retv->str_index = NULL;
 
         /* copy the extra space */
         if ((v->type == PURC_VARIANT_TYPE_STRING ||
@@ -443,6 +480,9 @@ move_or_clone_mutable_descendants_in_array(struct travel_context *ctxt,
     foreach_value_in_variant_array(arr, v, idx) {
         purc_variant_t retv;
 
+        if (pcvariant_is_frozen(v))
+            continue;
+
         UNUSED_PARAM(idx);
         switch (v->type) {
         case PURC_VARIANT_TYPE_ARRAY:
@@ -497,6 +537,10 @@ move_or_clone_mutable_descendants_in_object(struct travel_context *ctxt,
     foreach_key_value_in_variant_object(obj, k, v) {
         purc_variant_t retk, retv;
 
+        /* the key of a frozen value is moved in the second pass */
+        if (pcvariant_is_frozen(v))
+            continue;
+
         PC_DEBUG("a key when handling mutable variant: %s (%u)\n",
                 purc_variant_get_string_const(k), (unsigned)v->refc);
 
@@ -568,6 +612,9 @@ move_or_clone_mutable_descendants_in_set(struct travel_context *ctxt,
     foreach_value_in_variant_set(set, v) {
         purc_variant_t retv;
 
+        if (pcvariant_is_frozen(v))
+            continue;
+
         switch (v->type) {
         case PURC_VARIANT_TYPE_ARRAY:
             if (v->refc == 1) {
@@ -627,6 +674,9 @@ move_or_clone_mutable_descendants_in_tuple(struct travel_context *ctxt,
         v = members[idx];
         purc_variant_t retv;
 
+        if (pcvariant_is_frozen(v))
+            continue;
+
         switch (v->type) {
         case PURC_VARIANT_TYPE_ARRAY:
             if (v->refc == 1) {
@@ -713,6 +763,9 @@ move_or_clone_immutable_descendants_in_array(struct travel_context *ctxt,
     foreach_value_in_variant_array(arr, v, idx) {
         purc_variant_t retv;
 
+        if (pcvariant_is_frozen(v))
+            continue;
+
         UNUSED_PARAM(idx);
         switch (v->type) {
         case PURC_VARIANT_TYPE_ARRAY:
@@ -763,6 +816,16 @@ move_or_clone_immutable_descendants_in_object(struct travel_context *ctxt,
     foreach_key_value_in_variant_object(obj, k, v) {
         purc_variant_t retk, retv;
 
+        /* share the frozen value as is, but move in the key */
+        if (pcvariant_is_frozen(v)) {
+            retk = move_or_clone_immutable(ctxt->inst, k);
+            if (retk != k) {
+                _node->key = retk;
+                pcutils_arrlist_append(ctxt->vrts_to_unref, k);
+            }
+            continue;
+        }
+
         switch (v->type) {
         case PURC_VARIANT_TYPE_ARRAY:
             move_or_clone_immutable_descendants_in_array(ctxt, v);
@@ -809,6 +872,9 @@ move_or_clone_immutable_descendants_in_set(struct travel_context *ctxt,
     foreach_value_in_variant_set(set, v) {
         purc_variant_t retv;
 
+        if (pcvariant_is_frozen(v))
+            continue;
+
         switch (v->type) {
         case PURC_VARIANT_TYPE_ARRAY:
             move_or_clone_immutable_descendants_in_array(ctxt, v);
@@ -864,6 +930,9 @@ move_or_clone_immutable_descendants_in_tuple(struct travel_context *ctxt,
         v = members[idx];
         purc_variant_t retv;
 
+        if (pcvariant_is_frozen(v))
+            continue;
+
         switch (v->type) {
         case PURC_VARIANT_TYPE_ARRAY:
             move_or_clone_immutable_descendants_in_array(ctxt, v);
@@ -936,6 +1005,10 @@ purc_variant_t pcvariant_move_heap_in(purc_variant_t v)
     struct pcinst *inst = pcinst_current();
     struct travel_context ctxt;
 
+    /* a frozen variant is shared by reference; no lock is needed */
+    if (pcvariant_is_frozen(v))
+        return v;
+
     ctxt.inst = pcinst_current();
     ctxt.vrts_to_unref = pcutils_arrlist_new(cb_free_element);
     if (ctxt.vrts_to_unref == NULL) {
@@ -1019,6 +1092,9 @@ static purc_variant_t move_array_descendants_out(purc_variant_t arr)
     foreach_value_in_variant_array(arr, v, idx) {
         purc_variant_t retv;
 
+        if (pcvariant_is_frozen(v))
+            continue;
+
         UNUSED_PARAM(idx);
         switch (v->type) {
         case PURC_VARIANT_TYPE_ARRAY:
@@ -1060,6 +1136,11 @@ static purc_variant_t move_object_descendants_out(purc_variant_t obj)
         purc_variant_t retk, retv;
 
         retk = move_variant_out(k);
+        if (pcvariant_is_frozen(v)) {
+            _node->key = retk;
+            continue;
+        }
+
         switch (v->type) {
         case PURC_VARIANT_TYPE_ARRAY:
             retv = move_array_descendants_out(v);
@@ -1100,6 +1181,9 @@ static purc_variant_t move_set_descendants_out(purc_variant_t set)
     foreach_value_in_variant_set(set, v) {
         purc_variant_t retv;
 
+        if (pcvariant_is_frozen(v))
+            continue;
+
         switch (v->type) {
         case PURC_VARIANT_TYPE_ARRAY:
             retv = move_array_descendants_out(v);
@@ -1144,6 +1228,9 @@ static purc_variant_t move_tuple_descendants_out(purc_variant_t tuple)
         v = members[idx];
         purc_variant_t retv;
 
+        if (pcvariant_is_frozen(v))
+            continue;
+
         switch (v->type) {
         case PURC_VARIANT_TYPE_ARRAY:
             retv = move_array_descendants_out(v);
@@ -1180,6 +1267,9 @@ static purc_variant_t move_variant_out(purc_variant_t v)
     purc_variant_t retv = v;
     struct pcinst *inst = pcinst_current();
 
+    if (pcvariant_is_frozen(v))
+        return v;
+
     if (v == &move_heap.v_undefined) {
         retv = &inst->org_vrt_heap->v_undefined;
         v->refc--;
@@ -1260,6 +1350,9 @@ purc_variant_t pcvariant_move_heap_out(purc_variant_t v)
 {
     purc_variant_t retv = PURC_VARIANT_INVALID;
 
+    if (pcvariant_is_frozen(v))
+        return v;
+
     pcvariant_use_move_heap();
     retv = move_variant_out(v);
     pcvariant_use_norm_heap();
@@ -1267,6 +1360,233 @@ purc_variant_t pcvariant_move_heap_out(purc_variant_t v)
     return retv;
 }
 
+static purc_variant_t freeze_variant(purc_variant_t v);
+
+static purc_variant_t freeze_array(purc_variant_t arr)
+{
+    purc_variant_t retv = purc_variant_make_array_0();
+    if (retv == PURC_VARIANT_INVALID)
+        return retv;
+
+    size_t idx;
+    purc_variant_t v;
+    foreach_value_in_variant_array(arr, v, idx) {
+        UNUSED_PARAM(idx);
+
+        purc_variant_t frozen = freeze_variant(v);
+        if (frozen == PURC_VARIANT_INVALID)
+            goto failed;
+
+        bool ok = purc_variant_array_append(retv, frozen);
+        purc_variant_unref(frozen);
+        if (!ok)
+            goto failed;
+    } end_foreach;
+
+    return retv;
+
+failed:
+    purc_variant_unref(retv);
+    return PURC_VARIANT_INVALID;
+}
+
+static purc_variant_t freeze_object(purc_variant_t obj)
+{
+    purc_variant_t retv = purc_variant_make_object_0();
+    if (retv == PURC_VARIANT_INVALID)
+        return retv;
+
+    purc_variant_t k, v;
+    foreach_key_value_in_variant_object(obj, k, v) {
+        purc_variant_t frozen_k = freeze_variant(k);
+        if (frozen_k == PURC_VARIANT_INVALID)
+            goto failed;
+
+        purc_variant_t frozen_v = freeze_variant(v);
+        if (frozen_v == PURC_VARIANT_INVALID) {
+            purc_variant_unref(frozen_k);
+            goto failed;
+        }
+
+        bool ok = purc_variant_object_set(retv, frozen_k, frozen_v);
+        purc_variant_unref(frozen_k);
+        purc_variant_unref(frozen_v);
+        if (!ok)
+            goto failed;
+    } end_foreach;
+
+    return retv;
+
+failed:
+    purc_variant_unref(retv);
+    return PURC_VARIANT_INVALID;
+}
+
+static purc_variant_t freeze_set(purc_variant_t set)
+{
+    variant_set_t data = pcvar_set_get_data(set);
+    purc_variant_t retv = purc_variant_make_set_by_ckey_ex(0,
+            data->unique_key, data->caseless, PURC_VARIANT_INVALID);
+    if (retv == PURC_VARIANT_INVALID)
+        return retv;
+
+    purc_variant_t v;
+    foreach_value_in_variant_set(set, v) {
+        purc_variant_t frozen = freeze_variant(v);
+        if (frozen == PURC_VARIANT_INVALID)
+            goto failed;
+
+        bool ok = purc_variant_set_add(retv, frozen, true);
+        purc_variant_unref(frozen);
+        if (!ok)
+            goto failed;
+    } end_foreach;
+
+    return retv;
+
+failed:
+    purc_variant_unref(retv);
+    return PURC_VARIANT_INVALID;
+}
+
+static purc_variant_t freeze_tuple(purc_variant_t tuple)
+{
+    size_t sz;
+    purc_variant_t *members = tuple_members(tuple, &sz);
+    assert(members);
+
+    purc_variant_t *frozen = calloc(sz ? sz : 1, sizeof(purc_variant_t));
+    if (frozen == NULL) {
+        purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
+        return PURC_VARIANT_INVALID;
+    }
+
+    purc_variant_t retv = PURC_VARIANT_INVALID;
+    size_t idx;
+    for (idx = 0; idx < sz; idx++) {
+        frozen[idx] = freeze_variant(members[idx]);
+        if (frozen[idx] == PURC_VARIANT_INVALID)
+            break;
+    }
+
+    if (idx == sz)
+        retv = purc_variant_make_tuple(sz, frozen);
+
+    for (size_t i = 0; i < idx; i++)
+        purc_variant_unref(frozen[i]);
+    free(frozen);
+    return retv;
+}
+
+/* must be called when the move heap is in use */
+static purc_variant_t freeze_variant(purc_variant_t v)
+{
+    purc_variant_t retv = PURC_VARIANT_INVALID;
+
+    if (pcvariant_is_frozen(v))
+        return purc_variant_ref(v);
+
+    switch (v->type) {
+    case PURC_VARIANT_TYPE_UNDEFINED:
+        return &frozen_undefined;
+
+    case PURC_VARIANT_TYPE_NULL:
+        return &frozen_null;
+
+    case PURC_VARIANT_TYPE_BOOLEAN:
+        return v->b ? &frozen_true : &frozen_false;
+
+    case PURC_VARIANT_TYPE_EXCEPTION:
+        retv = purc_variant_make_exception(v->atom);
+        break;
+
+    case PURC_VARIANT_TYPE_NUMBER:
+        retv = purc_variant_make_number(v->d);
+        break;
+
+    case PURC_VARIANT_TYPE_LONGINT:
+        retv = purc_variant_make_longint(v->i64);
+        break;
+
+    case PURC_VARIANT_TYPE_ULONGINT:
+        retv = purc_variant_make_ulongint(v->u64);
+        break;
+
+    case PURC_VARIANT_TYPE_LONGDOUBLE:
+        retv = purc_variant_make_longdouble(v->ld);
+        break;
+
+    case PURC_VARIANT_TYPE_ATOMSTRING:
+        retv = purc_variant_make_atom(v->atom);
+        break;
+
+    case PURC_VARIANT_TYPE_STRING:
+    {
+        size_t len;
+        const char *str = purc_variant_get_string_const_ex(v, &len);
+        retv = purc_variant_make_string_ex(str, len, false);
+        break;
+    }
+
+    case PURC_VARIANT_TYPE_BSEQUENCE:
+    {
+        size_t nr_bytes;
+        const unsigned char *bytes = purc_variant_get_bytes_const(v,
+                &nr_bytes);
+        retv = purc_variant_make_byte_sequence(bytes, nr_bytes);
+        break;
+    }
+
+    case PURC_VARIANT_TYPE_ARRAY:
+        retv = freeze_array(v);
+        break;
+
+    case PURC_VARIANT_TYPE_OBJECT:
+        retv = freeze_object(v);
+        break;
+
+    case PURC_VARIANT_TYPE_SET:
+        retv = freeze_set(v);
+        break;
+
+    case PURC_VARIANT_TYPE_TUPLE:
+        retv = freeze_tuple(v);
+        break;
+
+    default:
+        /* dynamic and native variants are bound to the instance */
+        purc_set_error(PURC_ERROR_NOT_SUPPORTED);
+        return PURC_VARIANT_INVALID;
+    }
+
+    /* mark it after the descendants were added */
+    if (retv != PURC_VARIANT_INVALID)
+        retv->flags |= PCVARIANT_FLAG_FROZEN;
+    return retv;
+}
+
+purc_variant_t purc_variant_freeze(purc_variant_t v)
+{
+    if (v == PURC_VARIANT_INVALID) {
+        purc_set_error(PURC_ERROR_INVALID_VALUE);
+        return PURC_VARIANT_INVALID;
+    }
+
+    if (pcvariant_is_frozen(v))
+        return purc_variant_ref(v);
+
+    pcvariant_use_move_heap();
+    purc_variant_t retv = freeze_variant(v);
+    pcvariant_use_norm_heap();
+
+    return retv;
+}
+
+bool purc_variant_is_frozen(purc_variant_t v)
+{
+    return v != PURC_VARIANT_INVALID && pcvariant_is_frozen(v);
+}
+
 void pcvariant_use_move_heap(void)
 {
     struct pcinst *inst = pcinst_current();
@@ -76,6 +76,11 @@ purc_variant_register_pre_listener(purc_variant_t v,
         return NULL;
     }
 
+    if (pcvariant_is_frozen(v)) {
+        pcinst_set_error(PURC_ERROR_ACCESS_DENIED);
+        return NULL;
+    }
+
     return register_listener(v, PCVAR_LISTENER_PRE, op, handler, ctxt);
 }
 
@@ -98,6 +103,11 @@ purc_variant_register_post_listener(purc_variant_t v,
         return NULL;
     }
 
+    if (pcvariant_is_frozen(v)) {
+        pcinst_set_error(PURC_ERROR_ACCESS_DENIED);
+        return NULL;
+    }
+
     return register_listener(v, PCVAR_LISTENER_POST, op, handler, ctxt);
 }
 
@@ -143,6 +153,12 @@ bool pcvariant_on_pre_fired(
     op &= PCVAR_OPERATION_ALL;
     PC_ASSERT(op != PCVAR_OPERATION_ALL);
 
+    /* a frozen container may be shared by other instances */
+    if (pcvariant_is_frozen(source)) {
+        pcinst_set_error(PURC_ERROR_ACCESS_DENIED);
+        return false;
+    }
+
     struct list_head *listeners;
     listeners = &source->listeners;
 
@@ -196,6 +212,9 @@ void
 pcvar_break_rue_downward(purc_variant_t val)
 {
     PC_ASSERT(val != PURC_VARIANT_INVALID);
+    if (pcvariant_is_frozen(val))
+        return;
+
     switch (val->type) {
         case PURC_VARIANT_TYPE_ARRAY:
             if (pcvar_container_belongs_to_set(val))
@@ -237,7 +256,7 @@ pcvar_break_edge_to_parent(purc_variant_t val,
         struct pcvar_rev_update_edge *edge)
 {
     PC_ASSERT(val != PURC_VARIANT_INVALID);
-    if (pcvariant_is_mutable(val) == false)
+    if (pcvariant_is_mutable(val) == false || pcvariant_is_frozen(val))
         return;
 
     switch (val->type) {
@@ -262,6 +281,10 @@ int
 pcvar_build_rue_downward(purc_variant_t val)
 {
     PC_ASSERT(val != PURC_VARIANT_INVALID);
+    /* frozen variants never change; no reverse update edges for them */
+    if (pcvariant_is_frozen(val))
+        return 0;
+
     switch (val->type) {
         case PURC_VARIANT_TYPE_ARRAY:
             return pcvar_array_build_rue_downward(val);
@@ -297,7 +320,7 @@ pcvar_build_edge_to_parent(purc_variant_t val,
         struct pcvar_rev_update_edge *edge)
 {
     PC_ASSERT(val != PURC_VARIANT_INVALID);
-    if (pcvariant_is_mutable(val) == false)
+    if (pcvariant_is_mutable(val) == false || pcvariant_is_frozen(val))
         return 0;
 
     switch (val->type) {
@@ -369,3 +392,16 @@ pcvar_container_belongs_to_set(purc_variant_t val)
     }
 }
 
+bool
+pcvar_container_needs_check(purc_variant_t val)
+{
+    PC_ASSERT(val != PURC_VARIANT_INVALID);
+    if (pcvariant_is_frozen(val))
+        return true;
+
+    if (!list_empty(&val->listeners))
+        return true;
+
+    return pcvar_container_belongs_to_set(val);
+}
+
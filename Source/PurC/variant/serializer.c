@@ -56,6 +56,10 @@
 #include <float.h>
 #include <assert.h>
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
 static const char *hex_chars = "0123456789abcdefABCDEF";
 
 #define MY_WRITE(rws, buff, count)                                      \
@@ -96,93 +100,108 @@ static const char *hex_chars = "0123456789abcdefABCDEF";
         }                                                               \
     } while (0)
 
+/*
+ * The escape to use for each byte in a string: 0 for the bytes copied as is,
+ * 'u' for the control characters written as \u00XX, and otherwise the
+ * character following the backslash. The slash is only escaped when
+ * PCVARIANT_SERIALIZE_OPT_NOSLASHESCAPE is not set.
+ */
+static const unsigned char escape_table[256] = {
+    'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u',
+    'b', 't', 'n', 'u', 'f', 'r', 'u', 'u',
+    'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u',
+    'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u',
+    ['"'] = '"',
+    ['/'] = '/',
+    ['\\'] = '\\',
+};
+
+#define SWAR_ONES       UINT64_C(0x0101010101010101)
+#define SWAR_HIGHS      UINT64_C(0x8080808080808080)
+
+/* Non-zero if any byte of x is less than n (n <= 128). */
+#define SWAR_HAS_LESS(x, n)     (((x) - SWAR_ONES * (n)) & ~(x) & SWAR_HIGHS)
+/* Non-zero if any byte of x equals c. */
+#define SWAR_HAS_BYTE(x, c)     SWAR_HAS_LESS((x) ^ (SWAR_ONES * (c)), 1)
+
+/*
+ * Find the end of the run of bytes which can be copied as is. When the
+ * slash should not be escaped, the quote is looked for twice instead.
+ */
+static const char *
+scan_plain_run(const char *p, const char *end, unsigned char slash)
+{
+#if defined(__SSE2__)
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i bslash = _mm_set1_epi8('\\');
+    const __m128i vslash = _mm_set1_epi8((char)slash);
+    /* c < 0x20 (unsigned) <=> (c ^ 0x80) < (0x20 ^ 0x80) (signed) */
+    const __m128i flip = _mm_set1_epi8((char)0x80);
+    const __m128i c0 = _mm_set1_epi8((char)(0x20 ^ 0x80));
+
+    while (end - p >= 16) {
+        __m128i chunk = _mm_loadu_si128((const __m128i *)p);
+        __m128i mask = _mm_or_si128(
+                _mm_or_si128(_mm_cmpeq_epi8(chunk, quote),
+                    _mm_cmpeq_epi8(chunk, bslash)),
+                _mm_or_si128(_mm_cmpeq_epi8(chunk, vslash),
+                    _mm_cmplt_epi8(_mm_xor_si128(chunk, flip), c0)));
+        int bits = _mm_movemask_epi8(mask);
+        if (bits)
+            return p + __builtin_ctz(bits);
+        p += 16;
+    }
+#endif
+
+    while (end - p >= 8) {
+        uint64_t x;
+        memcpy(&x, p, sizeof(x));
+        if (SWAR_HAS_LESS(x, 0x20) || SWAR_HAS_BYTE(x, '"') ||
+                SWAR_HAS_BYTE(x, '\\') || SWAR_HAS_BYTE(x, slash))
+            break;
+        p += 8;
+    }
+
+    while (p < end) {
+        unsigned char c = *p;
+        if (escape_table[c] && (c != '/' || slash == '/'))
+            break;
+        p++;
+    }
+    return p;
+}
+
 static ssize_t
 serialize_string(purc_rwstream_t rws, const char* str,
         size_t len, unsigned int flags, size_t *len_expected)
 {
     int nr_written = 0;
-    size_t pos = 0, start_offset = 0;
-    unsigned char c;
-    char buff[3];
-
-    while (len--) {
-        c = str[pos];
-        switch (c) {
-        case '\b':
-        case '\n':
-        case '\r':
-        case '\t':
-        case '\f':
-        case '"':
-        case '\\':
-        case '/':
-            if ((flags & PCVARIANT_SERIALIZE_OPT_NOSLASHESCAPE) && c == '/') {
-                pos++;
-                break;
-            }
-
-            if (pos - start_offset > 0)
-                MY_WRITE(rws, str + start_offset, pos - start_offset);
-
-            buff[0] = 0;
-            if (c == '\b') {
-                buff[0] = '\\';
-                buff[1] = 'b';
-            }
-            else if (c == '\n') {
-                buff[0] = '\\';
-                buff[1] = 'n';
-            }
-            else if (c == '\r') {
-                buff[0] = '\\';
-                buff[1] = 'r';
-            }
-            else if (c == '\t') {
-                buff[0] = '\\';
-                buff[1] = 't';
-            }
-            else if (c == '\f') {
-                buff[0] = '\\';
-                buff[1] = 'f';
-            }
-            else if (c == '"') {
-                buff[0] = '\\';
-                buff[1] = '\"';
-            }
-            else if (c == '\\') {
-                buff[0] = '\\';
-                buff[1] = '\\';
-            }
-            else if (c == '/') {
-                buff[0] = '\\';
-                buff[1] = '/';
-            }
-
-            if (buff[0])
-                MY_WRITE(rws, buff, 2);
-
-            start_offset = ++pos;
+    const char *end = str + len;
+    unsigned char slash =
+        (flags & PCVARIANT_SERIALIZE_OPT_NOSLASHESCAPE) ? '"' : '/';
+
+    while (str < end) {
+        const char *run_end = scan_plain_run(str, end, slash);
+        if (run_end > str)
+            MY_WRITE(rws, str, run_end - str);
+        if (run_end == end)
             break;
 
-        default:
-            if (c < ' ') {
-                char sbuf[7];
-                if (pos - start_offset > 0)
-                    MY_WRITE(rws, str + start_offset, pos - start_offset);
-
-                if (snprintf(sbuf, sizeof(sbuf), "\\u00%c%c",
-                            hex_chars[c >> 4], hex_chars[c & 0xf]) < 0)
-                    goto failed;
-
-                MY_WRITE(rws, sbuf, sizeof(sbuf) - 1);
-                start_offset = ++pos;
-            }
-            else
-                pos++;
+        unsigned char c = *run_end;
+        char buff[6] = { '\\', (char)escape_table[c] };
+        if (buff[1] == 'u') {
+            buff[2] = '0';
+            buff[3] = '0';
+            buff[4] = hex_chars[c >> 4];
+            buff[5] = hex_chars[c & 0xf];
+            MY_WRITE(rws, buff, 6);
+        }
+        else {
+            MY_WRITE(rws, buff, 2);
         }
+
+        str = run_end + 1;
     }
-    if (pos - start_offset > 0)
-        MY_WRITE(rws, str + start_offset, pos - start_offset);
 
     return nr_written;
 
@@ -405,6 +424,226 @@ static inline UNUSED_FUNCTION bool equal_long_doubles(long double a,
 /* strlen of character literals resolved at compile time */
 #define static_strlen(string_literal) (sizeof(string_literal) - sizeof(""))
 
+/* Write the decimal digits of u backwards, ending at end; returns the start */
+static inline char *u64_to_digits(uint64_t u, char *end)
+{
+    do {
+        *--end = '0' + (char)(u % 10);
+        u /= 10;
+    } while (u);
+    return end;
+}
+
+#if defined(__SIZEOF_INT128__)
+
+typedef unsigned __int128 u128_t;
+
+#define NR_DIGITS_G17       17
+#define MAX_POW5_U64        27
+
+static const uint64_t pow5_u64[MAX_POW5_U64 + 1] = {
+    UINT64_C(1), UINT64_C(5), UINT64_C(25), UINT64_C(125), UINT64_C(625),
+    UINT64_C(3125), UINT64_C(15625), UINT64_C(78125), UINT64_C(390625),
+    UINT64_C(1953125), UINT64_C(9765625), UINT64_C(48828125),
+    UINT64_C(244140625), UINT64_C(1220703125), UINT64_C(6103515625),
+    UINT64_C(30517578125), UINT64_C(152587890625), UINT64_C(762939453125),
+    UINT64_C(3814697265625), UINT64_C(19073486328125),
+    UINT64_C(95367431640625), UINT64_C(476837158203125),
+    UINT64_C(2384185791015625), UINT64_C(11920928955078125),
+    UINT64_C(59604644775390625), UINT64_C(298023223876953125),
+    UINT64_C(1490116119384765625), UINT64_C(7450580596923828125),
+};
+
+/*
+ * Compute the 17 significant decimal digits of m * 2^e (m > 0) exactly as
+ * printf() does: the value scaled by 10^(16 - k) and rounded half to even,
+ * where k is the decimal exponent of the result. Returns false if the
+ * scaled value does not fit in 128 bits, in which case the caller falls
+ * back to snprintf().
+ */
+static bool
+decimal_digits_g17(uint64_t m, int e, int *exp10, uint64_t *digits)
+{
+    static const uint64_t lower = UINT64_C(10000000000000000);
+    static const uint64_t upper = UINT64_C(100000000000000000);
+
+    /* floor(log10(2^(e + bits - 1))); may be one less than the exponent */
+    int bits = 64 - __builtin_clzll(m);
+    int k = (int)(((int64_t)(e + bits - 1) * 78913) >> 18);
+    u128_t q = 0, rem = 0, den = 1;
+
+    for (int i = 0; i < 3; i++) {
+        int s = NR_DIGITS_G17 - 1 - k;
+
+        if (s >= 0) {
+            /* m * 2^e * 10^s = m * 5^s * 2^(e + s) */
+            if (s > MAX_POW5_U64)
+                return false;
+
+            u128_t p = (u128_t)m * pow5_u64[s];
+            int t = e + s;
+            if (t >= 0) {
+                if (t >= 64 || (p >> (127 - t)))
+                    return false;
+                q = p << t;
+                rem = 0;
+                den = 1;
+            }
+            else {
+                if (-t >= 127)
+                    return false;
+                den = (u128_t)1 << -t;
+                q = p >> -t;
+                rem = p & (den - 1);
+            }
+        }
+        else {
+            /* m * 2^e / 10^u = m * 2^(e - u) / 5^u */
+            int u = -s;
+            int t = e - u;
+            if (u > MAX_POW5_U64 || t >= 64 || -t >= 64)
+                return false;
+
+            u128_t num = m;
+            den = pow5_u64[u];
+            if (t >= 0)
+                num <<= t;
+            else
+                den <<= -t;
+            q = num / den;
+            rem = num % den;
+        }
+
+        if (q < lower)
+            k--;
+        else if (q >= upper)
+            k++;
+        else
+            break;
+    }
+
+    if (q < lower || q >= upper)
+        return false;
+
+    /* round half to even */
+    if (rem && (rem > den - rem || (rem == den - rem && (q & 1)))) {
+        q++;
+        if (q == upper) {
+            q = lower;
+            k++;
+        }
+    }
+
+    *exp10 = k;
+    *digits = (uint64_t)q;
+    return true;
+}
+
+/*
+ * Lay out the digits in the style of "%.17g": trailing zeros dropped, fixed
+ * notation for the exponents in [-4, 17) and scientific notation with at
+ * least two exponent digits otherwise. Returns the length of the result.
+ */
+static int
+format_digits_g17(char *buf, bool negative, int k, uint64_t digits)
+{
+    char tmp[NR_DIGITS_G17];
+    char *d = tmp;
+    char *p = buf;
+    int nd = NR_DIGITS_G17;
+
+    u64_to_digits(digits, tmp + NR_DIGITS_G17);
+    while (nd > 1 && tmp[nd - 1] == '0')
+        nd--;
+
+    if (negative)
+        *p++ = '-';
+
+    if (k >= NR_DIGITS_G17 || k < -4) {
+        *p++ = *d;
+        if (nd > 1) {
+            *p++ = '.';
+            memcpy(p, d + 1, nd - 1);
+            p += nd - 1;
+        }
+        *p++ = 'e';
+        *p++ = (k < 0) ? '-' : '+';
+        if (k < 0)
+            k = -k;
+        if (k < 10)
+            *p++ = '0';
+        char *start = u64_to_digits(k, p + 4);
+        memmove(p, start, p + 4 - start);
+        p += p + 4 - start;
+    }
+    else if (k >= 0) {
+        memcpy(p, d, k + 1);
+        p += k + 1;
+        if (nd > k + 1) {
+            *p++ = '.';
+            memcpy(p, d + k + 1, nd - k - 1);
+            p += nd - k - 1;
+        }
+    }
+    else {
+        *p++ = '0';
+        *p++ = '.';
+        for (int i = -1; i > k; i--)
+            *p++ = '0';
+        memcpy(p, d, nd);
+        p += nd;
+    }
+
+    *p = 0;
+    return p - buf;
+}
+
+/*
+ * Format a double like snprintf(buf, sz, "%.17g", d) does, but without
+ * going through the multi-precision code of the C library for the common
+ * magnitudes. Returns -1 if the value is not handled here.
+ */
+static int format_double_g17(char *buf, double d)
+{
+    if (!isnormal(d))
+        return -1;
+
+    int exp2;
+    double f = frexp(fabs(d), &exp2);
+    uint64_t m = (uint64_t)ldexp(f, DBL_MANT_DIG);
+    int k;
+    uint64_t digits;
+
+    if (!decimal_digits_g17(m, exp2 - DBL_MANT_DIG, &k, &digits))
+        return -1;
+    return format_digits_g17(buf, signbit(d), k, digits);
+}
+
+#if LDBL_MANT_DIG <= 64
+static int format_long_double_g17(char *buf, long double ld)
+{
+    if (!isnormal(ld))
+        return -1;
+
+    int exp2;
+    long double f = frexpl(fabsl(ld), &exp2);
+    uint64_t m = (uint64_t)ldexpl(f, LDBL_MANT_DIG);
+    int k;
+    uint64_t digits;
+
+    if (!decimal_digits_g17(m, exp2 - LDBL_MANT_DIG, &k, &digits))
+        return -1;
+    return format_digits_g17(buf, signbit(ld), k, digits);
+}
+#else
+#define format_long_double_g17(buf, ld)     (-1)
+#endif
+
+#else /* defined(__SIZEOF_INT128__) */
+#define format_double_g17(buf, d)           (-1)
+#define format_long_double_g17(buf, ld)     (-1)
+#endif /* !defined(__SIZEOF_INT128__) */
+
 static ssize_t
 serialize_number(purc_rwstream_t rws, double d, size_t *len_expected)
 {
@@ -430,6 +669,22 @@ serialize_number(purc_rwstream_t rws, double d, size_t *len_expected)
             size = static_strlen("-Infinity");
         }
     }
+    else if (fabs(d) < 0x1p63) {
+        /* The same test as below without the round trip through text:
+         * for such magnitudes, "%.0f" prints nearbyint(d) exactly. */
+        double r = nearbyint(d);
+        if (!equal_doubles(r, d))
+            return 0;
+
+        char *p = u64_to_digits((uint64_t)fabs(r), buf + sizeof(buf));
+        if (signbit(r))
+            *--p = '-';
+        size = buf + sizeof(buf) - p;
+
+        if (len_expected)
+            *len_expected += size;
+        return purc_rwstream_write(rws, p, size);
+    }
     else {
         double test;
 
@@ -465,13 +720,19 @@ serialize_double(purc_rwstream_t rws, double d, int flags,
 
     if (!format) {
         format = std_format;
+        size = format_double_g17(buf, d);
+    }
+    else {
+        size = -1;
     }
 
-    size = snprintf(buf, sizeof(buf), format, d);
-    // although unlikely, snprintf might fail
-    if (UNLIKELY(size < 0)) {
-        pcinst_set_error(PURC_ERROR_OUTPUT);
-        return -1;
+    if (size < 0) {
+        size = snprintf(buf, sizeof(buf), format, d);
+        // although unlikely, snprintf might fail
+        if (UNLIKELY(size < 0)) {
+            pcinst_set_error(PURC_ERROR_OUTPUT);
+            return -1;
+        }
     }
 
     p = strchr(buf, ',');
@@ -493,7 +754,7 @@ serialize_double(purc_rwstream_t rws, double d, int flags,
             format_drops_decimals) {
         // Ensure it looks like a float, even if snprintf didn't,
         // unless a custom format is set to omit the decimal.
-        strcat(buf, ".0");
+        memcpy(buf + size, ".0", sizeof(".0"));
         size += 2;
     }
 
@@ -545,9 +806,14 @@ serialize_long_double(purc_rwstream_t rws, long double ld, int flags,
         static const char *std_format = "%.17Lg";
         if (!format) {
             format = std_format;
+            size = format_long_double_g17(buf, ld);
+        }
+        else {
+            size = -1;
         }
 
-        size = snprintf(buf, sizeof(buf) - 2, format, ld);
+        if (size < 0)
+            size = snprintf(buf, sizeof(buf) - 2, format, ld);
         if (UNLIKELY(size < 0)) {
             pcinst_set_error(PURC_ERROR_OUTPUT);
             return -1;
@@ -581,7 +847,7 @@ serialize_long_double(purc_rwstream_t rws, long double ld, int flags,
 
         // append FL postfix
         if (flags & PCVARIANT_SERIALIZE_OPT_REAL_EJSON) {
-            strcat(buf, "FL");
+            memcpy(buf + size, "FL", sizeof("FL"));
             size += 2;
         }
     }
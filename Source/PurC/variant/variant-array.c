@@ -285,9 +285,15 @@ variant_arr_insert_before(purc_variant_t arr, size_t idx, purc_variant_t val,
     if (idx > nr)
         idx = nr;
 
-    purc_variant_t pos = variant_arr_make_pos(data, idx);
-    if (pos == PURC_VARIANT_INVALID)
-        return -1;
+    if (check)
+        check = pcvar_container_needs_check(arr);
+
+    purc_variant_t pos = PURC_VARIANT_INVALID;
+    if (check) {
+        pos = variant_arr_make_pos(data, idx);
+        if (pos == PURC_VARIANT_INVALID)
+            return -1;
+    }
 
     struct arr_node *node = NULL;
 
@@ -322,13 +328,13 @@ variant_arr_insert_before(purc_variant_t arr, size_t idx, purc_variant_t val,
             grown(arr, pos, val, check);
         }
 
-        purc_variant_unref(pos);
+        PURC_VARIANT_SAFE_CLEAR(pos);
 
         return 0;
     } while (0);
 
     arr_node_destroy(arr, node);
-    purc_variant_unref(pos);
+    PURC_VARIANT_SAFE_CLEAR(pos);
 
     return -1;
 }
@@ -336,6 +342,9 @@ variant_arr_insert_before(purc_variant_t arr, size_t idx, purc_variant_t val,
 static void
 refresh_extra(purc_variant_t arr)
 {
+    if (pcvariant_is_frozen(arr))
+        return;
+
     size_t extra = 0;
     variant_arr_t data = pcvar_arr_get_data(arr);
     if (data) {
@@ -450,9 +459,15 @@ variant_arr_set(purc_variant_t arr, size_t idx, purc_variant_t val,
         return 0;
     }
 
-    purc_variant_t pos = variant_arr_make_pos(data, idx);
-    if (pos == PURC_VARIANT_INVALID)
-        return -1;
+    if (check)
+        check = pcvar_container_needs_check(arr);
+
+    purc_variant_t pos = PURC_VARIANT_INVALID;
+    if (check) {
+        pos = variant_arr_make_pos(data, idx);
+        if (pos == PURC_VARIANT_INVALID)
+            return -1;
+    }
 
     do {
         purc_variant_t old = old_node->val;
@@ -485,12 +500,12 @@ variant_arr_set(purc_variant_t arr, size_t idx, purc_variant_t val,
         }
 
         purc_variant_unref(old);
-        purc_variant_unref(pos);
+        PURC_VARIANT_SAFE_CLEAR(pos);
 
         return 0;
     } while (0);
 
-    purc_variant_unref(pos);
+    PURC_VARIANT_SAFE_CLEAR(pos);
 
     return -1;
 }
@@ -555,9 +570,15 @@ variant_arr_remove(purc_variant_t arr, size_t idx,
         return 0;
     }
 
-    purc_variant_t pos = variant_arr_make_pos(data, idx);
-    if (pos == PURC_VARIANT_INVALID)
-        return -1;
+    if (check)
+        check = pcvar_container_needs_check(arr);
+
+    purc_variant_t pos = PURC_VARIANT_INVALID;
+    if (check) {
+        pos = variant_arr_make_pos(data, idx);
+        if (pos == PURC_VARIANT_INVALID)
+            return -1;
+    }
 
     struct pcutils_array_list_node *p, *n;
     p = pcutils_array_list_get(al, idx);
@@ -591,12 +612,12 @@ variant_arr_remove(purc_variant_t arr, size_t idx,
         }
 
         arr_node_destroy(arr, node);
-        purc_variant_unref(pos);
+        PURC_VARIANT_SAFE_CLEAR(pos);
 
         return 0;
     } while (0);
 
-    purc_variant_unref(pos);
+    PURC_VARIANT_SAFE_CLEAR(pos);
 
     return -1;
 }
@@ -752,6 +773,41 @@ purc_variant_t purc_variant_make_array (size_t sz, purc_variant_t value0, ...)
     return v;
 }
 
+purc_variant_t
+purc_variant_make_array_from(size_t sz, purc_variant_t *values)
+{
+    PCVARIANT_CHECK_FAIL_RET(sz == 0 || values, PURC_VARIANT_INVALID);
+
+    purc_variant_t var = make_array(sz);
+    if (!var)
+        return PURC_VARIANT_INVALID;
+
+    /* nobody can observe the array before it is returned:
+       no listener to fire, no set to adjust. */
+    bool check = false;
+    size_t i;
+    for (i = 0; i < sz; i++) {
+        if (!values[i]) {
+            pcinst_set_error(PURC_ERROR_INVALID_VALUE);
+            break;
+        }
+
+        struct pcutils_array_list *al = &pcvar_arr_get_data(var)->al;
+        size_t nr = pcutils_array_list_length(al);
+        if (variant_arr_insert_before(var, nr, values[i], check))
+            break;
+    }
+
+    if (i < sz) {
+        array_release(var);
+        pcvariant_put(var);
+        return PURC_VARIANT_INVALID;
+    }
+
+    refresh_extra(var);
+    return var;
+}
+
 void pcvariant_array_release (purc_variant_t value)
 {
     array_release(value);
@@ -880,18 +936,10 @@ sort_cmp(struct pcutils_array_list_node *l, struct pcutils_array_list_node *r,
     return d->cmp(l_n->val, r_n->val, d->ud);
 }
 
-static int vrtcmp(purc_variant_t l, purc_variant_t r, void *ud)
+static purc_variant_t
+node_member(struct pcutils_array_list_node *node)
 {
-    uintptr_t sort_flags;
-    purc_vrtcmp_opt_t cmpopt;
-
-    sort_flags = (uintptr_t)ud;
-    cmpopt = (purc_vrtcmp_opt_t)(sort_flags & PCVARIANT_CMPOPT_MASK);
-
-    int retv = purc_variant_compare_ex(l, r, cmpopt);
-    if (sort_flags & PCVARIANT_SORT_DESC)
-        retv = -retv;
-    return retv;
+    return container_of(node, struct arr_node, node)->val;
 }
 
 int pcvariant_array_sort(purc_variant_t arr, void *ud,
@@ -900,6 +948,17 @@ int pcvariant_array_sort(purc_variant_t arr, void *ud,
     if (!arr || arr->type != PURC_VARIANT_TYPE_ARRAY)
         return -1;
 
+    if (pcvariant_is_frozen(arr)) {
+        pcinst_set_error(PURC_ERROR_ACCESS_DENIED);
+        return -1;
+    }
+
+    /* use the keys extracted once for the default comparison */
+    if (cmp == NULL) {
+        return pcvariant_array_sort_by_keys(arr, 1, ud,
+                pcvar_sort_decorate_by_flags, pcvar_sort_keycmp_by_flags);
+    }
+
     variant_arr_t data = pcvar_arr_get_data(arr);
 
     struct arr_user_data d = {
@@ -907,15 +966,36 @@ int pcvariant_array_sort(purc_variant_t arr, void *ud,
         .ud  = ud,
     };
 
-    if (d.cmp == NULL) {
-        d.cmp = vrtcmp;
-    }
-
     pcutils_array_list_sort(&data->al, &d, sort_cmp);
 
     return 0;
 }
 
+int pcvariant_array_sort_by_keys(purc_variant_t arr, size_t nr_keys,
+        void *ud, pcvariant_sort_decorate_f decorate,
+        pcvariant_sort_keycmp_f cmp)
+{
+    if (!arr || arr->type != PURC_VARIANT_TYPE_ARRAY)
+        return -1;
+
+    if (pcvariant_is_frozen(arr)) {
+        pcinst_set_error(PURC_ERROR_ACCESS_DENIED);
+        return -1;
+    }
+
+    variant_arr_t data = pcvar_arr_get_data(arr);
+
+    struct pcvar_sort_args args = {
+        .nr_keys  = nr_keys,
+        .ud       = ud,
+        .decorate = decorate,
+        .cmp      = cmp,
+        .member   = node_member,
+    };
+
+    return pcvar_sort_by_keys(&data->al, &args);
+}
+
 purc_variant_t
 pcvariant_array_clone(purc_variant_t arr, bool recursively)
 {
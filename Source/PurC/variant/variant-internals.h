@@ -73,6 +73,26 @@ void pcvariant_set_release     (purc_variant_t value)    WTF_INTERNAL;
 void pcvariant_tuple_release   (purc_variant_t value)    WTF_INTERNAL;
 void pcvariant_sorted_array_release (purc_variant_t value)    WTF_INTERNAL;
 
+/* the arguments of pcvar_sort_by_keys() */
+struct pcvar_sort_args {
+    size_t                      nr_keys;
+    void                       *ud;
+    pcvariant_sort_decorate_f   decorate;
+    pcvariant_sort_keycmp_f     cmp;
+    /* gets the member held by an array list node */
+    purc_variant_t (*member)(struct pcutils_array_list_node *node);
+};
+
+// for sorting the members of an array or a set by keys
+int pcvar_sort_by_keys(struct pcutils_array_list *al,
+        struct pcvar_sort_args *args) WTF_INTERNAL;
+
+// the sort keys for the flags PCVARIANT_SORT_XXX | PCVARIANT_COMPARE_OPT_XXX
+int pcvar_sort_decorate_by_flags(purc_variant_t member,
+        struct pcvariant_sort_key *keys, void *ud) WTF_INTERNAL;
+int pcvar_sort_keycmp_by_flags(const struct pcvariant_sort_key *l,
+        const struct pcvariant_sort_key *r, void *ud) WTF_INTERNAL;
+
 variant_arr_t
 pcvar_arr_get_data(purc_variant_t arr) WTF_INTERNAL;
 variant_obj_t
@@ -101,6 +121,11 @@ pcvar_reverse_check(purc_variant_t old, purc_variant_t _new) WTF_INTERNAL;
 bool
 pcvar_container_belongs_to_set(purc_variant_t val) WTF_INTERNAL;
 
+// true if mutating the container has to go through listeners, the
+// frozen guard or the reverse-update of its parent sets
+bool
+pcvar_container_needs_check(purc_variant_t val) WTF_INTERNAL;
+
 purc_variant_t
 pcvariant_container_clone(purc_variant_t cntr, bool recursively) WTF_INTERNAL;
 
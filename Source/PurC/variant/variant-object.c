@@ -26,6 +26,7 @@
 #include "config.h"
 #include "private/variant.h"
 #include "private/errors.h"
+#include "private/hashtable.h"
 #include "purc-errors.h"
 #include "variant-internals.h"
 
@@ -36,7 +37,11 @@
 #include <string.h>
 
 #define OBJ_EXTRA_SIZE(data) (sizeof(*data) + \
-        (data->size) * sizeof(struct obj_node))
+        (data->size) * sizeof(struct obj_node) + \
+        (data->sz_index) * sizeof(struct obj_node *))
+
+/* the objects with more members than this get a hash index of the keys */
+#define OBJ_INDEX_THRESHOLD     8
 
 static inline bool
 grow(purc_variant_t obj, purc_variant_t key, purc_variant_t val,
@@ -127,6 +132,165 @@ pcvar_obj_get_data(purc_variant_t obj)
     return data;
 }
 
+static inline uint32_t
+key_hash(const char *key)
+{
+    return (uint32_t)pchash_default_char_hash(key);
+}
+
+static void
+index_put(struct obj_node **index, size_t sz_index, struct obj_node *node)
+{
+    size_t mask = sz_index - 1;
+    size_t i = node->hash & mask;
+    while (index[i])
+        i = (i + 1) & mask;
+    index[i] = node;
+}
+
+/* (Re)builds the index with the given number of slots; false on failure */
+static bool
+index_rebuild(variant_obj_t data, size_t sz_index)
+{
+    struct obj_node **index;
+    index = (struct obj_node **)calloc(sz_index, sizeof(*index));
+    if (!index)
+        return false;
+
+    struct rb_node *p = pcutils_rbtree_first(&data->kvs);
+    for (; p; p = pcutils_rbtree_next(p)) {
+        index_put(index, sz_index, container_of(p, struct obj_node, node));
+    }
+
+    free(data->index);
+    data->index = index;
+    data->sz_index = sz_index;
+    return true;
+}
+
+/* Called after the node was linked into the tree. */
+static void
+index_insert(variant_obj_t data, struct obj_node *node)
+{
+    if (data->index && data->size * 2 <= data->sz_index) {
+        index_put(data->index, data->sz_index, node);
+        return;
+    }
+
+    if (data->size <= OBJ_INDEX_THRESHOLD)
+        return;
+
+    size_t sz_index = data->sz_index ? data->sz_index : 16;
+    while (data->size * 2 > sz_index)
+        sz_index <<= 1;
+
+    if (!index_rebuild(data, sz_index)) {
+        /* lookups fall back to the tree */
+        free(data->index);
+        data->index = NULL;
+        data->sz_index = 0;
+    }
+}
+
+static void
+index_remove(variant_obj_t data, struct obj_node *node)
+{
+    if (!data->index)
+        return;
+
+    size_t mask = data->sz_index - 1;
+    size_t i = node->hash & mask;
+    while (data->index[i] != node) {
+        PC_ASSERT(data->index[i]);
+        i = (i + 1) & mask;
+    }
+
+    /* backward-shift deletion: no tombstones */
+    size_t j = i;
+    for (;;) {
+        j = (j + 1) & mask;
+        struct obj_node *p = data->index[j];
+        if (!p)
+            break;
+
+        size_t home = p->hash & mask;
+        if (((j - home) & mask) >= ((j - i) & mask)) {
+            data->index[i] = p;
+            i = j;
+        }
+    }
+    data->index[i] = NULL;
+}
+
+static struct obj_node *
+index_find(variant_obj_t data, const char *key, uint32_t hash)
+{
+    size_t mask = data->sz_index - 1;
+    size_t i = hash & mask;
+    struct obj_node *p;
+    while ((p = data->index[i])) {
+        if (p->hash == hash &&
+                strcmp(purc_variant_get_string_const(p->key), key) == 0)
+            return p;
+        i = (i + 1) & mask;
+    }
+    return NULL;
+}
+
+/*
+ * Looks the key up in the tree. If not found and pparent and ppnode are
+ * given, they are set to the place where a node with the key would be
+ * linked.
+ */
+static struct obj_node *
+tree_find(variant_obj_t data, const char *key,
+        struct rb_node **pparent, struct rb_node ***ppnode)
+{
+    struct rb_node **pnode = &data->kvs.rb_node;
+    struct rb_node *parent = NULL;
+    while (*pnode) {
+        struct obj_node *node;
+        node = container_of(*pnode, struct obj_node, node);
+        const char *sk = purc_variant_get_string_const(node->key);
+        int ret = strcmp(key, sk);
+
+        parent = *pnode;
+
+        if (ret < 0)
+            pnode = &parent->rb_left;
+        else if (ret > 0)
+            pnode = &parent->rb_right;
+        else
+            return node;
+    }
+
+    if (pparent) {
+        *pparent = parent;
+        *ppnode = pnode;
+    }
+    return NULL;
+}
+
+static inline struct obj_node *
+find_node(variant_obj_t data, const char *key)
+{
+    if (data->index)
+        return index_find(data, key, key_hash(key));
+    return tree_find(data, key, NULL, NULL);
+}
+
+static void
+unlink_node(variant_obj_t data, struct obj_node *node)
+{
+    struct rb_root *root = &data->kvs;
+    PC_ASSERT(&node->node == root->rb_node || node->node.rb_parent);
+
+    index_remove(data, node);
+    --data->size;
+    pcutils_rbtree_erase(&node->node, root);
+    node->node.rb_parent = NULL;
+}
+
 static purc_variant_t v_object_new_with_capacity(void)
 {
     purc_variant_t var = pcvariant_get(PVT(_OBJECT));
@@ -183,9 +347,7 @@ obj_node_release(purc_variant_t obj, struct obj_node *node)
 
     struct rb_root *root = &data->kvs;
     if (&node->node == root->rb_node || node->node.rb_parent) {
-        --data->size;
-        pcutils_rbtree_erase(&node->node, root);
-        node->node.rb_parent = NULL;
+        unlink_node(data, node);
     }
 
     PURC_VARIANT_SAFE_CLEAR(node->key);
@@ -220,6 +382,7 @@ obj_node_create(purc_variant_t k, purc_variant_t v)
 
     node->key = purc_variant_ref(k);
     node->val = purc_variant_ref(v);
+    node->hash = key_hash(purc_variant_get_string_const(k));
 
     return node;
 }
@@ -295,29 +458,9 @@ v_object_remove(purc_variant_t obj, const char *key, bool silently,
         bool check)
 {
     variant_obj_t data = pcvar_obj_get_data(obj);
-    struct rb_root *root = &data->kvs;
-    struct rb_node **pnode = &root->rb_node;
-    struct rb_node *parent = NULL;
-    struct rb_node *entry = NULL;
-    while (*pnode) {
-        struct obj_node *node;
-        node = container_of(*pnode, struct obj_node, node);
-        const char *sk = purc_variant_get_string_const(node->key);
-        int ret = strcmp(key, sk);
-
-        parent = *pnode;
-
-        if (ret < 0)
-            pnode = &parent->rb_left;
-        else if (ret > 0)
-            pnode = &parent->rb_right;
-        else{
-            entry = *pnode;
-            break;
-        }
-    }
+    struct obj_node *node = find_node(data, key);
 
-    if (!entry) {
+    if (!node) {
         if (silently)
             return 0;
 
@@ -325,11 +468,12 @@ v_object_remove(purc_variant_t obj, const char *key, bool silently,
         return -1;
     }
 
-    struct obj_node *node;
-    node = container_of(entry, struct obj_node, node);
     purc_variant_t k = node->key;
     purc_variant_t v = node->val;
 
+    if (check)
+        check = pcvar_container_needs_check(obj);
+
     do {
         if (check) {
             if (!shrink(obj, k, v, check))
@@ -341,10 +485,7 @@ v_object_remove(purc_variant_t obj, const char *key, bool silently,
             break_rev_update_chain(obj, node);
         }
 
-        --data->size;
-        PC_ASSERT(entry == root->rb_node || entry->rb_parent);
-        pcutils_rbtree_erase(entry, root);
-        entry->rb_parent = NULL;
+        unlink_node(data, node);
 
         if (check) {
             pcvar_adjust_set_by_descendant(obj);
@@ -473,29 +614,23 @@ v_object_set(purc_variant_t obj, purc_variant_t key, purc_variant_t val,
     variant_obj_t data = pcvar_obj_get_data(obj);
     PC_ASSERT(data);
 
+    if (check)
+        check = pcvar_container_needs_check(obj);
+
     struct rb_root *root = &data->kvs;
-    struct rb_node **pnode = &root->rb_node;
+    struct rb_node **pnode = NULL;
     struct rb_node *parent = NULL;
-    struct rb_node *entry = NULL;
-    while (*pnode) {
-        struct obj_node *node;
-        node = container_of(*pnode, struct obj_node, node);
-        const char *sko = purc_variant_get_string_const(node->key);
-        int ret = strcmp(sk, sko);
-
-        parent = *pnode;
-
-        if (ret < 0)
-            pnode = &parent->rb_left;
-        else if (ret > 0)
-            pnode = &parent->rb_right;
-        else{
-            entry = *pnode;
-            break;
-        }
+    struct obj_node *found;
+    if (data->index) {
+        found = index_find(data, sk, key_hash(sk));
+        if (!found)
+            tree_find(data, sk, &parent, &pnode);
+    }
+    else {
+        found = tree_find(data, sk, &parent, &pnode);
     }
 
-    if (!entry) { //new the entry
+    if (!found) { //new the entry
         struct obj_node *node = obj_node_create(key, val);
         if (!node)
             return -1;
@@ -509,12 +644,13 @@ v_object_set(purc_variant_t obj, purc_variant_t key, purc_variant_t val,
                     break;
             }
 
-            entry = &node->node;
+            struct rb_node *entry = &node->node;
 
             pcutils_rbtree_link_node(entry, parent, pnode);
             pcutils_rbtree_insert_color(entry, root);
 
             ++data->size;
+            index_insert(data, node);
 
             if (check) {
                 if (build_rev_update_chain(obj, node))
@@ -536,8 +672,7 @@ v_object_set(purc_variant_t obj, purc_variant_t key, purc_variant_t val,
         return -1;
     }
 
-    struct obj_node *node;
-    node = container_of(entry, struct obj_node, node);
+    struct obj_node *node = found;
     if (node->val == val) {
         // NOTE: keep refc intact
         return 0;
@@ -748,10 +883,47 @@ purc_variant_make_object (size_t nr_kv_pairs,
     return v;
 }
 
+purc_variant_t
+purc_variant_make_object_from(size_t nr_kv_pairs,
+        purc_variant_t *keys, purc_variant_t *values)
+{
+    PCVARIANT_CHECK_FAIL_RET(nr_kv_pairs == 0 || (keys && values),
+        PURC_VARIANT_INVALID);
+
+    purc_variant_t obj = v_object_new_with_capacity();
+    if (!obj)
+        return PURC_VARIANT_INVALID;
+
+    /* nobody can observe the object before it is returned:
+       no listener to fire, no set to adjust. */
+    bool check = false;
+    size_t i;
+    for (i = 0; i < nr_kv_pairs; i++) {
+        if (v_object_set(obj, keys[i], values[i], check))
+            break;
+    }
+
+    if (i < nr_kv_pairs) {
+        purc_variant_unref(obj);
+        return PURC_VARIANT_INVALID;
+    }
+
+    variant_obj_t data = pcvar_obj_get_data(obj);
+    size_t extra = OBJ_EXTRA_SIZE(data);
+    pcvariant_stat_set_extra_size(obj, extra);
+
+    return obj;
+}
+
 void pcvariant_object_release (purc_variant_t value)
 {
     variant_obj_t data = pcvar_obj_get_data(value);
 
+    /* no need to keep the index up to date when destroying the nodes */
+    free(data->index);
+    data->index = NULL;
+    data->sz_index = 0;
+
     struct rb_root *root = &data->kvs;
 
     struct rb_node *p, *n;
@@ -798,44 +970,28 @@ int pcvariant_object_compare (purc_variant_t lv, purc_variant_t rv)
 
 purc_variant_t
 purc_variant_object_get_by_ckey(purc_variant_t obj, const char* key)
+{
+    return pcvariant_object_get_by_ckey_ex(obj, key, false);
+}
+
+purc_variant_t
+pcvariant_object_get_by_ckey_ex(purc_variant_t obj, const char* key,
+        bool silently)
 {
     PCVARIANT_CHECK_FAIL_RET((obj && obj->type==PVT(_OBJECT) &&
         obj->sz_ptr[1] && key),
         PURC_VARIANT_INVALID);
 
     variant_obj_t data = pcvar_obj_get_data(obj);
-    struct rb_root *root = &data->kvs;
+    struct obj_node *node = find_node(data, key);
 
-    struct rb_node **pnode = &root->rb_node;
-    struct rb_node *parent = NULL;
-    struct rb_node *entry = NULL;
-    while (*pnode) {
-        struct obj_node *node;
-        node = container_of(*pnode, struct obj_node, node);
-        const char *sk = purc_variant_get_string_const(node->key);
-
-        int ret = strcmp(key, sk);
-
-        parent = *pnode;
-
-        if (ret < 0)
-            pnode = &parent->rb_left;
-        else if (ret > 0)
-            pnode = &parent->rb_right;
-        else{
-            entry = *pnode;
-            break;
-        }
-    }
-
-    if (!entry) {
-        pcinst_set_error(PCVARIANT_ERROR_NO_SUCH_KEY);
+    if (!node) {
+        if (!silently)
+            pcinst_set_error(PCVARIANT_ERROR_NO_SUCH_KEY);
 
         return PURC_VARIANT_INVALID;
     }
 
-    struct obj_node *node;
-    node = container_of(entry, struct obj_node, node);
     return node->val;
 }
 
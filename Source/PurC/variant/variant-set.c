@@ -138,6 +138,7 @@ variant_set_get_extra_size(variant_set_t data)
 
     extra += sz_record * count;
     extra += sizeof(struct set_node*)*(data->al.nr);
+    extra += sizeof(struct set_node*)*(data->nr_buckets);
 
     return extra;
 }
@@ -357,6 +358,7 @@ struct element_rb_node {
     struct rb_node     **pnode;
     struct rb_node      *parent;
     struct rb_node      *entry;
+    uint64_t             hash;
 };
 
 static int
@@ -434,6 +436,98 @@ _compare(purc_variant_t _new, purc_variant_t _old,
     return _compare_by_unique_keys(_new, _old, data);
 }
 
+#define SET_MIN_BUCKETS         16
+
+static inline size_t
+bucket_of(variant_set_t data, uint64_t hash)
+{
+    return (size_t)(hash & (data->nr_buckets - 1));
+}
+
+static int
+index_grow(variant_set_t data)
+{
+    size_t nr_buckets = data->nr_buckets ? data->nr_buckets * 2 :
+        SET_MIN_BUCKETS;
+    struct set_node **buckets;
+    buckets = (struct set_node**)calloc(nr_buckets, sizeof(*buckets));
+    if (!buckets)
+        return -1;
+
+    size_t old_nr_buckets = data->nr_buckets;
+    struct set_node **old_buckets = data->buckets;
+    data->buckets = buckets;
+    data->nr_buckets = nr_buckets;
+
+    for (size_t i=0; i<old_nr_buckets; ++i) {
+        struct set_node *p = old_buckets[i];
+        while (p) {
+            struct set_node *next = p->hnext;
+            size_t idx = bucket_of(data, p->hash);
+            p->hnext = buckets[idx];
+            buckets[idx] = p;
+            p = next;
+        }
+    }
+    free(old_buckets);
+
+    return 0;
+}
+
+static int
+index_add(variant_set_t data, struct set_node *node)
+{
+    if (data->caseless)
+        return 0;
+
+    size_t count = pcutils_array_list_length(&data->al);
+    if (count > data->nr_buckets && index_grow(data)) {
+        // a fuller table still works, only an absent one does not
+        if (data->buckets == NULL) {
+            pcinst_set_error(PURC_ERROR_OUT_OF_MEMORY);
+            return -1;
+        }
+    }
+
+    size_t idx = bucket_of(data, node->hash);
+    node->hnext = data->buckets[idx];
+    data->buckets[idx] = node;
+
+    return 0;
+}
+
+static void
+index_remove(variant_set_t data, struct set_node *node)
+{
+    if (data->buckets == NULL)
+        return;
+
+    struct set_node **pp = &data->buckets[bucket_of(data, node->hash)];
+    while (*pp) {
+        if (*pp == node) {
+            *pp = node->hnext;
+            break;
+        }
+        pp = &(*pp)->hnext;
+    }
+    node->hnext = NULL;
+}
+
+static struct set_node*
+index_find(variant_set_t data, purc_variant_t kvs, uint64_t hash)
+{
+    if (data->buckets == NULL)
+        return NULL;
+
+    struct set_node *p = data->buckets[bucket_of(data, hash)];
+    for (; p; p = p->hnext) {
+        if (p->hash == hash && _compare(kvs, p->val, data) == 0)
+            return p;
+    }
+
+    return NULL;
+}
+
 static void
 find_element_rb_node(struct element_rb_node *node,
         purc_variant_t set, purc_variant_t kvs)
@@ -443,8 +537,19 @@ find_element_rb_node(struct element_rb_node *node,
     struct rb_node **pnode = &root->rb_node;
     struct rb_node *parent = NULL;
     struct rb_node *entry = NULL;
-    char md5[33];
-    pcvariant_md5_by_set(md5, kvs, set);
+
+    node->hash = 0;
+    if (!data->caseless) {
+        // equal elements have equal hashes: a miss in the index is final,
+        // and the rb-tree is only walked to find where to link a new node
+        node->hash = pcvariant_hash_by_set(kvs, set);
+        struct set_node *found = index_find(data, kvs, node->hash);
+        if (found || data->buckets == NULL) {
+            if (found)
+                entry = &found->rbnode;
+            goto done;
+        }
+    }
 
     while (*pnode) {
         struct set_node *on;
@@ -453,9 +558,6 @@ find_element_rb_node(struct element_rb_node *node,
         if (0) {
             diff = variant_set_compare_by_set_keys(set, kvs, on->val);
         }
-        else if (0) {
-            diff = pcvariant_diff_by_set(md5, kvs, on->md5, on->val, set);
-        }
         else {
             diff = _compare(kvs, on->val, data);
         }
@@ -474,6 +576,7 @@ find_element_rb_node(struct element_rb_node *node,
         }
     }
 
+done:
     node->pnode  = pnode;
     node->parent = parent;
     node->entry  = entry;
@@ -574,6 +677,7 @@ elem_node_remove(purc_variant_t set, struct set_node *node)
     PC_ASSERT(data);
 
     pcutils_rbtree_erase(&node->rbnode, &data->elems);
+    index_remove(data, node);
 
     int r;
     struct pcutils_array_list_node *old;
@@ -646,6 +750,10 @@ variant_set_release_elems(purc_variant_t set, variant_set_t data)
     }
 
     pcutils_array_list_reset(&data->al);
+
+    free(data->buckets);
+    data->buckets = NULL;
+    data->nr_buckets = 0;
 }
 
 static void
@@ -715,8 +823,6 @@ variant_set_create_elem_node(purc_variant_t set, purc_variant_t val)
         return NULL;
     }
 
-    pcvariant_md5_by_set(_new->md5, val, set);
-
     _new->alnode.idx = (size_t)-1;
     _new->val = val;
     purc_variant_ref(val);
@@ -840,8 +946,7 @@ check_grow(purc_variant_t set, purc_variant_t val)
 
 static int
 insert(purc_variant_t set, variant_set_t data,
-        purc_variant_t val,
-        struct rb_node *parent, struct rb_node **pnode,
+        purc_variant_t val, const struct element_rb_node *rbn,
         bool check)
 {
     struct set_node *node = NULL;
@@ -870,9 +975,13 @@ insert(purc_variant_t set, variant_set_t data,
 
         struct rb_node *entry = &node->rbnode;
 
-        pcutils_rbtree_link_node(entry, parent, pnode);
+        pcutils_rbtree_link_node(entry, rbn->parent, rbn->pnode);
         pcutils_rbtree_insert_color(entry, &data->elems);
 
+        node->hash = rbn->hash;
+        if (index_add(data, node))
+            break;
+
         if (check) {
             if (!elem_node_setup_constraints(set, node))
                 break;
@@ -905,7 +1014,7 @@ pcvar_set_add(purc_variant_t set, purc_variant_t val)
     }
 
     bool check = false;
-    return insert(set, data, val, rbn.parent, rbn.pnode, check);
+    return insert(set, data, val, &rbn, check);
 }
 
 static int
@@ -963,7 +1072,7 @@ insert_or_replace(purc_variant_t set,
     find_element_rb_node(&rbn, set, val);
 
     if (!rbn.entry) {
-        int r = insert(set, data, val, rbn.parent, rbn.pnode, check);
+        int r = insert(set, data, val, &rbn, check);
 
         return r ? -1 : 0;
     }
@@ -1539,20 +1648,6 @@ struct set_user_data {
     void *ud;
 };
 
-static int vrtcmp(purc_variant_t l, purc_variant_t r, void *ud)
-{
-    uintptr_t sort_flags;
-    purc_vrtcmp_opt_t cmpopt;
-
-    sort_flags = (uintptr_t)ud;
-    cmpopt = (purc_vrtcmp_opt_t)(sort_flags & PCVARIANT_CMPOPT_MASK);
-
-    int retv = purc_variant_compare_ex(l, r, cmpopt);
-    if (sort_flags & PCVARIANT_SORT_DESC)
-        retv = -retv;
-    return retv;
-}
-
 static int
 cmp_f(struct pcutils_array_list_node *l, struct pcutils_array_list_node *r,
         void *ud)
@@ -1568,16 +1663,33 @@ cmp_f(struct pcutils_array_list_node *l, struct pcutils_array_list_node *r,
     return d->cmp(nl->val, nr->val, d->ud);
 }
 
+static purc_variant_t
+node_member(struct pcutils_array_list_node *node)
+{
+    return container_of(node, struct set_node, alnode)->val;
+}
+
 int pcvariant_set_sort(purc_variant_t value, void *ud,
         int (*cmp)(purc_variant_t l, purc_variant_t r, void *ud))
 {
     PC_ASSERT(value != PURC_VARIANT_INVALID);
 
+    if (pcvariant_is_frozen(value)) {
+        pcinst_set_error(PURC_ERROR_ACCESS_DENIED);
+        return -1;
+    }
+
+    /* use the keys extracted once for the default comparison */
+    if (cmp == NULL) {
+        return pcvariant_set_sort_by_keys(value, 1, ud,
+                pcvar_sort_decorate_by_flags, pcvar_sort_keycmp_by_flags);
+    }
+
     variant_set_t data = pcvar_set_get_data(value);
     struct pcutils_array_list *al = &data->al;
 
     struct set_user_data d = {
-        .cmp = cmp ? cmp : vrtcmp,
+        .cmp = cmp,
         .ud  = ud,
     };
 
@@ -1586,6 +1698,30 @@ int pcvariant_set_sort(purc_variant_t value, void *ud,
     return 0;
 }
 
+int pcvariant_set_sort_by_keys(purc_variant_t value, size_t nr_keys,
+        void *ud, pcvariant_sort_decorate_f decorate,
+        pcvariant_sort_keycmp_f cmp)
+{
+    PC_ASSERT(value != PURC_VARIANT_INVALID);
+
+    if (pcvariant_is_frozen(value)) {
+        pcinst_set_error(PURC_ERROR_ACCESS_DENIED);
+        return -1;
+    }
+
+    variant_set_t data = pcvar_set_get_data(value);
+
+    struct pcvar_sort_args args = {
+        .nr_keys  = nr_keys,
+        .ud       = ud,
+        .decorate = decorate,
+        .cmp      = cmp,
+        .member   = node_member,
+    };
+
+    return pcvar_sort_by_keys(&data->al, &args);
+}
+
 purc_variant_t
 pcvariant_set_find(purc_variant_t set, purc_variant_t value)
 {
@@ -2091,6 +2227,7 @@ pcvar_readjust_set(purc_variant_t set, struct set_node *node)
     variant_set_t data = pcvar_set_get_data(set);
 
     pcutils_rbtree_erase(&node->rbnode, &data->elems);
+    index_remove(data, node);
 
     struct element_rb_node rbn;
     find_element_rb_node(&rbn, set, node->val);
@@ -2101,6 +2238,7 @@ pcvar_readjust_set(purc_variant_t set, struct set_node *node)
     pcutils_rbtree_link_node(entry, rbn.parent, rbn.pnode);
     pcutils_rbtree_insert_color(entry, &data->elems);
 
-    return 0;
+    node->hash = rbn.hash;
+    return index_add(data, node);
 }
 
@@ -26,6 +26,7 @@
 #include "private/variant.h"
 #include "private/instance.h"
 #include "private/ejson.h"
+#include "private/rwstream.h"
 #include "private/vcm.h"
 #include "private/errors.h"
 #include "private/debug.h"
@@ -325,6 +326,9 @@ purc_variant_ref_count(purc_variant_t value)
 {
     PC_ASSERT(value);
 
+    if (value->flags & PCVARIANT_FLAG_FROZEN)
+        return __atomic_load_n(&value->refc, __ATOMIC_RELAXED);
+
     /* this should not occur */
     if (UNLIKELY(value->refc == 0)) {
         PC_ASSERT(0);
@@ -338,6 +342,13 @@ purc_variant_t purc_variant_ref (purc_variant_t value)
 {
     PC_ASSERT(value);
 
+    /* the constants in frozen variants are never released */
+    if (value->flags & PCVARIANT_FLAG_FROZEN) {
+        if (!(value->flags & PCVARIANT_FLAG_NOFREE))
+            __atomic_add_fetch(&value->refc, 1, __ATOMIC_RELAXED);
+        return value;
+    }
+
     /* this should not occur */
     if (UNLIKELY(value->refc == 0)) {
         PC_ASSERT(0);
@@ -351,10 +362,41 @@ purc_variant_t purc_variant_ref (purc_variant_t value)
     return value;
 }
 
+static unsigned int
+unref_frozen(purc_variant_t value)
+{
+    if (value->flags & PCVARIANT_FLAG_NOFREE)
+        return value->refc;
+
+    unsigned int refc = __atomic_sub_fetch(&value->refc, 1, __ATOMIC_ACQ_REL);
+    if (refc == 0) {
+        /* frozen variants live in the move heap; the heap is already in use
+           when releasing the descendants of a frozen container */
+        struct pcinst *inst = pcinst_current();
+        bool nested = (inst->variant_heap != inst->org_vrt_heap);
+
+        if (!nested)
+            pcvariant_use_move_heap();
+
+        pcvariant_release_fn release_fn = variant_releasers[value->type];
+        if (release_fn)
+            release_fn(value);
+        pcvariant_put(value);
+
+        if (!nested)
+            pcvariant_use_norm_heap();
+    }
+
+    return refc;
+}
+
 unsigned int purc_variant_unref(purc_variant_t value)
 {
     PC_ASSERT(value);
 
+    if (value->flags & PCVARIANT_FLAG_FROZEN)
+        return unref_frozen(value);
+
     /* this should not occur */
     if (UNLIKELY(value->refc == 0)) {
         PC_ASSERT(0);
@@ -1607,6 +1649,142 @@ int purc_variant_compare_ex (purc_variant_t v1,
     return compare;
 }
 
+static inline bool is_number_type(purc_variant_t v)
+{
+    return v->type == PURC_VARIANT_TYPE_NUMBER ||
+        v->type == PURC_VARIANT_TYPE_LONGINT ||
+        v->type == PURC_VARIANT_TYPE_ULONGINT ||
+        v->type == PURC_VARIANT_TYPE_LONGDOUBLE;
+}
+
+void pcvariant_sort_key_extract(struct pcvariant_sort_key *key,
+        purc_variant_t member, unsigned int forms)
+{
+    memset(key, 0, sizeof(*key));
+    if (member == PURC_VARIANT_INVALID)
+        return;
+
+    key->is_number = is_number_type(member);
+    if (forms & PCVARIANT_SORT_KEY_NUMBER)
+        key->d = purc_variant_numerify(member);
+
+    if (forms & PCVARIANT_SORT_KEY_STRING) {
+        switch (member->type) {
+        case PURC_VARIANT_TYPE_EXCEPTION:
+        case PURC_VARIANT_TYPE_ATOMSTRING:
+        case PURC_VARIANT_TYPE_STRING:
+            key->s = purc_variant_get_string_const(member);
+            break;
+
+        default:
+            if (purc_variant_stringify_alloc(&key->owned, member) < 0)
+                key->owned = NULL;
+            key->s = key->owned;
+            break;
+        }
+    }
+}
+
+void pcvariant_sort_key_release(struct pcvariant_sort_key *key)
+{
+    if (key->owned) {
+        free(key->owned);
+        key->owned = NULL;
+    }
+    key->s = NULL;
+}
+
+int pcvar_sort_decorate_by_flags(purc_variant_t member,
+        struct pcvariant_sort_key *keys, void *ud)
+{
+    purc_vrtcmp_opt_t cmpopt;
+    cmpopt = (purc_vrtcmp_opt_t)((uintptr_t)ud & PCVARIANT_CMPOPT_MASK);
+
+    unsigned int forms;
+    if (cmpopt == PCVARIANT_COMPARE_OPT_NUMBER)
+        forms = PCVARIANT_SORT_KEY_NUMBER;
+    else if (cmpopt == PCVARIANT_COMPARE_OPT_AUTO)
+        forms = PCVARIANT_SORT_KEY_NUMBER | PCVARIANT_SORT_KEY_STRING;
+    else
+        forms = PCVARIANT_SORT_KEY_STRING;
+
+    pcvariant_sort_key_extract(keys, member, forms);
+    return 0;
+}
+
+/* the same as purc_variant_compare_ex() but on the extracted keys */
+int pcvar_sort_keycmp_by_flags(const struct pcvariant_sort_key *l,
+        const struct pcvariant_sort_key *r, void *ud)
+{
+    uintptr_t sort_flags = (uintptr_t)ud;
+    purc_vrtcmp_opt_t cmpopt;
+    cmpopt = (purc_vrtcmp_opt_t)(sort_flags & PCVARIANT_CMPOPT_MASK);
+
+    int retv;
+    if (cmpopt == PCVARIANT_COMPARE_OPT_NUMBER ||
+            (cmpopt == PCVARIANT_COMPARE_OPT_AUTO && l->is_number)) {
+        if (equal_doubles(l->d, r->d))
+            retv = 0;
+        else
+            retv = l->d < r->d ? -1 : 1;
+    }
+    else {
+        const char *sl = l->s ? l->s : "";
+        const char *sr = r->s ? r->s : "";
+        if (cmpopt == PCVARIANT_COMPARE_OPT_CASELESS)
+            retv = pcutils_strcasecmp(sl, sr);
+        else
+            retv = strcmp(sl, sr);
+    }
+
+    if (sort_flags & PCVARIANT_SORT_DESC)
+        retv = -retv;
+    return retv;
+}
+
+static int sort_decorate(struct pcutils_array_list_node *node,
+        void *keys, void *ud)
+{
+    struct pcvar_sort_args *args = ud;
+    memset(keys, 0, sizeof(struct pcvariant_sort_key) * args->nr_keys);
+    int ret = args->decorate(args->member(node), keys, args->ud);
+    if (ret) {
+        struct pcvariant_sort_key *k = keys;
+        for (size_t i = 0; i < args->nr_keys; i++)
+            pcvariant_sort_key_release(k + i);
+    }
+    return ret;
+}
+
+static int sort_keycmp(const void *l, const void *r, void *ud)
+{
+    struct pcvar_sort_args *args = ud;
+    return args->cmp(l, r, args->ud);
+}
+
+static void sort_release(void *keys, void *ud)
+{
+    struct pcvar_sort_args *args = ud;
+    struct pcvariant_sort_key *k = keys;
+    for (size_t i = 0; i < args->nr_keys; i++)
+        pcvariant_sort_key_release(k + i);
+}
+
+int pcvar_sort_by_keys(struct pcutils_array_list *al,
+        struct pcvar_sort_args *args)
+{
+    PC_ASSERT(args->nr_keys > 0);
+
+    if (pcutils_array_list_sort_by_keys(al,
+                sizeof(struct pcvariant_sort_key) * args->nr_keys, args,
+                sort_decorate, sort_keycmp, sort_release)) {
+        pcinst_set_error(PURC_ERROR_OUT_OF_MEMORY);
+        return -1;
+    }
+
+    return 0;
+}
+
 purc_variant_t purc_variant_load_from_json_stream(purc_rwstream_t stream)
 {
     if (stream  == NULL) {
@@ -1617,6 +1795,17 @@ purc_variant_t purc_variant_load_from_json_stream(purc_rwstream_t stream)
     struct pcvcm_node* root = NULL;
     struct pcejson* parser = NULL;
 
+    /* try the fast path for plain JSON in memory first */
+    size_t sz_unread;
+    const char *buf = pcrwstream_get_unread_mem(stream, &sz_unread);
+    if (buf) {
+        value = pcejson_parse_plain_json(buf, sz_unread);
+        if (value != PURC_VARIANT_INVALID) {
+            purc_rwstream_seek(stream, 0, SEEK_END);
+            return value;
+        }
+    }
+
     int ret = pcejson_parse (&root, &parser, stream, PCEJSON_DEFAULT_DEPTH);
     if (ret != PCEJSON_SUCCESS) {
         goto ret;
@@ -3589,108 +3778,66 @@ void pcvariant_md5_ex(char *md5, purc_variant_t val, const char *salt,
     pcutils_bin2hex(md5_digest, MD5_DIGEST_SIZE, md5, uppercase);
 }
 
-void
-pcvariant_md5_by_set(char *md5, purc_variant_t val, purc_variant_t set)
+/* hashes exactly the bytes compare_string_method() passes to strcmp() */
+static uint64_t
+compare_hash(purc_variant_t v, uint64_t seed)
 {
-    PC_ASSERT(md5);
-    PC_ASSERT(val != PURC_VARIANT_INVALID);
-    PC_ASSERT(set != PURC_VARIANT_INVALID);
-
-    variant_set_t data = pcvar_set_get_data(set);
-    PC_ASSERT(data);
+    const char *str;
+    char *buf = NULL;
+    char stackbuf[128];
 
-    if (data->unique_key == NULL) {
-        pcvariant_md5(md5, val);
-        return;
-    }
-
-    purc_variant_t undefined = purc_variant_make_undefined();
-    PC_ASSERT(undefined);
-
-    if (val->type != PVT(_OBJECT)) {
-        pcvariant_md5(md5, undefined);
-        purc_variant_unref(undefined);
-        return;
-    }
-
-    pcutils_md5_ctxt ud;
-
-    pcutils_md5_begin(&ud);
-
-    struct stringify_arg arg;
-    arg.cb    = do_stringify_md5;
-    arg.arg   = &ud;
-    arg.flags = 0;
+    switch (v->type) {
+        case PURC_VARIANT_TYPE_EXCEPTION:
+        case PURC_VARIANT_TYPE_ATOMSTRING:
+        case PURC_VARIANT_TYPE_STRING:
+            str = purc_variant_get_string_const(v);
+            break;
 
-    for (size_t i=0; i<data->nr_keynames; ++i) {
-        purc_variant_t v;
-        v = purc_variant_object_get_by_ckey(val, data->keynames[i]);
-        if (v == PURC_VARIANT_INVALID) {
-            v = undefined;
-        }
-        stringify_kv(&arg, data->keynames[i], v);
+        default:
+            buf = compare_stringify(v, stackbuf, sizeof(stackbuf));
+            str = buf ? buf : stackbuf;
+            break;
     }
 
-    unsigned char md5_digest[MD5_DIGEST_SIZE];
-    pcutils_md5_end(&ud, md5_digest);
-
-    bool uppercase = true;
-    pcutils_bin2hex(md5_digest, MD5_DIGEST_SIZE, md5, uppercase);
+    seed = pcutils_hash64(str, strlen(str), seed);
+    free(buf);
 
-    purc_variant_unref(undefined);
+    return seed;
 }
 
-int
-pcvariant_diff_by_set(const char *md5l, purc_variant_t l,
-        const char *md5r, purc_variant_t r, purc_variant_t set)
+uint64_t
+pcvariant_hash_by_set(purc_variant_t val, purc_variant_t set)
 {
-    // TODO: https://gitlab.fmsoft.cn/hvml/hvml-docs/-/blob/master/zh/hvml-spec-v1.0-zh.md#21610-%E9%9B%86%E5%90%88%E5%8F%98%E9%87%8F
-
-    PC_ASSERT(md5l);
-    PC_ASSERT(l != PURC_VARIANT_INVALID);
-    PC_ASSERT(md5r);
-    PC_ASSERT(r != PURC_VARIANT_INVALID);
-
+    PC_ASSERT(val != PURC_VARIANT_INVALID);
     PC_ASSERT(set != PURC_VARIANT_INVALID);
 
-    int diff;
-
     variant_set_t data = pcvar_set_get_data(set);
     PC_ASSERT(data);
+    PC_ASSERT(!data->caseless);
 
-    if (data->unique_key == NULL) {
-        return pcvariant_diff(l, r);
-    }
-
-    diff = strcmp(md5l, md5r);
-    if (diff)
-        return diff;
+    if (data->unique_key == NULL)
+        return compare_hash(val, 0);
 
     purc_variant_t undefined = purc_variant_make_undefined();
     PC_ASSERT(undefined);
 
+    uint64_t hash = 0;
     for (size_t i=0; i<data->nr_keynames; ++i) {
-        purc_variant_t vl = PURC_VARIANT_INVALID;
-        purc_variant_t vr = PURC_VARIANT_INVALID;
-
-        if (l->type == PVT(_OBJECT))
-            vl = purc_variant_object_get_by_ckey(l, data->keynames[i]);
-        if (r->type == PVT(_OBJECT))
-            vr = purc_variant_object_get_by_ckey(r, data->keynames[i]);
-
-        if (vl == PURC_VARIANT_INVALID)
-            vl = undefined;
-        if (vr == PURC_VARIANT_INVALID)
-            vr = undefined;
+        purc_variant_t v = PURC_VARIANT_INVALID;
+        if (val->type == PVT(_OBJECT)) {
+            v = purc_variant_object_get_by_ckey(val, data->keynames[i]);
+            if (v == PURC_VARIANT_INVALID)
+                purc_clr_error();
+        }
+        if (v == PURC_VARIANT_INVALID)
+            v = undefined;
 
-        diff = pcvariant_diff(vl, vr);
-        if (diff)
-            break;
+        hash = compare_hash(v, hash);
     }
 
     purc_variant_unref(undefined);
 
-    return diff;
+    return hash;
 }
 
 bool pcvariant_is_scalar(purc_variant_t v)
@@ -43,6 +43,9 @@
 #define PURC_ENVV_VCM_LOG_ENABLE    "PURC_VCM_LOG_ENABLE"
 #define VCM_VARIABLE_ARGS_NAME      "_ARGS"
 
+#define MIN_FRAME_PARAMS            4
+#define MAX_FREE_FRAMES             16
+
 static const char *stepnames[] = {
     STEP_NAME_AFTER_PUSH,
     STEP_NAME_EVAL_PARAMS,
@@ -56,65 +59,86 @@ pcvcm_eval_stack_frame_step_name(enum pcvcm_eval_stack_frame_step type)
     return stepnames[type];
 }
 
-struct pcvcm_eval_stack_frame *
-pcvcm_eval_stack_frame_create(struct pcvcm_node *node, size_t return_pos)
+static struct pcvcm_eval_stack_frame *
+frame_alloc(size_t capacity)
 {
     struct pcvcm_eval_stack_frame *frame;
-    frame = (struct pcvcm_eval_stack_frame*)calloc(1,sizeof(*frame));
+    frame = (struct pcvcm_eval_stack_frame*)calloc(1, sizeof(*frame) +
+            capacity * (sizeof(struct pcvcm_node *) + sizeof(purc_variant_t)));
     if (!frame) {
         purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
-        goto out;
+        return NULL;
     }
 
-    frame->variables = pcvarmgr_create();
-    if (!frame->variables) {
-        purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
-        goto out_destroy_frame;
-    }
+    frame->capacity = capacity;
+    frame->params = (struct pcvcm_node **)(frame + 1);
+    frame->params_result = (purc_variant_t *)(frame->params + capacity);
+    return frame;
+}
 
+static void
+frame_init(struct pcvcm_eval_stack_frame *frame, struct pcvcm_node *node,
+        size_t nr_params, size_t return_pos)
+{
     frame->node = node;
     frame->pos = 0;
     frame->return_pos = return_pos;
-    frame->nr_params = pcvcm_node_children_count(node);
-    if (frame->nr_params) {
-        frame->params = pcutils_array_create();
-        if (!frame->params) {
-            purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
-            goto out_destroy_variables;
-        }
-        frame->params_result = pcutils_array_create();
-        if (!frame->params_result) {
-            purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
-            goto out_destroy_params;
-        }
-
-        struct pctree_node *child = pctree_node_child(
-                (struct pctree_node*)node);
-        while (child) {
-            int ret = pcutils_array_push(frame->params, child);
-            if (ret != PURC_ERROR_OK) {
-                goto out_destroy_params_result;
-            }
-            child = pctree_node_next(child);
-        }
+    frame->step = STEP_AFTER_PUSH;
+    frame->nr_params = nr_params;
 
+    size_t i = 0;
+    struct pctree_node *child = pctree_node_child((struct pctree_node*)node);
+    while (child) {
+        frame->params[i] = (struct pcvcm_node *)child;
+        frame->params_result[i] = PURC_VARIANT_INVALID;
+        child = pctree_node_next(child);
+        i++;
     }
+
     frame->ops = pcvcm_eval_get_ops_by_node(node);
-    return frame;
+}
 
-out_destroy_params_result:
-    pcutils_array_destroy(frame->params_result, true);
+/* release the evaluated params and variables, keep the memory */
+static void
+frame_clear(struct pcvcm_eval_stack_frame *frame)
+{
+    for (size_t i = 0; i < frame->nr_params; i++) {
+        if (frame->params_result[i]) {
+            purc_variant_unref(frame->params_result[i]);
+            frame->params_result[i] = PURC_VARIANT_INVALID;
+        }
+    }
+    frame->nr_params = 0;
 
-out_destroy_params:
-    pcutils_array_destroy(frame->params, true);
+    if (frame->variables) {
+        pcvarmgr_destroy(frame->variables);
+        frame->variables = NULL;
+    }
+}
 
-out_destroy_variables:
-    pcvarmgr_destroy(frame->variables);
+static int
+frame_set_args(struct pcvcm_eval_stack_frame *frame, purc_variant_t args)
+{
+    if (!frame->variables) {
+        frame->variables = pcvarmgr_create();
+        if (!frame->variables) {
+            purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
+            return -1;
+        }
+    }
 
-out_destroy_frame:
-    free(frame);
+    return pcvarmgr_add(frame->variables, VCM_VARIABLE_ARGS_NAME, args) ?
+        0 : -1;
+}
 
-out:
+struct pcvcm_eval_stack_frame *
+pcvcm_eval_stack_frame_create(struct pcvcm_node *node, size_t return_pos)
+{
+    size_t nr_params = pcvcm_node_children_count(node);
+    struct pcvcm_eval_stack_frame *frame = frame_alloc(nr_params);
+    if (frame) {
+        frame_init(frame, node, nr_params, return_pos);
+    }
     return frame;
 }
 
@@ -124,19 +148,7 @@ pcvcm_eval_stack_frame_destroy(struct pcvcm_eval_stack_frame *frame)
     if (!frame) {
         return;
     }
-    if (frame->params) {
-        pcutils_array_destroy(frame->params, true);
-    }
-    if (frame->params_result) {
-        for (size_t i = 0; i < frame->nr_params; i++) {
-            purc_variant_t v = pcutils_array_get(frame->params_result, i);
-            if (v) {
-                purc_variant_unref(v);
-            }
-        }
-        pcutils_array_destroy(frame->params_result, true);
-    }
-    pcvarmgr_destroy(frame->variables);
+    frame_clear(frame);
     free(frame);
 }
 
@@ -151,6 +163,7 @@ pcvcm_eval_ctxt_create()
     }
 
     list_head_init(&ctxt->stack);
+    list_head_init(&ctxt->free_frames);
 out:
     return ctxt;
 }
@@ -166,6 +179,9 @@ pcvcm_eval_ctxt_destroy(struct pcvcm_eval_ctxt *ctxt)
     list_for_each_entry_safe(p, n, stack, ln) {
         pcvcm_eval_stack_frame_destroy(p);
     }
+    list_for_each_entry_safe(p, n, &ctxt->free_frames, ln) {
+        free(p);
+    }
     if (ctxt->result) {
         purc_variant_unref(ctxt->result);
     }
@@ -244,7 +260,7 @@ pcvcm_dump_frame(struct pcvcm_eval_stack_frame *frame, purc_rwstream_t rws,
 #if __DEV_VCM__
     for (size_t i = 0; i < frame->nr_params; i++) {
         print_indent(rws, indent, NULL);
-        struct pcvcm_node *param = pcutils_array_get(frame->params, i);
+        struct pcvcm_node *param = frame->params[i];
         char *s = pcvcm_node_to_string(param, &len);
 
         if (i == frame->pos && frame->step == STEP_EVAL_PARAMS) {
@@ -257,7 +273,7 @@ pcvcm_dump_frame(struct pcvcm_eval_stack_frame *frame, purc_rwstream_t rws,
         purc_rwstream_write(rws, s, len);
 
         if (i < frame->pos) {
-            purc_variant_t result = pcutils_array_get(frame->params_result, i);
+            purc_variant_t result = frame->params_result[i];
             if (result) {
                 const char *type = pcvariant_typename(result);
                 snprintf(buf, DUMP_BUF_SIZE, ", result: %s/", type);
@@ -394,16 +410,34 @@ bottom_frame(struct pcvcm_eval_ctxt *ctxt)
     return list_last_entry(&ctxt->stack, struct pcvcm_eval_stack_frame, ln);
 }
 
+/* frames are recycled through the context, so evaluating a node does not
+   allocate in the common case */
 static struct pcvcm_eval_stack_frame *
 push_frame(struct pcvcm_eval_ctxt *ctxt, struct pcvcm_node *node,
         size_t return_pos)
 {
-    struct pcvcm_eval_stack_frame *frame = pcvcm_eval_stack_frame_create(
-            node, return_pos);
+    struct pcvcm_eval_stack_frame *frame = NULL;
+    size_t nr_params = pcvcm_node_children_count(node);
+
+    struct pcvcm_eval_stack_frame *p;
+    list_for_each_entry(p, &ctxt->free_frames, ln) {
+        if (p->capacity >= nr_params) {
+            frame = p;
+            list_del(&frame->ln);
+            ctxt->nr_free_frames--;
+            break;
+        }
+    }
+
     if (frame == NULL) {
-        goto out;
+        frame = frame_alloc(nr_params > MIN_FRAME_PARAMS ?
+                nr_params : MIN_FRAME_PARAMS);
+        if (frame == NULL) {
+            goto out;
+        }
     }
 
+    frame_init(frame, node, nr_params, return_pos);
     list_add_tail(&frame->ln, &ctxt->stack);
 out:
     return frame;
@@ -415,7 +449,15 @@ pop_frame(struct pcvcm_eval_ctxt *ctxt)
     struct pcvcm_eval_stack_frame *last = list_last_entry(
             &ctxt->stack, struct pcvcm_eval_stack_frame, ln);
     list_del(&last->ln);
-    pcvcm_eval_stack_frame_destroy(last);
+
+    if (ctxt->nr_free_frames < MAX_FREE_FRAMES) {
+        frame_clear(last);
+        list_add(&last->ln, &ctxt->free_frames);
+        ctxt->nr_free_frames++;
+    }
+    else {
+        pcvcm_eval_stack_frame_destroy(last);
+    }
 }
 
 purc_variant_t
@@ -560,7 +602,7 @@ eval_frame(struct pcvcm_eval_ctxt *ctxt, struct pcvcm_eval_stack_frame *frame,
 
             case STEP_EVAL_PARAMS:
                 for (; frame->pos < frame->nr_params; frame->pos++) {
-                    purc_variant_t v = pcutils_array_get(frame->params_result, frame->pos);
+                    purc_variant_t v = frame->params_result[frame->pos];
                     if (v) {
                         continue;
                     }
@@ -584,7 +626,7 @@ eval_frame(struct pcvcm_eval_ctxt *ctxt, struct pcvcm_eval_stack_frame *frame,
                     if (!val) {
                         goto out;
                     }
-                    pcutils_array_set(frame->params_result, param_frame->return_pos, val);
+                    frame->params_result[param_frame->return_pos] = val;
                     pop_frame(ctxt);
                 }
                 frame->step = STEP_EVAL_VCM;
@@ -669,7 +711,7 @@ eval_vcm(struct pcvcm_node *tree,
         goto out;
     }
 
-    if (args && !pcvarmgr_add(frame->variables, VCM_VARIABLE_ARGS_NAME, args)) {
+    if (args && frame_set_args(frame, args)) {
         goto out;
     }
 
@@ -683,7 +725,7 @@ eval_vcm(struct pcvcm_node *tree,
         pop_frame(ctxt);
         frame = bottom_frame(ctxt);
         if (frame) {
-            pcutils_array_set(frame->params_result, return_pos, result);
+            frame->params_result[return_pos] = result;
         }
     } while (frame);
 
@@ -858,7 +900,7 @@ purc_variant_t pcvcm_eval_sub_expr_full(struct pcvcm_node *tree,
         goto out;
     }
 
-    if (args && !pcvarmgr_add(frame->variables, VCM_VARIABLE_ARGS_NAME, args)) {
+    if (args && frame_set_args(frame, args)) {
         goto out_destroy_frame;
     }
 
@@ -79,12 +79,14 @@ struct pcvcm_eval_stack_frame {
     struct list_head        ln;
 
     struct pcvcm_node      *node;
-    pcutils_array_t        *params;
-    pcutils_array_t        *params_result;
+    /* both arrays live in the same allocation right after the frame */
+    struct pcvcm_node     **params;
+    purc_variant_t         *params_result;
     struct pcvcm_eval_stack_frame_ops *ops;
-    struct pcvarmgr        *variables; // _ARGS
+    struct pcvarmgr        *variables; // _ARGS, created on demand
 
     size_t                  nr_params;
+    size_t                  capacity;   // max nr_params of the allocation
     size_t                  pos;
     size_t                  return_pos;
 
@@ -94,6 +96,9 @@ struct pcvcm_eval_stack_frame {
 struct pcvcm_eval_ctxt {
     /* struct pcvcm_eval_stack_frame */
     struct list_head        stack;
+    /* popped frames kept for reuse */
+    struct list_head        free_frames;
+    size_t                  nr_free_frames;
     uint32_t                flags;
     find_var_fn             find_var;
     void                   *find_var_ctxt;
@@ -161,6 +166,19 @@ pcvcm_eval_call_nvariant_method(purc_variant_t var,
 bool
 pcvcm_eval_is_handle_as_getter(struct pcvcm_node *node);
 
+static inline struct pcvcm_node *
+pcvcm_eval_frame_param(struct pcvcm_eval_stack_frame *frame, size_t pos)
+{
+    return (pos < frame->nr_params) ? frame->params[pos] : NULL;
+}
+
+static inline purc_variant_t
+pcvcm_eval_frame_result(struct pcvcm_eval_stack_frame *frame, size_t pos)
+{
+    return (pos < frame->nr_params) ? frame->params_result[pos] :
+        PURC_VARIANT_INVALID;
+}
+
 static inline purc_variant_t
 pcvcm_eval_get_attach_variant(struct pcvcm_node *node)
 {
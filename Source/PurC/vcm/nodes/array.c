@@ -61,7 +61,7 @@ eval(struct pcvcm_eval_ctxt *ctxt,
     }
 
     for (size_t i = 0; i < frame->nr_params; i++) {
-        purc_variant_t v = pcutils_array_get(frame->params_result, i);
+        purc_variant_t v = pcvcm_eval_frame_result(frame, i);
         if(!purc_variant_array_append(array, v)) {
             goto out;
         }
@@ -61,8 +61,8 @@ eval(struct pcvcm_eval_ctxt *ctxt,
     UNUSED_PARAM(ctxt);
     UNUSED_PARAM(frame);
     purc_variant_t ret_var = PURC_VARIANT_INVALID;
-    struct pcvcm_node *caller_node = pcutils_array_get(frame->params, 0);
-    purc_variant_t caller_var = pcutils_array_get(frame->params_result, 0);
+    struct pcvcm_node *caller_node = pcvcm_eval_frame_param(frame, 0);
+    purc_variant_t caller_var = pcvcm_eval_frame_result(frame, 0);
 
     if (!purc_variant_is_dynamic(caller_var)
             && !pcvcm_eval_is_native_wrapper(caller_var)) {
@@ -81,7 +81,7 @@ eval(struct pcvcm_eval_ctxt *ctxt,
         }
 
         for (size_t i = 1, j = 0; i < frame->nr_params; i++, j++) {
-            params[j] = pcutils_array_get(frame->params_result, i);
+            params[j] = pcvcm_eval_frame_result(frame, i);
         }
     }
 
@@ -61,6 +61,9 @@ find_from_frame(struct pcvcm_eval_ctxt *ctxt, const char *name)
     struct list_head *stack = &ctxt->stack;
     struct pcvcm_eval_stack_frame *p, *n;
     list_for_each_entry_reverse_safe(p, n, stack, ln) {
+        if (!p->variables) {
+            continue;
+        }
         ret = pcvarmgr_get(p->variables, name);
         if (ret) {
             goto out;
@@ -77,7 +80,7 @@ eval(struct pcvcm_eval_ctxt *ctxt,
         struct pcvcm_eval_stack_frame *frame)
 {
     purc_variant_t ret = PURC_VARIANT_INVALID;
-    purc_variant_t name = pcutils_array_get(frame->params_result, 0);
+    purc_variant_t name = pcvcm_eval_frame_result(frame, 0);
     if (name == PURC_VARIANT_INVALID || !purc_variant_is_string(name)) {
         purc_set_error(PURC_ERROR_INVALID_VALUE);
         goto out;
@@ -78,7 +78,7 @@ select_param_default(struct pcvcm_eval_ctxt *ctxt,
         struct pcvcm_eval_stack_frame *frame, size_t pos)
 {
     UNUSED_PARAM(ctxt);
-    return pcutils_array_get(frame->params, pos);
+    return pcvcm_eval_frame_param(frame, pos);
 }
 
 struct pcvcm_eval_stack_frame_ops *
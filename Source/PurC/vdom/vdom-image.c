@@ -0,0 +1,720 @@
+/*
+ * @file vdom-image.c
+ * @author
+ * @date 2026/10/16
+ * @brief The precompiled (binary) image of a vDOM document.
+ *
+ * Copyright (C) 2022 FMSoft <https://www.fmsoft.cn>
+ *
+ * This file is a part of PurC (short for Purring Cat), an HVML interpreter.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * An image is a header followed by the nodes of the document in pre-order.
+ * Integers are stored in the native byte order and the header records the
+ * byte order and the size of long double, so an image is only valid on
+ * the kind of machine which wrote it; a mismatched image is just ignored.
+ *
+ *  - string: u32 length (IMG_NO_STRING for NULL), then the bytes;
+ *  - vcm node: u8 type, u8 is_closed, u32 extra, the payload of the
+ *    scalar types, u32 number of children, then the children;
+ *  - vdom node: u8 node type, then
+ *      element: tag name, u8 self_closing, u32 number of attributes,
+ *          each as key, u8 operator, u8 has-value, [vcm]; u32 number of
+ *          children, then the children;
+ *      content: vcm;
+ *      comment: text.
+ *  - document: doctype name, system information, u8 quirks, u32 number of
+ *    children, the children, then the pre-order indices of the root, head
+ *    and body elements (IMG_NO_ELEMENT if none) and of the bodies.
+ *
+ * The reader checks every length against the end of the buffer, so a
+ * truncated or corrupted image fails cleanly.
+ */
+
+#include "config.h"
+
+#include "purc-utils.h"
+#include "purc-errors.h"
+#include "purc-rwstream.h"
+#include "private/errors.h"
+#include "private/vdom.h"
+#include "private/vcm.h"
+#include "private/utils.h"
+
+#include "vdom-internal.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define IMG_MAGIC           "PCVDOMI"
+#define IMG_VERSION         1
+#define IMG_BYTE_ORDER      0x01020304U
+
+#define IMG_NO_STRING       0xFFFFFFFFU
+#define IMG_NO_ELEMENT      0xFFFFFFFFU
+
+/* deep enough for any sane document; stops a corrupted image early */
+#define IMG_MAX_DEPTH       1024
+
+struct image_header {
+    char        magic[8];
+    uint32_t    version;
+    uint32_t    byte_order;
+    uint32_t    sz_long_double;
+    uint32_t    reserved;
+    uint8_t     md5[MD5_DIGEST_SIZE];
+    uint64_t    src_length;
+    uint64_t    body_length;
+};
+
+struct image_writer {
+    purc_rwstream_t out;
+    int             failed;
+
+    /* the pre-order index of the next element */
+    uint32_t        nr_elems;
+    uint32_t        root;
+    uint32_t        head;
+    uint32_t        body;
+
+    struct pcvdom_document *doc;
+    struct pcutils_arrlist *bodies;     /* indices, parallel to doc->bodies */
+};
+
+struct image_reader {
+    const uint8_t  *p;
+    const uint8_t  *end;
+    int             failed;
+
+    struct pcvdom_element **elems;
+    size_t          nr_elems;
+    size_t          sz_elems;
+};
+
+static void
+put_bytes(struct image_writer *wr, const void *buf, size_t len)
+{
+    if (wr->failed || len == 0)
+        return;
+
+    if (purc_rwstream_write(wr->out, buf, len) != (ssize_t)len)
+        wr->failed = 1;
+}
+
+static inline void
+put_u8(struct image_writer *wr, uint8_t v)
+{
+    put_bytes(wr, &v, sizeof(v));
+}
+
+static inline void
+put_u32(struct image_writer *wr, uint32_t v)
+{
+    put_bytes(wr, &v, sizeof(v));
+}
+
+static void
+put_string(struct image_writer *wr, const char *str, size_t len)
+{
+    if (str == NULL) {
+        put_u32(wr, IMG_NO_STRING);
+        return;
+    }
+
+    if (len >= IMG_NO_STRING) {
+        wr->failed = 1;
+        return;
+    }
+
+    put_u32(wr, (uint32_t)len);
+    put_bytes(wr, str, len);
+}
+
+static inline void
+put_cstring(struct image_writer *wr, const char *str)
+{
+    put_string(wr, str, str ? strlen(str) : 0);
+}
+
+static inline const void *
+get_bytes(struct image_reader *rd, size_t len)
+{
+    if (rd->failed || (size_t)(rd->end - rd->p) < len) {
+        rd->failed = 1;
+        return NULL;
+    }
+
+    const void *p = rd->p;
+    rd->p += len;
+    return p;
+}
+
+static inline uint8_t
+get_u8(struct image_reader *rd)
+{
+    const uint8_t *p = get_bytes(rd, 1);
+    return p ? *p : 0;
+}
+
+static inline uint32_t
+get_u32(struct image_reader *rd)
+{
+    uint32_t v = 0;
+    const void *p = get_bytes(rd, sizeof(v));
+    if (p)
+        memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+/* returns a null-terminated copy; *is_null tells a NULL string apart */
+static char *
+get_string(struct image_reader *rd, size_t *len, bool *is_null)
+{
+    *is_null = false;
+    uint32_t n = get_u32(rd);
+    if (rd->failed)
+        return NULL;
+
+    if (n == IMG_NO_STRING) {
+        *is_null = true;
+        return NULL;
+    }
+
+    const char *src = get_bytes(rd, n);
+    if (!src)
+        return NULL;
+
+    char *str = malloc(n + 1);
+    if (!str) {
+        pcinst_set_error(PURC_ERROR_OUT_OF_MEMORY);
+        rd->failed = 1;
+        return NULL;
+    }
+
+    memcpy(str, src, n);
+    str[n] = 0;
+    if (len)
+        *len = n;
+    return str;
+}
+
+static void
+write_vcm(struct image_writer *wr, struct pcvcm_node *node)
+{
+    put_u8(wr, (uint8_t)node->type);
+    put_u8(wr, node->is_closed ? 1 : 0);
+    put_u32(wr, node->extra);
+
+    switch (node->type) {
+    case PCVCM_NODE_TYPE_BOOLEAN:
+        put_u8(wr, node->b ? 1 : 0);
+        break;
+    case PCVCM_NODE_TYPE_NUMBER:
+        put_bytes(wr, &node->d, sizeof(node->d));
+        break;
+    case PCVCM_NODE_TYPE_LONG_INT:
+        put_bytes(wr, &node->i64, sizeof(node->i64));
+        break;
+    case PCVCM_NODE_TYPE_ULONG_INT:
+        put_bytes(wr, &node->u64, sizeof(node->u64));
+        break;
+    case PCVCM_NODE_TYPE_LONG_DOUBLE:
+        put_bytes(wr, &node->ld, sizeof(node->ld));
+        break;
+    case PCVCM_NODE_TYPE_STRING:
+    case PCVCM_NODE_TYPE_BYTE_SEQUENCE:
+        put_string(wr, (const char *)node->sz_ptr[1], node->sz_ptr[0]);
+        break;
+    default:
+        break;
+    }
+
+    put_u32(wr, (uint32_t)pcvcm_node_children_count(node));
+
+    struct pctree_node *child = node->tree_node.first_child;
+    while (child && !wr->failed) {
+        write_vcm(wr, (struct pcvcm_node *)child);
+        child = child->next;
+    }
+}
+
+static struct pcvcm_node *
+read_vcm(struct image_reader *rd, int depth)
+{
+    if (depth > IMG_MAX_DEPTH) {
+        rd->failed = 1;
+        return NULL;
+    }
+
+    uint8_t type = get_u8(rd);
+    uint8_t closed = get_u8(rd);
+    uint32_t extra = get_u32(rd);
+    if (rd->failed || type > PCVCM_NODE_TYPE_LAST) {
+        rd->failed = 1;
+        return NULL;
+    }
+
+    struct pcvcm_node *node = calloc(1, sizeof(*node));
+    if (!node) {
+        pcinst_set_error(PURC_ERROR_OUT_OF_MEMORY);
+        rd->failed = 1;
+        return NULL;
+    }
+
+    node->type = (enum pcvcm_node_type)type;
+    node->is_closed = closed ? true : false;
+    node->extra = extra;
+
+    const void *p = NULL;
+    switch (node->type) {
+    case PCVCM_NODE_TYPE_BOOLEAN:
+        node->b = get_u8(rd) ? true : false;
+        break;
+    case PCVCM_NODE_TYPE_NUMBER:
+        if ((p = get_bytes(rd, sizeof(node->d))))
+            memcpy(&node->d, p, sizeof(node->d));
+        break;
+    case PCVCM_NODE_TYPE_LONG_INT:
+        if ((p = get_bytes(rd, sizeof(node->i64))))
+            memcpy(&node->i64, p, sizeof(node->i64));
+        break;
+    case PCVCM_NODE_TYPE_ULONG_INT:
+        if ((p = get_bytes(rd, sizeof(node->u64))))
+            memcpy(&node->u64, p, sizeof(node->u64));
+        break;
+    case PCVCM_NODE_TYPE_LONG_DOUBLE:
+        if ((p = get_bytes(rd, sizeof(node->ld))))
+            memcpy(&node->ld, p, sizeof(node->ld));
+        break;
+    case PCVCM_NODE_TYPE_STRING:
+    case PCVCM_NODE_TYPE_BYTE_SEQUENCE:
+    {
+        size_t len = 0;
+        bool is_null;
+        char *str = get_string(rd, &len, &is_null);
+        if (is_null && node->type == PCVCM_NODE_TYPE_STRING)
+            rd->failed = 1;
+        if (str && len == 0 && node->type == PCVCM_NODE_TYPE_BYTE_SEQUENCE) {
+            /* an empty byte sequence keeps no buffer */
+            free(str);
+            str = NULL;
+        }
+        node->sz_ptr[0] = len;
+        node->sz_ptr[1] = (uintptr_t)str;
+        break;
+    }
+    default:
+        break;
+    }
+
+    uint32_t nr = get_u32(rd);
+    for (uint32_t i = 0; i < nr && !rd->failed; i++) {
+        struct pcvcm_node *child = read_vcm(rd, depth + 1);
+        if (child)
+            pcvcm_node_append_child(node, child);
+    }
+
+    if (rd->failed) {
+        pcvcm_node_destroy(node);
+        return NULL;
+    }
+
+    return node;
+}
+
+static void
+write_node(struct image_writer *wr, struct pcvdom_node *node);
+
+static void
+write_children(struct image_writer *wr, struct pcvdom_node *node)
+{
+    put_u32(wr, (uint32_t)pctree_node_children_number(&node->node));
+
+    struct pctree_node *child = node->node.first_child;
+    while (child && !wr->failed) {
+        write_node(wr, container_of(child, struct pcvdom_node, node));
+        child = child->next;
+    }
+}
+
+static void
+write_element(struct image_writer *wr, struct pcvdom_element *elem)
+{
+    uint32_t idx = wr->nr_elems++;
+    if (elem == wr->doc->root)
+        wr->root = idx;
+    if (elem == wr->doc->head)
+        wr->head = idx;
+    if (elem == wr->doc->body)
+        wr->body = idx;
+
+    size_t nr_bodies = pcutils_arrlist_length(wr->doc->bodies);
+    for (size_t i = 0; i < nr_bodies; i++) {
+        if (pcutils_arrlist_get_idx(wr->doc->bodies, i) == elem) {
+            if (pcutils_arrlist_put_idx(wr->bodies, i,
+                        (void *)(uintptr_t)(idx + 1)))
+                wr->failed = 1;
+        }
+    }
+
+    put_cstring(wr, elem->tag_name);
+    put_u8(wr, elem->self_closing ? 1 : 0);
+
+    size_t nr_attrs = elem->attrs ? pcutils_array_length(elem->attrs) : 0;
+    put_u32(wr, (uint32_t)nr_attrs);
+    for (size_t i = 0; i < nr_attrs; i++) {
+        struct pcvdom_attr *attr = pcutils_array_get(elem->attrs, i);
+        put_cstring(wr, attr->key);
+        put_u8(wr, (uint8_t)attr->op);
+        put_u8(wr, attr->val ? 1 : 0);
+        if (attr->val)
+            write_vcm(wr, attr->val);
+    }
+
+    write_children(wr, &elem->node);
+}
+
+static void
+write_node(struct image_writer *wr, struct pcvdom_node *node)
+{
+    put_u8(wr, (uint8_t)node->type);
+
+    switch (node->type) {
+    case PCVDOM_NODE_ELEMENT:
+        write_element(wr, PCVDOM_ELEMENT_FROM_NODE(node));
+        break;
+
+    case PCVDOM_NODE_CONTENT:
+    {
+        struct pcvdom_content *content = PCVDOM_CONTENT_FROM_NODE(node);
+        if (content->vcm == NULL) {
+            wr->failed = 1;
+            break;
+        }
+        write_vcm(wr, content->vcm);
+        break;
+    }
+
+    case PCVDOM_NODE_COMMENT:
+        put_cstring(wr, PCVDOM_COMMENT_FROM_NODE(node)->text);
+        break;
+
+    default:
+        wr->failed = 1;
+        break;
+    }
+}
+
+int
+pcvdom_document_write_image(struct pcvdom_document *doc,
+        const unsigned char *md5, size_t src_length, purc_rwstream_t out)
+{
+    if (!doc || !md5 || !out) {
+        pcinst_set_error(PURC_ERROR_INVALID_VALUE);
+        return -1;
+    }
+
+    struct image_writer wr = { };
+    wr.root = wr.head = wr.body = IMG_NO_ELEMENT;
+    wr.doc = doc;
+    wr.bodies = pcutils_arrlist_new_ex(NULL,
+            pcutils_arrlist_length(doc->bodies) + 1);
+    if (!wr.bodies) {
+        pcinst_set_error(PURC_ERROR_OUT_OF_MEMORY);
+        return -1;
+    }
+
+    /* the body goes to a buffer first: its length is in the header */
+    wr.out = purc_rwstream_new_buffer(4096, 0);
+    if (!wr.out) {
+        pcutils_arrlist_free(wr.bodies);
+        return -1;
+    }
+
+    put_cstring(&wr, doc->doctype.name);
+    put_cstring(&wr, doc->doctype.system_info);
+    put_u8(&wr, doc->quirks ? 1 : 0);
+    write_children(&wr, &doc->node);
+
+    put_u32(&wr, wr.root);
+    put_u32(&wr, wr.head);
+    put_u32(&wr, wr.body);
+
+    size_t nr_bodies = pcutils_arrlist_length(doc->bodies);
+    put_u32(&wr, (uint32_t)nr_bodies);
+    for (size_t i = 0; i < nr_bodies; i++) {
+        uintptr_t idx = (uintptr_t)pcutils_arrlist_get_idx(wr.bodies, i);
+        /* a body which is not in the tree any more */
+        if (idx == 0)
+            wr.failed = 1;
+        put_u32(&wr, (uint32_t)(idx - 1));
+    }
+
+    int ret = -1;
+    if (!wr.failed) {
+        size_t sz_body = 0;
+        const char *body = purc_rwstream_get_mem_buffer(wr.out, &sz_body);
+
+        struct image_header header = { };
+        memcpy(header.magic, IMG_MAGIC, sizeof(IMG_MAGIC));
+        header.version = IMG_VERSION;
+        header.byte_order = IMG_BYTE_ORDER;
+        header.sz_long_double = sizeof(long double);
+        memcpy(header.md5, md5, MD5_DIGEST_SIZE);
+        header.src_length = src_length;
+        header.body_length = sz_body;
+
+        if (purc_rwstream_write(out, &header, sizeof(header)) ==
+                    (ssize_t)sizeof(header) &&
+                purc_rwstream_write(out, body, sz_body) == (ssize_t)sz_body)
+            ret = 0;
+    }
+
+    purc_rwstream_destroy(wr.out);
+    pcutils_arrlist_free(wr.bodies);
+    return ret;
+}
+
+static int
+keep_element(struct image_reader *rd, struct pcvdom_element *elem)
+{
+    if (rd->nr_elems == rd->sz_elems) {
+        size_t sz = rd->sz_elems ? rd->sz_elems * 2 : 64;
+        struct pcvdom_element **elems;
+        elems = realloc(rd->elems, sz * sizeof(elems[0]));
+        if (!elems) {
+            pcinst_set_error(PURC_ERROR_OUT_OF_MEMORY);
+            return -1;
+        }
+        rd->elems = elems;
+        rd->sz_elems = sz;
+    }
+
+    rd->elems[rd->nr_elems++] = elem;
+    return 0;
+}
+
+static struct pcvdom_node *
+read_node(struct image_reader *rd, int depth);
+
+static void
+read_children(struct image_reader *rd, struct pcvdom_node *parent, int depth)
+{
+    uint32_t nr = get_u32(rd);
+    for (uint32_t i = 0; i < nr && !rd->failed; i++) {
+        struct pcvdom_node *child = read_node(rd, depth + 1);
+        if (child) {
+            bool b = pctree_node_append_child(&parent->node, &child->node);
+            PC_ASSERT(b);
+        }
+    }
+}
+
+static struct pcvdom_element *
+read_element(struct image_reader *rd, int depth)
+{
+    bool is_null;
+    char *tag_name = get_string(rd, NULL, &is_null);
+    if (!tag_name) {
+        rd->failed = 1;
+        return NULL;
+    }
+
+    struct pcvdom_element *elem = pcvdom_element_create_c(tag_name);
+    free(tag_name);
+    if (!elem || keep_element(rd, elem)) {
+        if (elem)
+            pcvdom_node_destroy(&elem->node);
+        rd->failed = 1;
+        return NULL;
+    }
+
+    elem->self_closing = get_u8(rd) ? 1 : 0;
+
+    uint32_t nr_attrs = get_u32(rd);
+    for (uint32_t i = 0; i < nr_attrs && !rd->failed; i++) {
+        char *key = get_string(rd, NULL, &is_null);
+        uint8_t op = get_u8(rd);
+        uint8_t has_val = get_u8(rd);
+        struct pcvcm_node *val = NULL;
+        if (has_val && !rd->failed)
+            val = read_vcm(rd, depth + 1);
+
+        struct pcvdom_attr *attr = NULL;
+        if (!rd->failed && key && op < PCHVML_ATTRIBUTE_MAX)
+            attr = pcvdom_attr_create(key, (enum pchvml_attr_operator)op, val);
+        free(key);
+
+        if (!attr || pcvdom_element_append_attr(elem, attr)) {
+            if (attr)
+                pcvdom_attr_destroy(attr);
+            else if (val)
+                pcvcm_node_destroy(val);
+            rd->failed = 1;
+        }
+    }
+
+    if (!rd->failed)
+        read_children(rd, &elem->node, depth);
+
+    /* keep the element even on failure: rd->elems still refers to it,
+       and it is destroyed with its parent */
+    return elem;
+}
+
+static struct pcvdom_node *
+read_node(struct image_reader *rd, int depth)
+{
+    if (depth > IMG_MAX_DEPTH) {
+        rd->failed = 1;
+        return NULL;
+    }
+
+    uint8_t type = get_u8(rd);
+    if (rd->failed)
+        return NULL;
+
+    switch (type) {
+    case PCVDOM_NODE_ELEMENT:
+    {
+        struct pcvdom_element *elem = read_element(rd, depth);
+        return elem ? &elem->node : NULL;
+    }
+
+    case PCVDOM_NODE_CONTENT:
+    {
+        struct pcvcm_node *vcm = read_vcm(rd, depth + 1);
+        if (!vcm)
+            return NULL;
+
+        struct pcvdom_content *content = pcvdom_content_create(vcm);
+        if (!content) {
+            pcvcm_node_destroy(vcm);
+            rd->failed = 1;
+            return NULL;
+        }
+        return &content->node;
+    }
+
+    case PCVDOM_NODE_COMMENT:
+    {
+        bool is_null;
+        char *text = get_string(rd, NULL, &is_null);
+        if (!text) {
+            rd->failed = 1;
+            return NULL;
+        }
+
+        struct pcvdom_comment *comment = pcvdom_comment_create(text);
+        free(text);
+        if (!comment) {
+            rd->failed = 1;
+            return NULL;
+        }
+        return &comment->node;
+    }
+
+    default:
+        rd->failed = 1;
+        return NULL;
+    }
+}
+
+static struct pcvdom_element *
+element_by_index(struct image_reader *rd, uint32_t idx)
+{
+    if (idx == IMG_NO_ELEMENT)
+        return NULL;
+
+    if (idx >= rd->nr_elems) {
+        rd->failed = 1;
+        return NULL;
+    }
+
+    return rd->elems[idx];
+}
+
+struct pcvdom_document *
+pcvdom_document_read_image(const void *image, size_t sz_image,
+        const unsigned char *md5, size_t src_length)
+{
+    struct image_header header;
+    if (!image || sz_image < sizeof(header)) {
+        pcinst_set_error(PURC_ERROR_INVALID_VALUE);
+        return NULL;
+    }
+
+    memcpy(&header, image, sizeof(header));
+    if (memcmp(header.magic, IMG_MAGIC, sizeof(IMG_MAGIC)) ||
+            header.version != IMG_VERSION ||
+            header.byte_order != IMG_BYTE_ORDER ||
+            header.sz_long_double != sizeof(long double) ||
+            header.body_length != sz_image - sizeof(header) ||
+            header.src_length != src_length ||
+            (md5 && memcmp(header.md5, md5, MD5_DIGEST_SIZE))) {
+        pcinst_set_error(PURC_ERROR_INVALID_VALUE);
+        return NULL;
+    }
+
+    struct image_reader rd = { };
+    rd.p = (const uint8_t *)image + sizeof(header);
+    rd.end = rd.p + header.body_length;
+
+    struct pcvdom_document *doc = pcvdom_document_create();
+    if (!doc)
+        return NULL;
+
+    /* the doctype has both the name and the system information, or none */
+    bool name_is_null, si_is_null;
+    char *name = get_string(&rd, NULL, &name_is_null);
+    char *si = get_string(&rd, NULL, &si_is_null);
+    if (name_is_null != si_is_null)
+        rd.failed = 1;
+    else if (name && si && pcvdom_document_set_doctype(doc, name, si))
+        rd.failed = 1;
+    free(name);
+    free(si);
+
+    doc->quirks = get_u8(&rd) ? 1 : 0;
+
+    if (!rd.failed)
+        read_children(&rd, &doc->node, 0);
+
+    doc->root = element_by_index(&rd, get_u32(&rd));
+    doc->head = element_by_index(&rd, get_u32(&rd));
+    doc->body = element_by_index(&rd, get_u32(&rd));
+
+    uint32_t nr_bodies = get_u32(&rd);
+    for (uint32_t i = 0; i < nr_bodies && !rd.failed; i++) {
+        struct pcvdom_element *body = element_by_index(&rd, get_u32(&rd));
+        if (!body || pcutils_arrlist_put_idx(doc->bodies, i, body))
+            rd.failed = 1;
+    }
+
+    if (rd.p != rd.end)
+        rd.failed = 1;
+
+    free(rd.elems);
+
+    if (rd.failed) {
+        pcvdom_document_unref(doc);
+        purc_set_error(PURC_ERROR_INVALID_VALUE);
+        return NULL;
+    }
+
+    return doc;
+}
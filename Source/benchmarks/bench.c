@@ -0,0 +1,753 @@
+/*
+ * @file bench.c
+ * @author
+ * @date 2026/10/16
+ * @brief The benchmark harness: runs the cases, reports the throughput, the
+ *      latency percentiles and the variant usage, and compares the results
+ *      with the ones of a previous run.
+ *
+ * Copyright (C) 2022 FMSoft <https://www.fmsoft.cn>
+ *
+ * This file is a part of PurC (short for Purring Cat), an HVML interpreter.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "bench.h"
+#include "private/utils.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <getopt.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/utsname.h>
+
+#define BENCH_APP_NAME          "cn.fmsoft.hvml.benchmarks"
+#define BENCH_RUN_NAME          "purc_bench"
+#define BENCH_FORMAT            "purc-bench/1"
+
+#define DEF_MICRO_SAMPLES       30
+#define DEF_MACRO_SAMPLES       20
+#define DEF_MACRO_WARMUPS       2
+#define DEF_BATCH_MS            2.0
+#define MAX_BATCH               (1UL << 28)
+
+struct bench_opts {
+    const char *filter;
+    const char *json_file;
+    const char *baseline;
+    uint64_t    seed;
+    size_t      nr_samples;     /* 0 for the default of the kind */
+    double      batch_ms;
+    double      threshold;      /* in percent; negative for no check */
+    bool        list;
+};
+
+struct bench_result {
+    const struct bench_case *bc;
+
+    size_t      batch;          /* operations per sample */
+    size_t      nr_samples;
+    uint64_t    total_ns;
+    size_t      bytes_per_op;
+
+    /* in nanoseconds per operation */
+    double      min, mean, stddev, p50, p90, p99, max;
+    double      ops_per_sec;
+
+    /* from purc_variant_usage_stat() */
+    ssize_t     setup_values, setup_mem;
+    ssize_t     growth_values, growth_mem;
+    ssize_t     leaked_values, leaked_mem;
+    size_t      max_reserved;
+    ssize_t     leaked_by_type[PURC_VARIANT_TYPE_NR];
+};
+
+static const struct bench_case *all_suites[] = {
+    bench_variant_cases,
+    bench_utils_cases,
+    bench_ejson_cases,
+    bench_hvml_cases,
+    bench_pcrdr_cases,
+};
+
+static uint64_t random_state = 1;
+
+void bench_srandom(uint64_t seed)
+{
+    random_state = seed ? seed : 1;
+}
+
+uint64_t bench_random(void)
+{
+    random_state ^= random_state >> 12;
+    random_state ^= random_state << 25;
+    random_state ^= random_state >> 27;
+    return random_state * 0x2545F4914F6CDD1DULL;
+}
+
+char *bench_make_json_doc(size_t nr_records, size_t *len)
+{
+    static const char *cities[] = {
+        "Beijing", "Shanghai", "Guangzhou", "Shenzhen", "北京", "上海",
+    };
+
+    struct pcutils_mystring mystr;
+    char buf[512];
+
+    pcutils_mystring_init(&mystr);
+    pcutils_mystring_append_mchar(&mystr, (const unsigned char *)"[", 1);
+    for (size_t i = 0; i < nr_records; i++) {
+        int n = snprintf(buf, sizeof(buf),
+                "%s{\"id\":%zu,\"name\":\"record-%08llx\",\"active\":%s,"
+                "\"score\":%.3f,\"tags\":[\"t%u\",\"t%u\",\"t%u\"],"
+                "\"info\":{\"city\":\"%s\",\"zip\":\"%05u\",\"note\":null}}",
+                i ? "," : "", i,
+                (unsigned long long)(bench_random() & 0xFFFFFFFF),
+                (bench_random() & 1) ? "true" : "false",
+                (bench_random() % 100000) / 1000.0,
+                (unsigned)(bench_random() % 100),
+                (unsigned)(bench_random() % 100),
+                (unsigned)(bench_random() % 100),
+                cities[bench_random() % PCA_TABLESIZE(cities)],
+                (unsigned)(bench_random() % 100000));
+        pcutils_mystring_append_mchar(&mystr, (const unsigned char *)buf, n);
+    }
+    pcutils_mystring_append_mchar(&mystr, (const unsigned char *)"]", 1);
+
+    if (pcutils_mystring_done(&mystr)) {
+        pcutils_mystring_free(&mystr);
+        return NULL;
+    }
+
+    if (len)
+        *len = mystr.nr_bytes - 1;
+    return mystr.buff;
+}
+
+static uint64_t now_in_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static int cmp_doubles(const void *a, const void *b)
+{
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+/* the nearest-rank percentile of sorted values */
+static double percentile(const double *sorted, size_t n, double p)
+{
+    size_t rank = (size_t)ceil(p / 100.0 * n);
+    return sorted[rank ? rank - 1 : 0];
+}
+
+static bool
+run_case(const struct bench_case *bc, const struct bench_opts *opts,
+        struct bench_result *result)
+{
+    const struct purc_variant_stat *stat = purc_variant_usage_stat();
+    struct purc_variant_stat before, after_setup;
+    void *data = NULL;
+    double *samples = NULL;
+    bool ok = false;
+
+    memset(result, 0, sizeof(*result));
+    result->bc = bc;
+
+    bench_srandom(opts->seed);
+    before = *stat;
+    if (bc->setup && !bc->setup(&data)) {
+        fprintf(stderr, "%s: failed to set up: %s\n", bc->name,
+                purc_get_error_message(purc_get_last_error()));
+        if (data && bc->teardown)
+            bc->teardown(data);
+        return false;
+    }
+    after_setup = *stat;
+
+    if (bc->bytes_per_op)
+        result->bytes_per_op = bc->bytes_per_op(data);
+
+    /* warm up, and find a batch size making a sample last long enough
+       for the clock of micro benchmarks */
+    size_t batch = 1;
+    if (bc->kind == BENCH_KIND_MICRO) {
+        uint64_t target = (uint64_t)(opts->batch_ms * 1000000.0);
+        for (;;) {
+            uint64_t t = now_in_ns();
+            if (!bc->run(data, batch))
+                goto failed;
+            t = now_in_ns() - t;
+
+            if (t >= target || batch >= MAX_BATCH)
+                break;
+
+            double f = t ? (double)target / t * 1.2 : 100.0;
+            if (f > 100.0)
+                f = 100.0;
+            else if (f < 2.0)
+                f = 2.0;
+            batch = (size_t)(batch * f);
+            if (batch > MAX_BATCH)
+                batch = MAX_BATCH;
+        }
+    }
+    else {
+        for (int i = 0; i < DEF_MACRO_WARMUPS; i++) {
+            if (!bc->run(data, 1))
+                goto failed;
+        }
+    }
+
+    size_t nr_samples = opts->nr_samples;
+    if (nr_samples == 0)
+        nr_samples = (bc->kind == BENCH_KIND_MICRO) ?
+            DEF_MICRO_SAMPLES : DEF_MACRO_SAMPLES;
+
+    samples = malloc(sizeof(double) * nr_samples);
+    if (samples == NULL)
+        goto failed;
+
+    for (size_t i = 0; i < nr_samples; i++) {
+        uint64_t t = now_in_ns();
+        if (!bc->run(data, batch))
+            goto failed;
+        t = now_in_ns() - t;
+
+        result->total_ns += t;
+        samples[i] = (double)t / batch;
+
+        ssize_t values = stat->nr_total_values - after_setup.nr_total_values;
+        ssize_t mem = stat->sz_total_mem - after_setup.sz_total_mem;
+        if (values > result->growth_values)
+            result->growth_values = values;
+        if (mem > result->growth_mem)
+            result->growth_mem = mem;
+    }
+
+    result->batch = batch;
+    result->nr_samples = nr_samples;
+    result->ops_per_sec = (double)batch * nr_samples * 1e9 /
+        (result->total_ns ? result->total_ns : 1);
+
+    double sum = 0, sum2 = 0;
+    for (size_t i = 0; i < nr_samples; i++)
+        sum += samples[i];
+    result->mean = sum / nr_samples;
+    for (size_t i = 0; i < nr_samples; i++)
+        sum2 += (samples[i] - result->mean) * (samples[i] - result->mean);
+    result->stddev = sqrt(sum2 / nr_samples);
+
+    qsort(samples, nr_samples, sizeof(double), cmp_doubles);
+    result->min = samples[0];
+    result->max = samples[nr_samples - 1];
+    result->p50 = percentile(samples, nr_samples, 50);
+    result->p90 = percentile(samples, nr_samples, 90);
+    result->p99 = percentile(samples, nr_samples, 99);
+    ok = true;
+
+failed:
+    if (!ok)
+        fprintf(stderr, "%s: failed to run: %s\n", bc->name,
+                purc_get_error_message(purc_get_last_error()));
+
+    free(samples);
+    if (bc->teardown)
+        bc->teardown(data);
+
+    result->setup_values = after_setup.nr_total_values - before.nr_total_values;
+    result->setup_mem = after_setup.sz_total_mem - before.sz_total_mem;
+    result->leaked_values = stat->nr_total_values - before.nr_total_values;
+    result->leaked_mem = stat->sz_total_mem - before.sz_total_mem;
+    result->max_reserved = stat->nr_max_reserved;
+    for (int i = 0; i < PURC_VARIANT_TYPE_NR; i++)
+        result->leaked_by_type[i] = stat->nr_values[i] - before.nr_values[i];
+
+    return ok;
+}
+
+static const char *format_ns(double ns, char *buf, size_t sz)
+{
+    if (ns < 1e3)
+        snprintf(buf, sz, "%.1fns", ns);
+    else if (ns < 1e6)
+        snprintf(buf, sz, "%.2fus", ns / 1e3);
+    else if (ns < 1e9)
+        snprintf(buf, sz, "%.2fms", ns / 1e6);
+    else
+        snprintf(buf, sz, "%.2fs", ns / 1e9);
+    return buf;
+}
+
+static void print_result(FILE *fp, const struct bench_result *r)
+{
+    char p50[32], p90[32], p99[32];
+
+    fprintf(fp, "%-32s %14.1f ops/s  p50 %10s  p90 %10s  p99 %10s",
+            r->bc->name, r->ops_per_sec,
+            format_ns(r->p50, p50, sizeof(p50)),
+            format_ns(r->p90, p90, sizeof(p90)),
+            format_ns(r->p99, p99, sizeof(p99)));
+    if (r->bytes_per_op)
+        fprintf(fp, "  %8.1f MB/s",
+                r->ops_per_sec * r->bytes_per_op / 1024.0 / 1024.0);
+    if (r->leaked_values)
+        fprintf(fp, "  leaked %zd variants", r->leaked_values);
+    fputc('\n', fp);
+}
+
+static void
+set_number(purc_variant_t obj, const char *key, double d)
+{
+    purc_variant_t v = purc_variant_make_number(d);
+    purc_variant_object_set_by_static_ckey(obj, key, v);
+    purc_variant_unref(v);
+}
+
+static void
+set_longint(purc_variant_t obj, const char *key, int64_t i64)
+{
+    purc_variant_t v = purc_variant_make_longint(i64);
+    purc_variant_object_set_by_static_ckey(obj, key, v);
+    purc_variant_unref(v);
+}
+
+static void
+set_string(purc_variant_t obj, const char *key, const char *str)
+{
+    purc_variant_t v = purc_variant_make_string(str, false);
+    purc_variant_object_set_by_static_ckey(obj, key, v);
+    purc_variant_unref(v);
+}
+
+static void
+set_object(purc_variant_t obj, const char *key, purc_variant_t v)
+{
+    purc_variant_object_set_by_static_ckey(obj, key, v);
+    purc_variant_unref(v);
+}
+
+static purc_variant_t make_result_object(const struct bench_result *r)
+{
+    purc_variant_t obj = purc_variant_make_object_0();
+
+    set_string(obj, "name", r->bc->name);
+    set_string(obj, "kind",
+            (r->bc->kind == BENCH_KIND_MICRO) ? "micro" : "macro");
+    set_longint(obj, "batch", r->batch);
+    set_longint(obj, "samples", r->nr_samples);
+    set_longint(obj, "ops", (int64_t)(r->batch * r->nr_samples));
+    set_number(obj, "total_ns", r->total_ns);
+    set_number(obj, "ops_per_sec", r->ops_per_sec);
+    if (r->bytes_per_op) {
+        set_longint(obj, "bytes_per_op", r->bytes_per_op);
+        set_number(obj, "mb_per_sec",
+                r->ops_per_sec * r->bytes_per_op / 1024.0 / 1024.0);
+    }
+
+    purc_variant_t ns = purc_variant_make_object_0();
+    set_number(ns, "min", r->min);
+    set_number(ns, "mean", r->mean);
+    set_number(ns, "stddev", r->stddev);
+    set_number(ns, "p50", r->p50);
+    set_number(ns, "p90", r->p90);
+    set_number(ns, "p99", r->p99);
+    set_number(ns, "max", r->max);
+    set_object(obj, "ns_per_op", ns);
+
+    purc_variant_t usage = purc_variant_make_object_0();
+    set_longint(usage, "setup_values", r->setup_values);
+    set_longint(usage, "setup_mem", r->setup_mem);
+    set_longint(usage, "growth_values", r->growth_values);
+    set_longint(usage, "growth_mem", r->growth_mem);
+    set_longint(usage, "leaked_values", r->leaked_values);
+    set_longint(usage, "leaked_mem", r->leaked_mem);
+    set_longint(usage, "max_reserved", r->max_reserved);
+
+    purc_variant_t by_type = purc_variant_make_object_0();
+    for (int i = 0; i < PURC_VARIANT_TYPE_NR; i++) {
+        if (r->leaked_by_type[i])
+            set_longint(by_type, purc_variant_typename(i),
+                    r->leaked_by_type[i]);
+    }
+    set_object(usage, "leaked_by_type", by_type);
+    set_object(obj, "variants", usage);
+
+    return obj;
+}
+
+static purc_variant_t
+make_report(const struct bench_opts *opts,
+        const struct bench_result *results, size_t nr_results)
+{
+    purc_variant_t report = purc_variant_make_object_0();
+    char buf[64];
+
+    set_string(report, "format", BENCH_FORMAT);
+    set_string(report, "purc", purc_get_version_string());
+
+    time_t t = time(NULL);
+    struct tm tm;
+    gmtime_r(&t, &tm);
+    strftime(buf, sizeof(buf), "%Y-%m-%dT%H:%M:%SZ", &tm);
+    set_string(report, "timestamp", buf);
+
+    purc_variant_t host = purc_variant_make_object_0();
+    struct utsname uts;
+    if (uname(&uts) == 0) {
+        set_string(host, "system", uts.sysname);
+        set_string(host, "release", uts.release);
+        set_string(host, "machine", uts.machine);
+    }
+    set_longint(host, "cpus", sysconf(_SC_NPROCESSORS_ONLN));
+#ifdef __VERSION__
+    set_string(host, "compiler", __VERSION__);
+#endif
+#ifdef NDEBUG
+    set_string(host, "build", "release");
+#else
+    set_string(host, "build", "debug");
+#endif
+    set_object(report, "host", host);
+
+    purc_variant_t config = purc_variant_make_object_0();
+    set_longint(config, "seed", opts->seed);
+    set_longint(config, "samples", opts->nr_samples);
+    set_number(config, "batch_ms", opts->batch_ms);
+    if (opts->filter)
+        set_string(config, "filter", opts->filter);
+    set_object(report, "config", config);
+
+    purc_variant_t array = purc_variant_make_array_0();
+    for (size_t i = 0; i < nr_results; i++) {
+        purc_variant_t v = make_result_object(results + i);
+        purc_variant_array_append(array, v);
+        purc_variant_unref(v);
+    }
+    set_object(report, "results", array);
+
+    return report;
+}
+
+static int write_report(const char *file, purc_variant_t report)
+{
+    purc_rwstream_t rws = purc_rwstream_new_buffer(4096, 0);
+    if (rws == NULL)
+        return -1;
+
+    purc_variant_serialize(report, rws, 0,
+            PCVARIANT_SERIALIZE_OPT_PRETTY |
+            PCVARIANT_SERIALIZE_OPT_NOSLASHESCAPE, NULL);
+    purc_rwstream_write(rws, "\n", 1);
+
+    size_t sz = 0;
+    const char *buf = purc_rwstream_get_mem_buffer(rws, &sz);
+
+    int ret = 0;
+    FILE *fp = strcmp(file, "-") ? fopen(file, "w") : stdout;
+    if (fp == NULL || fwrite(buf, 1, sz, fp) != sz) {
+        fprintf(stderr, "Failed to write the results to %s\n", file);
+        ret = -1;
+    }
+    if (fp && fp != stdout)
+        fclose(fp);
+
+    purc_rwstream_destroy(rws);
+    return ret;
+}
+
+static bool get_number(purc_variant_t obj, const char *key, double *d)
+{
+    purc_variant_t v = purc_variant_object_get_by_ckey(obj, key);
+    return v && purc_variant_cast_to_number(v, d, false);
+}
+
+/* Compares the results with the ones of the same names in the baseline;
+   returns the number of the cases which slowed down more than the
+   threshold, or -1 if failed to load the baseline. */
+static int
+compare_with_baseline(FILE *fp, const char *file, double threshold,
+        const struct bench_result *results, size_t nr_results)
+{
+    purc_variant_t base = purc_variant_load_from_json_file(file);
+    if (base == PURC_VARIANT_INVALID) {
+        fprintf(stderr, "Failed to load the baseline: %s\n", file);
+        return -1;
+    }
+
+    size_t nr_base = 0;
+    purc_variant_t array = purc_variant_object_get_by_ckey(base, "results");
+    if (array == PURC_VARIANT_INVALID ||
+            !purc_variant_array_size(array, &nr_base)) {
+        fprintf(stderr, "Not a result file of the benchmarks: %s\n", file);
+        purc_variant_unref(base);
+        return -1;
+    }
+
+    fprintf(fp, "\nCompared with %s:\n", file);
+
+    int nr_slower = 0;
+    for (size_t i = 0; i < nr_results; i++) {
+        const struct bench_result *r = results + i;
+        purc_variant_t old = PURC_VARIANT_INVALID;
+
+        for (size_t j = 0; j < nr_base; j++) {
+            purc_variant_t v = purc_variant_array_get(array, j);
+            purc_variant_t name = purc_variant_object_get_by_ckey(v, "name");
+            const char *s = name ? purc_variant_get_string_const(name) : NULL;
+            if (s && strcmp(s, r->bc->name) == 0) {
+                old = v;
+                break;
+            }
+        }
+
+        double ops, p50;
+        purc_variant_t ns = old ?
+            purc_variant_object_get_by_ckey(old, "ns_per_op") : NULL;
+        if (old == PURC_VARIANT_INVALID || ns == PURC_VARIANT_INVALID ||
+                !get_number(old, "ops_per_sec", &ops) || ops <= 0 ||
+                !get_number(ns, "p50", &p50) || p50 <= 0) {
+            fprintf(fp, "%-32s %14s\n", r->bc->name, "(new)");
+            continue;
+        }
+
+        double delta_ops = (r->ops_per_sec - ops) * 100.0 / ops;
+        double delta_p50 = (r->p50 - p50) * 100.0 / p50;
+        bool slower = (threshold >= 0 && delta_ops < -threshold);
+        if (slower)
+            nr_slower++;
+
+        fprintf(fp, "%-32s %14.1f -> %14.1f ops/s (%+6.1f%%)  "
+                "p50 %+6.1f%%%s\n", r->bc->name, ops, r->ops_per_sec,
+                delta_ops, delta_p50, slower ? "  SLOWER" : "");
+    }
+
+    purc_variant_unref(base);
+    return nr_slower;
+}
+
+static void print_usage(FILE *fp)
+{
+    fputs(
+        "purc_bench: the micro and macro benchmarks of PurC.\n"
+        "\n"
+        "Usage: purc_bench [options]\n"
+        "\n"
+        "Options:\n"
+        "  -f --filter=<substring>\n"
+        "        Only run the cases whose names contain the substring.\n"
+        "  -j --json=<file>\n"
+        "        Write the results as JSON to the file ('-' for stdout).\n"
+        "  -b --baseline=<file>\n"
+        "        Compare the results with the ones in a JSON file written\n"
+        "        by a previous run.\n"
+        "  -t --threshold=<percent>\n"
+        "        Exit with 1 if a case is slower than the baseline by more\n"
+        "        than the percent of operations per second.\n"
+        "  -s --samples=<number>\n"
+        "        The number of timed samples of each case (default: 30 for\n"
+        "        the micro benchmarks and 20 for the macro ones).\n"
+        "  -m --batch-ms=<milliseconds>\n"
+        "        The least time of a sample of a micro benchmark (default: 2).\n"
+        "  -r --seed=<number>\n"
+        "        The seed of the generated data (default: 1).\n"
+        "  -l --list\n"
+        "        List the cases and exit.\n"
+        "  -h --help\n"
+        "        This help.\n",
+        fp);
+}
+
+static int read_option_args(struct bench_opts *opts, int argc, char **argv)
+{
+    static const char short_options[] = "f:j:b:t:s:m:r:lh";
+    static const struct option long_opts[] = {
+        { "filter"      , required_argument , NULL , 'f' },
+        { "json"        , required_argument , NULL , 'j' },
+        { "baseline"    , required_argument , NULL , 'b' },
+        { "threshold"   , required_argument , NULL , 't' },
+        { "samples"     , required_argument , NULL , 's' },
+        { "batch-ms"    , required_argument , NULL , 'm' },
+        { "seed"        , required_argument , NULL , 'r' },
+        { "list"        , no_argument       , NULL , 'l' },
+        { "help"        , no_argument       , NULL , 'h' },
+        { 0, 0, 0, 0 }
+    };
+
+    int o, idx = 0;
+    char *end;
+
+    while ((o = getopt_long(argc, argv, short_options, long_opts, &idx)) >= 0) {
+        switch (o) {
+        case 'f':
+            opts->filter = optarg;
+            break;
+
+        case 'j':
+            opts->json_file = optarg;
+            break;
+
+        case 'b':
+            opts->baseline = optarg;
+            break;
+
+        case 't':
+            opts->threshold = strtod(optarg, &end);
+            if (*end || opts->threshold < 0)
+                goto bad_arg;
+            break;
+
+        case 's':
+            opts->nr_samples = strtoul(optarg, &end, 10);
+            if (*end || opts->nr_samples == 0)
+                goto bad_arg;
+            break;
+
+        case 'm':
+            opts->batch_ms = strtod(optarg, &end);
+            if (*end || opts->batch_ms <= 0)
+                goto bad_arg;
+            break;
+
+        case 'r':
+            opts->seed = strtoull(optarg, &end, 0);
+            if (*end)
+                goto bad_arg;
+            break;
+
+        case 'l':
+            opts->list = true;
+            break;
+
+        case 'h':
+            print_usage(stdout);
+            return 1;
+
+        default:
+            print_usage(stderr);
+            return -1;
+        }
+    }
+
+    if (optind < argc) {
+        fprintf(stderr, "Got an unknown argument: %s\n", argv[optind]);
+        return -1;
+    }
+
+    return 0;
+
+bad_arg:
+    fprintf(stderr, "Got a bad value for option -%c: %s\n", o, optarg);
+    return -1;
+}
+
+int main(int argc, char **argv)
+{
+    struct bench_opts opts = {
+        .seed = 1,
+        .batch_ms = DEF_BATCH_MS,
+        .threshold = -1,
+    };
+
+    int ret = read_option_args(&opts, argc, argv);
+    if (ret)
+        return ret > 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+
+    size_t nr_cases = 0;
+    for (size_t i = 0; i < PCA_TABLESIZE(all_suites); i++) {
+        for (const struct bench_case *bc = all_suites[i]; bc->name; bc++) {
+            if (opts.filter && strstr(bc->name, opts.filter) == NULL)
+                continue;
+            if (opts.list)
+                fprintf(stdout, "%s (%s)\n", bc->name,
+                        (bc->kind == BENCH_KIND_MICRO) ? "micro" : "macro");
+            nr_cases++;
+        }
+    }
+
+    if (opts.list)
+        return EXIT_SUCCESS;
+    if (nr_cases == 0) {
+        fprintf(stderr, "No case matches: %s\n", opts.filter);
+        return EXIT_FAILURE;
+    }
+
+    /* the headless renderer logs the messages to /dev/null, so that the
+       round trips of PCRDR do not depend on the speed of the disk */
+    struct purc_instance_extra_info info = { 0 };
+    info.renderer_comm = PURC_RDRCOMM_HEADLESS;
+    info.renderer_uri = "file:///dev/null";
+
+    unsigned int modules =
+        (PURC_MODULE_HVML | PURC_MODULE_PCRDR) & ~PURC_HAVE_FETCHER;
+    ret = purc_init_ex(modules, BENCH_APP_NAME, BENCH_RUN_NAME, &info);
+    if (ret != PURC_ERROR_OK) {
+        fprintf(stderr, "Failed to initialize the PurC instance: %s\n",
+                purc_get_error_message(ret));
+        return EXIT_FAILURE;
+    }
+
+    /* the human-readable results go to stderr if stdout takes the JSON */
+    FILE *out = (opts.json_file && strcmp(opts.json_file, "-") == 0) ?
+        stderr : stdout;
+
+    struct bench_result *results = calloc(nr_cases, sizeof(*results));
+    size_t nr_results = 0;
+    int nr_failed = 0;
+
+    for (size_t i = 0; results && i < PCA_TABLESIZE(all_suites); i++) {
+        for (const struct bench_case *bc = all_suites[i]; bc->name; bc++) {
+            if (opts.filter && strstr(bc->name, opts.filter) == NULL)
+                continue;
+
+            if (run_case(bc, &opts, results + nr_results)) {
+                print_result(out, results + nr_results);
+                nr_results++;
+            }
+            else {
+                nr_failed++;
+            }
+            fflush(out);
+        }
+    }
+
+    ret = (results && nr_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+
+    if (opts.json_file && nr_results) {
+        purc_variant_t report = make_report(&opts, results, nr_results);
+        if (write_report(opts.json_file, report))
+            ret = EXIT_FAILURE;
+        purc_variant_unref(report);
+    }
+
+    if (opts.baseline && nr_results) {
+        int nr_slower = compare_with_baseline(out, opts.baseline,
+                opts.threshold, results, nr_results);
+        if (nr_slower != 0)
+            ret = EXIT_FAILURE;
+    }
+
+    free(results);
+    purc_cleanup();
+    return ret;
+}
+
@@ -0,0 +1,88 @@
+/*
+ * @file bench.h
+ * @author
+ * @date 2026/10/16
+ * @brief The interfaces of the benchmark harness.
+ *
+ * Copyright (C) 2022 FMSoft <https://www.fmsoft.cn>
+ *
+ * This file is a part of PurC (short for Purring Cat), an HVML interpreter.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef PURC_BENCHMARKS_BENCH_H
+#define PURC_BENCHMARKS_BENCH_H
+
+#include "purc/purc.h"
+
+#include "config.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+enum bench_kind {
+    /* one API call or a few of them; timed in batches of operations */
+    BENCH_KIND_MICRO = 0,
+    /* a whole program or a round trip; every operation is timed */
+    BENCH_KIND_MACRO,
+};
+
+struct bench_case {
+    /* the name of the case, in the form of `<area>.<operation>` */
+    const char *name;
+    enum bench_kind kind;
+
+    /* prepares the fixture used by run() (nullable);
+       returns false on failure */
+    bool (*setup)(void **data);
+
+    /* performs the operation `nr_ops` times; returns false on failure */
+    bool (*run)(void *data, size_t nr_ops);
+
+    /* releases the fixture (nullable) */
+    void (*teardown)(void *data);
+
+    /* returns the number of bytes processed by one operation (nullable) */
+    size_t (*bytes_per_op)(void *data);
+};
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* the cases of each area; every array ends with a case without name */
+extern const struct bench_case bench_variant_cases[];
+extern const struct bench_case bench_utils_cases[];
+extern const struct bench_case bench_ejson_cases[];
+extern const struct bench_case bench_hvml_cases[];
+extern const struct bench_case bench_pcrdr_cases[];
+
+/* A small PRNG (xorshift64*) which does not depend on the C library, so that
+   the generated data are the same on all platforms for the same seed. The
+   harness seeds it before setting up each case. */
+void bench_srandom(uint64_t seed);
+uint64_t bench_random(void);
+
+/* Makes a JSON document containing an array of `nr_records` records;
+   the caller should free the returned buffer. */
+char *bench_make_json_doc(size_t nr_records, size_t *len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* not defined PURC_BENCHMARKS_BENCH_H */
+
@@ -0,0 +1,205 @@
+/*
+ * @file bench_ejson.c
+ * @author
+ * @date 2026/10/16
+ * @brief The benchmarks of the eJSON parser and the VCM evaluator.
+ *
+ * Copyright (C) 2022 FMSoft <https://www.fmsoft.cn>
+ *
+ * This file is a part of PurC (short for Purring Cat), an HVML interpreter.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "bench.h"
+#include "private/ejson.h"
+#include "private/vcm.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define NR_DOC_RECORDS      200
+/* large enough to be read in many blocks by the tokenizer reader */
+#define NR_LARGE_DOC_RECORDS    5000
+
+/* an expression referring to the members of a record of the document */
+static const char expression[] =
+    "{ \"id\": $REC.id, \"name\": $REC.name, \"active\": $REC.active, "
+    "\"city\": $REC.info.city, \"tags\": $REC.tags, "
+    "\"summary\": [ $REC.score, $REC.info.zip, \"fixed\" ] }";
+
+struct ejson_fixture {
+    char               *json;
+    size_t              len;
+
+    struct pcvcm_node  *tree;
+    purc_variant_t      record;
+};
+
+static bool setup_doc_records(void **data, size_t nr_records)
+{
+    struct ejson_fixture *fx = calloc(1, sizeof(*fx));
+    if (fx == NULL)
+        return false;
+    *data = fx;
+
+    fx->json = bench_make_json_doc(nr_records, &fx->len);
+    return fx->json != NULL;
+}
+
+static bool setup_doc(void **data)
+{
+    return setup_doc_records(data, NR_DOC_RECORDS);
+}
+
+static bool setup_large_doc(void **data)
+{
+    return setup_doc_records(data, NR_LARGE_DOC_RECORDS);
+}
+
+static void teardown_fixture(void *data)
+{
+    struct ejson_fixture *fx = data;
+
+    if (fx->tree)
+        pcvcm_node_destroy(fx->tree);
+    if (fx->record)
+        purc_variant_unref(fx->record);
+    free(fx->json);
+    free(fx);
+}
+
+static size_t bytes_of_doc(void *data)
+{
+    return ((struct ejson_fixture *)data)->len;
+}
+
+static struct pcvcm_node *parse(const char *json, size_t len)
+{
+    purc_rwstream_t rws = purc_rwstream_new_from_mem((void *)json, len);
+    if (rws == NULL)
+        return NULL;
+
+    struct pcvcm_node *root = NULL;
+    struct pcejson *parser = NULL;
+    if (pcejson_parse(&root, &parser, rws, PCEJSON_DEFAULT_DEPTH) != 0 &&
+            root) {
+        pcvcm_node_destroy(root);
+        root = NULL;
+    }
+
+    if (parser)
+        pcejson_destroy(parser);
+    purc_rwstream_destroy(rws);
+    return root;
+}
+
+static bool run_parse(void *data, size_t nr_ops)
+{
+    struct ejson_fixture *fx = data;
+
+    for (size_t i = 0; i < nr_ops; i++) {
+        struct pcvcm_node *root = parse(fx->json, fx->len);
+        if (root == NULL)
+            return false;
+        pcvcm_node_destroy(root);
+    }
+    return true;
+}
+
+static bool run_parse_eval(void *data, size_t nr_ops)
+{
+    struct ejson_fixture *fx = data;
+
+    for (size_t i = 0; i < nr_ops; i++) {
+        struct pcvcm_node *root = parse(fx->json, fx->len);
+        if (root == NULL)
+            return false;
+
+        purc_variant_t v = pcvcm_eval(root, NULL, false);
+        pcvcm_node_destroy(root);
+        if (v == PURC_VARIANT_INVALID)
+            return false;
+        purc_variant_unref(v);
+    }
+    return true;
+}
+
+static bool run_make_from_json_string(void *data, size_t nr_ops)
+{
+    struct ejson_fixture *fx = data;
+
+    for (size_t i = 0; i < nr_ops; i++) {
+        purc_variant_t v = purc_variant_make_from_json_string(fx->json,
+                fx->len);
+        if (v == PURC_VARIANT_INVALID)
+            return false;
+        purc_variant_unref(v);
+    }
+    return true;
+}
+
+static bool setup_expression(void **data)
+{
+    if (!setup_doc(data))
+        return false;
+
+    struct ejson_fixture *fx = *data;
+    purc_variant_t doc = purc_variant_make_from_json_string(fx->json, fx->len);
+    if (doc == PURC_VARIANT_INVALID)
+        return false;
+
+    fx->record = purc_variant_array_get(doc, NR_DOC_RECORDS / 2);
+    if (fx->record)
+        purc_variant_ref(fx->record);
+    purc_variant_unref(doc);
+
+    fx->tree = parse(expression, sizeof(expression) - 1);
+    return fx->record && fx->tree;
+}
+
+static purc_variant_t find_record(void *ctxt, const char *name)
+{
+    UNUSED_PARAM(name);
+    return (purc_variant_t)ctxt;
+}
+
+static bool run_eval(void *data, size_t nr_ops)
+{
+    struct ejson_fixture *fx = data;
+
+    for (size_t i = 0; i < nr_ops; i++) {
+        purc_variant_t v = pcvcm_eval_ex(fx->tree, NULL,
+                find_record, fx->record, false);
+        if (v == PURC_VARIANT_INVALID)
+            return false;
+        purc_variant_unref(v);
+    }
+    return true;
+}
+
+const struct bench_case bench_ejson_cases[] = {
+    { "ejson.parse", BENCH_KIND_MICRO,
+        setup_doc, run_parse, teardown_fixture, bytes_of_doc },
+    { "ejson.parse_large", BENCH_KIND_MICRO,
+        setup_large_doc, run_parse, teardown_fixture, bytes_of_doc },
+    { "ejson.parse_eval", BENCH_KIND_MICRO,
+        setup_doc, run_parse_eval, teardown_fixture, bytes_of_doc },
+    { "ejson.make_from_json_string", BENCH_KIND_MICRO,
+        setup_doc, run_make_from_json_string, teardown_fixture, bytes_of_doc },
+    { "vcm.eval", BENCH_KIND_MICRO,
+        setup_expression, run_eval, teardown_fixture, NULL },
+    { NULL, 0, NULL, NULL, NULL, NULL },
+};
+
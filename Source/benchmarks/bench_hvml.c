@@ -0,0 +1,134 @@
+/*
+ * @file bench_hvml.c
+ * @author
+ * @date 2026/10/16
+ * @brief The benchmarks of HVML programs executed by the scheduler.
+ *
+ * Copyright (C) 2022 FMSoft <https://www.fmsoft.cn>
+ *
+ * This file is a part of PurC (short for Purring Cat), an HVML interpreter.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "bench.h"
+
+/* Samples/hvml/fibonacci-void-temp.hvml without the output */
+static const char fibonacci[] =
+    "<!DOCTYPE hvml>"
+    "<hvml target=\"void\">"
+    "    <body id=\"theBody\">"
+    "        <init as \"count\" at \"_topmost\" with 2 temp />"
+    "        <init as \"last_one\" with 0L temp />"
+    "        <init as \"last_two\" with 1L temp />"
+    ""
+    "        <iterate on $last_two onlyif $L.lt($0<, 1000000000L)"
+    "                with $DATA.arith('+', $0<, $last_one) nosetotail >"
+    "            <init as \"last_one\" at \"2\" with $last_two temp />"
+    "            <init as \"last_two\" at \"2\" with $? temp />"
+    "            <update on \"$3!\" at \".count\" to \"displace\" with += 1 />"
+    "        </iterate>"
+    ""
+    "        <exit with [$count, $last_two] />"
+    "    </body>"
+    "</hvml>";
+
+/* builds a list in the HTML document from an archetype */
+static const char html_list[] =
+    "<!DOCTYPE hvml>"
+    "<hvml target=\"html\" lang=\"en\">"
+    "    <head>"
+    "        <init as=\"buttons\" uniquely>"
+    "            ["
+    "                { \"letters\": \"7\", \"class\": \"number\" },"
+    "                { \"letters\": \"8\", \"class\": \"number\" },"
+    "                { \"letters\": \"9\", \"class\": \"number\" },"
+    "                { \"letters\": \"←\", \"class\": \"c_blue backspace\" },"
+    "                { \"letters\": \"C\", \"class\": \"c_blue clear\" },"
+    "                { \"letters\": \"4\", \"class\": \"number\" },"
+    "                { \"letters\": \"5\", \"class\": \"number\" },"
+    "                { \"letters\": \"6\", \"class\": \"number\" },"
+    "                { \"letters\": \"×\", \"class\": \"c_blue multiplication\" },"
+    "                { \"letters\": \"÷\", \"class\": \"c_blue division\" },"
+    "                { \"letters\": \"1\", \"class\": \"number\" },"
+    "                { \"letters\": \"2\", \"class\": \"number\" },"
+    "                { \"letters\": \"3\", \"class\": \"number\" },"
+    "                { \"letters\": \"+\", \"class\": \"c_blue plus\" },"
+    "                { \"letters\": \"-\", \"class\": \"c_blue subtraction\" },"
+    "                { \"letters\": \"0\", \"class\": \"number\" },"
+    "                { \"letters\": \"00\", \"class\": \"number\" },"
+    "                { \"letters\": \".\", \"class\": \"number\" },"
+    "                { \"letters\": \"%\", \"class\": \"c_blue percent\" },"
+    "                { \"letters\": \"=\", \"class\": \"c_yellow equal\" }"
+    "            ]"
+    "        </init>"
+    "    </head>"
+    ""
+    "    <body>"
+    "        <div id=\"calculator\">"
+    "            <div id=\"c_value\">"
+    "                <archetype name=\"button\">"
+    "                    <li class=\"$?.class\">$?.letters</li>"
+    "                </archetype>"
+    ""
+    "                <ul>"
+    "                    <iterate on=\"$buttons\">"
+    "                        <update on=\"$@\" to=\"append\" with=\"$button\" />"
+    "                    </iterate>"
+    "                </ul>"
+    "            </div>"
+    "        </div>"
+    "    </body>"
+    "</hvml>";
+
+static bool setup_fibonacci(void **data)
+{
+    *data = (void *)fibonacci;
+    return true;
+}
+
+static bool setup_html_list(void **data)
+{
+    *data = (void *)html_list;
+    return true;
+}
+
+/* one operation loads the program, schedules it in a new coroutine
+   and runs the scheduler until the coroutine exits */
+static bool run_program(void *data, size_t nr_ops)
+{
+    const char *hvml = data;
+
+    for (size_t i = 0; i < nr_ops; i++) {
+        purc_vdom_t vdom = purc_load_hvml_from_string(hvml);
+        if (vdom == NULL)
+            return false;
+
+        if (purc_schedule_vdom_null(vdom) == NULL)
+            return false;
+
+        if (purc_run(NULL))
+            return false;
+    }
+    return true;
+}
+
+const struct bench_case bench_hvml_cases[] = {
+    { "hvml.fibonacci", BENCH_KIND_MACRO,
+        setup_fibonacci, run_program, NULL, NULL },
+    { "hvml.html_list", BENCH_KIND_MACRO,
+        setup_html_list, run_program, NULL, NULL },
+    { NULL, 0, NULL, NULL, NULL, NULL },
+};
+
@@ -0,0 +1,114 @@
+/*
+ * @file bench_pcrdr.c
+ * @author
+ * @date 2026/10/16
+ * @brief The benchmarks of PCRDR requests and responses against
+ *      the headless renderer.
+ *
+ * Copyright (C) 2022 FMSoft <https://www.fmsoft.cn>
+ *
+ * This file is a part of PurC (short for Purring Cat), an HVML interpreter.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "bench.h"
+
+#include <stdio.h>
+
+/* in seconds */
+#define TIME_EXPECTED       5
+
+static bool setup_conn(void **data)
+{
+    pcrdr_conn *conn = purc_get_conn_to_renderer();
+    if (conn == NULL)
+        return false;
+
+    *data = conn;
+    return true;
+}
+
+/* sends the request and waits for the response; returns the return code
+   of the response, or -1 on failure */
+static int request(pcrdr_conn *conn, pcrdr_msg *msg, uint64_t *result_value)
+{
+    pcrdr_msg *response = NULL;
+    int ret_code = -1;
+
+    if (msg == NULL)
+        return -1;
+
+    if (pcrdr_send_request_and_wait_response(conn, msg,
+                TIME_EXPECTED, &response) == 0) {
+        ret_code = response->retCode;
+        if (result_value)
+            *result_value = response->resultValue;
+        pcrdr_release_message(response);
+    }
+
+    pcrdr_release_message(msg);
+    return ret_code;
+}
+
+static bool run_get_property(void *data, size_t nr_ops)
+{
+    pcrdr_conn *conn = data;
+
+    for (size_t i = 0; i < nr_ops; i++) {
+        if (request(conn, pcrdr_make_request_message(
+                    PCRDR_MSG_TARGET_SESSION, 0,
+                    PCRDR_OPERATION_GETPROPERTY, NULL, NULL,
+                    PCRDR_MSG_ELEMENT_TYPE_VOID, NULL, "workspaceList",
+                    PCRDR_MSG_DATA_TYPE_VOID, NULL, 0), NULL) != PCRDR_SC_OK)
+            return false;
+    }
+    return true;
+}
+
+/* one operation creates a plain window in the default workspace
+   and destroys it; that is, two round trips */
+static bool run_plain_window(void *data, size_t nr_ops)
+{
+    pcrdr_conn *conn = data;
+    char handle[32];
+
+    for (size_t i = 0; i < nr_ops; i++) {
+        uint64_t win = 0;
+        if (request(conn, pcrdr_make_request_message(
+                    PCRDR_MSG_TARGET_WORKSPACE, 0,
+                    PCRDR_OPERATION_CREATEPLAINWINDOW, NULL, NULL,
+                    PCRDR_MSG_ELEMENT_TYPE_VOID, NULL, NULL,
+                    PCRDR_MSG_DATA_TYPE_VOID, NULL, 0), &win) != PCRDR_SC_OK)
+            return false;
+
+        snprintf(handle, sizeof(handle), "%llx", (unsigned long long)win);
+        if (request(conn, pcrdr_make_request_message(
+                    PCRDR_MSG_TARGET_WORKSPACE, 0,
+                    PCRDR_OPERATION_DESTROYPLAINWINDOW, NULL, NULL,
+                    PCRDR_MSG_ELEMENT_TYPE_HANDLE, handle, NULL,
+                    PCRDR_MSG_DATA_TYPE_VOID, NULL, 0), NULL) != PCRDR_SC_OK)
+            return false;
+    }
+    return true;
+}
+
+const struct bench_case bench_pcrdr_cases[] = {
+    { "pcrdr.get_property", BENCH_KIND_MACRO,
+        setup_conn, run_get_property, NULL, NULL },
+    { "pcrdr.plain_window", BENCH_KIND_MACRO,
+        setup_conn, run_plain_window, NULL, NULL },
+    { NULL, 0, NULL, NULL, NULL, NULL },
+};
+
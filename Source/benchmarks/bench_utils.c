@@ -0,0 +1,273 @@
+/*
+ * @file bench_utils.c
+ * @author
+ * @date 2026/10/16
+ * @brief The benchmarks of the utilities: the UTF-8 validator and
+ *      transcoders, and the CRC-32 engines.
+ *
+ * Copyright (C) 2022 FMSoft <https://www.fmsoft.cn>
+ *
+ * This file is a part of PurC (short for Purring Cat), an HVML interpreter.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "bench.h"
+#include "private/utf8.h"
+#include "private/utils.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define LEN_TEXT            (64 * 1024)
+#define LEN_CRC32_DATA      (64 * 1024)
+
+static const char line_ascii[] =
+    "{ \"id\": 12345, \"name\": \"record\", \"ok\": true },\n";
+static const char line_mixed[] =
+    "{ \"id\": 12345, \"name\": \"记录 record\", \"ok\": true },\n";
+
+struct utils_fixture {
+    char           *text;
+    size_t          len;
+    size_t          nr_chars;
+
+    unsigned char  *bytes;
+    size_t          nr_bytes;
+
+    /* the SIMD extension to use; -1 for the one selected by default */
+    int             simd_level;
+};
+
+static void teardown_fixture(void *data)
+{
+    struct utils_fixture *fx = data;
+
+    free(fx->text);
+    free(fx->bytes);
+    free(fx);
+}
+
+static size_t bytes_of_text(void *data)
+{
+    return ((struct utils_fixture *)data)->len;
+}
+
+/* fills the text with the line repeated, and encodes it in UTF-16LE */
+static bool setup_text(void **data, const char *line, int simd_level)
+{
+    struct utils_fixture *fx = calloc(1, sizeof(*fx));
+    if (fx == NULL)
+        return false;
+    *data = fx;
+    fx->simd_level = simd_level;
+
+    size_t len_line = strlen(line);
+    fx->len = LEN_TEXT - LEN_TEXT % len_line;
+    fx->text = malloc(fx->len + 1);
+    if (fx->text == NULL)
+        return false;
+    for (size_t i = 0; i < fx->len; i += len_line)
+        memcpy(fx->text + i, line, len_line);
+    fx->text[fx->len] = '\0';
+
+    if (!pcutils_string_check_utf8_len(fx->text, fx->len, &fx->nr_chars,
+                NULL))
+        return false;
+
+    /* four bytes for each character at most */
+    fx->bytes = malloc(fx->nr_chars * 4);
+    if (fx->bytes == NULL)
+        return false;
+
+    fx->nr_bytes = pcutils_string_encode_utf16le(fx->text, fx->len,
+            fx->nr_chars, fx->bytes, fx->nr_chars * 4);
+    return fx->nr_bytes > 0;
+}
+
+static bool setup_ascii(void **data)
+{
+    return setup_text(data, line_ascii, -1);
+}
+
+static bool setup_mixed(void **data)
+{
+    return setup_text(data, line_mixed, -1);
+}
+
+static bool setup_ascii_scalar(void **data)
+{
+    return setup_text(data, line_ascii, PCUTILS_UTF8_SIMD_NONE);
+}
+
+static bool setup_mixed_scalar(void **data)
+{
+    return setup_text(data, line_mixed, PCUTILS_UTF8_SIMD_NONE);
+}
+
+static bool run_validate(void *data, size_t nr_ops)
+{
+    struct utils_fixture *fx = data;
+    int level = (fx->simd_level < 0) ? pcutils_utf8_simd_level() :
+        pcutils_utf8_set_simd_level(fx->simd_level);
+    bool ok = true;
+
+    for (size_t i = 0; ok && i < nr_ops; i++) {
+        size_t nr_chars;
+        ok = pcutils_string_check_utf8_len(fx->text, fx->len,
+                &nr_chars, NULL) && nr_chars == fx->nr_chars;
+    }
+
+    pcutils_utf8_set_simd_level(level);
+    return ok;
+}
+
+static bool run_to_utf16(void *data, size_t nr_ops)
+{
+    struct utils_fixture *fx = data;
+
+    for (size_t i = 0; i < nr_ops; i++) {
+        if (pcutils_string_encode_utf16le(fx->text, fx->len, fx->nr_chars,
+                    fx->bytes, fx->nr_chars * 4) != fx->nr_bytes)
+            return false;
+    }
+    return true;
+}
+
+static bool run_from_utf16(void *data, size_t nr_ops)
+{
+    struct utils_fixture *fx = data;
+
+    for (size_t i = 0; i < nr_ops; i++) {
+        size_t sz_space, consumed;
+        char *text = pcutils_string_decode_utf16le(fx->bytes, fx->nr_bytes,
+                &sz_space, &consumed, true);
+        if (text == NULL)
+            return false;
+        free(text);
+    }
+    return true;
+}
+
+struct crc32_fixture {
+    unsigned char       data[LEN_CRC32_DATA];
+    purc_crc32_algo_t   algo;
+
+    /* the best engine to use; -1 for the best one for the algorithm */
+    int                 engine_limit;
+};
+
+static bool setup_crc32_data(void **data, purc_crc32_algo_t algo,
+        int engine_limit)
+{
+    struct crc32_fixture *fx = malloc(sizeof(*fx));
+    if (fx == NULL)
+        return false;
+    *data = fx;
+
+    for (size_t i = 0; i < LEN_CRC32_DATA; i++)
+        fx->data[i] = (unsigned char)bench_random();
+    fx->algo = algo;
+    fx->engine_limit = engine_limit;
+    return true;
+}
+
+static bool setup_crc32(void **data)
+{
+    return setup_crc32_data(data, PURC_K_ALGO_CRC32, -1);
+}
+
+static bool setup_crc32_bytewise(void **data)
+{
+    return setup_crc32_data(data, PURC_K_ALGO_CRC32,
+            PCUTILS_CRC32_ENGINE_BYTEWISE);
+}
+
+static bool setup_crc32_slicing8(void **data)
+{
+    return setup_crc32_data(data, PURC_K_ALGO_CRC32,
+            PCUTILS_CRC32_ENGINE_SLICING8);
+}
+
+static bool setup_crc32c(void **data)
+{
+    return setup_crc32_data(data, PURC_K_ALGO_CRC32C, -1);
+}
+
+static bool setup_crc32_bzip2(void **data)
+{
+    return setup_crc32_data(data, PURC_K_ALGO_CRC32_BZIP2, -1);
+}
+
+static void teardown_crc32(void *data)
+{
+    free(data);
+}
+
+static size_t bytes_of_crc32_data(void *data)
+{
+    UNUSED_PARAM(data);
+    return LEN_CRC32_DATA;
+}
+
+static bool run_crc32(void *data, size_t nr_ops)
+{
+    struct crc32_fixture *fx = data;
+    int limit = (fx->engine_limit < 0) ?
+        pcutils_crc32_engine(fx->algo) : fx->engine_limit;
+    int old_limit = pcutils_crc32_set_engine_limit(limit);
+
+    for (size_t i = 0; i < nr_ops; i++) {
+        pcutils_crc32_ctxt ctxt;
+        uint32_t crc32;
+
+        pcutils_crc32_begin(&ctxt, fx->algo);
+        pcutils_crc32_update(&ctxt, fx->data, LEN_CRC32_DATA);
+        pcutils_crc32_end(&ctxt, &crc32);
+    }
+
+    pcutils_crc32_set_engine_limit(old_limit);
+    return true;
+}
+
+const struct bench_case bench_utils_cases[] = {
+    { "utf8.validate_ascii", BENCH_KIND_MICRO,
+        setup_ascii, run_validate, teardown_fixture, bytes_of_text },
+    { "utf8.validate_ascii_scalar", BENCH_KIND_MICRO,
+        setup_ascii_scalar, run_validate, teardown_fixture, bytes_of_text },
+    { "utf8.validate_mixed", BENCH_KIND_MICRO,
+        setup_mixed, run_validate, teardown_fixture, bytes_of_text },
+    { "utf8.validate_mixed_scalar", BENCH_KIND_MICRO,
+        setup_mixed_scalar, run_validate, teardown_fixture, bytes_of_text },
+    { "utf8.to_utf16_ascii", BENCH_KIND_MICRO,
+        setup_ascii, run_to_utf16, teardown_fixture, bytes_of_text },
+    { "utf8.to_utf16_mixed", BENCH_KIND_MICRO,
+        setup_mixed, run_to_utf16, teardown_fixture, bytes_of_text },
+    { "utf8.from_utf16_ascii", BENCH_KIND_MICRO,
+        setup_ascii, run_from_utf16, teardown_fixture, bytes_of_text },
+    { "utf8.from_utf16_mixed", BENCH_KIND_MICRO,
+        setup_mixed, run_from_utf16, teardown_fixture, bytes_of_text },
+    { "crc32.crc32", BENCH_KIND_MICRO,
+        setup_crc32, run_crc32, teardown_crc32, bytes_of_crc32_data },
+    { "crc32.crc32_bytewise", BENCH_KIND_MICRO,
+        setup_crc32_bytewise, run_crc32, teardown_crc32, bytes_of_crc32_data },
+    { "crc32.crc32_slicing8", BENCH_KIND_MICRO,
+        setup_crc32_slicing8, run_crc32, teardown_crc32, bytes_of_crc32_data },
+    { "crc32.crc32c", BENCH_KIND_MICRO,
+        setup_crc32c, run_crc32, teardown_crc32, bytes_of_crc32_data },
+    { "crc32.crc32_bzip2", BENCH_KIND_MICRO,
+        setup_crc32_bzip2, run_crc32, teardown_crc32, bytes_of_crc32_data },
+    { NULL, 0, NULL, NULL, NULL, NULL },
+};
+
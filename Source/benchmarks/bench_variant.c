@@ -0,0 +1,436 @@
+/*
+ * @file bench_variant.c
+ * @author
+ * @date 2026/10/16
+ * @brief The benchmarks of variant creation, containers and serialization.
+ *
+ * Copyright (C) 2022 FMSoft <https://www.fmsoft.cn>
+ *
+ * This file is a part of PurC (short for Purring Cat), an HVML interpreter.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "bench.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define NR_BUILT_MEMBERS    64
+#define NR_LOOKUP_MEMBERS   1024
+#define NR_INDICES          4096
+#define NR_DOC_RECORDS      200
+#define NR_NUMBERS          4096
+#define NR_TEXT_LINES       1000
+#define LEN_KEY             16
+
+struct variant_fixture {
+    purc_variant_t  container;
+    purc_variant_t  members[NR_BUILT_MEMBERS];
+    char            keys[NR_LOOKUP_MEMBERS][LEN_KEY];
+    size_t          indices[NR_INDICES];
+
+    purc_rwstream_t rws;
+    unsigned        serialize_flags;
+    size_t          bytes;
+};
+
+static struct variant_fixture *new_fixture(size_t nr_keys)
+{
+    struct variant_fixture *fx = calloc(1, sizeof(*fx));
+    if (fx == NULL)
+        return NULL;
+
+    for (size_t i = 0; i < nr_keys; i++)
+        snprintf(fx->keys[i], LEN_KEY, "key-%04zu", i);
+    for (size_t i = 0; i < NR_INDICES; i++)
+        fx->indices[i] = bench_random() % (nr_keys ? nr_keys : 1);
+
+    return fx;
+}
+
+static void teardown_fixture(void *data)
+{
+    struct variant_fixture *fx = data;
+    if (fx == NULL)
+        return;
+
+    if (fx->container)
+        purc_variant_unref(fx->container);
+    for (size_t i = 0; i < NR_BUILT_MEMBERS; i++) {
+        if (fx->members[i])
+            purc_variant_unref(fx->members[i]);
+    }
+    if (fx->rws)
+        purc_rwstream_destroy(fx->rws);
+    free(fx);
+}
+
+static size_t bytes_of_fixture(void *data)
+{
+    return ((struct variant_fixture *)data)->bytes;
+}
+
+static bool run_number_make_free(void *data, size_t nr_ops)
+{
+    UNUSED_PARAM(data);
+
+    for (size_t i = 0; i < nr_ops; i++) {
+        purc_variant_t v = purc_variant_make_number((double)i);
+        if (v == PURC_VARIANT_INVALID)
+            return false;
+        purc_variant_unref(v);
+    }
+    return true;
+}
+
+static bool run_string_make_free(void *data, size_t nr_ops)
+{
+    UNUSED_PARAM(data);
+
+    for (size_t i = 0; i < nr_ops; i++) {
+        purc_variant_t v = purc_variant_make_string("a short string", false);
+        if (v == PURC_VARIANT_INVALID)
+            return false;
+        purc_variant_unref(v);
+    }
+    return true;
+}
+
+static bool setup_long_string(void **data)
+{
+    struct variant_fixture *fx = new_fixture(0);
+    if (fx == NULL)
+        return false;
+
+    /* reuse the space of the keys for a string of 255 characters */
+    char *str = fx->keys[0];
+    for (size_t i = 0; i < 255; i++)
+        str[i] = 'a' + bench_random() % 26;
+    str[255] = '\0';
+    fx->bytes = 255;
+
+    *data = fx;
+    return true;
+}
+
+static bool run_long_string_make_free(void *data, size_t nr_ops)
+{
+    struct variant_fixture *fx = data;
+
+    for (size_t i = 0; i < nr_ops; i++) {
+        purc_variant_t v = purc_variant_make_string(fx->keys[0], true);
+        if (v == PURC_VARIANT_INVALID)
+            return false;
+        purc_variant_unref(v);
+    }
+    return true;
+}
+
+static bool setup_members(void **data)
+{
+    struct variant_fixture *fx = new_fixture(NR_BUILT_MEMBERS);
+    if (fx == NULL)
+        return false;
+
+    for (size_t i = 0; i < NR_BUILT_MEMBERS; i++) {
+        purc_variant_t id = purc_variant_make_ulongint(i);
+        fx->members[i] = purc_variant_make_object_by_static_ckey(1, "id", id);
+        purc_variant_unref(id);
+        if (fx->members[i] == PURC_VARIANT_INVALID) {
+            teardown_fixture(fx);
+            return false;
+        }
+    }
+
+    *data = fx;
+    return true;
+}
+
+static bool run_array_build(void *data, size_t nr_ops)
+{
+    struct variant_fixture *fx = data;
+
+    for (size_t i = 0; i < nr_ops; i++) {
+        purc_variant_t array = purc_variant_make_array_0();
+        if (array == PURC_VARIANT_INVALID)
+            return false;
+
+        for (size_t j = 0; j < NR_BUILT_MEMBERS; j++) {
+            if (!purc_variant_array_append(array, fx->members[j])) {
+                purc_variant_unref(array);
+                return false;
+            }
+        }
+        purc_variant_unref(array);
+    }
+    return true;
+}
+
+static bool run_object_build(void *data, size_t nr_ops)
+{
+    struct variant_fixture *fx = data;
+
+    for (size_t i = 0; i < nr_ops; i++) {
+        purc_variant_t obj = purc_variant_make_object_0();
+        if (obj == PURC_VARIANT_INVALID)
+            return false;
+
+        for (size_t j = 0; j < NR_BUILT_MEMBERS; j++) {
+            if (!purc_variant_object_set_by_static_ckey(obj, fx->keys[j],
+                        fx->members[j])) {
+                purc_variant_unref(obj);
+                return false;
+            }
+        }
+        purc_variant_unref(obj);
+    }
+    return true;
+}
+
+static bool run_set_build(void *data, size_t nr_ops)
+{
+    struct variant_fixture *fx = data;
+
+    for (size_t i = 0; i < nr_ops; i++) {
+        purc_variant_t set = purc_variant_make_set_by_ckey(0, "id",
+                PURC_VARIANT_INVALID);
+        if (set == PURC_VARIANT_INVALID)
+            return false;
+
+        for (size_t j = 0; j < NR_BUILT_MEMBERS; j++) {
+            if (!purc_variant_set_add(set, fx->members[j], true)) {
+                purc_variant_unref(set);
+                return false;
+            }
+        }
+        purc_variant_unref(set);
+    }
+    return true;
+}
+
+static bool setup_lookup_array(void **data)
+{
+    struct variant_fixture *fx = new_fixture(NR_LOOKUP_MEMBERS);
+    if (fx == NULL)
+        return false;
+
+    fx->container = purc_variant_make_array_0();
+    for (size_t i = 0; fx->container && i < NR_LOOKUP_MEMBERS; i++) {
+        purc_variant_t v = purc_variant_make_ulongint(i);
+        purc_variant_array_append(fx->container, v);
+        purc_variant_unref(v);
+    }
+
+    *data = fx;
+    return fx->container != PURC_VARIANT_INVALID;
+}
+
+static bool run_array_get(void *data, size_t nr_ops)
+{
+    struct variant_fixture *fx = data;
+
+    for (size_t i = 0; i < nr_ops; i++) {
+        size_t idx = fx->indices[i % NR_INDICES];
+        if (purc_variant_array_get(fx->container, idx) == PURC_VARIANT_INVALID)
+            return false;
+    }
+    return true;
+}
+
+static bool setup_lookup_object(void **data)
+{
+    struct variant_fixture *fx = new_fixture(NR_LOOKUP_MEMBERS);
+    if (fx == NULL)
+        return false;
+
+    fx->container = purc_variant_make_object_0();
+    for (size_t i = 0; fx->container && i < NR_LOOKUP_MEMBERS; i++) {
+        purc_variant_t v = purc_variant_make_ulongint(i);
+        purc_variant_object_set_by_static_ckey(fx->container, fx->keys[i], v);
+        purc_variant_unref(v);
+    }
+
+    *data = fx;
+    return fx->container != PURC_VARIANT_INVALID;
+}
+
+static bool run_object_get(void *data, size_t nr_ops)
+{
+    struct variant_fixture *fx = data;
+
+    for (size_t i = 0; i < nr_ops; i++) {
+        const char *key = fx->keys[fx->indices[i % NR_INDICES]];
+        if (purc_variant_object_get_by_ckey(fx->container, key) ==
+                PURC_VARIANT_INVALID)
+            return false;
+    }
+    return true;
+}
+
+/* serializes the container once to get the size of the output and
+   to allocate the space of the buffer */
+static bool prepare_serialize(struct variant_fixture *fx, unsigned flags,
+        size_t sz_init)
+{
+    fx->serialize_flags = flags;
+    fx->rws = purc_rwstream_new_buffer(sz_init, 0);
+    if (fx->rws == NULL)
+        return false;
+
+    ssize_t n = purc_variant_serialize(fx->container, fx->rws, 0, flags, NULL);
+    if (n < 0)
+        return false;
+    fx->bytes = n;
+    return true;
+}
+
+static bool setup_serialize(void **data, unsigned flags)
+{
+    struct variant_fixture *fx = new_fixture(0);
+    if (fx == NULL)
+        return false;
+    *data = fx;
+
+    size_t len;
+    char *json = bench_make_json_doc(NR_DOC_RECORDS, &len);
+    if (json == NULL)
+        return false;
+
+    fx->container = purc_variant_make_from_json_string(json, len);
+    free(json);
+    if (fx->container == PURC_VARIANT_INVALID)
+        return false;
+
+    return prepare_serialize(fx, flags, len * 2);
+}
+
+static bool setup_serialize_plain(void **data)
+{
+    return setup_serialize(data, PCVARIANT_SERIALIZE_OPT_PLAIN);
+}
+
+static bool setup_serialize_pretty(void **data)
+{
+    return setup_serialize(data, PCVARIANT_SERIALIZE_OPT_PRETTY);
+}
+
+/* a mix of the numbers having long and short representations */
+static double random_number(void)
+{
+    switch (bench_random() % 3) {
+    case 0:
+        return ldexp((double)(bench_random() >> 11),
+                (int)(bench_random() % 140) - 90);
+    case 1:
+        return (double)(int64_t)(bench_random() % 2000001) / 1000.0;
+    default:
+        return (double)(bench_random() % 1000000);
+    }
+}
+
+static bool setup_serialize_numbers(void **data)
+{
+    struct variant_fixture *fx = new_fixture(0);
+    if (fx == NULL)
+        return false;
+    *data = fx;
+
+    fx->container = purc_variant_make_array_0();
+    for (size_t i = 0; fx->container && i < NR_NUMBERS; i++) {
+        purc_variant_t v = purc_variant_make_number(random_number());
+        if (v == PURC_VARIANT_INVALID)
+            return false;
+        purc_variant_array_append(fx->container, v);
+        purc_variant_unref(v);
+    }
+    if (fx->container == PURC_VARIANT_INVALID)
+        return false;
+
+    return prepare_serialize(fx, PCVARIANT_SERIALIZE_OPT_PLAIN, 0);
+}
+
+static bool setup_serialize_text(void **data)
+{
+    static const char line[] = "The quick brown fox jumps over the lazy dog.\n";
+
+    struct variant_fixture *fx = new_fixture(0);
+    if (fx == NULL)
+        return false;
+    *data = fx;
+
+    size_t len = (sizeof(line) - 1) * NR_TEXT_LINES;
+    char *text = malloc(len);
+    if (text == NULL)
+        return false;
+    for (size_t i = 0; i < NR_TEXT_LINES; i++)
+        memcpy(text + (sizeof(line) - 1) * i, line, sizeof(line) - 1);
+
+    fx->container = purc_variant_make_string_ex(text, len, false);
+    free(text);
+    if (fx->container == PURC_VARIANT_INVALID)
+        return false;
+
+    return prepare_serialize(fx, PCVARIANT_SERIALIZE_OPT_PLAIN, len * 2);
+}
+
+static bool run_serialize(void *data, size_t nr_ops)
+{
+    struct variant_fixture *fx = data;
+
+    for (size_t i = 0; i < nr_ops; i++) {
+        /* rewind the buffer, so that the space is allocated only once */
+        purc_rwstream_seek(fx->rws, 0, SEEK_SET);
+        if (purc_variant_serialize(fx->container, fx->rws, 0,
+                    fx->serialize_flags, NULL) < 0)
+            return false;
+    }
+    return true;
+}
+
+const struct bench_case bench_variant_cases[] = {
+    { "variant.number_make_free", BENCH_KIND_MICRO,
+        NULL, run_number_make_free, NULL, NULL },
+    { "variant.string_make_free", BENCH_KIND_MICRO,
+        NULL, run_string_make_free, NULL, NULL },
+    { "variant.long_string_make_free", BENCH_KIND_MICRO,
+        setup_long_string, run_long_string_make_free,
+        teardown_fixture, bytes_of_fixture },
+    { "variant.array_build_64", BENCH_KIND_MICRO,
+        setup_members, run_array_build, teardown_fixture, NULL },
+    { "variant.object_build_64", BENCH_KIND_MICRO,
+        setup_members, run_object_build, teardown_fixture, NULL },
+    { "variant.set_build_64", BENCH_KIND_MICRO,
+        setup_members, run_set_build, teardown_fixture, NULL },
+    { "variant.array_get", BENCH_KIND_MICRO,
+        setup_lookup_array, run_array_get, teardown_fixture, NULL },
+    { "variant.object_get", BENCH_KIND_MICRO,
+        setup_lookup_object, run_object_get, teardown_fixture, NULL },
+    { "variant.serialize", BENCH_KIND_MICRO,
+        setup_serialize_plain, run_serialize,
+        teardown_fixture, bytes_of_fixture },
+    { "variant.serialize_pretty", BENCH_KIND_MICRO,
+        setup_serialize_pretty, run_serialize,
+        teardown_fixture, bytes_of_fixture },
+    { "variant.serialize_numbers", BENCH_KIND_MICRO,
+        setup_serialize_numbers, run_serialize,
+        teardown_fixture, bytes_of_fixture },
+    { "variant.serialize_text", BENCH_KIND_MICRO,
+        setup_serialize_text, run_serialize,
+        teardown_fixture, bytes_of_fixture },
+    { NULL, 0, NULL, NULL, NULL, NULL },
+};
+
@@ -130,6 +130,7 @@ PURC_CHECK_HAVE_INCLUDE(HAVE_MMAP sys/mman.h)
 PURC_CHECK_HAVE_INCLUDE(HAVE_PTHREAD_NP_H pthread_np.h)
 PURC_CHECK_HAVE_INCLUDE(HAVE_SYS_TIME_H sys/time.h)
 PURC_CHECK_HAVE_INCLUDE(HAVE_SYS_TIMEB_H sys/timeb.h)
+PURC_CHECK_HAVE_INCLUDE(HAVE_SYS_EVENTFD_H sys/eventfd.h)
 PURC_CHECK_HAVE_INCLUDE(HAVE_SYS_SYSMACROS_H sys/sysmacros.h)
 PURC_CHECK_HAVE_INCLUDE(HAVE_LINUX_MEMFD_H linux/memfd.h)
 PURC_CHECK_HAVE_INCLUDE(HAVE_LINUX_FS_H linux/fs.h)
@@ -538,3 +538,113 @@ TEST(document, travel_descendants)
     ASSERT_EQ(refc, 1);
 }
 
+
+static std::string element_tag_name(purc_document_t doc, pcdoc_element_t elem)
+{
+    const char *local_name;
+    size_t local_len;
+
+    pcdoc_element_get_tag_name(doc, elem, &local_name, &local_len,
+            NULL, NULL, NULL, NULL);
+    return std::string(local_name, local_len);
+}
+
+static size_t count_selected(purc_document_t doc, const char *selector)
+{
+    pcdoc_elem_coll_t coll = pcdoc_elem_coll_new_from_document(doc, selector);
+    if (coll == NULL)
+        return (size_t)-1;
+
+    size_t n = pcdoc_elem_coll_count(doc, coll);
+    pcdoc_elem_coll_delete(doc, coll);
+    return n;
+}
+
+TEST(document, select)
+{
+    purc_document_t doc = purc_document_load(PCDOC_K_TYPE_HTML,
+            html_contents, strlen(html_contents));
+    ASSERT_NE(doc, nullptr);
+
+    ASSERT_EQ(count_selected(doc, "#foo"), 1);
+    ASSERT_EQ(count_selected(doc, "#nonexistent"), 0);
+    ASSERT_EQ(count_selected(doc, ".tocline1"), 26);
+    ASSERT_EQ(count_selected(doc, "li.tocline1 > a.tocxref"), 26);
+    ASSERT_EQ(count_selected(doc, "body .toc li"), 26);
+    ASSERT_EQ(count_selected(doc, ".FOOBAR"), 1);
+    ASSERT_EQ(count_selected(doc, "link[rel=stylesheet]"), 2);
+    ASSERT_EQ(count_selected(doc, "a[href$=\"#q1.0\"]"), 1);
+    ASSERT_EQ(count_selected(doc, "li:first-child, li:last-child"), 2);
+    ASSERT_EQ(count_selected(doc, "li:nth-child(2n+1)"), 13);
+    ASSERT_EQ(count_selected(doc, "h2 + ul"), 1);
+    ASSERT_EQ(count_selected(doc, "span:not(.index-def)"), 0);
+
+    /* bad selectors */
+    ASSERT_EQ(count_selected(doc, ""), (size_t)-1);
+    ASSERT_EQ(count_selected(doc, "div >"), (size_t)-1);
+    ASSERT_EQ(count_selected(doc, "li:nth-child(x)"), (size_t)-1);
+
+    /* the elements are in document order */
+    pcdoc_elem_coll_t coll;
+    coll = pcdoc_elem_coll_new_from_document(doc, ".toc, #bar, #foo");
+    ASSERT_NE(coll, nullptr);
+    ASSERT_EQ(pcdoc_elem_coll_count(doc, coll), 4);
+    ASSERT_EQ(pcdoc_elem_coll_get(doc, coll, 0), purc_document_head(doc));
+    ASSERT_EQ(pcdoc_elem_coll_get(doc, coll, 1), purc_document_body(doc));
+    ASSERT_EQ(element_tag_name(doc, pcdoc_elem_coll_get(doc, coll, 2)), "div");
+    ASSERT_EQ(element_tag_name(doc, pcdoc_elem_coll_get(doc, coll, 3)), "ul");
+    ASSERT_EQ(pcdoc_elem_coll_get(doc, coll, 4), nullptr);
+
+    pcdoc_elem_coll_t sub = pcdoc_elem_coll_select(doc, coll, "div, ul");
+    ASSERT_NE(sub, nullptr);
+    ASSERT_EQ(pcdoc_elem_coll_count(doc, sub), 2);
+    pcdoc_elem_coll_delete(doc, sub);
+    pcdoc_elem_coll_delete(doc, coll);
+
+    pcdoc_element_t found;
+    found = pcdoc_find_element_in_document(doc, "span.index-def");
+    ASSERT_NE(found, nullptr);
+    const char *value;
+    size_t len;
+    int ret = pcdoc_element_get_attribute(doc, found, "title", &value, &len);
+    ASSERT_EQ(ret, 0);
+    ASSERT_EQ(std::string(value, len), "generated content");
+
+    /* the ancestor itself is checked as well */
+    pcdoc_element_t body = purc_document_body(doc);
+    found = pcdoc_find_element_in_descendants(doc, body, ".foo");
+    ASSERT_EQ(found, body);
+    found = pcdoc_find_element_in_descendants(doc, body, "head");
+    ASSERT_EQ(found, nullptr);
+
+    /* the indexes follow the changes of the document */
+    pcdoc_element_t head = purc_document_head(doc);
+    ret = pcdoc_element_set_attribute(doc, head, PCDOC_OP_DISPLACE,
+            "id", "head", 0);
+    ASSERT_EQ(ret, 0);
+    ret = pcdoc_element_set_attribute(doc, head, PCDOC_OP_DISPLACE,
+            "class", "toc", 0);
+    ASSERT_EQ(ret, 0);
+    ASSERT_EQ(count_selected(doc, "#foo"), 0);
+    ASSERT_EQ(count_selected(doc, "#head"), 1);
+    ASSERT_EQ(count_selected(doc, ".toc"), 3);
+
+    pcdoc_node node = pcdoc_element_new_content(doc, body, PCDOC_OP_APPEND,
+            "<p id=\"new\" class=\"toc\">new</p>", 0);
+    ASSERT_EQ(node.type, PCDOC_NODE_ELEMENT);
+    ASSERT_EQ(count_selected(doc, "#new"), 1);
+    ASSERT_EQ(count_selected(doc, ".toc"), 4);
+
+    found = pcdoc_find_element_in_document(doc, "div.quick");
+    ASSERT_NE(found, nullptr);
+    pcdoc_element_erase(doc, found);
+    ASSERT_EQ(count_selected(doc, ".tocline1"), 0);
+    ASSERT_EQ(count_selected(doc, ".toc"), 2);
+
+    pcdoc_element_clear(doc, body);
+    ASSERT_EQ(count_selected(doc, "#new"), 0);
+    ASSERT_EQ(count_selected(doc, ".toc"), 1);
+
+    unsigned int refc = purc_document_delete(doc);
+    ASSERT_EQ(refc, 1);
+}
@@ -0,0 +1,169 @@
+/*
+** Copyright (C) 2022 FMSoft <https://www.fmsoft.cn>
+**
+** This file is a part of PurC (short for Purring Cat), an HVML interpreter.
+**
+** This program is free software: you can redistribute it and/or modify
+** it under the terms of the GNU Lesser General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU Lesser General Public License for more details.
+**
+** You should have received a copy of the GNU Lesser General Public License
+** along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "purc/purc.h"
+
+#include "private/ejson.h"
+#include "private/vcm.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <gtest/gtest.h>
+
+using namespace std;
+
+static string serialize(purc_variant_t v)
+{
+    purc_rwstream_t rws = purc_rwstream_new_buffer(1024, 1024 * 1024);
+    purc_variant_serialize(v, rws, 0, PCVARIANT_SERIALIZE_OPT_PLAIN, NULL);
+
+    size_t sz = 0;
+    const char *buf = (const char *)purc_rwstream_get_mem_buffer(rws, &sz);
+    string s(buf, sz);
+    purc_rwstream_destroy(rws);
+    return s;
+}
+
+static purc_variant_t eval_by_ejson(const char *json)
+{
+    purc_rwstream_t rws = purc_rwstream_new_from_mem((void *)json,
+            strlen(json));
+    struct pcvcm_node *root = NULL;
+    struct pcejson *parser = NULL;
+    purc_variant_t v = PURC_VARIANT_INVALID;
+
+    if (pcejson_parse(&root, &parser, rws, PCEJSON_DEFAULT_DEPTH) == 0)
+        v = pcvcm_eval(root, NULL, false);
+
+    pcvcm_node_destroy(root);
+    pcejson_destroy(parser);
+    purc_rwstream_destroy(rws);
+    return v;
+}
+
+TEST(plain_json, same_as_ejson)
+{
+    const char *cases[] = {
+        "0",
+        "-0",
+        "123",
+        "-1.5e-3",
+        "3.1415926535897932",
+        "1E+10",
+        "true",
+        "false",
+        "null",
+        "\"\"",
+        "\"plain string without any escape sequence\"",
+        "\"escapes: \\\" \\\\ \\/ \\b \\f \\n \\r \\t\"",
+        "\"unicode: \\u4e2d\\u6587 \\u00e9 中文\"",
+        "[]",
+        "{}",
+        " [ 1 , 2 , [ 3 , [ 4 ] ] ] ",
+        "{\"a\": 1, \"b\": [true, false, null], \"c\": {\"d\": \"e\"}}",
+        "{\"dup\": 1, \"dup\": 2}",
+        "[{\"id\": 1, \"name\": \"foo\"}, {\"id\": 2, \"name\": \"bar\"}]",
+    };
+
+    purc_instance_extra_info info = {};
+    ASSERT_EQ(purc_init_ex(PURC_MODULE_EJSON, "cn.fmsoft.hybridos.test",
+                "plain_json", &info), PURC_ERROR_OK);
+
+    for (size_t i = 0; i < PCA_TABLESIZE(cases); i++) {
+        purc_variant_t fast = pcejson_parse_plain_json(cases[i],
+                strlen(cases[i]));
+        ASSERT_NE(fast, PURC_VARIANT_INVALID) << cases[i];
+
+        purc_variant_t slow = eval_by_ejson(cases[i]);
+        ASSERT_NE(slow, PURC_VARIANT_INVALID) << cases[i];
+
+        ASSERT_EQ(serialize(fast), serialize(slow)) << cases[i];
+        ASSERT_EQ(purc_get_last_error(), PURC_ERROR_OK) << cases[i];
+
+        purc_variant_unref(fast);
+        purc_variant_unref(slow);
+    }
+
+    purc_cleanup();
+}
+
+TEST(plain_json, fallback)
+{
+    const char *cases[] = {
+        "",
+        "   ",
+        "{a: 1}",
+        "{'a': 1}",
+        "\"$foo\"",
+        "[1, 2, ]",
+        "01",
+        "1L",
+        "1.0FL",
+        "0x10",
+        "-Infinity",
+        "NaN",
+        "undefined",
+        "b64UEFSQVNJVEU=",
+        "\"\\ud800\"",
+        "\"\\u0000\"",
+        "\"\\x\"",
+        "[1] [2]",
+        "{\"a\": 1",
+        "[[[[[[[[[[[[[[[[[[[[[[[[[[[[[[[[[1]]]]]]]]]]]]]]]]]]]]]]]]]]]]]]]]]",
+    };
+
+    purc_instance_extra_info info = {};
+    ASSERT_EQ(purc_init_ex(PURC_MODULE_EJSON, "cn.fmsoft.hybridos.test",
+                "plain_json", &info), PURC_ERROR_OK);
+
+    for (size_t i = 0; i < PCA_TABLESIZE(cases); i++) {
+        purc_variant_t v = pcejson_parse_plain_json(cases[i],
+                strlen(cases[i]));
+        ASSERT_EQ(v, PURC_VARIANT_INVALID) << cases[i];
+        ASSERT_EQ(purc_get_last_error(), PURC_ERROR_OK) << cases[i];
+    }
+
+    purc_cleanup();
+}
+
+TEST(plain_json, load_from_stream)
+{
+    purc_instance_extra_info info = {};
+    ASSERT_EQ(purc_init_ex(PURC_MODULE_EJSON, "cn.fmsoft.hybridos.test",
+                "plain_json", &info), PURC_ERROR_OK);
+
+    /* the terminating null byte is treated as EOF */
+    const char json[] = "{\"a\": [1, 2, 3]}";
+    purc_rwstream_t rws = purc_rwstream_new_from_mem((void *)json,
+            sizeof(json));
+    purc_variant_t v = purc_variant_load_from_json_stream(rws);
+    ASSERT_NE(v, PURC_VARIANT_INVALID);
+    ASSERT_EQ(serialize(v), "{\"a\":[1,2,3]}");
+    ASSERT_EQ(purc_rwstream_tell(rws), (off_t)sizeof(json));
+    purc_variant_unref(v);
+    purc_rwstream_destroy(rws);
+
+    /* eJSON only syntax still goes through the eJSON parser */
+    v = purc_variant_make_from_json_string("{a: 'b'}", 8);
+    ASSERT_NE(v, PURC_VARIANT_INVALID);
+    ASSERT_EQ(serialize(v), "{\"a\":\"b\"}");
+    purc_variant_unref(v);
+
+    purc_cleanup();
+}
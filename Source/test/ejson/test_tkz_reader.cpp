@@ -0,0 +1,189 @@
+/*
+** Copyright (C) 2022 FMSoft <https://www.fmsoft.cn>
+**
+** This file is a part of PurC (short for Purring Cat), an HVML interpreter.
+**
+** This program is free software: you can redistribute it and/or modify
+** it under the terms of the GNU Lesser General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU Lesser General Public License for more details.
+**
+** You should have received a copy of the GNU Lesser General Public License
+** along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "purc/purc.h"
+
+#include "private/tkz-helper.h"
+
+#include <string.h>
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+using namespace std;
+
+static void append_utf8(string &s, uint32_t uc)
+{
+    char buf[8];
+    size_t n = uc_to_utf8(uc, buf);
+    s.append(buf, n);
+}
+
+class tkz_reader_test : public testing::Test
+{
+protected:
+    void SetUp() {
+        purc_instance_extra_info info = {};
+        purc_init_ex(PURC_MODULE_EJSON, "cn.fmsoft.hybridos.test",
+                "tkz_reader", &info);
+    }
+    void TearDown() {
+        purc_cleanup();
+    }
+};
+
+TEST_F(tkz_reader_test, next_and_reconsume)
+{
+    /* mix ASCII, 2-byte and 3-byte characters; long enough to span blocks */
+    string text;
+    vector<uint32_t> chars;
+    for (uint32_t i = 0; i < 20000; i++) {
+        uint32_t uc;
+        switch (i % 4) {
+        case 0: uc = 'a' + i % 26; break;
+        case 1: uc = 0xE9; break;
+        case 2: uc = 0x4E2D; break;
+        default: uc = (i % 100) ? ' ' : '\n'; break;
+        }
+        append_utf8(text, uc);
+        chars.push_back(uc);
+    }
+
+    purc_rwstream_t rws = purc_rwstream_new_from_mem((void *)text.c_str(),
+            text.size());
+    struct tkz_reader *reader = tkz_reader_new();
+    ASSERT_NE(reader, nullptr);
+    tkz_reader_set_rwstream(reader, rws);
+
+    size_t pos = 0;
+    size_t nr_back = 0;
+    int line = 1;
+    while (pos < chars.size()) {
+        struct tkz_uc *uc = tkz_reader_next_char(reader);
+        ASSERT_NE(uc, nullptr);
+        ASSERT_EQ(uc->character, chars[pos]) << "at " << pos;
+        ASSERT_EQ((size_t)uc->position, pos + 1) << "at " << pos;
+        if (nr_back == 0) {
+            ASSERT_EQ(uc->line, line) << "at " << pos;
+            if (uc->character == '\n')
+                line++;
+        }
+        else {
+            nr_back--;
+        }
+        pos++;
+
+        /* reconsume some characters from time to time */
+        if (pos % 97 == 0 && nr_back == 0) {
+            for (int i = 0; i < 3; i++)
+                tkz_reader_reconsume_last_char(reader);
+            pos -= 3;
+            nr_back = 3;
+        }
+    }
+
+    struct tkz_uc *uc = tkz_reader_next_char(reader);
+    ASSERT_EQ(uc->character, (uint32_t)TKZ_END_OF_FILE);
+    uc = tkz_reader_next_char(reader);
+    ASSERT_EQ(uc->character, (uint32_t)TKZ_END_OF_FILE);
+
+    tkz_reader_destroy(reader);
+    purc_rwstream_destroy(rws);
+}
+
+TEST_F(tkz_reader_test, give_back_unread_bytes)
+{
+    const char *text = "{\"a\": 1} trailing";
+    purc_rwstream_t rws = purc_rwstream_new_from_mem((void *)text,
+            strlen(text));
+    struct tkz_reader *reader = tkz_reader_new();
+    tkz_reader_set_rwstream(reader, rws);
+
+    for (int i = 0; i < 8; i++)
+        tkz_reader_next_char(reader);
+    tkz_reader_reconsume_last_char(reader);
+    tkz_reader_next_char(reader);
+
+    /* the bytes read ahead are given back to the rwstream */
+    tkz_reader_destroy(reader);
+    ASSERT_EQ(purc_rwstream_tell(rws), 8);
+
+    purc_rwstream_destroy(rws);
+}
+
+TEST_F(tkz_reader_test, position_after_give_back)
+{
+    const char *text1 = "ab\ncd\nef";
+    const char *text2 = "xy";
+    purc_rwstream_t rws1 = purc_rwstream_new_from_mem((void *)text1,
+            strlen(text1));
+    purc_rwstream_t rws2 = purc_rwstream_new_from_mem((void *)text2,
+            strlen(text2));
+    struct tkz_reader *reader = tkz_reader_new();
+    tkz_reader_set_rwstream(reader, rws1);
+
+    /* read up to the first new line; the rest is read ahead */
+    for (int i = 0; i < 3; i++)
+        tkz_reader_next_char(reader);
+
+    /* the position goes on from the last character returned */
+    tkz_reader_set_rwstream(reader, rws2);
+    ASSERT_EQ(purc_rwstream_tell(rws1), 3);
+
+    struct tkz_uc *uc = tkz_reader_next_char(reader);
+    ASSERT_EQ(uc->character, (uint32_t)'x');
+    ASSERT_EQ(uc->line, 2);
+    ASSERT_EQ(uc->column, 1);
+    ASSERT_EQ(uc->position, 4);
+
+    /* back to the first rwstream in the middle of a line */
+    tkz_reader_set_rwstream(reader, rws1);
+    ASSERT_EQ(purc_rwstream_tell(rws2), 1);
+
+    uc = tkz_reader_next_char(reader);
+    ASSERT_EQ(uc->character, (uint32_t)'c');
+    ASSERT_EQ(uc->line, 2);
+    ASSERT_EQ(uc->column, 2);
+    ASSERT_EQ(uc->position, 5);
+
+    tkz_reader_destroy(reader);
+    purc_rwstream_destroy(rws1);
+    purc_rwstream_destroy(rws2);
+}
+
+TEST_F(tkz_reader_test, bad_encoding)
+{
+    const char text[] = "ab\xFF" "cd";
+    purc_rwstream_t rws = purc_rwstream_new_from_mem((void *)text,
+            sizeof(text) - 1);
+    struct tkz_reader *reader = tkz_reader_new();
+    tkz_reader_set_rwstream(reader, rws);
+
+    ASSERT_EQ(tkz_reader_next_char(reader)->character, (uint32_t)'a');
+    ASSERT_EQ(tkz_reader_next_char(reader)->character, (uint32_t)'b');
+    /* the error is only reported when the bad character is reached */
+    ASSERT_EQ(purc_get_last_error(), PURC_ERROR_OK);
+    ASSERT_EQ(tkz_reader_next_char(reader)->character,
+            (uint32_t)TKZ_INVALID_CHARACTER);
+    ASSERT_NE(purc_get_last_error(), PURC_ERROR_OK);
+
+    tkz_reader_destroy(reader);
+    purc_rwstream_destroy(rws);
+}
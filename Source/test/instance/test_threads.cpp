@@ -288,3 +288,134 @@ TEST(instance, threads)
     purc_cleanup();
 }
 
+
+#define NR_PRODUCERS        4
+#define NR_PRODUCED_MSGS    1000
+
+static void* producer_thread_entry(void* arg)
+{
+    int nr = (int)(intptr_t)arg;
+    char runner_name[32];
+
+    sprintf(runner_name, "producer%d", nr);
+    int ret = purc_init_ex(PURC_MODULE_EJSON, "cn.fmsoft.purc.test",
+            runner_name, NULL);
+    assert(ret == PURC_ERROR_OK);
+    (void)ret;
+
+    for (int i = 0; i < NR_PRODUCED_MSGS; i++) {
+        pcrdr_msg *event;
+        event = pcrdr_make_event_message(
+                PCRDR_MSG_TARGET_INSTANCE,
+                (nr << 16) | i,
+                "test", NULL,
+                PCRDR_MSG_ELEMENT_TYPE_VOID, NULL, NULL,
+                PCRDR_MSG_DATA_TYPE_VOID, NULL, 0);
+
+        // the buffer of the consumer is full; try again later
+        while (purc_inst_move_message(main_inst, event) == 0) {
+            usleep(100);
+        }
+        pcrdr_release_message(event);
+    }
+
+    purc_cleanup();
+    return NULL;
+}
+
+TEST(instance, producers)
+{
+    int ret;
+    pthread_t producers[NR_PRODUCERS];
+    int next_seq[NR_PRODUCERS] = { };
+
+    ret = purc_init_ex(PURC_MODULE_VARIANT, "cn.fmsoft.purc.test", "threads",
+            NULL);
+    ASSERT_EQ(ret, PURC_ERROR_OK);
+
+    main_inst = purc_inst_create_move_buffer(PCINST_MOVE_BUFFER_FLAG_NONE, 16);
+    ASSERT_NE(main_inst, 0);
+
+    for (int i = 0; i < NR_PRODUCERS; i++) {
+        ret = pthread_create(&producers[i], NULL, producer_thread_entry,
+                (void *)(intptr_t)i);
+        ASSERT_EQ(ret, 0);
+    }
+
+    int nr_got = 0;
+    while (nr_got < NR_PRODUCERS * NR_PRODUCED_MSGS) {
+        pcrdr_msg *msg = purc_inst_take_away_message(0);
+        if (msg == NULL) {
+            usleep(100);
+            continue;
+        }
+
+        // the messages from one producer arrive in order
+        int nr = (int)(msg->targetValue >> 16);
+        ASSERT_LT(nr, NR_PRODUCERS);
+        ASSERT_EQ((int)(msg->targetValue & 0xFFFF), next_seq[nr]);
+        next_seq[nr]++;
+
+        pcrdr_release_message(msg);
+        nr_got++;
+    }
+
+    for (int i = 0; i < NR_PRODUCERS; i++) {
+        pthread_join(producers[i], NULL);
+    }
+
+    size_t n = purc_inst_destroy_move_buffer();
+    ASSERT_EQ(n, 0);
+
+    purc_cleanup();
+}
+
+#define NR_MAX_HELD_MSGS    16
+
+// the buffer is filled up if the owner only polls the number of messages
+TEST(instance, counting_only)
+{
+    int ret;
+
+    ret = purc_init_ex(PURC_MODULE_VARIANT, "cn.fmsoft.purc.test", "threads",
+            NULL);
+    ASSERT_EQ(ret, PURC_ERROR_OK);
+
+    main_inst = purc_inst_create_move_buffer(PCINST_MOVE_BUFFER_FLAG_NONE,
+            NR_MAX_HELD_MSGS);
+    ASSERT_NE(main_inst, 0);
+
+    size_t nr_moved = 0;
+    for (int i = 0; i < NR_MAX_HELD_MSGS * 8; i++) {
+        pcrdr_msg *event;
+        event = pcrdr_make_event_message(
+                PCRDR_MSG_TARGET_INSTANCE, i,
+                "test", NULL,
+                PCRDR_MSG_ELEMENT_TYPE_VOID, NULL, NULL,
+                PCRDR_MSG_DATA_TYPE_VOID, NULL, 0);
+        nr_moved += purc_inst_move_message(main_inst, event);
+        pcrdr_release_message(event);
+
+        size_t n;
+        ret = purc_inst_holding_messages_count(&n);
+        ASSERT_EQ(ret, 0);
+        ASSERT_LE(n, NR_MAX_HELD_MSGS);
+    }
+
+    // the held ones and a full ring at most
+    ASSERT_GE(nr_moved, NR_MAX_HELD_MSGS);
+    ASSERT_LE(nr_moved, NR_MAX_HELD_MSGS * 2);
+
+    // the messages are kept in order
+    for (size_t i = 0; i < nr_moved; i++) {
+        pcrdr_msg *msg = purc_inst_take_away_message(0);
+        ASSERT_NE(msg, nullptr);
+        ASSERT_EQ(msg->targetValue, i);
+        pcrdr_release_message(msg);
+    }
+
+    size_t n = purc_inst_destroy_move_buffer();
+    ASSERT_EQ(n, 0);
+
+    purc_cleanup();
+}
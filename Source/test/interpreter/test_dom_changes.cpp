@@ -0,0 +1,298 @@
+/*
+** Copyright (C) 2022 FMSoft <https://www.fmsoft.cn>
+**
+** This file is a part of PurC (short for Purring Cat), an HVML interpreter.
+**
+** This program is free software: you can redistribute it and/or modify
+** it under the terms of the GNU Lesser General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU Lesser General Public License for more details.
+**
+** You should have received a copy of the GNU Lesser General Public License
+** along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "purc/purc.h"
+#include "private/instance.h"
+#include "private/interpreter.h"
+#include "private/pcrdr.h"
+#include "interpreter/internal.h"
+
+#include "../helpers.h"
+
+#include <gtest/gtest.h>
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <string>
+#include <vector>
+
+#define LOG_FILE            "/tmp/purc-test-dom-changes.log"
+#define DOM_HANDLE          0x1234
+
+#define ELEMENT(n)          ((pcdoc_element_t)(uintptr_t)(0x100 + (n)))
+
+// the requests sent to the headless renderer, read back from its log file;
+// the log file is complete once the instance is cleaned up
+class RdrRequests
+{
+public:
+    RdrRequests() {
+        FILE *fp = fopen(LOG_FILE, "r");
+        if (fp == NULL)
+            return;
+
+        std::string log;
+        char buf[4096];
+        size_t n;
+        while ((n = fread(buf, 1, sizeof(buf), fp)) > 0)
+            log.append(buf, n);
+        fclose(fp);
+
+        static const char begin[] = ">>>\n";
+        static const char end[] = "\n>>>END\n";
+        size_t pos = 0;
+        while ((pos = log.find(begin, pos)) != std::string::npos) {
+            pos += sizeof(begin) - 1;
+            size_t stop = log.find(end, pos);
+            if (stop == std::string::npos)
+                break;
+
+            std::string packet = log.substr(pos, stop - pos);
+            pcrdr_msg *msg = NULL;
+            if (pcrdr_parse_packet(&packet[0], packet.size(), &msg) == 0)
+                msgs.push_back(msg);
+            pos = stop + sizeof(end) - 1;
+        }
+    }
+
+    ~RdrRequests() {
+        for (auto msg : msgs)
+            pcrdr_release_message(msg);
+    }
+
+    // the DOM requests with the operation
+    std::vector<const pcrdr_msg *> with(const char *operation) {
+        std::vector<const pcrdr_msg *> found;
+        for (auto msg : msgs) {
+            if (msg->type == PCRDR_MSG_TYPE_REQUEST &&
+                    msg->target == PCRDR_MSG_TARGET_DOM &&
+                    strcmp(purc_variant_get_string_const(msg->operation),
+                        operation) == 0)
+                found.push_back(msg);
+        }
+        return found;
+    }
+
+private:
+    std::vector<pcrdr_msg *> msgs;
+};
+
+static std::string
+change_string(purc_variant_t change, const char *key)
+{
+    purc_variant_t v = purc_variant_object_get_by_ckey(change, key);
+    if (v == PURC_VARIANT_INVALID) {
+        purc_clr_error();
+        return "";
+    }
+
+    const char *s = purc_variant_get_string_const(v);
+    return s ? s : "";
+}
+
+static std::string
+element_string(int n)
+{
+    char buf[32];
+    snprintf(buf, sizeof(buf), "%llx",
+            (unsigned long long int)(uint64_t)ELEMENT(n));
+    return buf;
+}
+
+// a coroutine observing events with a page loaded in the headless renderer
+class DomChanges : public testing::Test
+{
+protected:
+    void SetUp() override {
+        unlink(LOG_FILE);
+
+        purc_instance_extra_info info = {};
+        info.renderer_comm = PURC_RDRCOMM_HEADLESS;
+        info.renderer_uri = "file://" LOG_FILE;
+        purc = new PurCInstance(PURC_MODULE_HVML | PURC_MODULE_PCRDR,
+                "cn.fmsoft.hybridos.test", "test_dom_changes", &info);
+        ASSERT_TRUE(*purc);
+
+        co = (pcintr_coroutine_t)calloc(1, sizeof(*co));
+        ASSERT_NE(co, nullptr);
+        co->stage = CO_STAGE_OBSERVING;
+        co->target_page_handle = DOM_HANDLE;
+        co->target_dom_handle = DOM_HANDLE;
+        co->stack.co = co;
+        list_head_init(&co->dom_changes);
+    }
+
+    void TearDown() override {
+        end();
+    }
+
+    // cleans up the instance, so that the log file can be read
+    void end() {
+        if (co) {
+            pcintr_rdr_discard_dom_changes(co);
+            free(co);
+            co = nullptr;
+        }
+
+        delete purc;
+        purc = nullptr;
+    }
+
+    bool change(pcdoc_operation op, int n, const char *property,
+            const char *text) {
+        return pcintr_rdr_send_dom_req_simple_raw(&co->stack, op,
+                ELEMENT(n), property, PCRDR_MSG_DATA_TYPE_PLAIN, text, 0);
+    }
+
+    bool append(int n, const char *text) {
+        return change(PCDOC_OP_APPEND, n, NULL, text);
+    }
+
+    PurCInstance *purc = nullptr;
+    pcintr_coroutine_t co = nullptr;
+};
+
+TEST_F(DomChanges, merge)
+{
+    // the texts appended one by one are joined
+    ASSERT_TRUE(append(1, "b"));
+    ASSERT_TRUE(append(1, "c"));
+    ASSERT_TRUE(append(1, "d"));
+    ASSERT_EQ(co->nr_dom_changes, 1U);
+
+    // a displace drops the earlier changes on the content of the element,
+    // but not the siblings inserted around it
+    ASSERT_TRUE(change(PCDOC_OP_INSERTBEFORE, 2, NULL, "<hr/>"));
+    ASSERT_TRUE(append(2, "x"));
+    ASSERT_TRUE(change(PCDOC_OP_DISPLACE, 2, NULL, "y"));
+
+    // a changed attribute survives a displace of the content
+    ASSERT_TRUE(change(PCDOC_OP_DISPLACE, 3, "attr.class", "new"));
+    ASSERT_TRUE(change(PCDOC_OP_DISPLACE, 3, NULL, "z"));
+
+    // a clear drops the earlier appends
+    ASSERT_TRUE(append(4, "a"));
+    ASSERT_TRUE(change(PCDOC_OP_CLEAR, 4, NULL, NULL));
+
+    // an erase drops the earlier changes but the inserted siblings
+    ASSERT_TRUE(change(PCDOC_OP_INSERTAFTER, 5, NULL, "<br/>"));
+    ASSERT_TRUE(change(PCDOC_OP_UPDATE, 5, "textContent", "t"));
+    ASSERT_TRUE(change(PCDOC_OP_ERASE, 5, NULL, NULL));
+
+    ASSERT_EQ(co->nr_dom_changes, 8U);
+    pcintr_rdr_flush_dom_changes(co);
+    ASSERT_EQ(co->nr_dom_changes, 0U);
+    end();
+
+    RdrRequests requests;
+    ASSERT_EQ(requests.with(PCRDR_OPERATION_APPEND).size(), 0U);
+
+    auto batches = requests.with(PCRDR_OPERATION_APPLYCHANGES);
+    ASSERT_EQ(batches.size(), 1U);
+    ASSERT_EQ(batches[0]->targetValue, (uint64_t)DOM_HANDLE);
+    ASSERT_EQ(batches[0]->dataType, PCRDR_MSG_DATA_TYPE_JSON);
+
+    static const struct {
+        int         element;
+        const char *operation;
+        const char *property;
+        const char *data;
+    } expected[] = {
+        { 1, PCRDR_OPERATION_APPEND,        "",             "bcd" },
+        { 2, PCRDR_OPERATION_INSERTBEFORE,  "",             "<hr/>" },
+        { 2, PCRDR_OPERATION_DISPLACE,      "",             "y" },
+        { 3, PCRDR_OPERATION_UPDATE,        "attr.class",   "new" },
+        { 3, PCRDR_OPERATION_DISPLACE,      "",             "z" },
+        { 4, PCRDR_OPERATION_CLEAR,         "",             " " },
+        { 5, PCRDR_OPERATION_INSERTAFTER,   "",             "<br/>" },
+        { 5, PCRDR_OPERATION_ERASE,         "",             " " },
+    };
+
+    size_t nr_changes;
+    ASSERT_TRUE(purc_variant_array_size(batches[0]->data, &nr_changes));
+    ASSERT_EQ(nr_changes, PCA_TABLESIZE(expected));
+
+    for (size_t i = 0; i < nr_changes; i++) {
+        purc_variant_t change = purc_variant_array_get(batches[0]->data, i);
+        ASSERT_EQ(change_string(change, "element"),
+                element_string(expected[i].element));
+        ASSERT_EQ(change_string(change, "operation"), expected[i].operation);
+        ASSERT_EQ(change_string(change, "property"), expected[i].property);
+        ASSERT_EQ(change_string(change, "data"), expected[i].data);
+    }
+}
+
+TEST_F(DomChanges, flush_at_limit)
+{
+    const size_t nr_more = 10;
+
+    // one change for each element; none is merged
+    for (size_t i = 0; i < PCINTR_MAX_PENDING_DOM_CHANGES + nr_more; i++) {
+        ASSERT_TRUE(append((int)i, "x"));
+    }
+
+    // the journal is flushed as soon as it is full
+    ASSERT_EQ(co->nr_dom_changes, nr_more);
+
+    pcintr_rdr_flush_dom_changes(co);
+    ASSERT_EQ(co->nr_dom_changes, 0U);
+    end();
+
+    RdrRequests requests;
+    auto batches = requests.with(PCRDR_OPERATION_APPLYCHANGES);
+    ASSERT_EQ(batches.size(), 2U);
+
+    size_t nr_changes;
+    ASSERT_TRUE(purc_variant_array_size(batches[0]->data, &nr_changes));
+    ASSERT_EQ(nr_changes, (size_t)PCINTR_MAX_PENDING_DOM_CHANGES);
+    ASSERT_TRUE(purc_variant_array_size(batches[1]->data, &nr_changes));
+    ASSERT_EQ(nr_changes, nr_more);
+}
+
+TEST_F(DomChanges, older_renderer)
+{
+    struct pcinst *inst = pcinst_current();
+    ASSERT_NE(inst->rdr_caps, nullptr);
+    ASSERT_GE(inst->rdr_caps->prot_version,
+            PCRDR_PURCMC_APPLYCHANGES_PROTOCOL_VERSION);
+
+    // a renderer without `applyChanges` gets every change at once
+    int prot_version = inst->rdr_caps->prot_version;
+    inst->rdr_caps->prot_version =
+        PCRDR_PURCMC_APPLYCHANGES_PROTOCOL_VERSION - 1;
+
+    append(1, "b");
+    append(1, "c");
+    append(1, "d");
+    ASSERT_EQ(co->nr_dom_changes, 0U);
+
+    inst->rdr_caps->prot_version = prot_version;
+    end();
+
+    RdrRequests requests;
+    ASSERT_EQ(requests.with(PCRDR_OPERATION_APPLYCHANGES).size(), 0U);
+
+    auto appends = requests.with(PCRDR_OPERATION_APPEND);
+    ASSERT_EQ(appends.size(), 3U);
+    ASSERT_STREQ(purc_variant_get_string_const(appends[0]->data), "b");
+    ASSERT_STREQ(purc_variant_get_string_const(appends[1]->data), "c");
+    ASSERT_STREQ(purc_variant_get_string_const(appends[2]->data), "d");
+}
@@ -0,0 +1,138 @@
+/*
+** Copyright (C) 2022 FMSoft <https://www.fmsoft.cn>
+**
+** This file is a part of PurC (short for Purring Cat), an HVML interpreter.
+**
+** This program is free software: you can redistribute it and/or modify
+** it under the terms of the GNU Lesser General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU Lesser General Public License for more details.
+**
+** You should have received a copy of the GNU Lesser General Public License
+** along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "purc/purc.h"
+#include "private/instance.h"
+#include "private/interpreter.h"
+#include "interpreter/internal.h"
+
+#include "../helpers.h"
+
+#include <gtest/gtest.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <string>
+
+/* many times of the length of one write (DEF_LEN_ONE_WRITE in rdr.c) */
+#define LEN_PAGE            (1024 * 10 * 8)
+
+// a coroutine loading a large page in a plain window of the headless renderer
+class PageWriter : public testing::Test
+{
+protected:
+    void SetUp() override {
+        purc_instance_extra_info info = {};
+        info.renderer_comm = PURC_RDRCOMM_HEADLESS;
+        purc = new PurCInstance(PURC_MODULE_HVML | PURC_MODULE_PCRDR,
+                "cn.fmsoft.hybridos.test", "test_page_writer", &info);
+        ASSERT_TRUE(*purc);
+
+        struct pcinst *inst = pcinst_current();
+        plain_window = pcintr_rdr_create_plain_window(inst->conn_to_rdr, 0,
+                NULL, "test", "Page Writer", NULL, NULL,
+                PURC_VARIANT_INVALID);
+        ASSERT_NE(plain_window, 0U);
+
+        std::string html = "<html><body>";
+        for (int i = 0; html.length() < LEN_PAGE; i++) {
+            html += "<p>This is the paragraph #" + std::to_string(i) +
+                " of a page larger than one write.</p>";
+        }
+        html += "</body></html>";
+
+        doc = purc_document_load(PCDOC_K_TYPE_HTML, html.c_str(),
+                html.length());
+        ASSERT_NE(doc, nullptr);
+
+        co = (pcintr_coroutine_t)calloc(1, sizeof(*co));
+        ASSERT_NE(co, nullptr);
+        co->stage = CO_STAGE_OBSERVING;
+        co->target_page_type = PCRDR_PAGE_TYPE_PLAINWIN;
+        co->target_page_handle = plain_window;
+        co->stack.co = co;
+        co->stack.doc = doc;
+        list_head_init(&co->dom_changes);
+    }
+
+    void TearDown() override {
+        unsetenv(PURC_ENVV_RDR_WRITE_WINDOW);
+
+        free(co);
+        if (doc)
+            purc_document_delete(doc);
+        delete purc;
+    }
+
+    // whether the renderer accepts a request on the loaded DOM
+    bool is_dom_valid() {
+        pcrdr_msg *response_msg = pcintr_rdr_send_dom_req_raw(&co->stack,
+                PCDOC_OP_CLEAR, purc_document_body(doc), NULL,
+                PCRDR_MSG_DATA_TYPE_PLAIN, " ", 1);
+        if (response_msg == NULL)
+            return false;
+
+        pcrdr_release_message(response_msg);
+        return true;
+    }
+
+    PurCInstance *purc = nullptr;
+    uint64_t plain_window = 0;
+    purc_document_t doc = nullptr;
+    pcintr_coroutine_t co = nullptr;
+};
+
+TEST_F(PageWriter, load)
+{
+    ASSERT_TRUE(pcintr_rdr_page_control_load(&co->stack));
+    ASSERT_NE(co->target_dom_handle, 0U);
+    ASSERT_TRUE(is_dom_valid());
+}
+
+TEST_F(PageWriter, window_of_one)
+{
+    // every write waits for the response to the previous one
+    setenv(PURC_ENVV_RDR_WRITE_WINDOW, "1", 1);
+
+    ASSERT_TRUE(pcintr_rdr_page_control_load(&co->stack));
+    ASSERT_NE(co->target_dom_handle, 0U);
+    ASSERT_TRUE(is_dom_valid());
+}
+
+TEST_F(PageWriter, failed_write)
+{
+    // the renderer refuses the writes to an unknown plain window
+    co->target_page_handle = plain_window + 1;
+
+    ASSERT_FALSE(pcintr_rdr_page_control_load(&co->stack));
+    ASSERT_EQ(purc_get_last_error(), PCRDR_ERROR_SERVER_REFUSED);
+    ASSERT_EQ(co->target_dom_handle, 0U);
+}
+
+TEST_F(PageWriter, failed_write_window_of_one)
+{
+    setenv(PURC_ENVV_RDR_WRITE_WINDOW, "1", 1);
+    co->target_page_handle = plain_window + 1;
+
+    ASSERT_FALSE(pcintr_rdr_page_control_load(&co->stack));
+    ASSERT_EQ(purc_get_last_error(), PCRDR_ERROR_SERVER_REFUSED);
+    ASSERT_EQ(co->target_dom_handle, 0U);
+}
+
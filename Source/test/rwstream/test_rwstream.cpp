@@ -30,6 +30,7 @@
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <fcntl.h>
+#include <unistd.h>
 
 
 void create_temp_file(const char* file, const char* buf, size_t buf_len)
@@ -1353,3 +1354,261 @@ TEST(dump_rwstream, mem_buffer)
     ret = purc_rwstream_destroy (rws);
     ASSERT_EQ(ret, 0);
 }
+
+/* test peek/unread and bulk UTF-8 reading */
+static const char utf8_text[] =
+    "This is test file. 这是测试文件。Another line with 中文 characters.";
+
+static void check_utf8_chars(purc_rwstream_t rws, size_t nr_wcs)
+{
+    purc_rwstream_t ref = purc_rwstream_new_from_mem((void *)utf8_text,
+            strlen(utf8_text));
+    ASSERT_NE(ref, nullptr);
+
+    uint32_t wcs[64];
+    ssize_t n;
+    while ((n = purc_rwstream_read_utf8_chars(rws, wcs, nr_wcs)) > 0) {
+        ASSERT_LE((size_t)n, nr_wcs);
+        for (ssize_t i = 0; i < n; i++) {
+            char utf8[8];
+            uint32_t wc;
+            ASSERT_GT(purc_rwstream_read_utf8_char(ref, utf8, &wc), 0);
+            ASSERT_EQ(wcs[i], wc);
+        }
+    }
+    ASSERT_EQ(n, 0);
+
+    char utf8[8];
+    uint32_t wc;
+    ASSERT_EQ(purc_rwstream_read_utf8_char(ref, utf8, &wc), 0);
+    purc_rwstream_destroy(ref);
+}
+
+TEST(mem_rwstream, peek_unread)
+{
+    char buf[] = "This is test file. 这是测试文件。";
+    purc_rwstream_t rws = purc_rwstream_new_from_mem(buf, strlen(buf));
+    ASSERT_NE(rws, nullptr);
+
+    char read_buf[32] = {0};
+    ASSERT_EQ(purc_rwstream_peek(rws, read_buf, 4), 4);
+    ASSERT_EQ(purc_rwstream_read(rws, read_buf + 4, 4), 4);
+    ASSERT_EQ(strncmp(read_buf, "ThisThis", 8), 0);
+
+    ASSERT_EQ(purc_rwstream_unread(rws, "This", 4), 0);
+    ASSERT_EQ(purc_rwstream_tell(rws), 0);
+    ASSERT_EQ(purc_rwstream_unread(rws, "T", 1), -1);
+
+    ASSERT_EQ(purc_rwstream_read(rws, read_buf, 4), 4);
+    ASSERT_EQ(purc_rwstream_unread(rws, "That", 4), -1);
+    ASSERT_EQ(purc_get_last_error(), PURC_ERROR_NOT_SUPPORTED);
+
+    purc_rwstream_destroy(rws);
+
+    for (size_t nr_wcs = 1; nr_wcs <= 64; nr_wcs *= 4) {
+        rws = purc_rwstream_new_from_mem((void *)utf8_text,
+                strlen(utf8_text));
+        check_utf8_chars(rws, nr_wcs);
+        purc_rwstream_destroy(rws);
+    }
+}
+
+TEST(stdio_rwstream, peek_unread)
+{
+    char tmp_file[] = "/tmp/rwstream.txt";
+    create_temp_file(tmp_file, utf8_text, strlen(utf8_text));
+
+    purc_rwstream_t rws = purc_rwstream_new_from_file(tmp_file, "r");
+    ASSERT_NE(rws, nullptr);
+
+    char read_buf[8];
+    ASSERT_EQ(purc_rwstream_peek(rws, read_buf, 4), -1);
+    ASSERT_EQ(purc_rwstream_unread(rws, "T", 1), -1);
+
+    /* falls back to reading the characters one by one */
+    check_utf8_chars(rws, 16);
+
+    purc_rwstream_destroy(rws);
+    remove_temp_file(tmp_file);
+}
+
+#if OS(LINUX) || OS(UNIX) || OS(DARWIN)
+static int make_pipe_with(const char *data, size_t len)
+{
+    int fds[2];
+    if (pipe(fds))
+        return -1;
+
+    if (write(fds[1], data, len) != (ssize_t)len) {
+        close(fds[0]);
+        close(fds[1]);
+        return -1;
+    }
+
+    close(fds[1]);
+    return fds[0];
+}
+
+TEST(fdbuf_rwstream, pipe_read)
+{
+    size_t len = strlen(utf8_text);
+    int fd = make_pipe_with(utf8_text, len);
+    ASSERT_GE(fd, 0);
+
+    purc_rwstream_t rws = purc_rwstream_new_from_unix_fd_ex(fd, 32);
+    ASSERT_NE(rws, nullptr);
+
+    char read_buf[128] = {0};
+    ASSERT_EQ(purc_rwstream_peek(rws, read_buf, 4), 4);
+    ASSERT_EQ(strncmp(read_buf, "This", 4), 0);
+    ASSERT_EQ(purc_rwstream_tell(rws), 0);
+
+    ASSERT_EQ(purc_rwstream_read(rws, read_buf, 5), 5);
+    ASSERT_EQ(strncmp(read_buf, "This ", 5), 0);
+    ASSERT_EQ(purc_rwstream_tell(rws), 5);
+
+    /* the bytes read are kept in the buffer; seek back even on a pipe */
+    ASSERT_EQ(purc_rwstream_seek(rws, -5, SEEK_CUR), 0);
+    ASSERT_EQ(purc_rwstream_read(rws, read_buf, 8), 8);
+    ASSERT_EQ(strncmp(read_buf, "This is ", 8), 0);
+
+    /* push back bytes which were not read */
+    ASSERT_EQ(purc_rwstream_unread(rws, "XYZ", 3), 0);
+    ASSERT_EQ(purc_rwstream_read(rws, read_buf, 7), 7);
+    ASSERT_EQ(strncmp(read_buf, "XYZtest", 7), 0);
+    ASSERT_EQ(purc_rwstream_tell(rws), 12);
+
+    /* peek across the end of the buffer */
+    ASSERT_EQ(purc_rwstream_peek(rws, read_buf, 30), 30);
+    ASSERT_EQ(strncmp(read_buf, utf8_text + 12, 30), 0);
+    ASSERT_EQ(purc_rwstream_peek(rws, read_buf, 64), 32);
+
+    /* the buffer is full */
+    ASSERT_EQ(purc_rwstream_unread(rws, "XYZ", 3), -1);
+    ASSERT_EQ(purc_get_last_error(), PURC_ERROR_TOO_SMALL_BUFF);
+
+    size_t total = 12;
+    ssize_t n;
+    while ((n = purc_rwstream_read(rws, read_buf, 7)) > 0) {
+        ASSERT_EQ(strncmp(read_buf, utf8_text + total, n), 0);
+        total += n;
+    }
+    ASSERT_EQ(n, 0);
+    ASSERT_EQ(total, len);
+
+    purc_rwstream_destroy(rws);
+    close(fd);
+}
+
+TEST(fdbuf_rwstream, read_utf8_chars)
+{
+    size_t len = strlen(utf8_text);
+
+    /* small buffers split the characters at the ends */
+    for (size_t sz_buf = 32; sz_buf <= 64; sz_buf += 7) {
+        for (size_t nr_wcs = 1; nr_wcs <= 64; nr_wcs *= 4) {
+            int fd = make_pipe_with(utf8_text, len);
+            ASSERT_GE(fd, 0);
+
+            purc_rwstream_t rws = purc_rwstream_new_from_unix_fd_ex(fd,
+                    sz_buf);
+            ASSERT_NE(rws, nullptr);
+            check_utf8_chars(rws, nr_wcs);
+            purc_rwstream_destroy(rws);
+            close(fd);
+        }
+    }
+
+    /* a bad character is reported after the good ones */
+    const char bad[] = "ab\xff" "cd";
+    int fd = make_pipe_with(bad, sizeof(bad) - 1);
+    ASSERT_GE(fd, 0);
+
+    purc_rwstream_t rws = purc_rwstream_new_from_unix_fd_ex(fd, 32);
+    ASSERT_NE(rws, nullptr);
+
+    uint32_t wcs[8];
+    ASSERT_EQ(purc_rwstream_read_utf8_chars(rws, wcs, 8), 2);
+    ASSERT_EQ(wcs[0], 'a');
+    ASSERT_EQ(wcs[1], 'b');
+    ASSERT_EQ(purc_rwstream_read_utf8_chars(rws, wcs, 8), -1);
+    ASSERT_EQ(purc_rwstream_read_utf8_chars(rws, wcs, 8), 2);
+    ASSERT_EQ(wcs[0], 'c');
+
+    purc_rwstream_destroy(rws);
+    close(fd);
+}
+
+/* the characters available are returned without waiting for more */
+TEST(fdbuf_rwstream, read_utf8_chars_partial)
+{
+    int fds[2];
+    ASSERT_EQ(pipe(fds), 0);
+
+    purc_rwstream_t rws = purc_rwstream_new_from_unix_fd_ex(fds[0], 32);
+    ASSERT_NE(rws, nullptr);
+
+    /* the write end is kept open; the calls would block if they tried
+       to read more bytes than available */
+    const char part1[] = "ab\xe4\xb8";  /* 'a', 'b' and a split '中' */
+    const char part2[] = "\xad" "c";
+    ASSERT_EQ(write(fds[1], part1, sizeof(part1) - 1),
+            (ssize_t)sizeof(part1) - 1);
+
+    uint32_t wcs[64];
+    ASSERT_EQ(purc_rwstream_read_utf8_chars(rws, wcs, 64), 2);
+    ASSERT_EQ(wcs[0], 'a');
+    ASSERT_EQ(wcs[1], 'b');
+
+    ASSERT_EQ(write(fds[1], part2, sizeof(part2) - 1),
+            (ssize_t)sizeof(part2) - 1);
+    ASSERT_EQ(purc_rwstream_read_utf8_chars(rws, wcs, 64), 1);
+    ASSERT_EQ(wcs[0], 0x4E2D);
+    ASSERT_EQ(purc_rwstream_read_utf8_chars(rws, wcs, 64), 1);
+    ASSERT_EQ(wcs[0], 'c');
+
+    close(fds[1]);
+    ASSERT_EQ(purc_rwstream_read_utf8_chars(rws, wcs, 64), 0);
+
+    purc_rwstream_destroy(rws);
+    close(fds[0]);
+}
+
+TEST(fdbuf_rwstream, file_seek_write)
+{
+    char tmp_file[] = "/tmp/rwstream.txt";
+    char buf[] = "0123456789abcdefghijklmnopqrstuvwxyz";
+    create_temp_file(tmp_file, buf, strlen(buf));
+
+    int fd = open(tmp_file, O_RDWR);
+    ASSERT_GE(fd, 0);
+
+    purc_rwstream_t rws = purc_rwstream_new_from_unix_fd_ex(fd, 64);
+    ASSERT_NE(rws, nullptr);
+
+    char read_buf[64] = {0};
+    ASSERT_EQ(purc_rwstream_read(rws, read_buf, 4), 4);
+    ASSERT_EQ(purc_rwstream_tell(rws), 4);
+
+    ASSERT_EQ(purc_rwstream_seek(rws, 6, SEEK_CUR), 10);
+    ASSERT_EQ(purc_rwstream_read(rws, read_buf, 3), 3);
+    ASSERT_EQ(strncmp(read_buf, "abc", 3), 0);
+
+    /* written at the position read to, not after the bytes read ahead */
+    ASSERT_EQ(purc_rwstream_write(rws, "DEF", 3), 3);
+    ASSERT_EQ(purc_rwstream_tell(rws), 16);
+    ASSERT_EQ(purc_rwstream_read(rws, read_buf, 3), 3);
+    ASSERT_EQ(strncmp(read_buf, "ghi", 3), 0);
+
+    ASSERT_EQ(purc_rwstream_seek(rws, 0, SEEK_SET), 0);
+    ASSERT_EQ(purc_rwstream_read(rws, read_buf, 20), 20);
+    ASSERT_EQ(strncmp(read_buf, "0123456789abcDEFghij", 20), 0);
+
+    /* leaves the fd at the position read to */
+    purc_rwstream_destroy(rws);
+    ASSERT_EQ(lseek(fd, 0, SEEK_CUR), 20);
+
+    close(fd);
+    remove_temp_file(tmp_file);
+}
+#endif
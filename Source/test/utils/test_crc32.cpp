@@ -0,0 +1,131 @@
+/*
+** Copyright (C) 2022 FMSoft <https://www.fmsoft.cn>
+**
+** This file is a part of PurC (short for Purring Cat), an HVML interpreter.
+**
+** This program is free software: you can redistribute it and/or modify
+** it under the terms of the GNU Lesser General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU Lesser General Public License for more details.
+**
+** You should have received a copy of the GNU Lesser General Public License
+** along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "purc/purc.h"
+
+#include "private/utils.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <gtest/gtest.h>
+
+#include <vector>
+
+using namespace std;
+
+#define PRINTF(...)                                                       \
+    do {                                                                  \
+        fprintf(stdout, "\e[0;32m[          ] \e[0m");                    \
+        fprintf(stdout, __VA_ARGS__);                                     \
+    } while(false)
+
+static const char *engine_names[] = {
+    "bytewise", "slicing-by-8", "SSE4.2", "PCLMULQDQ"
+};
+
+/* the check values of "123456789"; see <https://crccalc.com/> */
+static const struct {
+    purc_crc32_algo_t algo;
+    uint32_t check;
+} algos[] = {
+    { PURC_K_ALGO_CRC32,            0xCBF43926 },
+    { PURC_K_ALGO_CRC32_BZIP2,      0xFC891918 },
+    { PURC_K_ALGO_CRC32_MPEG2,      0x0376E6E7 },
+    { PURC_K_ALGO_CRC32_POSIX,      0x765E7680 },
+    { PURC_K_ALGO_CRC32_XFER,       0xBD0BE338 },
+    { PURC_K_ALGO_CRC32_ISCSI,      0xE3069283 },
+    { PURC_K_ALGO_CRC32C,           0xE3069283 },
+    { PURC_K_ALGO_CRC32_BASE91_D,   0x87315576 },
+    { PURC_K_ALGO_CRC32D,           0x87315576 },
+    { PURC_K_ALGO_CRC32_JAMCRC,     0x340BC6D9 },
+    { PURC_K_ALGO_CRC32_AIXM,       0x3010BF7F },
+    { PURC_K_ALGO_CRC32Q,           0x3010BF7F },
+};
+
+static uint32_t
+calc_crc32(purc_crc32_algo_t algo, const unsigned char *data, size_t len,
+        size_t chunk)
+{
+    pcutils_crc32_ctxt ctxt;
+    pcutils_crc32_begin(&ctxt, algo);
+
+    while (len > 0) {
+        size_t n = (chunk && chunk < len) ? chunk : len;
+        pcutils_crc32_update(&ctxt, data, n);
+        data += n;
+        len -= n;
+    }
+
+    uint32_t crc32;
+    pcutils_crc32_end(&ctxt, &crc32);
+    return crc32;
+}
+
+TEST(crc32, check_values)
+{
+    for (size_t i = 0; i < sizeof(algos) / sizeof(algos[0]); i++) {
+        int best = pcutils_crc32_engine(algos[i].algo);
+        int old_limit = pcutils_crc32_set_engine_limit(best);
+
+        for (int l = PCUTILS_CRC32_ENGINE_BYTEWISE; l <= best; l++) {
+            pcutils_crc32_set_engine_limit(l);
+            ASSERT_EQ(calc_crc32(algos[i].algo,
+                        (const unsigned char *)"123456789", 9, 0),
+                    algos[i].check);
+        }
+
+        pcutils_crc32_set_engine_limit(old_limit);
+    }
+}
+
+/* all engines get the same results as the bytewise one, whatever the
+   alignment of the data and the sizes of the pieces fed are */
+TEST(crc32, engines)
+{
+    vector<unsigned char> data(4096 + 16);
+
+    srand(1);
+    for (size_t i = 0; i < data.size(); i++)
+        data[i] = rand();
+
+    for (size_t i = 0; i < sizeof(algos) / sizeof(algos[0]); i++) {
+        int best = pcutils_crc32_engine(algos[i].algo);
+        int old_limit = pcutils_crc32_set_engine_limit(best);
+        PRINTF("algo %d: %s\n", algos[i].algo, engine_names[best]);
+
+        for (int n = 0; n < 2000; n++) {
+            size_t offset = rand() % 16;
+            size_t len = rand() % (data.size() - offset);
+            size_t chunk = (n % 4) ? (size_t)(rand() % 200) : 0;
+
+            pcutils_crc32_set_engine_limit(PCUTILS_CRC32_ENGINE_BYTEWISE);
+            uint32_t expected = calc_crc32(algos[i].algo,
+                    data.data() + offset, len, 0);
+
+            for (int l = PCUTILS_CRC32_ENGINE_SLICING8; l <= best; l++) {
+                pcutils_crc32_set_engine_limit(l);
+                ASSERT_EQ(calc_crc32(algos[i].algo,
+                            data.data() + offset, len, chunk), expected);
+            }
+        }
+
+        pcutils_crc32_set_engine_limit(old_limit);
+    }
+}
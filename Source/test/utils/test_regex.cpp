@@ -147,3 +147,65 @@ TEST(regex, match_info)
     pcregex_destroy(regex);
 }
 
+
+static struct pcregex *get_cached(const char *pattern, int flags = 0)
+{
+    return pcregex_get_cached(pattern, (enum pcregex_compile_flags)flags,
+            (enum pcregex_match_flags)0);
+}
+
+TEST(regex, cached)
+{
+    int ret = purc_init_ex(PURC_MODULE_VARIANT, "cn.fmsoft.hybridos.test",
+            "regex", NULL);
+    ASSERT_EQ(ret, PURC_ERROR_OK);
+
+    struct pcregex *first = get_cached("\\d+");
+    ASSERT_NE(first, nullptr);
+
+    struct pcregex *again = get_cached("\\d+");
+    ASSERT_EQ(again, first);
+    pcregex_destroy(again);
+
+    struct pcregex *caseless = get_cached("\\d+", PCREGEX_CASELESS);
+    ASSERT_NE(caseless, nullptr);
+    ASSERT_NE(caseless, first);
+    pcregex_destroy(caseless);
+
+    ASSERT_EQ(get_cached("("), nullptr);
+    purc_clr_error();
+
+    /* evict the first pattern; the reference taken stays usable */
+    char pattern[32];
+    for (int i = 0; i < 64; i++) {
+        snprintf(pattern, sizeof(pattern), "^x%d$", i);
+        ASSERT_EQ(pcregex_is_match(pattern, pattern + 1), true);
+    }
+    ASSERT_EQ(pcregex_match(first, "a123", NULL), true);
+
+    again = get_cached("\\d+");
+    ASSERT_NE(again, nullptr);
+    ASSERT_NE(again, first);
+    pcregex_destroy(again);
+
+    /* a bad pattern does not match and leaves no error */
+    ASSERT_EQ(pcregex_is_match("(", "("), false);
+    ASSERT_EQ(purc_get_last_error(), PURC_ERROR_OK);
+
+    purc_cleanup();
+
+    ASSERT_EQ(pcregex_match(first, "abc", NULL), false);
+    pcregex_destroy(first);
+}
+
+TEST(regex, is_literal)
+{
+    ASSERT_EQ(pcregex_is_literal("click"), true);
+    ASSERT_EQ(pcregex_is_literal("attached-to-renderer"), true);
+    ASSERT_EQ(pcregex_is_literal(""), true);
+    ASSERT_EQ(pcregex_is_literal("cli.k"), false);
+    ASSERT_EQ(pcregex_is_literal("^click"), false);
+    ASSERT_EQ(pcregex_is_literal("a|b"), false);
+    ASSERT_EQ(pcregex_is_literal("\\d"), false);
+    ASSERT_EQ(pcregex_is_literal(NULL), false);
+}
@@ -0,0 +1,167 @@
+/*
+** Copyright (C) 2022 FMSoft <https://www.fmsoft.cn>
+**
+** This file is a part of PurC (short for Purring Cat), an HVML interpreter.
+**
+** This program is free software: you can redistribute it and/or modify
+** it under the terms of the GNU Lesser General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU Lesser General Public License for more details.
+**
+** You should have received a copy of the GNU Lesser General Public License
+** along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "purc/purc.h"
+
+#include "private/utf8.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <gtest/gtest.h>
+
+#include <string>
+
+using namespace std;
+
+#define PRINTF(...)                                                       \
+    do {                                                                  \
+        fprintf(stdout, "\e[0;32m[          ] \e[0m");                    \
+        fprintf(stdout, __VA_ARGS__);                                     \
+    } while(false)
+
+static const char *simd_names[] = { "scalar", "SSE4.2", "AVX2" };
+
+/* the first ones are valid, and the others are not */
+static const char *pieces[] = {
+    "a", "z", " ", "\xc2\x80", "\xdf\xbf", "\xe0\xa0\x80", "\xed\x9f\xbf",
+    "\xef\xbf\xbf", "\xf0\x90\x80\x80", "\xf4\x8f\xbf\xbf", "中", "文",
+    "\xc0\x80", "\xc1\xbf", "\xe0\x80\x80", "\xed\xa0\x80", "\xf0\x80\x80\x80",
+    "\xf4\x90\x80\x80", "\xf5\x80\x80\x80", "\xff", "\x80", "\xe4\xb8",
+    "\xf0\x90", "",
+};
+#define NR_VALID_PIECES     12
+
+static string random_utf8(bool with_errors)
+{
+    string s;
+    size_t len = rand() % 300;
+    size_t nr_pieces = sizeof(pieces) / sizeof(pieces[0]);
+
+    while (s.size() < len) {
+        if (rand() % 2) {
+            s.append("abcdefghijklmnop", 1 + rand() % 16);
+            continue;
+        }
+
+        size_t i = rand() % NR_VALID_PIECES;
+        if (with_errors && rand() % 20 == 0)
+            i = rand() % nr_pieces;
+
+        if (pieces[i][0])
+            s += pieces[i];
+        else
+            s += '\0';
+    }
+
+    return s;
+}
+
+/* all SIMD levels get the same results as the scalar code */
+TEST(utf8, simd_validate)
+{
+    int level = pcutils_utf8_simd_level();
+    PRINTF("UTF-8 SIMD in use: %s\n", simd_names[level]);
+
+    srand(1);
+    for (int i = 0; i < 20000; i++) {
+        string s = random_utf8(i % 2);
+
+        pcutils_utf8_set_simd_level(PCUTILS_UTF8_SIMD_NONE);
+        size_t nr_chars;
+        const char *end;
+        bool valid = pcutils_string_check_utf8_len(s.c_str(), s.size(),
+                &nr_chars, &end);
+
+        for (int l = PCUTILS_UTF8_SIMD_SSE42; l <= level; l++) {
+            pcutils_utf8_set_simd_level(l);
+
+            size_t my_nr_chars;
+            const char *my_end;
+            ASSERT_EQ(pcutils_string_check_utf8_len(s.c_str(), s.size(),
+                        &my_nr_chars, &my_end), valid);
+            ASSERT_EQ(my_nr_chars, nr_chars);
+            ASSERT_EQ(my_end, end);
+
+            ASSERT_EQ(pcutils_string_check_utf8(s.c_str(), -1,
+                        &my_nr_chars, &my_end), *end == '\0');
+            ASSERT_EQ(my_end, end);
+        }
+    }
+
+    pcutils_utf8_set_simd_level(level);
+}
+
+TEST(utf8, simd_transcode)
+{
+    typedef size_t (*encoder_t)(const char *, size_t, size_t,
+            unsigned char *, size_t);
+    typedef char *(*decoder_t)(const unsigned char *, size_t,
+            size_t *, size_t *, bool);
+
+    static const struct {
+        encoder_t encoder;
+        decoder_t decoder;
+    } codecs[] = {
+        { pcutils_string_encode_utf16le, pcutils_string_decode_utf16le },
+        { pcutils_string_encode_utf16be, pcutils_string_decode_utf16be },
+        { pcutils_string_encode_utf32le, pcutils_string_decode_utf32le },
+        { pcutils_string_encode_utf32be, pcutils_string_decode_utf32be },
+    };
+
+    int level = pcutils_utf8_simd_level();
+    unsigned char expected[4096], bytes[4096];
+
+    srand(2);
+    for (int i = 0; i < 5000; i++) {
+        string s = random_utf8(false);
+        size_t nr_chars;
+        const char *end;
+        pcutils_string_check_utf8_len(s.c_str(), s.size(), &nr_chars, &end);
+        size_t len = end - s.c_str();
+        size_t max_bytes = (i % 3) ? sizeof(bytes) : (size_t)(rand() % 1024);
+
+        for (size_t c = 0; c < sizeof(codecs) / sizeof(codecs[0]); c++) {
+            pcutils_utf8_set_simd_level(PCUTILS_UTF8_SIMD_NONE);
+            size_t nr_bytes = codecs[c].encoder(s.c_str(), len, nr_chars,
+                    expected, max_bytes);
+            size_t sz_space, consumed;
+            char *decoded = codecs[c].decoder(expected, nr_bytes,
+                    &sz_space, &consumed, true);
+
+            for (int l = PCUTILS_UTF8_SIMD_SSE42; l <= level; l++) {
+                pcutils_utf8_set_simd_level(l);
+                ASSERT_EQ(codecs[c].encoder(s.c_str(), len, nr_chars,
+                            bytes, max_bytes), nr_bytes);
+                ASSERT_EQ(memcmp(bytes, expected, nr_bytes), 0);
+
+                size_t my_consumed;
+                char *my_decoded = codecs[c].decoder(expected, nr_bytes,
+                        &sz_space, &my_consumed, true);
+                ASSERT_EQ(my_consumed, consumed);
+                ASSERT_STREQ(my_decoded, decoded);
+                free(my_decoded);
+            }
+
+            free(decoded);
+        }
+    }
+
+    pcutils_utf8_set_simd_level(level);
+}
@@ -37,6 +37,9 @@
 #include <errno.h>
 #include <gtest/gtest.h>
 
+#include <thread>
+#include <vector>
+
 #define ATOM_BUCKET     1
 
 static struct atom_info {
@@ -130,7 +133,53 @@ TEST(utils, atom_basic)
     ASSERT_EQ(purc_atom_to_string(old_atom), nullptr);
 
     purc_atom_t new_atom = purc_atom_from_string("displace");
-    ASSERT_GT(new_atom, old_atom);
+    ASSERT_EQ(new_atom, old_atom);
+
+    purc_cleanup ();
+}
+
+// to test that the slots of the removed atoms are reclaimed
+TEST(utils, atom_remove_many)
+{
+    int ret = purc_init_ex(PURC_MODULE_UTILS, "cn.fmsoft.hybridos.test",
+            "utils", NULL);
+    ASSERT_EQ (ret, PURC_ERROR_OK);
+
+    const int nr_live = 16;
+    const int nr_strings = 100000;
+    char buf[64];
+
+    size_t nr_slots, nr_seq_ids;
+    pcutils_atom_bucket_stats(ATOM_BUCKET_CUSTOM, &nr_slots, &nr_seq_ids);
+    size_t max_slots = nr_slots, max_seq_ids = nr_seq_ids;
+
+    for (int i = 0; i < nr_strings; i++) {
+        snprintf(buf, sizeof(buf), "removed-atom-%d", i);
+        purc_atom_t atom = purc_atom_from_string_ex(ATOM_BUCKET_CUSTOM, buf);
+        ASSERT_NE(atom, 0);
+        ASSERT_STREQ(purc_atom_to_string(atom), buf);
+
+        if (i >= nr_live) {
+            snprintf(buf, sizeof(buf), "removed-atom-%d", i - nr_live);
+            ASSERT_TRUE(purc_atom_remove_string_ex(ATOM_BUCKET_CUSTOM, buf));
+        }
+
+        pcutils_atom_bucket_stats(ATOM_BUCKET_CUSTOM,
+                &nr_slots, &nr_seq_ids);
+        max_slots = std::max(max_slots, nr_slots);
+        max_seq_ids = std::max(max_seq_ids, nr_seq_ids);
+    }
+
+    /* bounded by the live ones instead of all the strings ever added */
+    ASSERT_LE(max_slots, 512U);
+    ASSERT_LE(max_seq_ids, 512U);
+
+    for (int i = nr_strings - nr_live; i < nr_strings; i++) {
+        snprintf(buf, sizeof(buf), "removed-atom-%d", i);
+        purc_atom_t atom = purc_atom_try_string_ex(ATOM_BUCKET_CUSTOM, buf);
+        ASSERT_NE(atom, 0);
+        ASSERT_STREQ(purc_atom_to_string(atom), buf);
+    }
 
     purc_cleanup ();
 }
@@ -354,6 +403,47 @@ TEST(utils, atom_buckets)
     purc_cleanup ();
 }
 
+// to test creating and looking up atoms on several threads at once
+TEST(utils, atom_threads)
+{
+    int ret = purc_init_ex(PURC_MODULE_UTILS, "cn.fmsoft.hybridos.test",
+            "utils", NULL);
+    ASSERT_EQ (ret, PURC_ERROR_OK);
+
+    const int nr_threads = 4;
+    const int nr_atoms = 5000;
+    std::vector<std::vector<purc_atom_t>> atoms(nr_threads,
+            std::vector<purc_atom_t>(nr_atoms));
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < nr_threads; t++) {
+        threads.emplace_back([&atoms, t] {
+            char buf[32];
+            for (int i = 0; i < nr_atoms; i++) {
+                snprintf(buf, sizeof(buf), "thread-atom-%d", i);
+                atoms[t][i] = purc_atom_from_string_ex(ATOM_BUCKET, buf);
+                if (purc_atom_try_string_ex(ATOM_BUCKET, buf) != atoms[t][i])
+                    atoms[t][i] = 0;
+            }
+        });
+    }
+
+    for (auto &th : threads)
+        th.join();
+
+    char buf[32];
+    for (int i = 0; i < nr_atoms; i++) {
+        snprintf(buf, sizeof(buf), "thread-atom-%d", i);
+        ASSERT_NE(atoms[0][i], 0);
+        ASSERT_STREQ(purc_atom_to_string(atoms[0][i]), buf);
+        for (int t = 1; t < nr_threads; t++) {
+            ASSERT_EQ(atoms[t][i], atoms[0][i]);
+        }
+    }
+
+    purc_cleanup ();
+}
+
 // to test sorted array
 static int sortv[10] = { 1, 8, 7, 5, 4, 6, 9, 0, 2, 3 };
 
@@ -23,6 +23,12 @@
 
 #include <stdio.h>
 #include <errno.h>
+#include <float.h>
+#include <math.h>
+#include <string.h>
+#include <cmath>
+#include <string>
+#include <vector>
 #include <gtest/gtest.h>
 
 static inline int my_puts(const char* str)
@@ -994,3 +1000,238 @@ TEST(variant, serialize_object_with_empty_key2)
 
     purc_cleanup ();
 }
+
+/* The serialization of a number before the fast paths were introduced */
+static std::string reference_number(double d, unsigned int flags)
+{
+    char buf[128];
+
+    if (std::isnan(d))
+        return "NaN";
+    if (std::isinf(d))
+        return d > 0 ? "Infinity" : "-Infinity";
+
+    double test;
+    snprintf(buf, sizeof(buf), "%.0f", d);
+    if (sscanf(buf, "%lg", &test) == 1 &&
+            fabs(test - d) <= fmax(fabs(test), fabs(d)) * DBL_EPSILON)
+        return buf;
+
+    int size = snprintf(buf, sizeof(buf), "%.17g", d);
+    char *p = strchr(buf, '.');
+    if (!p && strchr(buf, 'e') == NULL) {
+        strcat(buf, ".0");
+        size += 2;
+    }
+
+    if (p && (flags & PCVARIANT_SERIALIZE_OPT_NOZERO)) {
+        char *q;
+        p++;
+        for (q = p; *q; q++) {
+            if (*q != '0')
+                p = q;
+        }
+        if (*p != 0)
+            *(++p) = 0;
+    }
+
+    return buf;
+}
+
+static std::string reference_long_double(long double ld, unsigned int flags)
+{
+    char buf[256];
+
+    if (std::isnan(ld))
+        return "NaN";
+    if (std::isinf(ld))
+        return ld > 0 ? "Infinity" : "-Infinity";
+
+    snprintf(buf, sizeof(buf) - 2, "%.17Lg", ld);
+    char *p = strchr(buf, '.');
+    if (p && (flags & PCVARIANT_SERIALIZE_OPT_NOZERO)) {
+        char *q;
+        p++;
+        for (q = p; *q; q++) {
+            if (*q != '0')
+                p = q;
+        }
+        if (*p != 0)
+            *(++p) = 0;
+    }
+
+    if (flags & PCVARIANT_SERIALIZE_OPT_REAL_EJSON)
+        strcat(buf, "FL");
+    return buf;
+}
+
+static std::string reference_string(const std::string &str,
+        unsigned int flags)
+{
+    std::string out = "\"";
+    char sbuf[8];
+
+    for (unsigned char c : str) {
+        switch (c) {
+        case '\b': out += "\\b"; break;
+        case '\n': out += "\\n"; break;
+        case '\r': out += "\\r"; break;
+        case '\t': out += "\\t"; break;
+        case '\f': out += "\\f"; break;
+        case '"': out += "\\\""; break;
+        case '\\': out += "\\\\"; break;
+        case '/':
+            if (flags & PCVARIANT_SERIALIZE_OPT_NOSLASHESCAPE)
+                out += "/";
+            else
+                out += "\\/";
+            break;
+        default:
+            if (c < ' ') {
+                snprintf(sbuf, sizeof(sbuf), "\\u00%02x", c);
+                out += sbuf;
+            }
+            else
+                out += (char)c;
+            break;
+        }
+    }
+
+    return out + "\"";
+}
+
+static std::string serialize_to_string(purc_variant_t v, unsigned int flags)
+{
+    purc_rwstream_t rws = purc_rwstream_new_buffer(32, 0);
+    size_t len_expected = 0;
+    ssize_t n = purc_variant_serialize(v, rws, 0, flags, &len_expected);
+
+    size_t sz = 0;
+    const char *buf = (const char *)purc_rwstream_get_mem_buffer(rws, &sz);
+    std::string s;
+    if (n >= 0 && (size_t)n == len_expected)
+        s.assign(buf, n);
+    purc_rwstream_destroy(rws);
+    return s;
+}
+
+static uint64_t xorshift64(uint64_t *state)
+{
+    uint64_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    return *state = x;
+}
+
+static std::vector<double> sample_doubles(size_t count)
+{
+    static const double edges[] = {
+        0.0, -0.0, 0.1, -0.1, 0.5, 1.5, 2.5, 123.456, 1e-5, 1e-4,
+        9.9999999999999e-5, 1e16, 1e17, 99999999999999999.0,
+        12345678901234565.0, 1e15 + 0.125, 9007199254740993.0,
+        9223372036854775807.0, 1e22, 1e43, 1e100, 5e-324, DBL_MIN,
+        NAN, INFINITY, -INFINITY,
+    };
+    std::vector<double> v(std::begin(edges), std::end(edges));
+    uint64_t state = UINT64_C(88172645463325252);
+
+    while (v.size() < count) {
+        uint64_t u = xorshift64(&state);
+        double d;
+        switch (u % 4) {
+        case 0:
+            u = xorshift64(&state);
+            memcpy(&d, &u, sizeof(d));
+            break;
+        case 1:
+            d = ldexp((double)(xorshift64(&state) >> 11),
+                    (int)(xorshift64(&state) % 140) - 90);
+            break;
+        case 2:
+            d = (double)(int64_t)(xorshift64(&state) % 2000001) / 1000.0;
+            break;
+        default:
+            d = (double)(int64_t)(xorshift64(&state) % 2000001 - 1000000);
+            break;
+        }
+
+        /* the integral form of larger numbers overflows the buffer
+           of serialize_number() */
+        if (std::isfinite(d) && fabs(d) >= 1e120)
+            continue;
+        v.push_back((u & 0x100) ? -d : d);
+    }
+
+    return v;
+}
+
+// to test: the serialized numbers are identical to the ones of "%.17g"
+TEST(variant, serialize_number_exact)
+{
+    static const unsigned int flags[] = {
+        PCVARIANT_SERIALIZE_OPT_PLAIN,
+        PCVARIANT_SERIALIZE_OPT_NOZERO,
+        PCVARIANT_SERIALIZE_OPT_REAL_EJSON,
+    };
+
+    int ret = purc_init_ex(PURC_MODULE_VARIANT, "cn.fmsoft.hybridos.test",
+            "variant", NULL);
+    ASSERT_EQ(ret, PURC_ERROR_OK);
+
+    std::vector<double> numbers = sample_doubles(200000);
+    for (double d : numbers) {
+        purc_variant_t v = purc_variant_make_number(d);
+        for (unsigned int f : flags) {
+            ASSERT_EQ(serialize_to_string(v, f), reference_number(d, f))
+                << "%.17g: " << std::hexfloat << d;
+        }
+        purc_variant_unref(v);
+
+        long double ld = (long double)d / 3;
+        v = purc_variant_make_longdouble(ld);
+        for (unsigned int f : flags) {
+            ASSERT_EQ(serialize_to_string(v, f), reference_long_double(ld, f))
+                << "%.17Lg: " << std::hexfloat << ld;
+        }
+        purc_variant_unref(v);
+    }
+
+    purc_cleanup();
+}
+
+// to test: the escaped strings are identical to the byte-by-byte escaping
+TEST(variant, serialize_string_escape)
+{
+    static const char alphabet[] = "abc /\"\\\b\t\n\f\r\x01\x1f\x7f\xe4\xb8\xad";
+
+    int ret = purc_init_ex(PURC_MODULE_VARIANT, "cn.fmsoft.hybridos.test",
+            "variant", NULL);
+    ASSERT_EQ(ret, PURC_ERROR_OK);
+
+    uint64_t state = UINT64_C(0x9e3779b97f4a7c15);
+    for (int i = 0; i < 20000; i++) {
+        std::string str;
+        size_t len = xorshift64(&state) % 80;
+        unsigned density = 1 + xorshift64(&state) % 32;
+        for (size_t j = 0; j < len; j++) {
+            uint64_t r = xorshift64(&state);
+            if (r % density == 0)
+                str += alphabet[(r >> 8) % (sizeof(alphabet) - 1)];
+            else
+                str += (char)('A' + (r >> 8) % 26);
+        }
+
+        purc_variant_t v = purc_variant_make_string_ex(str.c_str(),
+                str.size(), false);
+        ASSERT_NE(v, PURC_VARIANT_INVALID);
+        ASSERT_EQ(serialize_to_string(v, PCVARIANT_SERIALIZE_OPT_PLAIN),
+                reference_string(str, PCVARIANT_SERIALIZE_OPT_PLAIN));
+        ASSERT_EQ(serialize_to_string(v,
+                    PCVARIANT_SERIALIZE_OPT_NOSLASHESCAPE),
+                reference_string(str, PCVARIANT_SERIALIZE_OPT_NOSLASHESCAPE));
+        purc_variant_unref(v);
+    }
+
+    purc_cleanup();
+}
@@ -115,3 +115,88 @@ TEST(set, unique_key_find)
     ASSERT_EQ (cleanup, true);
 }
 
+
+TEST(set, many_records)
+{
+    purc_instance_extra_info info = {};
+    int ret = purc_init_ex (PURC_MODULE_VARIANT, "cn.fmsoft.hybridos.test",
+            "test_init", &info);
+    ASSERT_EQ(ret, PURC_ERROR_OK);
+
+    const size_t nr_records = 20000;
+    purc_variant_t set = purc_variant_make_set_by_ckey(0, "id name",
+            PURC_VARIANT_INVALID);
+    ASSERT_NE(set, PURC_VARIANT_INVALID);
+
+    char name[32];
+    for (size_t i = 0; i < nr_records; i++) {
+        snprintf(name, sizeof(name), "name-%zu", i % 100);
+        purc_variant_t id = purc_variant_make_longint(i);
+        purc_variant_t nm = purc_variant_make_string(name, false);
+        purc_variant_t obj = purc_variant_make_object_by_static_ckey(2,
+                "id", id, "name", nm);
+        purc_variant_unref(id);
+        purc_variant_unref(nm);
+        ASSERT_NE(obj, PURC_VARIANT_INVALID);
+        ASSERT_TRUE(purc_variant_set_add(set, obj, false));
+        purc_variant_unref(obj);
+    }
+
+    size_t sz;
+    ASSERT_TRUE(purc_variant_set_size(set, &sz));
+    ASSERT_EQ(sz, nr_records);
+
+    // the same unique-key values are a duplicate, whatever the rest is
+    purc_variant_t id = purc_variant_make_longint(77);
+    purc_variant_t nm = purc_variant_make_string("name-77", false);
+    purc_variant_t extra = purc_variant_make_boolean(true);
+    purc_variant_t dup = purc_variant_make_object_by_static_ckey(3,
+            "id", id, "name", nm, "extra", extra);
+    purc_variant_unref(extra);
+    ASSERT_FALSE(purc_variant_set_add(set, dup, false));
+    purc_variant_unref(dup);
+
+    purc_variant_t v;
+    v = purc_variant_set_get_member_by_key_values(set, id, nm);
+    ASSERT_NE(v, PURC_VARIANT_INVALID);
+    purc_variant_unref(nm);
+
+    nm = purc_variant_make_string("name-78", false);
+    v = purc_variant_set_get_member_by_key_values(set, id, nm);
+    ASSERT_EQ(v, PURC_VARIANT_INVALID);
+    purc_variant_unref(nm);
+    purc_variant_unref(id);
+
+    // remove every other record by its key values
+    for (size_t i = 0; i < nr_records; i += 2) {
+        snprintf(name, sizeof(name), "name-%zu", i % 100);
+        id = purc_variant_make_longint(i);
+        nm = purc_variant_make_string(name, false);
+        v = purc_variant_set_remove_member_by_key_values(set, id, nm);
+        ASSERT_NE(v, PURC_VARIANT_INVALID);
+        purc_variant_unref(v);
+        purc_variant_unref(id);
+        purc_variant_unref(nm);
+    }
+
+    ASSERT_TRUE(purc_variant_set_size(set, &sz));
+    ASSERT_EQ(sz, nr_records / 2);
+
+    for (size_t i = 0; i < nr_records; i++) {
+        snprintf(name, sizeof(name), "name-%zu", i % 100);
+        id = purc_variant_make_longint(i);
+        nm = purc_variant_make_string(name, false);
+        v = purc_variant_set_get_member_by_key_values(set, id, nm);
+        if (i % 2)
+            ASSERT_NE(v, PURC_VARIANT_INVALID);
+        else
+            ASSERT_EQ(v, PURC_VARIANT_INVALID);
+        purc_variant_unref(id);
+        purc_variant_unref(nm);
+    }
+
+    purc_variant_unref(set);
+
+    bool cleanup = purc_cleanup ();
+    ASSERT_EQ (cleanup, true);
+}
@@ -1589,3 +1589,128 @@ TEST(variant, reuse_buff)
     purc_cleanup ();
 }
 
+
+TEST(variant, freeze)
+{
+    purc_instance_extra_info info = {};
+    int ret = purc_init_ex(PURC_MODULE_VARIANT, "cn.fmsfot.hvml.test",
+            "variant", &info);
+    ASSERT_EQ (ret, PURC_ERROR_OK);
+
+    const char *json = "{ 'name': 'PurC', 'tags': ['a', 'b', null, true], "
+        "'size': 100 }";
+    purc_variant_t v = purc_variant_make_from_json_string(json, strlen(json));
+    ASSERT_NE(v, PURC_VARIANT_INVALID);
+    ASSERT_FALSE(purc_variant_is_frozen(v));
+
+    purc_variant_t frozen = purc_variant_freeze(v);
+    ASSERT_NE(frozen, PURC_VARIANT_INVALID);
+    ASSERT_NE(frozen, v);
+    ASSERT_TRUE(purc_variant_is_frozen(frozen));
+    ASSERT_TRUE(purc_variant_is_equal_to(frozen, v));
+
+    // freezing a frozen variant only gets a new reference
+    purc_variant_t again = purc_variant_freeze(frozen);
+    ASSERT_EQ(again, frozen);
+    ASSERT_EQ(purc_variant_ref_count(frozen), 2);
+    purc_variant_unref(again);
+
+    // the descendants are frozen too, and can not be changed
+    purc_variant_t tags = purc_variant_object_get_by_ckey(frozen, "tags");
+    ASSERT_NE(tags, PURC_VARIANT_INVALID);
+    ASSERT_TRUE(purc_variant_is_frozen(tags));
+
+    purc_variant_t s = purc_variant_make_string("c", false);
+    ASSERT_FALSE(purc_variant_array_append(tags, s));
+    ASSERT_EQ(purc_get_last_error(), PURC_ERROR_ACCESS_DENIED);
+    ASSERT_FALSE(purc_variant_object_set_by_static_ckey(frozen, "new", s));
+
+    // a frozen variant can be a member of an ordinary container
+    purc_variant_t arr = purc_variant_make_array(1, frozen);
+    ASSERT_NE(arr, PURC_VARIANT_INVALID);
+    ASSERT_TRUE(purc_variant_array_append(arr, s));
+    purc_variant_unref(s);
+    purc_variant_unref(arr);
+
+    // the clone of a frozen container can be changed
+    purc_variant_t cloned = purc_variant_container_clone_recursively(frozen);
+    ASSERT_NE(cloned, PURC_VARIANT_INVALID);
+    ASSERT_FALSE(purc_variant_is_frozen(cloned));
+    ASSERT_TRUE(purc_variant_object_remove_by_static_ckey(cloned, "size",
+                false));
+    purc_variant_unref(cloned);
+
+    ASSERT_EQ(purc_variant_ref_count(frozen), 1);
+    purc_variant_unref(frozen);
+    purc_variant_unref(v);
+
+    purc_cleanup ();
+}
+
+TEST(variant, substring)
+{
+    purc_instance_extra_info info = {};
+    int ret = purc_init_ex(PURC_MODULE_VARIANT, "cn.fmsfot.hvml.test",
+            "variant", &info);
+    ASSERT_EQ (ret, PURC_ERROR_OK);
+
+    // long enough to get the sparse character index
+    std::string str;
+    for (int i = 0; i < 300; i++)
+        str += (i % 3) ? "a" : "中";
+
+    purc_variant_t v = purc_variant_make_string(str.c_str(), true);
+    ASSERT_NE(v, PURC_VARIANT_INVALID);
+
+    size_t nr_chars;
+    ASSERT_TRUE(purc_variant_string_chars(v, &nr_chars));
+    ASSERT_EQ(nr_chars, 300);
+
+    // a suffix refers to the buffer of the string
+    purc_variant_t sub = purc_variant_make_substring(v, 100, 1000);
+    ASSERT_NE(sub, PURC_VARIANT_INVALID);
+    ASSERT_TRUE(purc_variant_string_chars(sub, &nr_chars));
+    ASSERT_EQ(nr_chars, 200);
+    ASSERT_EQ(purc_variant_ref_count(v), 2);
+
+    const char *s = purc_variant_get_string_const(v);
+    const char *p = purc_variant_get_string_const(sub);
+    ASSERT_EQ(p, s + 34 * 3 + 66);
+    ASSERT_STREQ(p, str.c_str() + 34 * 3 + 66);
+
+    // a substring of a substring refers to the same buffer
+    purc_variant_t sub2 = purc_variant_make_substring(sub, 150, 50);
+    ASSERT_NE(sub2, PURC_VARIANT_INVALID);
+    ASSERT_EQ(purc_variant_ref_count(v), 3);
+    ASSERT_EQ(purc_variant_ref_count(sub), 1);
+    ASSERT_STREQ(purc_variant_get_string_const(sub2),
+            str.c_str() + 84 * 3 + 166);
+
+    // a substring in the middle is copied
+    purc_variant_t mid = purc_variant_make_substring(sub, 0, 3);
+    ASSERT_NE(mid, PURC_VARIANT_INVALID);
+    ASSERT_STREQ(purc_variant_get_string_const(mid), "aa中");
+    ASSERT_EQ(purc_variant_ref_count(v), 3);
+    purc_variant_unref(mid);
+
+    // out of range
+    ASSERT_EQ(purc_variant_make_substring(v, 301, 1), PURC_VARIANT_INVALID);
+    ASSERT_EQ(purc_get_last_error(), PCVARIANT_ERROR_OUT_OF_BOUNDS);
+
+    purc_variant_t empty = purc_variant_make_substring(v, 300, 1);
+    ASSERT_NE(empty, PURC_VARIANT_INVALID);
+    ASSERT_STREQ(purc_variant_get_string_const(empty), "");
+    purc_variant_unref(empty);
+
+    purc_variant_t all = purc_variant_make_substring(v, 0, 300);
+    ASSERT_EQ(all, v);
+    purc_variant_unref(all);
+
+    purc_variant_unref(sub);
+    purc_variant_unref(v);
+    ASSERT_STREQ(purc_variant_get_string_const(sub2),
+            str.c_str() + 84 * 3 + 166);
+    purc_variant_unref(sub2);
+
+    purc_cleanup ();
+}
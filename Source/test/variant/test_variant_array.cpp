@@ -533,3 +533,111 @@ TEST(variant_array, sort)
     ASSERT_STREQ(inbuf, outbuf);
 }
 
+
+TEST(variant_array, sort_large)
+{
+    purc_instance_extra_info info = {};
+    int ret = 0;
+    bool cleanup = false;
+
+    ret = purc_init_ex (PURC_MODULE_VARIANT, "cn.fmsoft.hybridos.test",
+            "test_init", &info);
+    ASSERT_EQ(ret, PURC_ERROR_OK);
+
+    /* large enough to be sorted on several threads */
+    const size_t nr = 100000;
+    purc_variant_t arr = purc_variant_make_array(0, PURC_VARIANT_INVALID);
+    ASSERT_NE(arr, nullptr);
+    for (size_t i = 0; i < nr; i++) {
+        purc_variant_t v = purc_variant_make_number((i * 7919) % 1000);
+        ASSERT_TRUE(purc_variant_array_append(arr, v));
+        purc_variant_unref(v);
+    }
+
+    uintptr_t opt = PCVARIANT_SORT_DESC | PCVARIANT_COMPARE_OPT_NUMBER;
+    int r = pcvariant_array_sort(arr, (void *)opt, NULL);
+    ASSERT_EQ(r, 0);
+
+    ASSERT_EQ(purc_variant_array_get_size(arr), nr);
+    double last = 1000;
+    for (size_t i = 0; i < nr; i++) {
+        double d = purc_variant_numerify(purc_variant_array_get(arr, i));
+        ASSERT_LE(d, last);
+        last = d;
+    }
+
+    purc_variant_unref(arr);
+
+    cleanup = purc_cleanup ();
+    ASSERT_EQ (cleanup, true);
+}
+
+static bool
+count_grown(purc_variant_t src, pcvar_op_t op, void *ctxt,
+        size_t nr_args, purc_variant_t *argv)
+{
+    (void)src;
+
+    if (op != PCVAR_OPERATION_GROW || nr_args != 2)
+        return false;
+
+    /* the position of the new member is still reported */
+    int64_t pos;
+    if (!purc_variant_cast_to_longint(argv[0], &pos, false))
+        return false;
+
+    int64_t *last = (int64_t *)ctxt;
+    *last = pos;
+    return true;
+}
+
+TEST(variant_array, make_from)
+{
+    purc_instance_extra_info info = {};
+    int ret = 0;
+    bool cleanup = false;
+
+    ret = purc_init_ex (PURC_MODULE_VARIANT, "cn.fmsoft.hybridos.test",
+            "test_init", &info);
+    ASSERT_EQ(ret, PURC_ERROR_OK);
+
+    purc_variant_t values[4];
+    values[0] = purc_variant_make_longint(0);
+    values[1] = purc_variant_make_string_static("one", false);
+    values[2] = purc_variant_make_undefined();
+    values[3] = purc_variant_make_number(3.0);
+
+    /* undefined members are skipped as purc_variant_make_array() does */
+    purc_variant_t arr = purc_variant_make_array_from(4, values);
+    ASSERT_NE(arr, PURC_VARIANT_INVALID);
+    purc_variant_t ref = purc_variant_make_array(4,
+            values[0], values[1], values[2], values[3]);
+    ASSERT_NE(ref, PURC_VARIANT_INVALID);
+    ASSERT_EQ(purc_variant_array_get_size(arr), 3);
+    ASSERT_TRUE(purc_variant_is_equal_to(arr, ref));
+
+    purc_variant_t empty = purc_variant_make_array_from(0, NULL);
+    ASSERT_NE(empty, PURC_VARIANT_INVALID);
+    ASSERT_EQ(purc_variant_array_get_size(empty), 0);
+    purc_variant_unref(empty);
+
+    /* a listener registered afterwards sees the grow */
+    int64_t last = -1;
+    struct pcvar_listener *listener;
+    listener = purc_variant_register_post_listener(arr,
+            PCVAR_OPERATION_GROW, count_grown, &last);
+    ASSERT_NE(listener, nullptr);
+    ASSERT_TRUE(purc_variant_array_append(arr, values[0]));
+    ASSERT_EQ(last, 3);
+    ASSERT_TRUE(purc_variant_array_insert_before(arr, 1, values[1]));
+    ASSERT_EQ(last, 1);
+    purc_variant_revoke_listener(arr, listener);
+
+    purc_variant_unref(ref);
+    purc_variant_unref(arr);
+    for (int i = 0; i < 4; i++)
+        purc_variant_unref(values[i]);
+
+    cleanup = purc_cleanup ();
+    ASSERT_EQ (cleanup, true);
+}
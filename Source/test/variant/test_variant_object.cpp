@@ -466,3 +466,200 @@ TEST(object, compare)
     purc_variant_unref(obj2);
 }
 
+
+TEST(object, get_silently)
+{
+    PurCInstance purc;
+
+    const char *s = "{first:xiaohong,last:xu}";
+    purc_variant_t obj = pcejson_parser_parse_string(s, 0, 0);
+    if (obj == PURC_VARIANT_INVALID) {
+        ADD_FAILURE() << "failed to parse: " << s << std::endl;
+        return;
+    }
+
+    purc_clr_error();
+    purc_variant_t v = pcvariant_object_get_by_ckey_ex(obj, "middle", true);
+    ASSERT_EQ(v, PURC_VARIANT_INVALID);
+    ASSERT_EQ(purc_get_last_error(), 0);
+
+    v = pcvariant_object_get_by_ckey_ex(obj, "middle", false);
+    ASSERT_EQ(v, PURC_VARIANT_INVALID);
+    ASSERT_EQ(purc_get_last_error(), PCVARIANT_ERROR_NO_SUCH_KEY);
+
+    purc_clr_error();
+    v = pcvariant_object_get_by_ckey_ex(obj, "last", true);
+    ASSERT_NE(v, PURC_VARIANT_INVALID);
+    ASSERT_STREQ(purc_variant_get_string_const(v), "xu");
+
+    purc_variant_unref(obj);
+}
+
+static bool
+count_ops(purc_variant_t src, pcvar_op_t op, void *ctxt,
+        size_t nr_args, purc_variant_t *argv)
+{
+    (void)src;
+    (void)nr_args;
+    (void)argv;
+
+    int *counts = (int *)ctxt;
+    if (op == PCVAR_OPERATION_GROW)
+        counts[0]++;
+    else if (op == PCVAR_OPERATION_SHRINK)
+        counts[1]++;
+    else if (op == PCVAR_OPERATION_CHANGE)
+        counts[2]++;
+    return true;
+}
+
+// the objects large enough to get a hash index behave like the small ones
+TEST(object, indexed)
+{
+    PurCInstance purc;
+
+    const int nr_keys = 1000;
+    char key[32];
+
+    purc_variant_t obj = purc_variant_make_object_0();
+    ASSERT_NE(obj, PURC_VARIANT_INVALID);
+
+    int counts[3] = { 0, 0, 0 };
+    struct pcvar_listener *listener;
+    listener = purc_variant_register_post_listener(obj,
+            (pcvar_op_t)PCVAR_OPERATION_ALL, count_ops, counts);
+    ASSERT_NE(listener, nullptr);
+
+    /* insert in an order which is neither sorted nor reversed */
+    for (int i = 0; i < nr_keys; i++) {
+        int n = (i * 7919) % nr_keys;
+        snprintf(key, sizeof(key), "key%d", n);
+        purc_variant_t v = purc_variant_make_longint(n);
+        ASSERT_TRUE(purc_variant_object_set_by_static_ckey(obj, key, v));
+        purc_variant_unref(v);
+    }
+    ASSERT_EQ(counts[0], nr_keys);
+
+    size_t sz = 0;
+    ASSERT_TRUE(purc_variant_object_size(obj, &sz));
+    ASSERT_EQ(sz, (size_t)nr_keys);
+
+    for (int i = 0; i < nr_keys; i++) {
+        snprintf(key, sizeof(key), "key%d", i);
+        purc_variant_t v = purc_variant_object_get_by_ckey(obj, key);
+        ASSERT_NE(v, PURC_VARIANT_INVALID) << key;
+        int64_t n;
+        ASSERT_TRUE(purc_variant_cast_to_longint(v, &n, false));
+        ASSERT_EQ(n, i);
+    }
+
+    /* change the even keys and remove the multiples of three */
+    for (int i = 0; i < nr_keys; i += 2) {
+        snprintf(key, sizeof(key), "key%d", i);
+        purc_variant_t v = purc_variant_make_longint(-i);
+        ASSERT_TRUE(purc_variant_object_set_by_static_ckey(obj, key, v));
+        purc_variant_unref(v);
+    }
+    int nr_removed = 0;
+    for (int i = 0; i < nr_keys; i += 3) {
+        snprintf(key, sizeof(key), "key%d", i);
+        ASSERT_TRUE(purc_variant_object_remove_by_static_ckey(obj, key,
+                    false));
+        nr_removed++;
+    }
+    ASSERT_EQ(counts[1], nr_removed);
+    ASSERT_EQ(counts[2], nr_keys / 2);
+
+    for (int i = 0; i < nr_keys; i++) {
+        snprintf(key, sizeof(key), "key%d", i);
+        purc_variant_t v = pcvariant_object_get_by_ckey_ex(obj, key, true);
+        if (i % 3 == 0) {
+            ASSERT_EQ(v, PURC_VARIANT_INVALID) << key;
+            continue;
+        }
+
+        ASSERT_NE(v, PURC_VARIANT_INVALID) << key;
+        int64_t n;
+        ASSERT_TRUE(purc_variant_cast_to_longint(v, &n, false));
+        ASSERT_EQ(n, (i % 2) ? i : -i);
+    }
+
+    /* the members are still iterated in the order of the keys */
+    const char *prev = NULL;
+    size_t nr = 0;
+    purc_variant_t k, v;
+    foreach_key_value_in_variant_object(obj, k, v) {
+        const char *sk = purc_variant_get_string_const(k);
+        if (prev)
+            ASSERT_LT(strcmp(prev, sk), 0);
+        prev = sk;
+        nr++;
+        (void)v;
+    } end_foreach;
+    ASSERT_EQ(nr, (size_t)(nr_keys - nr_removed));
+
+    purc_variant_revoke_listener(obj, listener);
+    purc_variant_unref(obj);
+}
+
+// the objects made in bulk behave like the ones made one pair by one
+TEST(object, make_from)
+{
+    PurCInstance purc;
+
+    purc_variant_t keys[3], values[3];
+    keys[0] = purc_variant_make_string_static("id", false);
+    keys[1] = purc_variant_make_string_static("name", false);
+    keys[2] = purc_variant_make_string_static("id", false);
+    values[0] = purc_variant_make_longint(0);
+    values[1] = purc_variant_make_string_static("foo", false);
+    values[2] = purc_variant_make_longint(1);
+
+    /* the later pair overrides the earlier one */
+    purc_variant_t obj = purc_variant_make_object_from(3, keys, values);
+    ASSERT_NE(obj, PURC_VARIANT_INVALID);
+    purc_variant_t ref = purc_variant_make_object(2,
+            keys[1], values[1], keys[2], values[2]);
+    ASSERT_NE(ref, PURC_VARIANT_INVALID);
+    ASSERT_TRUE(purc_variant_is_equal_to(obj, ref));
+
+    purc_variant_t empty = purc_variant_make_object_from(0, NULL, NULL);
+    ASSERT_NE(empty, PURC_VARIANT_INVALID);
+    ASSERT_EQ(purc_variant_object_get_size(empty), 0);
+    purc_variant_unref(empty);
+
+    /* a listener registered afterwards sees every change */
+    int counts[3] = { 0, 0, 0 };
+    struct pcvar_listener *listener;
+    listener = purc_variant_register_post_listener(obj,
+            (pcvar_op_t)PCVAR_OPERATION_ALL, count_ops, counts);
+    ASSERT_NE(listener, nullptr);
+    ASSERT_TRUE(purc_variant_object_set_by_static_ckey(obj, "id", values[0]));
+    ASSERT_TRUE(purc_variant_object_set_by_static_ckey(obj, "extra",
+                values[0]));
+    ASSERT_TRUE(purc_variant_object_remove_by_static_ckey(obj, "extra",
+                false));
+    ASSERT_EQ(counts[0], 1);
+    ASSERT_EQ(counts[1], 1);
+    ASSERT_EQ(counts[2], 1);
+    purc_variant_revoke_listener(obj, listener);
+
+    /* the unique keys of a set still guard the members once they join */
+    purc_variant_t set = purc_variant_make_set_by_ckey(2, "id", obj, ref);
+    ASSERT_NE(set, PURC_VARIANT_INVALID);
+    purc_variant_t member = purc_variant_set_get_by_index(set, 0);
+    ASSERT_NE(member, PURC_VARIANT_INVALID);
+    purc_variant_t other = purc_variant_set_get_by_index(set, 1);
+    ASSERT_NE(other, PURC_VARIANT_INVALID);
+    purc_variant_t id = purc_variant_object_get_by_ckey(other, "id");
+    ASSERT_NE(id, PURC_VARIANT_INVALID);
+    ASSERT_FALSE(purc_variant_object_set_by_static_ckey(member, "id", id));
+
+    purc_variant_unref(set);
+    purc_variant_unref(ref);
+    purc_variant_unref(obj);
+    for (int i = 0; i < 3; i++) {
+        purc_variant_unref(keys[i]);
+        purc_variant_unref(values[i]);
+    }
+}
@@ -160,3 +160,115 @@ end:
     purc_cleanup ();
 }
 
+
+static int
+_append_to_string(const char *buf, size_t len, void *ctxt)
+{
+    std::string *str = (std::string *)ctxt;
+    str->append(buf, len);
+    return 0;
+}
+
+static std::string
+_serialize_doc(struct pcvdom_document *doc)
+{
+    std::string str;
+    pcvdom_util_node_serialize(pcvdom_node_from_document(doc),
+            _append_to_string, &str);
+    return str;
+}
+
+static int
+_process_image(const char *fn)
+{
+    if (strstr(pcutils_basename(fn), "neg.") == pcutils_basename(fn))
+        return 0;
+
+    purc_rwstream_t rin = purc_rwstream_new_from_file(fn, "r");
+    if (!rin) {
+        ADD_FAILURE() << "Failed to open [" << fn << "]" << std::endl;
+        return -1;
+    }
+
+    struct pcvdom_pos pos;
+    struct pcvdom_document *doc;
+    doc = pcvdom_util_document_from_stream(rin, &pos);
+    purc_rwstream_destroy(rin);
+    if (!doc) {
+        ADD_FAILURE() << "Parsing positive sample: [" << fn << "]" << std::endl;
+        return -1;
+    }
+
+    unsigned char md5[MD5_DIGEST_SIZE];
+    pcutils_md5digest(fn, md5);
+    const size_t length = 1234;
+
+    purc_rwstream_t out = purc_rwstream_new_buffer(1024, 0);
+    EXPECT_EQ(pcvdom_document_write_image(doc, md5, length, out), 0) << fn;
+
+    size_t sz = 0;
+    const char *image = (const char *)purc_rwstream_get_mem_buffer(out, &sz);
+
+    /* the same tree in the same order */
+    struct pcvdom_document *loaded;
+    loaded = pcvdom_document_read_image(image, sz, md5, length);
+    EXPECT_NE(loaded, nullptr) << fn;
+    if (loaded) {
+        EXPECT_EQ(_serialize_doc(loaded), _serialize_doc(doc)) << fn;
+        struct pcvdom_element *root = pcvdom_document_get_root(loaded);
+        EXPECT_EQ(root != NULL, pcvdom_document_get_root(doc) != NULL) << fn;
+        if (root) {
+            std::string loaded_root, orig_root;
+            pcvdom_util_node_serialize(pcvdom_node_from_element(root),
+                    _append_to_string, &loaded_root);
+            pcvdom_util_node_serialize(
+                    pcvdom_node_from_element(pcvdom_document_get_root(doc)),
+                    _append_to_string, &orig_root);
+            EXPECT_EQ(loaded_root, orig_root) << fn;
+        }
+        pcvdom_document_unref(loaded);
+    }
+
+    /* an image made from other sources is rejected */
+    EXPECT_EQ(pcvdom_document_read_image(image, sz, md5, length + 1), nullptr);
+    unsigned char other[MD5_DIGEST_SIZE];
+    memcpy(other, md5, sizeof(other));
+    other[0] ^= 0xFF;
+    EXPECT_EQ(pcvdom_document_read_image(image, sz, other, length), nullptr);
+
+    /* so is a truncated one, wherever it is cut */
+    std::string copy(image, sz);
+    size_t step = sz / 64 + 1;
+    for (size_t cut = 0; cut < sz; cut += step) {
+        EXPECT_EQ(pcvdom_document_read_image(copy.data(), cut, md5, length),
+                nullptr) << fn << " cut at " << cut;
+    }
+
+    purc_rwstream_destroy(out);
+    pcvdom_document_unref(doc);
+    return 0;
+}
+
+TEST(vdom_gen, image)
+{
+    purc_instance_extra_info info = {};
+    int r = purc_init_ex(PURC_MODULE_HVML, "cn.fmsoft.hybridos.test",
+        "vdom_gen", &info);
+    ASSERT_EQ(r, PURC_ERROR_OK);
+
+    char path[PATH_MAX+1];
+    test_getpath_from_env_or_rel(path, sizeof(path),
+        "SOURCE_FILES", "/data/*.hvml");
+
+    glob_t globbuf;
+    memset(&globbuf, 0, sizeof(globbuf));
+    if (path[0] && glob(path, 0, NULL, &globbuf) == 0) {
+        for (size_t i = 0; i < globbuf.gl_pathc; ++i) {
+            if (_process_image(globbuf.gl_pathv[i]))
+                break;
+        }
+    }
+    globfree(&globbuf);
+
+    purc_cleanup();
+}